@@ -0,0 +1,112 @@
+use super::{serialized_block_size, BlockType};
+use crate::{utils::FixedSizeSerialize, Account, BlockHash, Root};
+
+/// Borrowed view of a serialized block (without the block type byte).
+/// It gives access to the fields that are needed for early checks like the
+/// work validation, without deserializing and copying the whole block.
+#[derive(Clone, Copy, Debug)]
+pub struct BlockView<'a> {
+    block_type: BlockType,
+    bytes: &'a [u8],
+}
+
+impl<'a> BlockView<'a> {
+    const WORK_SIZE: usize = std::mem::size_of::<u64>();
+
+    /// Returns None if the buffer is too small for the given block type
+    pub fn new(block_type: BlockType, bytes: &'a [u8]) -> Option<Self> {
+        let size = serialized_block_size(block_type);
+        if size == 0 || bytes.len() < size {
+            return None;
+        }
+        Some(Self {
+            block_type,
+            bytes: &bytes[..size],
+        })
+    }
+
+    pub fn block_type(&self) -> BlockType {
+        self.block_type
+    }
+
+    pub fn bytes(&self) -> &'a [u8] {
+        self.bytes
+    }
+
+    pub fn root(&self) -> Root {
+        match self.block_type {
+            BlockType::State => {
+                let previous = self.hash_at(Account::serialized_size());
+                if !previous.is_zero() {
+                    previous.into()
+                } else {
+                    self.hash_at(0).into()
+                }
+            }
+            BlockType::LegacyOpen => {
+                // source and representative come before the account
+                self.hash_at(BlockHash::serialized_size() + Account::serialized_size())
+                    .into()
+            }
+            _ => self.hash_at(0).into(),
+        }
+    }
+
+    pub fn work(&self) -> u64 {
+        let mut work_bytes = [0u8; Self::WORK_SIZE];
+        work_bytes.copy_from_slice(&self.bytes[self.bytes.len() - Self::WORK_SIZE..]);
+        match self.block_type {
+            BlockType::State => u64::from_be_bytes(work_bytes),
+            _ => u64::from_le_bytes(work_bytes),
+        }
+    }
+
+    fn hash_at(&self, offset: usize) -> BlockHash {
+        BlockHash::from_slice(&self.bytes[offset..offset + BlockHash::serialized_size()]).unwrap()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{utils::MemoryStream, Block, BlockBase, TestBlockBuilder};
+
+    #[test]
+    fn state_block() {
+        assert_view_matches(Block::new_test_instance());
+    }
+
+    #[test]
+    fn state_open_block() {
+        assert_view_matches(Block::new_test_open());
+    }
+
+    #[test]
+    fn legacy_blocks() {
+        assert_view_matches(TestBlockBuilder::legacy_open().build());
+        assert_view_matches(TestBlockBuilder::legacy_send().build());
+        assert_view_matches(TestBlockBuilder::legacy_receive().build());
+        assert_view_matches(TestBlockBuilder::legacy_change().build());
+    }
+
+    #[test]
+    fn buffer_too_small() {
+        let bytes = serialize(&Block::new_test_instance());
+        assert!(BlockView::new(BlockType::State, &bytes[..bytes.len() - 1]).is_none());
+        assert!(BlockView::new(BlockType::Invalid, &bytes).is_none());
+    }
+
+    fn assert_view_matches(block: Block) {
+        let bytes = serialize(&block);
+        let view = BlockView::new(block.block_type(), &bytes).unwrap();
+        assert_eq!(view.root(), block.root());
+        assert_eq!(view.work(), block.work());
+        assert_eq!(view.bytes(), bytes.as_slice());
+    }
+
+    fn serialize(block: &Block) -> Vec<u8> {
+        let mut stream = MemoryStream::new();
+        block.serialize_without_block_type(&mut stream);
+        stream.to_vec()
+    }
+}
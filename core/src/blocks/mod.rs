@@ -1,6 +1,9 @@
 mod block_details;
 pub use block_details::BlockDetails;
 
+mod block_view;
+pub use block_view::BlockView;
+
 mod block_sideband;
 pub use block_sideband::BlockSideband;
 
@@ -575,9 +578,15 @@ impl Deserialize for SavedBlock {
     type Target = Self;
     fn deserialize(stream: &mut dyn Stream) -> anyhow::Result<Self> {
         let block = Block::deserialize(stream)?;
-        let mut sideband = BlockSideband::from_stream(stream, block.block_type())?;
-        // BlockSideband does not serialize all data depending on the block type.
-        // That's why we fill in the missing data here:
+        let sideband = BlockSideband::from_stream(stream, block.block_type())?;
+        Ok(SavedBlock::from_stored_sideband(block, sideband))
+    }
+}
+
+impl SavedBlock {
+    /// BlockSideband does not serialize all data depending on the block type.
+    /// This fills in the fields that are stored in the block itself
+    pub fn from_stored_sideband(block: Block, mut sideband: BlockSideband) -> Self {
         match &block {
             Block::LegacySend(i) => {
                 sideband.balance = i.balance();
@@ -598,7 +607,7 @@ impl Deserialize for SavedBlock {
                 sideband.balance = state.balance();
             }
         }
-        Ok(SavedBlock { block, sideband })
+        SavedBlock { block, sideband }
     }
 }
 
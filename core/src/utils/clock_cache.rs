@@ -0,0 +1,185 @@
+use std::{
+    collections::{HashMap, VecDeque},
+    hash::Hash,
+};
+
+/// Map with a fixed capacity whose eviction approximates LRU with the CLOCK algorithm:
+/// an entry that was hit since the last time it reached the front of the queue gets a
+/// second chance.
+pub struct ClockCache<K, V> {
+    entries: HashMap<K, ClockEntry<V>>,
+    /// Keys in insertion order. May contain keys that were already removed
+    clock: VecDeque<K>,
+    capacity: usize,
+}
+
+struct ClockEntry<V> {
+    value: V,
+    referenced: bool,
+}
+
+impl<K, V> ClockCache<K, V>
+where
+    K: Hash + Eq + Clone,
+{
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            entries: HashMap::new(),
+            clock: VecDeque::new(),
+            capacity,
+        }
+    }
+
+    /// Returns the value and marks it as hit
+    pub fn get(&mut self, key: &K) -> Option<&V> {
+        let entry = self.entries.get_mut(key)?;
+        entry.referenced = true;
+        Some(&entry.value)
+    }
+
+    /// Returns the value without marking it as hit
+    pub fn peek(&self, key: &K) -> Option<&V> {
+        self.entries.get(key).map(|e| &e.value)
+    }
+
+    /// Returns the value without marking it as hit
+    pub fn peek_mut(&mut self, key: &K) -> Option<&mut V> {
+        self.entries.get_mut(key).map(|e| &mut e.value)
+    }
+
+    /// Inserts or replaces the value of `key`. Returns the entry that was evicted
+    /// to make room for it. With a capacity of 0 nothing gets inserted, and the given
+    /// entry is returned instead.
+    pub fn insert(&mut self, key: K, value: V) -> Option<(K, V)> {
+        if let Some(entry) = self.entries.get_mut(&key) {
+            entry.value = value;
+            return None;
+        }
+
+        if self.capacity == 0 {
+            return Some((key, value));
+        }
+
+        let evicted = if self.entries.len() >= self.capacity {
+            self.evict_one()
+        } else {
+            None
+        };
+
+        self.clock.push_back(key.clone());
+        self.entries.insert(
+            key,
+            ClockEntry {
+                value,
+                referenced: false,
+            },
+        );
+
+        if self.clock.len() > self.capacity * 2 {
+            // Too many keys of removed entries
+            let entries = &self.entries;
+            self.clock.retain(|k| entries.contains_key(k));
+        }
+        evicted
+    }
+
+    pub fn remove(&mut self, key: &K) -> Option<V> {
+        self.entries.remove(key).map(|e| e.value)
+    }
+
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    pub fn capacity(&self) -> usize {
+        self.capacity
+    }
+
+    pub fn values(&self) -> impl Iterator<Item = &V> {
+        self.entries.values().map(|e| &e.value)
+    }
+
+    fn evict_one(&mut self) -> Option<(K, V)> {
+        while let Some(key) = self.clock.pop_front() {
+            match self.entries.get_mut(&key) {
+                Some(entry) if entry.referenced => {
+                    entry.referenced = false;
+                    self.clock.push_back(key);
+                }
+                Some(_) => {
+                    let entry = self.entries.remove(&key).unwrap();
+                    return Some((key, entry.value));
+                }
+                None => {}
+            }
+        }
+        None
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn empty() {
+        let mut cache: ClockCache<i32, i32> = ClockCache::new(10);
+        assert_eq!(cache.get(&1), None);
+        assert_eq!(cache.len(), 0);
+    }
+
+    #[test]
+    fn replace_value() {
+        let mut cache = ClockCache::new(10);
+        cache.insert(1, 1);
+        assert_eq!(cache.insert(1, 2), None);
+        assert_eq!(cache.peek(&1), Some(&2));
+        assert_eq!(cache.len(), 1);
+    }
+
+    #[test]
+    fn evict_entries_that_were_not_hit() {
+        let mut cache = ClockCache::new(2);
+        cache.insert(1, 1);
+        cache.insert(2, 2);
+        cache.get(&1);
+
+        assert_eq!(cache.insert(3, 3), Some((2, 2)));
+
+        assert_eq!(cache.len(), 2);
+        assert_eq!(cache.peek(&1), Some(&1));
+        assert_eq!(cache.peek(&2), None);
+        assert_eq!(cache.peek(&3), Some(&3));
+    }
+
+    #[test]
+    fn peek_doesnt_count_as_hit() {
+        let mut cache = ClockCache::new(1);
+        cache.insert(1, 1);
+        cache.peek(&1);
+
+        assert_eq!(cache.insert(2, 2), Some((1, 1)));
+    }
+
+    #[test]
+    fn forget_keys_of_removed_entries() {
+        let mut cache = ClockCache::new(2);
+        for i in 0..10 {
+            cache.insert(i, i);
+            cache.remove(&i);
+        }
+        assert!(cache.is_empty());
+        assert!(cache.clock.len() <= 4);
+    }
+
+    #[test]
+    fn zero_capacity() {
+        let mut cache = ClockCache::new(0);
+        assert_eq!(cache.insert(1, 1), Some((1, 1)));
+        assert_eq!(cache.len(), 0);
+    }
+}
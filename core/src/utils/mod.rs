@@ -1,7 +1,10 @@
+mod clock_cache;
 mod container_info;
 mod peer;
 mod stream;
+mod thread_topology;
 
+pub use clock_cache::ClockCache;
 pub use container_info::*;
 pub use peer::*;
 use std::{
@@ -10,6 +13,7 @@ use std::{
     time::{Duration, SystemTime, UNIX_EPOCH},
 };
 pub use stream::*;
+pub use thread_topology::*;
 
 pub trait Serialize {
     fn serialize(&self, stream: &mut dyn BufferWriter);
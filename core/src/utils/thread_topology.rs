@@ -0,0 +1,253 @@
+use std::{io, sync::Mutex};
+
+// Matches CPU_SETSIZE of glibc
+const MAX_CPUS: usize = 1024;
+
+/// The subsystems whose threads can be placed on dedicated CPUs
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum ThreadRole {
+    BlockProcessor,
+    ConfirmingSet,
+    VoteProcessor,
+    /// The message processor and the network loops
+    Network,
+    /// The tokio worker threads of the node. They can only be placed if the
+    /// node has a dedicated runtime, see `ThreadTopology::io_threads`
+    Io,
+    /// The proof of work generator threads
+    Work,
+    /// The short lived threads which traverse a whole table in parallel,
+    /// e.g. while the ledger cache is loaded or the ledger gets pruned
+    Traversal,
+}
+
+#[derive(Clone, Default, PartialEq, Eq, Debug)]
+pub struct ThreadPlacement {
+    /// The CPUs on which the threads may run. Empty means no restriction
+    pub cpus: Vec<usize>,
+    /// The nice value of the threads. Higher values lower their priority
+    pub nice: i32,
+}
+
+/// Describes on which CPUs the threads of each subsystem run.
+/// Linux allocates memory on the NUMA node of the thread which touches it first,
+/// so pinning a subsystem to the CPUs of one socket also keeps its allocations local.
+#[derive(Clone, Default, PartialEq, Eq, Debug)]
+pub struct ThreadTopology {
+    pub block_processor: ThreadPlacement,
+    pub confirming_set: ThreadPlacement,
+    pub vote_processor: ThreadPlacement,
+    pub network: ThreadPlacement,
+    /// Only applies if `io_threads` is not 0. The threads of a shared runtime
+    /// belong to the process and are not placed by the node
+    pub io: ThreadPlacement,
+    pub work: ThreadPlacement,
+    pub traversal: ThreadPlacement,
+    /// Number of worker threads of a dedicated tokio runtime for the node.
+    /// 0 means the node shares the runtime of the process
+    pub io_threads: usize,
+}
+
+impl ThreadTopology {
+    pub fn placement(&self, role: ThreadRole) -> &ThreadPlacement {
+        match role {
+            ThreadRole::BlockProcessor => &self.block_processor,
+            ThreadRole::ConfirmingSet => &self.confirming_set,
+            ThreadRole::VoteProcessor => &self.vote_processor,
+            ThreadRole::Network => &self.network,
+            ThreadRole::Io => &self.io,
+            ThreadRole::Work => &self.work,
+            ThreadRole::Traversal => &self.traversal,
+        }
+    }
+
+    /// The io placement is ignored if the node shares the tokio runtime of the process
+    pub fn io_placement_ignored(&self) -> bool {
+        self.io_threads == 0 && self.io != ThreadPlacement::default()
+    }
+
+    fn placements(&self) -> [&ThreadPlacement; 7] {
+        [
+            &self.block_processor,
+            &self.confirming_set,
+            &self.vote_processor,
+            &self.network,
+            &self.io,
+            &self.work,
+            &self.traversal,
+        ]
+    }
+
+    fn validate(&self, cpu_count: usize) -> anyhow::Result<()> {
+        for placement in self.placements() {
+            if let Some(cpu) = placement.cpus.iter().find(|cpu| **cpu >= cpu_count) {
+                bail!("CPU {} is out of range 0..{}", cpu, cpu_count - 1);
+            }
+            if !(-20..=19).contains(&placement.nice) {
+                bail!("nice value {} is out of range -20..19", placement.nice);
+            }
+        }
+        Ok(())
+    }
+}
+
+// The placement is process wide, like the CPUs it refers to
+static TOPOLOGY: Mutex<Option<ThreadTopology>> = Mutex::new(None);
+
+/// Sets the topology that `apply_thread_role` uses. Threads which are already running
+/// keep their placement
+pub fn set_thread_topology(topology: ThreadTopology) -> anyhow::Result<()> {
+    // The available CPUs aren't necessarily numbered from 0, e.g. in containers,
+    // so CPUs which don't exist are only detected when a thread is pinned
+    topology.validate(MAX_CPUS)?;
+    *TOPOLOGY.lock().unwrap() = Some(topology);
+    Ok(())
+}
+
+/// Places the calling thread according to the topology of its role.
+/// It has to be called by the thread itself, right after it was spawned
+pub fn apply_thread_role(role: ThreadRole) -> io::Result<()> {
+    let placement = match TOPOLOGY.lock().unwrap().as_ref() {
+        Some(topology) => topology.placement(role).clone(),
+        None => return Ok(()),
+    };
+    if !placement.cpus.is_empty() {
+        pin_current_thread(&placement.cpus)?;
+    }
+    if placement.nice != 0 {
+        set_current_thread_nice(placement.nice)?;
+    }
+    Ok(())
+}
+
+/// Like `apply_thread_role`, but a failure only gets logged, because the threads work
+/// without their placement too
+pub fn place_current_thread(role: ThreadRole) {
+    if let Err(e) = apply_thread_role(role) {
+        tracing::warn!("Could not apply the thread topology for {:?}: {}", role, e);
+    }
+}
+
+#[cfg(target_os = "linux")]
+mod sys {
+    use super::MAX_CPUS;
+    use std::io;
+
+    const PRIO_PROCESS: i32 = 0;
+
+    extern "C" {
+        fn sched_setaffinity(pid: i32, cpusetsize: usize, mask: *const u64) -> i32;
+        fn setpriority(which: i32, who: u32, prio: i32) -> i32;
+    }
+
+    pub fn pin_current_thread(cpus: &[usize]) -> io::Result<()> {
+        let mut mask = [0u64; MAX_CPUS / 64];
+        for &cpu in cpus {
+            if cpu >= MAX_CPUS {
+                return Err(io::Error::new(io::ErrorKind::InvalidInput, "invalid CPU"));
+            }
+            mask[cpu / 64] |= 1 << (cpu % 64);
+        }
+        // pid 0 is the calling thread
+        let result = unsafe { sched_setaffinity(0, std::mem::size_of_val(&mask), mask.as_ptr()) };
+        if result == 0 {
+            Ok(())
+        } else {
+            Err(io::Error::last_os_error())
+        }
+    }
+
+    pub fn set_current_thread_nice(nice: i32) -> io::Result<()> {
+        // On Linux the nice value is a per thread attribute, so this only affects the calling thread
+        let result = unsafe { setpriority(PRIO_PROCESS, 0, nice) };
+        if result == 0 {
+            Ok(())
+        } else {
+            Err(io::Error::last_os_error())
+        }
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+mod sys {
+    use std::io;
+
+    pub fn pin_current_thread(_cpus: &[usize]) -> io::Result<()> {
+        Err(io::ErrorKind::Unsupported.into())
+    }
+
+    pub fn set_current_thread_nice(_nice: i32) -> io::Result<()> {
+        Err(io::ErrorKind::Unsupported.into())
+    }
+}
+
+pub use sys::{pin_current_thread, set_current_thread_nice};
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn placement_by_role() {
+        let topology = ThreadTopology {
+            work: ThreadPlacement {
+                cpus: vec![1],
+                nice: 10,
+            },
+            ..Default::default()
+        };
+        assert_eq!(topology.placement(ThreadRole::Work).cpus, [1]);
+        assert_eq!(
+            topology.placement(ThreadRole::Io),
+            &ThreadPlacement::default()
+        );
+    }
+
+    #[test]
+    fn io_placement_needs_dedicated_runtime() {
+        let mut topology = ThreadTopology {
+            io: ThreadPlacement {
+                cpus: vec![2, 3],
+                nice: 0,
+            },
+            ..Default::default()
+        };
+        assert!(topology.io_placement_ignored());
+
+        topology.io_threads = 2;
+        assert!(!topology.io_placement_ignored());
+        assert!(!ThreadTopology::default().io_placement_ignored());
+    }
+
+    #[test]
+    fn reject_missing_cpu() {
+        let topology = ThreadTopology {
+            block_processor: ThreadPlacement {
+                cpus: vec![4],
+                nice: 0,
+            },
+            ..Default::default()
+        };
+        assert!(topology.validate(4).is_err());
+        assert!(topology.validate(5).is_ok());
+    }
+
+    #[test]
+    fn reject_invalid_nice_value() {
+        let topology = ThreadTopology {
+            work: ThreadPlacement {
+                cpus: Vec::new(),
+                nice: 20,
+            },
+            ..Default::default()
+        };
+        assert!(topology.validate(1).is_err());
+    }
+
+    #[cfg(target_os = "linux")]
+    #[test]
+    fn pin_thread() {
+        let handle = std::thread::spawn(|| pin_current_thread(&[0]));
+        assert!(handle.join().unwrap().is_ok());
+    }
+}
@@ -1,4 +1,5 @@
 mod cpu_work_generator;
+mod multi_lane_work_generator;
 mod opencl_work_generator;
 mod stub_work_pool;
 mod work_pool;
@@ -8,6 +9,7 @@ mod work_thresholds;
 mod xorshift;
 
 pub(crate) use cpu_work_generator::CpuWorkGenerator;
+pub(crate) use multi_lane_work_generator::{LaneBackend, MultiLaneWorkGenerator};
 pub use stub_work_pool::StubWorkPool;
 pub(crate) use work_pool::WorkGenerator;
 pub use work_pool::{WorkPool, WorkPoolImpl, STUB_WORK_POOL};
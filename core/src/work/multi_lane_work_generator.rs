@@ -0,0 +1,300 @@
+use super::{WorkGenerator, WorkRng, WorkTicket, XorShift1024Star};
+use crate::Root;
+use std::{thread, time::Duration};
+
+/// Number of nonces that are hashed together in one step
+pub(crate) const LANES: usize = 8;
+
+/// CPU work generator that hashes `LANES` nonces per step with a multi-lane Blake2b.
+/// The lanes are independent of each other, so the compiler maps them onto SIMD
+/// registers. The hash function is compiled once per instruction set and the widest
+/// one that the CPU supports is picked at runtime.
+pub(crate) struct MultiLaneWorkGenerator {
+    rng: XorShift1024Star,
+    backend: LaneBackend,
+    rate_limiter: Duration,
+    pub iteration_size: usize,
+}
+
+const DEFAULT_ITERATION_SIZE: usize = 256;
+
+impl MultiLaneWorkGenerator {
+    pub fn new(backend: LaneBackend, rate_limiter: Duration) -> Self {
+        Self {
+            rng: XorShift1024Star::new(),
+            backend,
+            rate_limiter,
+            iteration_size: DEFAULT_ITERATION_SIZE,
+        }
+    }
+
+    /// Tries to create PoW in a batch of `iteration_size` nonces
+    fn try_create_batch(&mut self, root: &[u64; 4], min_difficulty: u64) -> Option<u64> {
+        let mut iteration = self.iteration_size.div_ceil(LANES);
+        while iteration > 0 {
+            // Consecutive nonces from a random start, so that threads don't overlap
+            let start = self.rng.next_work();
+            let nonces: [u64; LANES] = std::array::from_fn(|i| start.wrapping_add(i as u64));
+            let difficulties = self.backend.hash_lanes(root, &nonces);
+            if let Some(i) = difficulties.iter().position(|d| *d >= min_difficulty) {
+                return Some(nonces[i]);
+            }
+            iteration -= 1;
+        }
+        None
+    }
+}
+
+impl WorkGenerator for MultiLaneWorkGenerator {
+    fn create(
+        &mut self,
+        item: &Root,
+        min_difficulty: u64,
+        work_ticket: &WorkTicket,
+    ) -> Option<u64> {
+        let root = root_words(item);
+        while !work_ticket.expired() {
+            let result = self.try_create_batch(&root, min_difficulty);
+            if result.is_some() {
+                return result;
+            }
+
+            // Add a rate limiter (if specified) to the pow calculation to save some CPUs which don't want to operate at full throttle
+            if !self.rate_limiter.is_zero() {
+                thread::sleep(self.rate_limiter);
+            }
+        }
+        None
+    }
+}
+
+/// Instruction set that is used for the multi-lane hashing
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub(crate) enum LaneBackend {
+    Avx512,
+    Avx2,
+    Neon,
+}
+
+impl LaneBackend {
+    /// Returns None if the CPU has no SIMD support that is worth using.
+    /// In that case the scalar `CpuWorkGenerator` should be used.
+    pub fn detect() -> Option<Self> {
+        #[cfg(target_arch = "x86_64")]
+        {
+            if is_x86_feature_detected!("avx512f") {
+                return Some(Self::Avx512);
+            }
+            if is_x86_feature_detected!("avx2") {
+                return Some(Self::Avx2);
+            }
+        }
+
+        #[cfg(target_arch = "aarch64")]
+        {
+            if std::arch::is_aarch64_feature_detected!("neon") {
+                return Some(Self::Neon);
+            }
+        }
+
+        None
+    }
+
+    fn hash_lanes(&self, root: &[u64; 4], nonces: &[u64; LANES]) -> [u64; LANES] {
+        match self {
+            #[cfg(target_arch = "x86_64")]
+            // SAFETY: the backend is only selected if the CPU supports the instruction set
+            Self::Avx512 => unsafe { x86::hash_lanes_avx512(root, nonces) },
+            #[cfg(target_arch = "x86_64")]
+            // SAFETY: see above
+            Self::Avx2 => unsafe { x86::hash_lanes_avx2(root, nonces) },
+            // NEON is part of the aarch64 baseline, so the plain code gets vectorized
+            _ => hash_lanes(root, nonces),
+        }
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+mod x86 {
+    use super::{hash_lanes, LANES};
+
+    #[target_feature(enable = "avx512f")]
+    pub(super) unsafe fn hash_lanes_avx512(root: &[u64; 4], nonces: &[u64; LANES]) -> [u64; LANES] {
+        hash_lanes(root, nonces)
+    }
+
+    #[target_feature(enable = "avx2")]
+    pub(super) unsafe fn hash_lanes_avx2(root: &[u64; 4], nonces: &[u64; LANES]) -> [u64; LANES] {
+        hash_lanes(root, nonces)
+    }
+}
+
+fn root_words(root: &Root) -> [u64; 4] {
+    let bytes = root.as_bytes();
+    std::array::from_fn(|i| u64::from_le_bytes(bytes[i * 8..i * 8 + 8].try_into().unwrap()))
+}
+
+const IV: [u64; 8] = [
+    0x6a09e667f3bcc908,
+    0xbb67ae8584caa73b,
+    0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1,
+    0x510e527fade682d1,
+    0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b,
+    0x5be0cd19137e2179,
+];
+
+const SIGMA: [[usize; 16]; 12] = [
+    [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15],
+    [14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3],
+    [11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4],
+    [7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8],
+    [9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13],
+    [2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9],
+    [12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11],
+    [13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10],
+    [6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5],
+    [10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0],
+    [0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15],
+    [14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3],
+];
+
+/// First state word: 8 byte digest, no key, fanout 1, depth 1
+const H0: u64 = IV[0] ^ 0x0101_0000 ^ 8;
+
+/// The hashed message is the nonce (8 bytes) followed by the root (32 bytes)
+const MESSAGE_LEN: u64 = 40;
+
+type Lanes = [u64; LANES];
+
+/// Blake2b with an 8 byte digest of `nonce || root` for every lane. This is the same
+/// value as `DifficultyV1::get_difficulty`. The whole message fits into the single,
+/// final block, so only one compression is needed.
+#[inline(always)]
+fn hash_lanes(root: &[u64; 4], nonces: &Lanes) -> Lanes {
+    let mut m = [[0u64; LANES]; 16];
+    m[0] = *nonces;
+    for i in 0..4 {
+        m[i + 1] = [root[i]; LANES];
+    }
+
+    let mut v = [[0u64; LANES]; 16];
+    v[0] = [H0; LANES];
+    for i in 1..8 {
+        v[i] = [IV[i]; LANES];
+    }
+    for i in 0..8 {
+        v[i + 8] = [IV[i]; LANES];
+    }
+    v[12] = [IV[4] ^ MESSAGE_LEN; LANES];
+    v[14] = [!IV[6]; LANES];
+
+    for s in &SIGMA {
+        g(&mut v, 0, 4, 8, 12, &m[s[0]], &m[s[1]]);
+        g(&mut v, 1, 5, 9, 13, &m[s[2]], &m[s[3]]);
+        g(&mut v, 2, 6, 10, 14, &m[s[4]], &m[s[5]]);
+        g(&mut v, 3, 7, 11, 15, &m[s[6]], &m[s[7]]);
+        g(&mut v, 0, 5, 10, 15, &m[s[8]], &m[s[9]]);
+        g(&mut v, 1, 6, 11, 12, &m[s[10]], &m[s[11]]);
+        g(&mut v, 2, 7, 8, 13, &m[s[12]], &m[s[13]]);
+        g(&mut v, 3, 4, 9, 14, &m[s[14]], &m[s[15]]);
+    }
+
+    std::array::from_fn(|l| H0 ^ v[0][l] ^ v[8][l])
+}
+
+#[inline(always)]
+fn g(v: &mut [Lanes; 16], a: usize, b: usize, c: usize, d: usize, x: &Lanes, y: &Lanes) {
+    for l in 0..LANES {
+        let mut va = v[a][l];
+        let mut vb = v[b][l];
+        let mut vc = v[c][l];
+        let mut vd = v[d][l];
+        va = va.wrapping_add(vb).wrapping_add(x[l]);
+        vd = (vd ^ va).rotate_right(32);
+        vc = vc.wrapping_add(vd);
+        vb = (vb ^ vc).rotate_right(24);
+        va = va.wrapping_add(vb).wrapping_add(y[l]);
+        vd = (vd ^ va).rotate_right(16);
+        vc = vc.wrapping_add(vd);
+        vb = (vb ^ vc).rotate_right(63);
+        v[a][l] = va;
+        v[b][l] = vb;
+        v[c][l] = vc;
+        v[d][l] = vd;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::difficulty::{Difficulty, DifficultyV1};
+
+    #[test]
+    fn same_difficulty_as_scalar_implementation() {
+        let roots = [
+            Root::from(0),
+            Root::from(123),
+            Root::decode_hex("000D1BAEC8EC208142C99059B393051BAC8380F9B5A2E6B2489A277D81789F3F")
+                .unwrap(),
+        ];
+
+        for root in &roots {
+            let nonces: [u64; LANES] =
+                std::array::from_fn(|i| 0xdead_beef_0000_0000 + i as u64 * 7919);
+            let difficulties = hash_lanes(&root_words(root), &nonces);
+            for (nonce, difficulty) in nonces.iter().zip(difficulties) {
+                assert_eq!(
+                    difficulty,
+                    DifficultyV1::default().get_difficulty(root, *nonce)
+                );
+            }
+        }
+    }
+
+    #[test]
+    fn known_difficulty() {
+        let root = Root::from(123);
+        assert_eq!(
+            hash_lanes(&root_words(&root), &[456; LANES]),
+            [10978371542656683347; LANES]
+        );
+    }
+
+    #[test]
+    fn all_detected_backends_agree() {
+        let Some(backend) = LaneBackend::detect() else {
+            return;
+        };
+        let root_words = root_words(&Root::from(42));
+        let nonces: [u64; LANES] = std::array::from_fn(|i| i as u64);
+        assert_eq!(
+            backend.hash_lanes(&root_words, &nonces),
+            hash_lanes(&root_words, &nonces)
+        );
+    }
+
+    #[test]
+    fn create_valid_work() {
+        let Some(backend) = LaneBackend::detect() else {
+            return;
+        };
+        let root = Root::from(7);
+        let min_difficulty = u64::MAX - u64::MAX / 256;
+        let mut generator = MultiLaneWorkGenerator::new(backend, Duration::ZERO);
+
+        let work = generator
+            .create(&root, min_difficulty, &WorkTicket::never_expires())
+            .unwrap();
+
+        assert!(DifficultyV1::default().get_difficulty(&root, work) >= min_difficulty);
+    }
+
+    #[test]
+    fn expired_work_ticket() {
+        let mut generator = MultiLaneWorkGenerator::new(LaneBackend::Neon, Duration::ZERO);
+        let result = generator.create(&Root::from(1), u64::MAX, &WorkTicket::already_expired());
+        assert_eq!(result, None);
+    }
+}
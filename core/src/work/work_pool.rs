@@ -1,8 +1,11 @@
 use super::{
-    CpuWorkGenerator, StubWorkPool, WorkItem, WorkQueueCoordinator, WorkThread, WorkThresholds,
-    WorkTicket, WORK_THRESHOLDS_STUB,
+    CpuWorkGenerator, LaneBackend, MultiLaneWorkGenerator, StubWorkPool, WorkItem,
+    WorkQueueCoordinator, WorkThread, WorkThresholds, WorkTicket, WORK_THRESHOLDS_STUB,
+};
+use crate::{
+    utils::{place_current_thread, ContainerInfo, ThreadRole},
+    Root,
 };
-use crate::{utils::ContainerInfo, Root};
 use std::{
     mem::size_of,
     sync::{Arc, Condvar, LazyLock, Mutex},
@@ -82,7 +85,11 @@ impl WorkPoolImpl {
     }
 
     fn spawn_cpu_worker_thread(&self) -> JoinHandle<()> {
-        self.spawn_worker_thread(CpuWorkGenerator::new(self.pow_rate_limiter))
+        match LaneBackend::detect() {
+            Some(backend) => self
+                .spawn_worker_thread(MultiLaneWorkGenerator::new(backend, self.pow_rate_limiter)),
+            None => self.spawn_worker_thread(CpuWorkGenerator::new(self.pow_rate_limiter)),
+        }
     }
 
     fn spawn_stub_worker_thread(&self, configured_work: u64) -> JoinHandle<()> {
@@ -97,6 +104,7 @@ impl WorkPoolImpl {
         thread::Builder::new()
             .name("Work pool".to_string())
             .spawn(move || {
+                place_current_thread(ThreadRole::Work);
                 WorkThread::new(work_generator, work_queue).work_loop();
             })
             .unwrap()
@@ -1,5 +1,6 @@
 use crate::{
-    Block, BlockDetails, BlockType, Difficulty, DifficultyV1, Epoch, Networks, Root, StubDifficulty,
+    Block, BlockDetails, BlockType, BlockView, Difficulty, DifficultyV1, Epoch, Networks, Root,
+    StubDifficulty,
 };
 use std::{
     cmp::{max, min},
@@ -258,6 +259,13 @@ impl WorkThresholds {
         difficulty >= threshold
     }
 
+    /// Same as `validate_entry_block`, but for a block that is still serialized
+    pub fn validate_entry_view(&self, block: &BlockView) -> bool {
+        let difficulty = self.difficulty(&block.root(), block.work());
+        let threshold = self.threshold_entry(block.block_type());
+        difficulty >= threshold
+    }
+
     pub fn is_valid_pow(&self, block: &Block, details: &BlockDetails) -> bool {
         self.difficulty_block(block) >= self.threshold(details)
     }
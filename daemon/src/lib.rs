@@ -1,6 +1,7 @@
-use rsnano_core::utils::get_cpu_count;
+use rsnano_core::utils::{get_cpu_count, set_thread_topology, ThreadRole, ThreadTopology};
 use rsnano_node::{
     config::{DaemonConfig, Networks, NodeFlags},
+    utils::place_current_thread,
     Node, NodeBuilder, NodeCallbacks, NodeExt,
 };
 use rsnano_rpc_server::{run_rpc_server, RpcServerConfig};
@@ -49,11 +50,20 @@ impl DaemonBuilder {
     {
         let data_path = self.node_builder.get_data_path()?;
         let parallelism = get_cpu_count();
-        let daemon_config =
-            DaemonConfig::load_from_data_path(self.network, parallelism, &data_path)?;
+        let daemon_config = DaemonConfig::load_from_data_path(
+            self.network,
+            parallelism,
+            &data_path,
+            self.node_builder.get_config_overrides(),
+        )?;
         let rpc_config =
             RpcServerConfig::load_from_data_path(self.network, parallelism, &data_path)?;
-        let node = self.node_builder.finish()?;
+        let io_runtime = create_io_runtime(&daemon_config.node.thread_topology)?;
+        let mut node_builder = self.node_builder;
+        if let Some(runtime) = &io_runtime {
+            node_builder = node_builder.runtime(runtime.handle().clone());
+        }
+        let node = node_builder.finish()?;
         let node = Arc::new(node);
 
         let websocket_server = if daemon_config.node.websocket_config.enabled {
@@ -98,6 +108,27 @@ impl DaemonBuilder {
         }
 
         node.stop();
+        if let Some(runtime) = io_runtime {
+            // The runtime gets dropped from within the async context of the daemon
+            runtime.shutdown_background();
+        }
         Ok(())
     }
 }
+
+/// Creates a separate tokio runtime for the node if the thread topology sizes one.
+/// Otherwise the node uses the runtime of the daemon
+fn create_io_runtime(topology: &ThreadTopology) -> anyhow::Result<Option<tokio::runtime::Runtime>> {
+    if topology.io_threads == 0 {
+        return Ok(None);
+    }
+    // The worker threads are spawned right away, so they need the topology already
+    set_thread_topology(topology.clone())?;
+    let runtime = tokio::runtime::Builder::new_multi_thread()
+        .worker_threads(topology.io_threads)
+        .thread_name("Node IO")
+        .on_thread_start(|| place_current_thread(ThreadRole::Io))
+        .enable_all()
+        .build()?;
+    Ok(Some(runtime))
+}
@@ -1,7 +1,10 @@
 use crate::{LedgerConstants, LedgerObserver, LedgerSetAny, LedgerSetConfirmed};
 use rsnano_core::{BlockHash, ConfirmationHeightInfo, SavedBlock};
 use rsnano_store_lmdb::{LmdbStore, LmdbWriteTransaction, Transaction};
-use std::{collections::VecDeque, sync::atomic::Ordering};
+use std::{
+    collections::{HashSet, VecDeque},
+    sync::atomic::Ordering,
+};
 
 /// Cements Blocks in the ledger
 pub(crate) struct BlockCementer<'a> {
@@ -10,6 +13,7 @@ pub(crate) struct BlockCementer<'a> {
     observer: &'a dyn LedgerObserver,
     any: LedgerSetAny<'a>,
     confirmed: LedgerSetConfirmed<'a>,
+    unconfirmed_index: bool,
 }
 
 impl<'a> BlockCementer<'a> {
@@ -17,6 +21,7 @@ impl<'a> BlockCementer<'a> {
         store: &'a LmdbStore,
         observer: &'a dyn LedgerObserver,
         constants: &'a LedgerConstants,
+        unconfirmed_index: bool,
     ) -> Self {
         Self {
             store,
@@ -24,6 +29,7 @@ impl<'a> BlockCementer<'a> {
             constants,
             any: LedgerSetAny::new(store),
             confirmed: LedgerSetConfirmed::new(store),
+            unconfirmed_index,
         }
     }
 
@@ -60,20 +66,7 @@ impl<'a> BlockCementer<'a> {
                 stack.pop_back();
                 if !self.confirmed.block_exists_or_pruned(txn, &hash) {
                     // We must only confirm blocks that have their dependencies confirmed
-
-                    let conf_height = ConfirmationHeightInfo::new(block.height(), block.hash());
-
-                    // Update store
-                    self.store
-                        .confirmation_height
-                        .put(txn, &block.account(), &conf_height);
-                    self.store
-                        .cache
-                        .cemented_count
-                        .fetch_add(1, Ordering::SeqCst);
-
-                    self.observer.blocks_cemented(1);
-
+                    self.cement(txn, &block);
                     result.push(block);
                 }
             } else {
@@ -96,4 +89,127 @@ impl<'a> BlockCementer<'a> {
         }
         result
     }
+
+    /// Walks the dependency tree of the target block on a read transaction and returns
+    /// the unconfirmed blocks in the order in which they have to be cemented
+    /// (dependencies first). Nothing is written, so multiple walks can run in parallel.
+    pub(crate) fn plan(
+        &self,
+        txn: &dyn Transaction,
+        target_hash: BlockHash,
+        max_blocks: usize,
+    ) -> Vec<SavedBlock> {
+        let mut result = Vec::new();
+        let mut planned = HashSet::new();
+
+        let mut stack = VecDeque::new();
+        stack.push_back(target_hash);
+        while let Some(&hash) = stack.back() {
+            let Some(block) = self.any.get_block(txn, &hash) else {
+                break; // Block was rolled back
+            };
+
+            let dependents =
+                block.dependent_blocks(&self.constants.epochs, &self.constants.genesis_account);
+            for dependent in dependents.iter() {
+                if !dependent.is_zero()
+                    && !planned.contains(dependent)
+                    && !self.confirmed.block_exists_or_pruned(txn, dependent)
+                {
+                    stack.push_back(*dependent);
+
+                    // Limit the stack size to avoid excessive memory usage
+                    // This will forget the bottom of the dependency tree
+                    if stack.len() > max_blocks {
+                        stack.pop_front();
+                    }
+                }
+            }
+
+            if stack.back() == Some(&hash) {
+                stack.pop_back();
+                if !planned.contains(&hash) && !self.confirmed.block_exists_or_pruned(txn, &hash) {
+                    planned.insert(hash);
+                    result.push(block);
+                }
+            }
+
+            // Early return might leave parts of the dependency tree unplanned
+            if result.len() >= max_blocks {
+                break;
+            }
+        }
+        result
+    }
+
+    /// Cements the blocks of a plan created by `plan`. The ledger might have changed since
+    /// the plan was created, so each block is re-checked cheaply. Blocks that got cemented
+    /// in the meantime are skipped, and cementing stops at the first block that was rolled
+    /// back or that has unconfirmed dependencies.
+    pub(crate) fn confirm_planned(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        planned: Vec<SavedBlock>,
+    ) -> Vec<SavedBlock> {
+        let mut result = Vec::new();
+        for block in planned {
+            if self.confirmed.block_exists_or_pruned(txn, &block.hash()) {
+                continue;
+            }
+
+            if !self.any.block_exists(txn, &block.hash())
+                || !self.dependencies_confirmed(txn, &block)
+            {
+                break;
+            }
+
+            self.cement(txn, &block);
+            result.push(block);
+
+            txn.refresh_if_needed();
+        }
+        result
+    }
+
+    fn dependencies_confirmed(&self, txn: &dyn Transaction, block: &SavedBlock) -> bool {
+        block
+            .dependent_blocks(&self.constants.epochs, &self.constants.genesis_account)
+            .iter()
+            .all(|dependent| {
+                dependent.is_zero() || self.confirmed.block_exists_or_pruned(txn, dependent)
+            })
+    }
+
+    fn cement(&self, txn: &mut LmdbWriteTransaction, block: &SavedBlock) {
+        let conf_height = ConfirmationHeightInfo::new(block.height(), block.hash());
+
+        // Update store
+        self.store
+            .confirmation_height
+            .put(txn, &block.account(), &conf_height);
+        self.store
+            .cache
+            .cemented_count
+            .fetch_add(1, Ordering::SeqCst);
+
+        if self.unconfirmed_index {
+            self.update_unconfirmed_index(txn, block);
+        }
+
+        self.observer.blocks_cemented(1);
+    }
+
+    /// Removes the account from the unconfirmed index once its head block is cemented
+    fn update_unconfirmed_index(&self, txn: &mut LmdbWriteTransaction, block: &SavedBlock) {
+        let account = block.account();
+        let fully_confirmed = self
+            .store
+            .account
+            .get(txn, &account)
+            .map(|info| info.block_count <= block.height())
+            .unwrap_or(true);
+        if fully_confirmed {
+            self.store.unconfirmed.del(txn, &account);
+        }
+    }
 }
@@ -1,7 +1,9 @@
 mod block_inserter;
+mod prevalidated_block;
 mod validation;
 mod validator_factory;
 
 pub(crate) use block_inserter::{BlockInsertInstructions, BlockInserter};
+pub use prevalidated_block::PrevalidatedBlock;
 pub(crate) use validation::BlockValidator;
 pub(crate) use validator_factory::BlockValidatorFactory;
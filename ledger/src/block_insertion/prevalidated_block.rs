@@ -0,0 +1,50 @@
+use super::BlockInsertInstructions;
+use crate::Ledger;
+use rsnano_core::Block;
+use rsnano_store_lmdb::Transaction;
+
+/// The speculative result of a block validation that was done on a read transaction.
+pub struct PrevalidatedBlock {
+    pub(crate) instructions: BlockInsertInstructions,
+}
+
+impl PrevalidatedBlock {
+    pub(crate) fn new(instructions: BlockInsertInstructions) -> Self {
+        Self { instructions }
+    }
+
+    /// Cheap re-check at insertion time. The validation result only depends on the
+    /// account head, the block itself and the received pending entry. If none of them
+    /// changed, the insert instructions are still correct.
+    /// Epoch blocks also depend on the receivable entries of the account, so they are
+    /// always validated again.
+    pub(crate) fn is_still_valid(
+        &self,
+        ledger: &Ledger,
+        txn: &dyn Transaction,
+        block: &Block,
+    ) -> bool {
+        if self.instructions.is_epoch_block {
+            return false;
+        }
+
+        let account_info = ledger
+            .account_info(txn, &self.instructions.account)
+            .unwrap_or_default();
+        if account_info != self.instructions.old_account_info {
+            return false;
+        }
+
+        if ledger.any().block_exists_or_pruned(txn, &block.hash()) {
+            return false;
+        }
+
+        if let Some(key) = &self.instructions.delete_pending {
+            if ledger.any().get_pending(txn, key).is_none() {
+                return false;
+            }
+        }
+
+        true
+    }
+}
@@ -13,8 +13,14 @@ impl<'a> BlockValidator<'a> {
 
     pub(crate) fn ensure_valid_signature(&self) -> Result<(), BlockStatus> {
         let result = if self.is_epoch_block() {
+            if self.is_signature_verified_for(self.epoch_signer()) {
+                return Ok(());
+            }
             self.epochs.validate_epoch_signature(self.block)
         } else {
+            if self.is_signature_verified_for(Some(self.account)) {
+                return Ok(());
+            }
             let pub_key: PublicKey = self.account.into();
             pub_key.verify(self.block.hash().as_bytes(), self.block.signature())
         };
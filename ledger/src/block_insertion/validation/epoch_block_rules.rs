@@ -91,6 +91,8 @@ impl<'a> BlockValidator<'a> {
         if let Block::State(state_block) = self.block {
             // Check for possible regular state blocks with epoch link (send subtype)
             if self.has_epoch_link(state_block)
+                && !self.is_signature_verified_for(Some(state_block.account()))
+                && !self.is_signature_verified_for(self.epoch_signer())
                 && (state_block.verify_signature().is_err()
                     && self.epochs.validate_epoch_signature(self.block).is_err())
             {
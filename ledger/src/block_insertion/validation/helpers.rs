@@ -1,5 +1,5 @@
 use rsnano_core::{
-    AccountInfo, Amount, Block, BlockBase, BlockDetails, BlockHash, BlockSideband, Epoch,
+    Account, AccountInfo, Amount, Block, BlockBase, BlockDetails, BlockHash, BlockSideband, Epoch,
     PendingInfo, PendingKey, PublicKey, StateBlock,
 };
 
@@ -112,6 +112,19 @@ impl<'a> BlockValidator<'a> {
         self.epochs.is_epoch_link(&state_block.link())
     }
 
+    pub(crate) fn epoch_signer(&self) -> Option<Account> {
+        self.epochs
+            .epoch_signer(&self.block.link_field().unwrap_or_default())
+    }
+
+    /// The signature was already verified outside of the ledger for the given signer
+    pub(crate) fn is_signature_verified_for(&self, signer: Option<Account>) -> bool {
+        match (self.verified_signer, signer) {
+            (Some(verified), Some(signer)) => verified == signer.as_key(),
+            _ => false,
+        }
+    }
+
     /// This check only makes sense after ensure_previous_block_exists_for_epoch_block_candidate,
     /// because we need the previous block for the balance change check!
     pub(crate) fn is_epoch_block(&self) -> bool {
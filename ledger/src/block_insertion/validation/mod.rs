@@ -10,7 +10,7 @@ mod tests;
 use super::BlockInsertInstructions;
 use crate::BlockStatus;
 use rsnano_core::{
-    work::WorkThresholds, Account, AccountInfo, Block, Epochs, PendingInfo, SavedBlock,
+    work::WorkThresholds, Account, AccountInfo, Block, Epochs, PendingInfo, PublicKey, SavedBlock,
 };
 
 /// Validates a single block before it gets inserted into the ledger
@@ -26,6 +26,8 @@ pub(crate) struct BlockValidator<'a> {
     pub any_pending_exists: bool,
     pub source_block_exists: bool,
     pub seconds_since_epoch: u64,
+    /// The block signature was already checked for this key outside of the ledger
+    pub verified_signer: Option<PublicKey>,
 }
 
 impl<'a> BlockValidator<'a> {
@@ -13,7 +13,8 @@ use crate::{
     block_insertion::BlockInsertInstructions, ledger_constants::LEDGER_CONSTANTS_STUB, BlockStatus,
 };
 use rsnano_core::{
-    work::WORK_THRESHOLDS_STUB, Account, Amount, Block, Epoch, PendingInfo, SavedAccountChain,
+    work::WORK_THRESHOLDS_STUB, Account, Amount, Block, Epoch, PendingInfo, PublicKey,
+    SavedAccountChain,
 };
 
 use super::BlockValidator;
@@ -26,6 +27,7 @@ pub(crate) struct BlockValidationTest {
     block_already_exists: bool,
     source_block_missing: bool,
     previous_block_missing: bool,
+    verified_signer: Option<PublicKey>,
 }
 impl BlockValidationTest {
     pub fn for_epoch0_account() -> Self {
@@ -60,6 +62,7 @@ impl BlockValidationTest {
             block_already_exists: false,
             source_block_missing: false,
             previous_block_missing: false,
+            verified_signer: None,
         }
     }
 
@@ -86,6 +89,11 @@ impl BlockValidationTest {
         self
     }
 
+    pub fn signature_verified_for(mut self, signer: PublicKey) -> Self {
+        self.verified_signer = Some(signer);
+        self
+    }
+
     pub fn block_already_exists(mut self) -> Self {
         self.block_already_exists = true;
         self
@@ -128,6 +136,7 @@ impl BlockValidationTest {
             validator.pending_receive_info = self.pending_receive.clone();
         }
         validator.block_exists = self.block_already_exists;
+        validator.verified_signer = self.verified_signer;
         validator.source_block_exists = !self.source_block_missing;
         validator.validate()
     }
@@ -146,5 +155,6 @@ fn new_test_validator<'a>(block: &'a Block, account: Account) -> BlockValidator
         any_pending_exists: false,
         source_block_exists: false,
         seconds_since_epoch: 123456,
+        verified_signer: None,
     }
 }
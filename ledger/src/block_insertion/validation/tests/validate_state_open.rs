@@ -1,6 +1,7 @@
 use crate::{block_insertion::validation::tests::BlockValidationTest, BlockStatus};
 use rsnano_core::{
     AccountInfo, Amount, BlockDetails, BlockHash, BlockSideband, Epoch, PendingKey, PrivateKey,
+    PublicKey,
 };
 
 #[test]
@@ -80,3 +81,36 @@ fn fails_with_bad_signature_if_signature_is_invalid() {
         })
         .assert_validation_fails_with(BlockStatus::BadSignature);
 }
+
+#[test]
+fn skips_signature_check_if_signature_was_already_verified() {
+    let test = BlockValidationTest::for_unopened_account();
+    let account = test.chain.account();
+    test.with_pending_receive(Amount::raw(10), Epoch::Epoch1)
+        .signature_verified_for(account.into())
+        .block_to_validate(|chain| {
+            chain
+                .new_open_block()
+                .balance(10)
+                .link(0)
+                .key(&PrivateKey::new())
+                .build()
+        })
+        .assert_is_valid();
+}
+
+#[test]
+fn checks_signature_if_it_was_verified_for_another_signer() {
+    BlockValidationTest::for_unopened_account()
+        .with_pending_receive(Amount::raw(10), Epoch::Epoch1)
+        .signature_verified_for(PublicKey::from(42))
+        .block_to_validate(|chain| {
+            chain
+                .new_open_block()
+                .balance(10)
+                .link(0)
+                .key(&PrivateKey::new())
+                .build()
+        })
+        .assert_validation_fails_with(BlockStatus::BadSignature);
+}
@@ -50,6 +50,7 @@ impl<'a> BlockValidatorFactory<'a> {
             source_block_exists,
             previous_block,
             seconds_since_epoch: seconds_since_epoch(),
+            verified_signer: None,
         }
     }
 
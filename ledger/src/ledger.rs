@@ -1,7 +1,7 @@
 use super::DependentBlocksFinder;
 use crate::{
     block_cementer::BlockCementer,
-    block_insertion::{BlockInserter, BlockValidatorFactory},
+    block_insertion::{BlockInserter, BlockValidatorFactory, PrevalidatedBlock},
     ledger_set_confirmed::LedgerSetConfirmed,
     BlockRollbackPerformer, GenerateCacheFlags, LedgerConstants, LedgerSetAny, RepWeightCache,
     RepWeightsUpdater, RepresentativeBlockFinder, WriteGuard, WriteQueue,
@@ -15,10 +15,12 @@ use rsnano_core::{
 use rsnano_store_lmdb::{
     ConfiguredAccountDatabaseBuilder, ConfiguredBlockDatabaseBuilder,
     ConfiguredConfirmationHeightDatabaseBuilder, ConfiguredPeersDatabaseBuilder,
-    ConfiguredPendingDatabaseBuilder, ConfiguredPrunedDatabaseBuilder, LedgerCache,
-    LmdbAccountStore, LmdbBlockStore, LmdbConfirmationHeightStore, LmdbEnv, LmdbFinalVoteStore,
+    ConfiguredPendingDatabaseBuilder, ConfiguredPrunedDatabaseBuilder, ConsistentIndexes,
+    LedgerCache, LedgerCacheCheckpoint, LmdbAccountStore, LmdbBlockStore,
+    LmdbConfirmationHeightStore, LmdbDelegatorStore, LmdbEnv, LmdbFinalVoteStore,
     LmdbOnlineWeightStore, LmdbPeerStore, LmdbPendingStore, LmdbPrunedStore, LmdbReadTransaction,
-    LmdbRepWeightStore, LmdbStore, LmdbVersionStore, LmdbWriteTransaction, Transaction,
+    LmdbRepWeightStore, LmdbStore, LmdbUnconfirmedStore, LmdbVersionStore, LmdbWriteTransaction,
+    Transaction,
 };
 use std::{
     collections::HashMap,
@@ -104,6 +106,12 @@ pub struct Ledger {
     pub constants: LedgerConstants,
     pub observer: Arc<dyn LedgerObserver>,
     pruning: AtomicBool,
+    delegators_index: AtomicBool,
+    /// The persisted delegators index was maintained up to the last shutdown
+    delegators_index_consistent: AtomicBool,
+    unconfirmed_index: AtomicBool,
+    /// The persisted unconfirmed index was maintained up to the last shutdown
+    unconfirmed_index_consistent: AtomicBool,
     pub write_queue: Arc<WriteQueue>,
 }
 
@@ -187,6 +195,8 @@ impl NullLedgerBuilder {
             account: Arc::new(LmdbAccountStore::new(env.clone()).unwrap()),
             block: Arc::new(LmdbBlockStore::new(env.clone()).unwrap()),
             confirmation_height: Arc::new(LmdbConfirmationHeightStore::new(env.clone()).unwrap()),
+            delegator: Arc::new(LmdbDelegatorStore::new(env.clone()).unwrap()),
+            unconfirmed: Arc::new(LmdbUnconfirmedStore::new(env.clone()).unwrap()),
             final_vote: Arc::new(LmdbFinalVoteStore::new(env.clone()).unwrap()),
             online_weight: Arc::new(LmdbOnlineWeightStore::new(env.clone()).unwrap()),
             peer: Arc::new(LmdbPeerStore::new(env.clone()).unwrap()),
@@ -229,6 +239,15 @@ impl Ledger {
         let rep_weights_updater =
             RepWeightsUpdater::new(store.rep_weight.clone(), min_rep_weight, &rep_weights);
 
+        let write_queue = if store.env.group_commit() {
+            let env = store.env.clone();
+            let queue = WriteQueue::with_group_commit(move || env.sync());
+            store.env.observe_commits(queue.commit_observer());
+            queue
+        } else {
+            WriteQueue::new()
+        };
+
         let mut ledger = Self {
             rep_weights,
             rep_weights_updater,
@@ -236,7 +255,11 @@ impl Ledger {
             constants,
             observer: Arc::new(NullLedgerObserver::new()),
             pruning: AtomicBool::new(false),
-            write_queue: Arc::new(WriteQueue::new()),
+            delegators_index: AtomicBool::new(false),
+            delegators_index_consistent: AtomicBool::new(false),
+            unconfirmed_index: AtomicBool::new(false),
+            unconfirmed_index_consistent: AtomicBool::new(false),
+            write_queue: Arc::new(write_queue),
         };
 
         ledger.initialize(&GenerateCacheFlags::new())?;
@@ -261,6 +284,60 @@ impl Ledger {
             self.add_genesis_block(&mut self.rw_txn());
         }
 
+        let indexes = self.store.valid_consistent_indexes();
+        self.delegators_index_consistent
+            .store(indexes.delegators, Ordering::SeqCst);
+        self.unconfirmed_index_consistent
+            .store(indexes.unconfirmed, Ordering::SeqCst);
+
+        if let Some(checkpoint) = self.store.valid_cache_checkpoint() {
+            self.load_cache_checkpoint(generate_cache, &checkpoint);
+        } else {
+            self.generate_cache(generate_cache);
+        }
+
+        let transaction = self.store.tx_begin_read();
+        self.store
+            .cache
+            .pruned_count
+            .fetch_add(self.store.pruned.count(&transaction), Ordering::SeqCst);
+
+        Ok(())
+    }
+
+    /// Fast start: the counters come from the checkpoint and the rep weights from the
+    /// rep weights table, which is updated in the same transactions as the account table
+    fn load_cache_checkpoint(
+        &self,
+        generate_cache: &GenerateCacheFlags,
+        checkpoint: &LedgerCacheCheckpoint,
+    ) {
+        let cache = &self.store.cache;
+        if generate_cache.block_count {
+            cache
+                .block_count
+                .store(checkpoint.block_count, Ordering::SeqCst);
+        }
+        if generate_cache.account_count {
+            cache
+                .account_count
+                .store(checkpoint.account_count, Ordering::SeqCst);
+        }
+        if generate_cache.cemented_count {
+            cache
+                .cemented_count
+                .store(checkpoint.cemented_count, Ordering::SeqCst);
+        }
+        if generate_cache.reps {
+            // One batch, so that the weights get published only once
+            let txn = self.read_txn();
+            let weights: HashMap<PublicKey, Amount> = self.store.rep_weight.iter(&txn).collect();
+            self.rep_weights_updater.copy_from(&weights);
+        }
+    }
+
+    /// Slow start: scans the whole account and confirmation height tables
+    fn generate_cache(&self, generate_cache: &GenerateCacheFlags) {
         if generate_cache.reps || generate_cache.account_count || generate_cache.block_count {
             self.store.account.for_each_par(|iter| {
                 let mut block_count = 0;
@@ -298,14 +375,16 @@ impl Ledger {
                     .fetch_add(cemented_count, Ordering::SeqCst);
             });
         }
+    }
 
-        let transaction = self.store.tx_begin_read();
-        self.store
-            .cache
-            .pruned_count
-            .fetch_add(self.store.pruned.count(&transaction), Ordering::SeqCst);
-
-        Ok(())
+    /// Persists the ledger cache counters, so that the next start can skip the table scans.
+    /// The enabled indexes are marked as consistent, so that they don't get rebuilt.
+    /// Call this after the last write to the ledger.
+    pub fn write_cache_checkpoint(&self) {
+        self.store.write_cache_checkpoint(ConsistentIndexes {
+            delegators: self.delegators_index_enabled(),
+            unconfirmed: self.unconfirmed_index_enabled(),
+        });
     }
 
     fn add_genesis_block(&self, txn: &mut LmdbWriteTransaction) {
@@ -371,6 +450,89 @@ impl Ledger {
         self.pruning.store(true, Ordering::SeqCst);
     }
 
+    pub fn delegators_index_enabled(&self) -> bool {
+        self.delegators_index.load(Ordering::SeqCst)
+    }
+
+    /// Keeps the representative -> delegators index up to date from now on.
+    /// Unless the index was maintained up to the last shutdown, it gets rebuilt from
+    /// the account table, which takes a full table scan. This has to be called
+    /// before the ledger is written to. Returns true if the index was built.
+    pub fn enable_delegators_index(&self) -> bool {
+        let build = !self
+            .delegators_index_consistent
+            .swap(false, Ordering::SeqCst);
+        if build {
+            let mut txn = self.rw_txn();
+            self.store.delegator.clear(&mut txn);
+            let read_txn = self.read_txn();
+            for (account, info) in self.store.account.iter(&read_txn) {
+                self.store
+                    .delegator
+                    .put(&mut txn, &info.representative, &account);
+            }
+            txn.commit();
+        }
+        self.delegators_index.store(true, Ordering::SeqCst);
+        build
+    }
+
+    /// Stops maintaining the delegators index. The index is cleared, so that a stale
+    /// index never gets used when it is enabled again later.
+    pub fn disable_delegators_index(&self) {
+        self.delegators_index.store(false, Ordering::SeqCst);
+        self.delegators_index_consistent
+            .store(false, Ordering::SeqCst);
+        if self.store.delegator.count(&self.read_txn()) > 0 {
+            self.store.delegator.clear(&mut self.rw_txn());
+        }
+    }
+
+    pub fn unconfirmed_index_enabled(&self) -> bool {
+        self.unconfirmed_index.load(Ordering::SeqCst)
+    }
+
+    /// Keeps the index of accounts with unconfirmed blocks up to date from now on.
+    /// Unless the index was maintained up to the last shutdown, it gets rebuilt from
+    /// the account and confirmation height tables, which takes a full table scan.
+    /// This has to be called before the ledger is written to. Returns true if the
+    /// index was built.
+    pub fn enable_unconfirmed_index(&self) -> bool {
+        let build = !self
+            .unconfirmed_index_consistent
+            .swap(false, Ordering::SeqCst);
+        if build {
+            let mut txn = self.rw_txn();
+            self.store.unconfirmed.clear(&mut txn);
+            let read_txn = self.read_txn();
+            for (account, info) in self.store.account.iter(&read_txn) {
+                let confirmed_height = self
+                    .store
+                    .confirmation_height
+                    .get(&read_txn, &account)
+                    .map(|i| i.height)
+                    .unwrap_or_default();
+                if confirmed_height < info.block_count {
+                    self.store.unconfirmed.put(&mut txn, &account);
+                }
+            }
+            txn.commit();
+        }
+        self.unconfirmed_index.store(true, Ordering::SeqCst);
+        build
+    }
+
+    /// Stops maintaining the unconfirmed index. The index is cleared, so that a stale
+    /// index never gets used when it is enabled again later.
+    pub fn disable_unconfirmed_index(&self) {
+        self.unconfirmed_index.store(false, Ordering::SeqCst);
+        self.unconfirmed_index_consistent
+            .store(false, Ordering::SeqCst);
+        if self.store.unconfirmed.count(&self.read_txn()) > 0 {
+            self.store.unconfirmed.clear(&mut self.rw_txn());
+        }
+    }
+
     pub fn bootstrap_weight_max_blocks(&self) -> u64 {
         self.rep_weights.bootstrap_weight_max_blocks()
     }
@@ -519,9 +681,23 @@ impl Ledger {
                 self.store.account.del(txn, account);
             }
             self.store.account.put(txn, account, new_info);
+            if self.delegators_index_enabled() {
+                self.update_delegator(txn, account, old_info, new_info);
+            }
+            if self.unconfirmed_index_enabled() {
+                self.update_unconfirmed(txn, account, old_info, new_info);
+            }
         } else {
             debug_assert!(!self.store.confirmation_height.exists(txn, account));
             self.store.account.del(txn, account);
+            if self.delegators_index_enabled() {
+                self.store
+                    .delegator
+                    .del(txn, &old_info.representative, account);
+            }
+            if self.unconfirmed_index_enabled() {
+                self.store.unconfirmed.del(txn, account);
+            }
             debug_assert!(self.store.cache.account_count.load(Ordering::SeqCst) > 0);
             self.store
                 .cache
@@ -530,6 +706,53 @@ impl Ledger {
         }
     }
 
+    fn update_delegator(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        account: &Account,
+        old_info: &AccountInfo,
+        new_info: &AccountInfo,
+    ) {
+        let is_new_account = old_info.head.is_zero();
+        if !is_new_account && old_info.representative == new_info.representative {
+            return;
+        }
+        if !is_new_account {
+            self.store
+                .delegator
+                .del(txn, &old_info.representative, account);
+        }
+        self.store
+            .delegator
+            .put(txn, &new_info.representative, account);
+    }
+
+    fn update_unconfirmed(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        account: &Account,
+        old_info: &AccountInfo,
+        new_info: &AccountInfo,
+    ) {
+        if new_info.block_count > old_info.block_count {
+            // A block was inserted, which can't be confirmed yet
+            if !self.store.unconfirmed.exists(txn, account) {
+                self.store.unconfirmed.put(txn, account);
+            }
+        } else if new_info.block_count < old_info.block_count {
+            // Blocks were rolled back, maybe all unconfirmed ones
+            let confirmed_height = self
+                .store
+                .confirmation_height
+                .get(txn, account)
+                .map(|i| i.height)
+                .unwrap_or_default();
+            if confirmed_height >= new_info.block_count {
+                self.store.unconfirmed.del(txn, account);
+            }
+        }
+    }
+
     pub fn pruning_action(
         &self,
         txn: &mut LmdbWriteTransaction,
@@ -612,12 +835,85 @@ impl Ledger {
         txn: &mut LmdbWriteTransaction,
         block: &Block,
     ) -> Result<SavedBlock, BlockStatus> {
-        let validator = BlockValidatorFactory::new(self, txn, block).create_validator();
+        self.process_verified(txn, block, None)
+    }
+
+    /// Same as `process`, but the signature check is skipped if the block signature
+    /// was already verified for the signer the ledger expects (see `verify_block_signer`)
+    pub fn process_verified(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        block: &Block,
+        verified_signer: Option<PublicKey>,
+    ) -> Result<SavedBlock, BlockStatus> {
+        let mut validator = BlockValidatorFactory::new(self, txn, block).create_validator();
+        validator.verified_signer = verified_signer;
         let instructions = validator.validate()?;
         let inserted = BlockInserter::new(self, txn, block, &instructions).insert();
         Ok(inserted)
     }
 
+    /// Validates the block on a read transaction, so that it can be done concurrently and
+    /// outside of the write lock. The result is speculative, because the ledger can change
+    /// until the block gets inserted with `insert_prevalidated`.
+    pub fn prevalidate(
+        &self,
+        txn: &dyn Transaction,
+        block: &Block,
+        verified_signer: Option<PublicKey>,
+    ) -> Result<PrevalidatedBlock, BlockStatus> {
+        let mut validator = BlockValidatorFactory::new(self, txn, block).create_validator();
+        validator.verified_signer = verified_signer;
+        let instructions = validator.validate()?;
+        Ok(PrevalidatedBlock::new(instructions))
+    }
+
+    /// Inserts a block that was validated with `prevalidate`. Returns None if the ledger
+    /// changed in the meantime in a way that invalidates the speculative result. In that
+    /// case the block has to be processed again with `process` or `process_verified`.
+    pub fn insert_prevalidated(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        block: &Block,
+        prevalidated: &PrevalidatedBlock,
+    ) -> Option<SavedBlock> {
+        if !prevalidated.is_still_valid(self, txn, block) {
+            return None;
+        }
+        let inserted = BlockInserter::new(self, txn, block, &prevalidated.instructions).insert();
+        Some(inserted)
+    }
+
+    /// Checks the signature of a state block without accessing the store, so that it
+    /// can be done outside of the write transaction.
+    /// Returns the key that signed the block, which is either the account owner or an
+    /// epoch signer. Legacy blocks need the account from the previous block, so they
+    /// can only be verified inside the ledger and always return None.
+    pub fn verify_block_signer(&self, block: &Block) -> Option<PublicKey> {
+        let Block::State(state_block) = block else {
+            return None;
+        };
+
+        if state_block.verify_signature().is_ok() {
+            return Some(state_block.account().into());
+        }
+
+        if self
+            .constants
+            .epochs
+            .validate_epoch_signature(block)
+            .is_ok()
+        {
+            return self
+                .constants
+                .epochs
+                .epoch_signer(&state_block.link())
+                .map(|signer| signer.into());
+        }
+
+        None
+    }
+
     pub fn get_block(&self, txn: &dyn Transaction, hash: &BlockHash) -> Option<SavedBlock> {
         self.store.block.get(txn, hash)
     }
@@ -650,10 +946,37 @@ impl Ledger {
         target_hash: BlockHash,
         max_blocks: usize,
     ) -> Vec<SavedBlock> {
-        BlockCementer::new(&self.store, self.observer.as_ref(), &self.constants).confirm(
-            txn,
-            target_hash,
-            max_blocks,
+        self.block_cementer().confirm(txn, target_hash, max_blocks)
+    }
+
+    /// Collects the unconfirmed dependency tree of the target block on a read transaction.
+    /// The result can be cemented with `confirm_planned`. This allows walking the dependencies
+    /// of multiple blocks in parallel, while only the writes need the write lock.
+    pub fn plan_confirmation(
+        &self,
+        txn: &dyn Transaction,
+        target_hash: BlockHash,
+        max_blocks: usize,
+    ) -> Vec<SavedBlock> {
+        self.block_cementer().plan(txn, target_hash, max_blocks)
+    }
+
+    /// Cements the blocks returned by `plan_confirmation`. Returns the cemented blocks.
+    /// Callers must check if the target block was confirmed and fall back to `confirm_max` if not.
+    pub fn confirm_planned(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        planned: Vec<SavedBlock>,
+    ) -> Vec<SavedBlock> {
+        self.block_cementer().confirm_planned(txn, planned)
+    }
+
+    fn block_cementer(&self) -> BlockCementer<'_> {
+        BlockCementer::new(
+            &self.store,
+            self.observer.as_ref(),
+            &self.constants,
+            self.unconfirmed_index_enabled(),
         )
     }
 
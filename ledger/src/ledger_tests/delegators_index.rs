@@ -0,0 +1,120 @@
+use super::LedgerContext;
+use crate::DEV_GENESIS_PUB_KEY;
+use rsnano_core::{Account, PublicKey};
+
+#[test]
+fn build_index_on_enable() {
+    let ctx = LedgerContext::empty();
+
+    assert!(ctx.ledger.enable_delegators_index());
+
+    let txn = ctx.ledger.read_txn();
+    assert_eq!(
+        ctx.ledger
+            .store
+            .delegator
+            .delegators_count(&txn, &DEV_GENESIS_PUB_KEY),
+        1
+    );
+}
+
+#[test]
+fn open_and_change_update_the_index() {
+    let ctx = LedgerContext::empty();
+    ctx.ledger.enable_delegators_index();
+    let mut txn = ctx.ledger.rw_txn();
+    let destination = ctx.block_factory();
+    let representative = PublicKey::from(42);
+
+    let send = ctx
+        .genesis_block_factory()
+        .send(&txn)
+        .link(destination.account())
+        .build();
+    ctx.ledger.process(&mut txn, &send).unwrap();
+    let open = destination
+        .open(&txn, send.hash())
+        .representative(representative)
+        .build();
+    ctx.ledger.process(&mut txn, &open).unwrap();
+
+    let delegators: Vec<_> = ctx
+        .ledger
+        .store
+        .delegator
+        .iter_delegators(&txn, &representative, Account::zero())
+        .collect();
+    assert_eq!(delegators, vec![destination.account()]);
+
+    let change = destination.change(&txn).build();
+    ctx.ledger.process(&mut txn, &change).unwrap();
+
+    let store = &ctx.ledger.store.delegator;
+    assert_eq!(store.delegators_count(&txn, &representative), 0);
+    assert!(store.exists(&txn, &PublicKey::from(1), &destination.account()));
+}
+
+#[test]
+fn rollback_updates_the_index() {
+    let ctx = LedgerContext::empty();
+    ctx.ledger.enable_delegators_index();
+    let mut txn = ctx.ledger.rw_txn();
+    let destination = ctx.block_factory();
+    let representative = PublicKey::from(42);
+
+    let send = ctx
+        .genesis_block_factory()
+        .send(&txn)
+        .link(destination.account())
+        .build();
+    ctx.ledger.process(&mut txn, &send).unwrap();
+    let open = destination
+        .open(&txn, send.hash())
+        .representative(representative)
+        .build();
+    ctx.ledger.process(&mut txn, &open).unwrap();
+    let change = destination.change(&txn).build();
+    ctx.ledger.process(&mut txn, &change).unwrap();
+
+    ctx.ledger.rollback(&mut txn, &change.hash()).unwrap();
+
+    let store = &ctx.ledger.store.delegator;
+    assert_eq!(store.delegators_count(&txn, &PublicKey::from(1)), 0);
+    assert!(store.exists(&txn, &representative, &destination.account()));
+
+    ctx.ledger.rollback(&mut txn, &open.hash()).unwrap();
+
+    assert_eq!(store.delegators_count(&txn, &representative), 0);
+}
+
+#[test]
+fn disable_clears_the_index() {
+    let ctx = LedgerContext::empty();
+    ctx.ledger.enable_delegators_index();
+
+    ctx.ledger.disable_delegators_index();
+
+    assert_eq!(ctx.ledger.delegators_index_enabled(), false);
+    let txn = ctx.ledger.read_txn();
+    assert_eq!(ctx.ledger.store.delegator.count(&txn), 0);
+}
+
+#[test]
+fn enable_rebuilds_a_stale_index() {
+    let ctx = LedgerContext::empty();
+    let stale_representative = PublicKey::from(42);
+    let mut txn = ctx.ledger.rw_txn();
+    ctx.ledger
+        .store
+        .delegator
+        .put(&mut txn, &stale_representative, &Account::from(7));
+    txn.commit();
+
+    // The index wasn't marked as consistent, so it can't be trusted
+    assert!(ctx.ledger.enable_delegators_index());
+
+    let txn = ctx.ledger.read_txn();
+    let store = &ctx.ledger.store.delegator;
+    assert_eq!(store.delegators_count(&txn, &stale_representative), 0);
+    assert_eq!(store.delegators_count(&txn, &DEV_GENESIS_PUB_KEY), 1);
+}
@@ -11,13 +11,17 @@ use rsnano_core::{
     TestBlockBuilder, DEV_GENESIS_KEY,
 };
 
+mod delegators_index;
 mod empty_ledger;
+mod planned_confirmation;
+mod prevalidation;
 mod pruning;
 mod receivable_iteration;
 mod rollback_legacy_change;
 mod rollback_legacy_receive;
 mod rollback_legacy_send;
 mod rollback_state;
+mod unconfirmed_index;
 
 #[test]
 fn ledger_successor() {
@@ -0,0 +1,103 @@
+use super::LedgerContext;
+use crate::DEV_GENESIS_HASH;
+
+#[test]
+fn plan_returns_dependencies_first() {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+    let destination = ctx.block_factory();
+
+    let send1 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send1).unwrap();
+    let send2 = ctx
+        .genesis_block_factory()
+        .send(&txn)
+        .link(destination.account())
+        .build();
+    ctx.ledger.process(&mut txn, &send2).unwrap();
+    let open = destination.open(&txn, send2.hash()).build();
+    ctx.ledger.process(&mut txn, &open).unwrap();
+
+    let plan = ctx.ledger.plan_confirmation(&txn, open.hash(), 1024);
+
+    let hashes: Vec<_> = plan.iter().map(|b| b.hash()).collect();
+    assert_eq!(hashes, vec![send1.hash(), send2.hash(), open.hash()]);
+    assert_eq!(
+        ctx.ledger.confirmed().block_exists(&txn, &open.hash()),
+        false
+    );
+
+    let cemented = ctx.ledger.confirm_planned(&mut txn, plan);
+
+    assert_eq!(cemented.len(), 3);
+    assert!(ctx.ledger.confirmed().block_exists(&txn, &open.hash()));
+    assert_eq!(ctx.ledger.cemented_count(), 4);
+}
+
+#[test]
+fn plan_is_empty_for_cemented_block() {
+    let ctx = LedgerContext::empty();
+    let txn = ctx.ledger.read_txn();
+    let plan = ctx.ledger.plan_confirmation(&txn, *DEV_GENESIS_HASH, 1024);
+    assert!(plan.is_empty());
+}
+
+#[test]
+fn confirm_planned_skips_blocks_cemented_in_the_meantime() {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+
+    let send1 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send1).unwrap();
+    let send2 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send2).unwrap();
+
+    let plan = ctx.ledger.plan_confirmation(&txn, send2.hash(), 1024);
+    ctx.ledger.confirm(&mut txn, send1.hash());
+
+    let cemented = ctx.ledger.confirm_planned(&mut txn, plan);
+
+    let hashes: Vec<_> = cemented.iter().map(|b| b.hash()).collect();
+    assert_eq!(hashes, vec![send2.hash()]);
+    assert_eq!(ctx.ledger.cemented_count(), 3);
+}
+
+#[test]
+fn confirm_planned_stops_at_rolled_back_block() {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+
+    let send1 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send1).unwrap();
+    let send2 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send2).unwrap();
+    let send3 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send3).unwrap();
+
+    let plan = ctx.ledger.plan_confirmation(&txn, send3.hash(), 1024);
+    ctx.ledger.rollback(&mut txn, &send2.hash()).unwrap();
+
+    let cemented = ctx.ledger.confirm_planned(&mut txn, plan);
+
+    let hashes: Vec<_> = cemented.iter().map(|b| b.hash()).collect();
+    assert_eq!(hashes, vec![send1.hash()]);
+    assert_eq!(
+        ctx.ledger.confirmed().block_exists(&txn, &send3.hash()),
+        false
+    );
+}
+
+#[test]
+fn plan_is_bounded() {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+
+    let send1 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send1).unwrap();
+    let send2 = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send2).unwrap();
+
+    let plan = ctx.ledger.plan_confirmation(&txn, send2.hash(), 1);
+
+    assert_eq!(plan.len(), 1);
+}
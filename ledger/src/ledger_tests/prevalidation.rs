@@ -0,0 +1,79 @@
+use super::LedgerContext;
+use crate::BlockStatus;
+use rsnano_core::Amount;
+
+#[test]
+fn insert_prevalidated_block() {
+    let ctx = LedgerContext::empty();
+    let genesis = ctx.genesis_block_factory();
+    let send = genesis.send(&ctx.ledger.read_txn()).build();
+
+    let prevalidated = ctx
+        .ledger
+        .prevalidate(&ctx.ledger.read_txn(), &send, None)
+        .unwrap();
+
+    let mut txn = ctx.ledger.rw_txn();
+    let inserted = ctx
+        .ledger
+        .insert_prevalidated(&mut txn, &send, &prevalidated);
+
+    assert_eq!(inserted.map(|b| b.hash()), Some(send.hash()));
+    assert!(ctx.ledger.store.block.exists(&txn, &send.hash()));
+}
+
+#[test]
+fn prevalidation_returns_validation_error() {
+    let ctx = LedgerContext::empty();
+    let genesis = ctx.genesis_block_factory();
+    let send = genesis.send(&ctx.ledger.read_txn()).previous(12345).build();
+
+    let result = ctx.ledger.prevalidate(&ctx.ledger.read_txn(), &send, None);
+
+    assert!(matches!(result, Err(BlockStatus::GapPrevious)));
+}
+
+#[test]
+fn prevalidated_block_is_stale_if_account_changed() {
+    let ctx = LedgerContext::empty();
+    let genesis = ctx.genesis_block_factory();
+    let send1 = genesis.send(&ctx.ledger.read_txn()).build();
+    let send2 = genesis
+        .send(&ctx.ledger.read_txn())
+        .amount_sent(Amount::raw(1234))
+        .build();
+
+    let prevalidated = ctx
+        .ledger
+        .prevalidate(&ctx.ledger.read_txn(), &send2, None)
+        .unwrap();
+
+    let mut txn = ctx.ledger.rw_txn();
+    ctx.ledger.process(&mut txn, &send1).unwrap();
+    let inserted = ctx
+        .ledger
+        .insert_prevalidated(&mut txn, &send2, &prevalidated);
+
+    assert!(inserted.is_none());
+    assert_eq!(ctx.ledger.process(&mut txn, &send2), Err(BlockStatus::Fork));
+}
+
+#[test]
+fn prevalidated_block_is_stale_if_it_was_inserted_already() {
+    let ctx = LedgerContext::empty();
+    let genesis = ctx.genesis_block_factory();
+    let send = genesis.send(&ctx.ledger.read_txn()).build();
+
+    let prevalidated = ctx
+        .ledger
+        .prevalidate(&ctx.ledger.read_txn(), &send, None)
+        .unwrap();
+
+    let mut txn = ctx.ledger.rw_txn();
+    ctx.ledger.process(&mut txn, &send).unwrap();
+
+    assert!(ctx
+        .ledger
+        .insert_prevalidated(&mut txn, &send, &prevalidated)
+        .is_none());
+}
@@ -0,0 +1,114 @@
+use super::LedgerContext;
+use crate::DEV_GENESIS_ACCOUNT;
+use rsnano_core::Account;
+
+#[test]
+fn genesis_is_confirmed() {
+    let ctx = LedgerContext::empty();
+
+    assert!(ctx.ledger.enable_unconfirmed_index());
+
+    let txn = ctx.ledger.read_txn();
+    assert_eq!(ctx.ledger.store.unconfirmed.count(&txn), 0);
+}
+
+#[test]
+fn build_index_on_enable() {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+    let send = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send).unwrap();
+    txn.commit();
+
+    assert!(ctx.ledger.enable_unconfirmed_index());
+
+    let txn = ctx.ledger.read_txn();
+    assert!(ctx
+        .ledger
+        .store
+        .unconfirmed
+        .exists(&txn, &DEV_GENESIS_ACCOUNT));
+}
+
+#[test]
+fn insert_and_confirm_update_the_index() {
+    let ctx = LedgerContext::empty();
+    ctx.ledger.enable_unconfirmed_index();
+    let mut txn = ctx.ledger.rw_txn();
+    let destination = ctx.block_factory();
+
+    let send = ctx
+        .genesis_block_factory()
+        .send(&txn)
+        .link(destination.account())
+        .build();
+    ctx.ledger.process(&mut txn, &send).unwrap();
+    let open = destination.open(&txn, send.hash()).build();
+    ctx.ledger.process(&mut txn, &open).unwrap();
+
+    let store = &ctx.ledger.store.unconfirmed;
+    assert!(store.exists(&txn, &DEV_GENESIS_ACCOUNT));
+    assert!(store.exists(&txn, &destination.account()));
+
+    ctx.ledger.confirm(&mut txn, send.hash());
+
+    assert!(!store.exists(&txn, &DEV_GENESIS_ACCOUNT));
+    assert!(store.exists(&txn, &destination.account()));
+
+    ctx.ledger.confirm(&mut txn, open.hash());
+
+    assert_eq!(store.count(&txn), 0);
+}
+
+#[test]
+fn rollback_updates_the_index() {
+    let ctx = LedgerContext::empty();
+    ctx.ledger.enable_unconfirmed_index();
+    let mut txn = ctx.ledger.rw_txn();
+    let destination = ctx.block_factory();
+
+    let send = ctx
+        .genesis_block_factory()
+        .send(&txn)
+        .link(destination.account())
+        .build();
+    ctx.ledger.process(&mut txn, &send).unwrap();
+    let open = destination.open(&txn, send.hash()).build();
+    ctx.ledger.process(&mut txn, &open).unwrap();
+
+    ctx.ledger.rollback(&mut txn, &send.hash()).unwrap();
+
+    let store = &ctx.ledger.store.unconfirmed;
+    assert_eq!(store.count(&txn), 0);
+}
+
+#[test]
+fn disable_clears_the_index() {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+    let send = ctx.genesis_block_factory().send(&txn).build();
+    ctx.ledger.process(&mut txn, &send).unwrap();
+    txn.commit();
+    ctx.ledger.enable_unconfirmed_index();
+
+    ctx.ledger.disable_unconfirmed_index();
+
+    assert_eq!(ctx.ledger.unconfirmed_index_enabled(), false);
+    let txn = ctx.ledger.read_txn();
+    assert_eq!(ctx.ledger.store.unconfirmed.count(&txn), 0);
+}
+
+#[test]
+fn enable_rebuilds_a_stale_index() {
+    let ctx = LedgerContext::empty();
+    // e.g. left behind by a CLI command that changed the confirmation heights
+    let stale_account = Account::from(7);
+    let mut txn = ctx.ledger.rw_txn();
+    ctx.ledger.store.unconfirmed.put(&mut txn, &stale_account);
+    txn.commit();
+
+    assert!(ctx.ledger.enable_unconfirmed_index());
+
+    let txn = ctx.ledger.read_txn();
+    assert_eq!(ctx.ledger.store.unconfirmed.count(&txn), 0);
+}
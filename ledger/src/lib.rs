@@ -22,6 +22,7 @@ mod write_queue;
 #[cfg(test)]
 mod ledger_tests;
 
+pub use block_insertion::PrevalidatedBlock;
 pub(crate) use block_rollback::BlockRollbackPerformer;
 pub use dependent_blocks_finder::*;
 pub use generate_cache_flags::GenerateCacheFlags;
@@ -35,4 +36,4 @@ pub use ledger_set_confirmed::*;
 pub use rep_weight_cache::*;
 pub use rep_weights_updater::*;
 pub(crate) use representative_block_finder::RepresentativeBlockFinder;
-pub use write_queue::{WriteGuard, WriteQueue, Writer};
+pub use write_queue::{DurableCallback, WriteGuard, WriteQueue, Writer};
@@ -1,20 +1,25 @@
 use rsnano_core::{utils::ContainerInfo, Account, Amount, PublicKey};
 use rsnano_store_lmdb::LedgerCache;
 use std::{
-    collections::HashMap,
-    mem::size_of,
+    collections::{BTreeMap, HashMap, HashSet},
+    mem::{self, size_of},
     sync::{
         atomic::{AtomicBool, Ordering},
-        Arc, RwLock, RwLockReadGuard,
+        Arc, Mutex, RwLock,
     },
 };
 
 /// Returns the cached vote weight for the given representative.
 /// If the weight is below the cache limit it returns 0.
 /// During bootstrap it returns the preconfigured bootstrap weights.
+///
+/// Readers never wait for the writers of the ledger: they clone the immutable snapshot
+/// that was published last. Writers publish a new snapshot after each change of the
+/// weight table. The snapshot keeps the changes since its sorted base in a small delta,
+/// so that publishing stays cheap and the base only gets rebuilt now and then.
 pub struct RepWeightCache {
-    weights: Arc<RwLock<HashMap<PublicKey, Amount>>>,
-    bootstrap_weights: RwLock<HashMap<PublicKey, Amount>>,
+    table: Arc<WeightTable>,
+    bootstrap_weights: Arc<RepWeightSnapshot>,
     max_blocks: u64,
     ledger_cache: Arc<LedgerCache>,
     check_bootstrap_weights: AtomicBool,
@@ -22,13 +27,7 @@ pub struct RepWeightCache {
 
 impl RepWeightCache {
     pub fn new() -> Self {
-        Self {
-            weights: Arc::new(RwLock::new(HashMap::new())),
-            bootstrap_weights: RwLock::new(HashMap::new()),
-            max_blocks: 0,
-            ledger_cache: Arc::new(LedgerCache::new()),
-            check_bootstrap_weights: AtomicBool::new(false),
-        }
+        Self::with_bootstrap_weights(HashMap::new(), 0, Arc::new(LedgerCache::new()))
     }
 
     pub fn with_bootstrap_weights(
@@ -37,19 +36,21 @@ impl RepWeightCache {
         ledger_cache: Arc<LedgerCache>,
     ) -> Self {
         Self {
-            weights: Arc::new(RwLock::new(HashMap::new())),
-            bootstrap_weights: RwLock::new(bootstrap_weights),
+            table: Arc::new(WeightTable::new()),
+            bootstrap_weights: Arc::new(RepWeightSnapshot::from_map(&bootstrap_weights)),
             max_blocks,
             ledger_cache,
             check_bootstrap_weights: AtomicBool::new(true),
         }
     }
 
-    pub fn read(&self) -> RwLockReadGuard<HashMap<PublicKey, Amount>> {
+    /// Returns the current weights. The snapshot doesn't change while it is held,
+    /// so it can be used for many lookups in a row
+    pub fn read(&self) -> Arc<RepWeightSnapshot> {
         if self.use_bootstrap_weights() {
-            self.bootstrap_weights.read().unwrap()
+            self.bootstrap_weights.clone()
         } else {
-            self.weights.read().unwrap()
+            self.table.snapshot()
         }
     }
 
@@ -65,18 +66,7 @@ impl RepWeightCache {
     }
 
     pub fn weight(&self, rep: &PublicKey) -> Amount {
-        let weights = if self.use_bootstrap_weights() {
-            &self.bootstrap_weights
-        } else {
-            &self.weights
-        };
-
-        weights
-            .read()
-            .unwrap()
-            .get(rep)
-            .cloned()
-            .unwrap_or_default()
+        self.read().weight(rep)
     }
 
     pub fn bootstrap_weight_max_blocks(&self) -> u64 {
@@ -84,7 +74,10 @@ impl RepWeightCache {
     }
 
     pub fn bootstrap_weights(&self) -> HashMap<PublicKey, Amount> {
-        self.bootstrap_weights.read().unwrap().clone()
+        self.bootstrap_weights
+            .iter()
+            .map(|(rep, weight)| (*rep, *weight))
+            .collect()
     }
 
     pub fn block_count(&self) -> u64 {
@@ -92,18 +85,286 @@ impl RepWeightCache {
     }
 
     pub fn len(&self) -> usize {
-        self.weights.read().unwrap().len()
+        self.table.snapshot().len()
     }
 
     pub fn set(&self, account: PublicKey, weight: Amount) {
-        self.weights.write().unwrap().insert(account, weight);
+        self.table.modify(|weights| weights.insert(account, weight));
     }
 
-    pub(super) fn inner(&self) -> Arc<RwLock<HashMap<PublicKey, Amount>>> {
-        self.weights.clone()
+    pub(super) fn table(&self) -> Arc<WeightTable> {
+        self.table.clone()
     }
 
     pub fn container_info(&self) -> ContainerInfo {
         [("rep_weights", self.len(), size_of::<(Account, Amount)>())].into()
     }
 }
+
+/// The mutable weights, which are changed by the `RepWeightsUpdater`
+pub(super) struct WeightTable {
+    changes: Mutex<WeightChanges>,
+    /// The weights as the readers see them. Replaced by the writer after every change
+    published: RwLock<Arc<RepWeightSnapshot>>,
+}
+
+impl WeightTable {
+    fn new() -> Self {
+        Self {
+            changes: Mutex::new(WeightChanges::default()),
+            published: RwLock::new(Arc::new(RepWeightSnapshot::default())),
+        }
+    }
+
+    /// Changes the weights and publishes them. Batch the changes into one call if possible
+    pub fn modify<T>(&self, f: impl FnOnce(&mut WeightChanges) -> T) -> T {
+        let mut changes = self.changes.lock().unwrap();
+        let result = f(&mut changes);
+        self.publish(&mut changes);
+        result
+    }
+
+    fn snapshot(&self) -> Arc<RepWeightSnapshot> {
+        self.published.read().unwrap().clone()
+    }
+
+    fn publish(&self, changes: &mut WeightChanges) {
+        if changes.dirty.is_empty() {
+            return;
+        }
+        let dirty = mem::take(&mut changes.dirty);
+        let next = Arc::new(self.snapshot().apply(&changes.weights, dirty));
+        *self.published.write().unwrap() = next;
+    }
+}
+
+#[derive(Default)]
+pub(super) struct WeightChanges {
+    weights: HashMap<PublicKey, Amount>,
+    /// Representatives that changed since the last published snapshot
+    dirty: HashSet<PublicKey>,
+}
+
+impl WeightChanges {
+    pub fn get(&self, rep: &PublicKey) -> Amount {
+        self.weights.get(rep).cloned().unwrap_or_default()
+    }
+
+    pub fn insert(&mut self, rep: PublicKey, weight: Amount) {
+        self.weights.insert(rep, weight);
+        self.dirty.insert(rep);
+    }
+
+    pub fn remove(&mut self, rep: &PublicKey) {
+        if self.weights.remove(rep).is_some() {
+            self.dirty.insert(*rep);
+        }
+    }
+}
+
+/// Immutable representative weights. A sorted base, which is shared between snapshots,
+/// plus the changes since the base was built
+#[derive(Default)]
+pub struct RepWeightSnapshot {
+    base: Arc<Vec<(PublicKey, Amount)>>,
+    /// None marks a representative that was removed from the base
+    delta: BTreeMap<PublicKey, Option<Amount>>,
+    len: usize,
+}
+
+impl RepWeightSnapshot {
+    /// The base gets rebuilt when the delta grows beyond this
+    const MAX_DELTA: usize = 256;
+
+    fn from_map(weights: &HashMap<PublicKey, Amount>) -> Self {
+        let mut base: Vec<_> = weights.iter().map(|(k, v)| (*k, *v)).collect();
+        base.sort_unstable_by_key(|(rep, _)| *rep);
+        Self {
+            len: base.len(),
+            base: Arc::new(base),
+            delta: BTreeMap::new(),
+        }
+    }
+
+    pub fn get(&self, rep: &PublicKey) -> Option<&Amount> {
+        match self.delta.get(rep) {
+            Some(weight) => weight.as_ref(),
+            None => self.base_get(rep),
+        }
+    }
+
+    fn base_get(&self, rep: &PublicKey) -> Option<&Amount> {
+        self.base
+            .binary_search_by_key(rep, |(r, _)| *r)
+            .ok()
+            .map(|i| &self.base[i].1)
+    }
+
+    pub fn weight(&self, rep: &PublicKey) -> Amount {
+        self.get(rep).cloned().unwrap_or_default()
+    }
+
+    /// Iterates the weights sorted by representative
+    pub fn iter(&self) -> impl Iterator<Item = (&PublicKey, &Amount)> {
+        let mut base = self
+            .base
+            .iter()
+            .map(|(rep, weight)| (rep, weight))
+            .peekable();
+        let mut delta = self.delta.iter().peekable();
+        std::iter::from_fn(move || loop {
+            let next_delta = delta.peek().map(|(rep, _)| **rep);
+            match (base.peek(), next_delta) {
+                (Some((base_rep, _)), Some(delta_rep)) if **base_rep < delta_rep => {
+                    return base.next();
+                }
+                (_, Some(delta_rep)) => {
+                    base.next_if(|(rep, _)| **rep == delta_rep);
+                    let (rep, weight) = delta.next().unwrap();
+                    if let Some(weight) = weight {
+                        return Some((rep, weight));
+                    }
+                }
+                (_, None) => return base.next(),
+            }
+        })
+    }
+
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Creates the next snapshot with the current weights of the changed representatives
+    fn apply(&self, weights: &HashMap<PublicKey, Amount>, dirty: HashSet<PublicKey>) -> Self {
+        if self.delta.len() + dirty.len() > Self::MAX_DELTA.max(self.base.len() / 8) {
+            // Cheaper to start from scratch, e.g. while the cache gets loaded
+            return Self::from_map(weights);
+        }
+
+        let mut delta = self.delta.clone();
+        for rep in dirty {
+            delta.insert(rep, weights.get(&rep).cloned());
+        }
+        Self {
+            base: self.base.clone(),
+            delta,
+            len: weights.len(),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn empty() {
+        let cache = RepWeightCache::new();
+        assert_eq!(cache.len(), 0);
+        assert_eq!(cache.weight(&PublicKey::from(1)), Amount::zero());
+    }
+
+    #[test]
+    fn publish_changes() {
+        let cache = RepWeightCache::new();
+        cache.set(PublicKey::from(3), Amount::from(30));
+        cache.set(PublicKey::from(1), Amount::from(10));
+        assert_eq!(cache.weight(&PublicKey::from(1)), Amount::from(10));
+
+        cache.set(PublicKey::from(2), Amount::from(20));
+        cache.table.modify(|w| w.remove(&PublicKey::from(3)));
+        cache.set(PublicKey::from(1), Amount::from(11));
+
+        let snapshot = cache.read();
+        let weights: Vec<_> = snapshot.iter().map(|(r, w)| (*r, *w)).collect();
+        assert_eq!(
+            weights,
+            vec![
+                (PublicKey::from(1), Amount::from(11)),
+                (PublicKey::from(2), Amount::from(20)),
+            ]
+        );
+    }
+
+    #[test]
+    fn snapshot_is_immutable() {
+        let cache = RepWeightCache::new();
+        cache.set(PublicKey::from(1), Amount::from(10));
+        let snapshot = cache.read();
+
+        cache.set(PublicKey::from(1), Amount::from(20));
+
+        assert_eq!(snapshot.weight(&PublicKey::from(1)), Amount::from(10));
+        assert_eq!(cache.weight(&PublicKey::from(1)), Amount::from(20));
+    }
+
+    #[test]
+    fn reuse_snapshot_if_nothing_changed() {
+        let cache = RepWeightCache::new();
+        cache.set(PublicKey::from(1), Amount::from(10));
+
+        let a = cache.read();
+        let b = cache.read();
+
+        assert!(Arc::ptr_eq(&a, &b));
+    }
+
+    #[test]
+    fn iterate_base_and_delta_in_order() {
+        let cache = RepWeightCache::new();
+        cache.table.modify(|w| {
+            for i in 1..=3 {
+                w.insert(PublicKey::from(i * 10), Amount::from(i as u128));
+            }
+        });
+        cache.set(PublicKey::from(15), Amount::from(15));
+        cache.set(PublicKey::from(30), Amount::from(33));
+        cache.table.modify(|w| w.remove(&PublicKey::from(10)));
+
+        let snapshot = cache.read();
+        let weights: Vec<_> = snapshot.iter().map(|(r, w)| (*r, *w)).collect();
+        assert_eq!(
+            weights,
+            vec![
+                (PublicKey::from(15), Amount::from(15)),
+                (PublicKey::from(20), Amount::from(2)),
+                (PublicKey::from(30), Amount::from(33)),
+            ]
+        );
+        assert_eq!(snapshot.len(), 3);
+        assert_eq!(snapshot.weight(&PublicKey::from(10)), Amount::zero());
+    }
+
+    #[test]
+    fn rebuild_base_when_delta_gets_large() {
+        let cache = RepWeightCache::new();
+        for i in 0..=RepWeightSnapshot::MAX_DELTA as u64 {
+            cache.set(PublicKey::from(i), Amount::from(1));
+        }
+
+        let snapshot = cache.read();
+        assert!(snapshot.delta.len() < RepWeightSnapshot::MAX_DELTA);
+        assert_eq!(snapshot.len(), RepWeightSnapshot::MAX_DELTA + 1);
+        assert_eq!(snapshot.iter().count(), RepWeightSnapshot::MAX_DELTA + 1);
+    }
+
+    #[test]
+    fn bootstrap_weights() {
+        let ledger_cache = Arc::new(LedgerCache::new());
+        let cache = RepWeightCache::with_bootstrap_weights(
+            [(PublicKey::from(1), Amount::from(100))].into(),
+            10,
+            ledger_cache.clone(),
+        );
+        cache.set(PublicKey::from(1), Amount::from(1));
+        assert_eq!(cache.weight(&PublicKey::from(1)), Amount::from(100));
+
+        ledger_cache.block_count.store(10, Ordering::SeqCst);
+
+        assert_eq!(cache.weight(&PublicKey::from(1)), Amount::from(1));
+    }
+}
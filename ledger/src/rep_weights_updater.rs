@@ -1,12 +1,15 @@
-use crate::RepWeightCache;
+use crate::{
+    rep_weight_cache::{WeightChanges, WeightTable},
+    RepWeightCache,
+};
 use rsnano_core::{Amount, PublicKey};
 use rsnano_store_lmdb::{LmdbRepWeightStore, LmdbWriteTransaction};
 use std::collections::HashMap;
-use std::sync::{Arc, RwLock};
+use std::sync::Arc;
 
 /// Updates the representative weights in the ledger and in the in-memory cache
 pub struct RepWeightsUpdater {
-    weight_cache: Arc<RwLock<HashMap<PublicKey, Amount>>>,
+    weight_cache: Arc<WeightTable>,
     store: Arc<LmdbRepWeightStore>,
     min_weight: Amount,
 }
@@ -14,7 +17,7 @@ pub struct RepWeightsUpdater {
 impl RepWeightsUpdater {
     pub fn new(store: Arc<LmdbRepWeightStore>, min_weight: Amount, cache: &RepWeightCache) -> Self {
         RepWeightsUpdater {
-            weight_cache: cache.inner(),
+            weight_cache: cache.table(),
             store,
             min_weight,
         }
@@ -22,15 +25,12 @@ impl RepWeightsUpdater {
 
     /// Only use this method when loading rep weights from the database table
     pub fn copy_from(&self, other: &HashMap<PublicKey, Amount>) {
-        let mut guard_this = self.weight_cache.write().unwrap();
-        for (account, amount) in other {
-            let prev_amount = self.get(&guard_this, account);
-            self.put_cache(&mut guard_this, *account, prev_amount.wrapping_add(*amount));
-        }
-    }
-
-    fn get(&self, weights: &HashMap<PublicKey, Amount>, account: &PublicKey) -> Amount {
-        weights.get(account).cloned().unwrap_or_default()
+        self.weight_cache.modify(|weights| {
+            for (account, amount) in other {
+                let prev_amount = weights.get(account);
+                self.put_cache(weights, *account, prev_amount.wrapping_add(*amount));
+            }
+        });
     }
 
     pub fn representation_add(
@@ -42,13 +42,13 @@ impl RepWeightsUpdater {
         let previous_weight = self.store.get(tx, &representative).unwrap_or_default();
         let new_weight = previous_weight.wrapping_add(amount);
         self.put_store(tx, representative, previous_weight, new_weight);
-        let mut guard = self.weight_cache.write().unwrap();
-        self.put_cache(&mut guard, representative, new_weight);
+        self.weight_cache
+            .modify(|weights| self.put_cache(weights, representative, new_weight));
     }
 
     fn put_cache(
         &self,
-        weights: &mut HashMap<PublicKey, Amount>,
+        weights: &mut WeightChanges,
         representative: PublicKey,
         new_weight: Amount,
     ) {
@@ -77,8 +77,8 @@ impl RepWeightsUpdater {
 
     /// Only use this method when loading rep weights from the database table!
     pub fn representation_put(&self, representative: PublicKey, weight: Amount) {
-        let mut guard = self.weight_cache.write().unwrap();
-        self.put_cache(&mut guard, representative, weight);
+        self.weight_cache
+            .modify(|weights| self.put_cache(weights, representative, weight));
     }
 
     pub fn representation_add_dual(
@@ -96,9 +96,10 @@ impl RepWeightsUpdater {
             let new_weight_2 = previous_weight_2.wrapping_add(amount_2);
             self.put_store(tx, rep_1, previous_weight_1, new_weight_1);
             self.put_store(tx, rep_2, previous_weight_2, new_weight_2);
-            let mut guard = self.weight_cache.write().unwrap();
-            self.put_cache(&mut guard, rep_1, new_weight_1);
-            self.put_cache(&mut guard, rep_2, new_weight_2);
+            self.weight_cache.modify(|weights| {
+                self.put_cache(weights, rep_1, new_weight_1);
+                self.put_cache(weights, rep_2, new_weight_2);
+            });
         } else {
             self.representation_add(tx, rep_1, amount_1.wrapping_add(amount_2));
         }
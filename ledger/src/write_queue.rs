@@ -1,7 +1,11 @@
 use std::{
     collections::VecDeque,
-    sync::{Arc, Condvar, Mutex},
+    mem,
+    sync::{Arc, Condvar, Mutex, Weak},
+    thread::{self, JoinHandle},
+    time::{Duration, Instant},
 };
+use tracing::error;
 
 /** Distinct areas write locking is done, order is irrelevant */
 #[derive(FromPrimitive, Clone, Copy, PartialEq, Eq)]
@@ -10,25 +14,35 @@ pub enum Writer {
     BlockProcessor,
     Pruning,
     VotingFinal,
+    BlockTableMigration,
     Testing, // Used in tests to emulate a write lock
 }
 
+/// Gets called once the writes of a writer are durable on disk
+pub type DurableCallback = Box<dyn FnOnce() + Send>;
+
+type GuardFinishCallback = Arc<dyn Fn(Vec<DurableCallback>) + Send + Sync>;
+
 pub struct WriteGuard {
     pub writer: Writer,
-    guard_finish_callback: Option<Arc<dyn Fn() + Send + Sync>>,
+    guard_finish_callback: Option<GuardFinishCallback>,
+    durable_callbacks: Vec<DurableCallback>,
 }
 
 impl WriteGuard {
-    pub fn new(writer: Writer, guard_finish_callback: Arc<dyn Fn() + Send + Sync>) -> Self {
+    fn new(writer: Writer, guard_finish_callback: GuardFinishCallback) -> Self {
         Self {
             writer,
             guard_finish_callback: Some(guard_finish_callback),
+            durable_callbacks: Vec::new(),
         }
     }
 
     pub fn release(&mut self) {
-        if let Some(callback) = self.guard_finish_callback.take() {
-            callback();
+        let callbacks = mem::take(&mut self.durable_callbacks);
+        match self.guard_finish_callback.take() {
+            Some(finish) => finish(callbacks),
+            None => callbacks.into_iter().for_each(|callback| callback()),
         }
     }
 
@@ -36,10 +50,19 @@ impl WriteGuard {
         self.guard_finish_callback.is_some()
     }
 
+    /// Calls `callback` once the write transactions committed while holding this guard
+    /// are durable. With group commit that is after the next sync of the database, otherwise
+    /// right after the guard is released. The transaction must be committed before the guard
+    /// is released.
+    pub fn on_durable(&mut self, callback: DurableCallback) {
+        self.durable_callbacks.push(callback);
+    }
+
     pub fn null() -> Self {
         Self {
             writer: Writer::Testing,
             guard_finish_callback: None,
+            durable_callbacks: Vec::new(),
         }
     }
 }
@@ -50,55 +73,349 @@ impl Drop for WriteGuard {
     }
 }
 
+/// Serializes the writers of the ledger.
+///
+/// In group commit mode the environment doesn't sync on commit. Instead a flusher thread
+/// syncs once for all writers that committed since the last sync. It syncs as soon as
+/// no writer is queued, or when the oldest unsynced commit is older than the sync interval.
+/// The interval adapts to load: it follows the duration of the last sync, so that under
+/// heavy load more commits share one sync.
 pub struct WriteQueue {
     data: Arc<WriteQueueData>,
-    guard_finish_callback: Arc<dyn Fn() + Send + Sync>,
+    guard_finish_callback: GuardFinishCallback,
+    flusher: Mutex<Option<JoinHandle<()>>>,
 }
 
 struct WriteQueueData {
-    queue: Mutex<VecDeque<Writer>>,
+    queue: Mutex<QueueState>,
     condition: Condvar,
+    flush_condition: Condvar,
+    group_commit: bool,
+}
+
+struct QueueState {
+    writers: VecDeque<Writer>,
+    /// Time of the oldest commit that isn't synced yet
+    unsynced_since: Option<Instant>,
+    durable_callbacks: Vec<DurableCallback>,
+    sync_interval: Duration,
+    stopped: bool,
 }
 
 impl WriteQueue {
+    pub const MAX_SYNC_INTERVAL: Duration = Duration::from_millis(100);
+
     pub fn new() -> Self {
+        Self::create(false)
+    }
+
+    /// `sync` has to flush the environment to disk
+    pub fn with_group_commit(sync: impl Fn() -> anyhow::Result<()> + Send + 'static) -> Self {
+        let queue = Self::create(true);
+        let data = queue.data.clone();
+        let handle = thread::Builder::new()
+            .name("Group commit".to_owned())
+            .spawn(move || data.run_flusher(sync))
+            .unwrap();
+        *queue.flusher.lock().unwrap() = Some(handle);
+        queue
+    }
+
+    fn create(group_commit: bool) -> Self {
         let data = Arc::new(WriteQueueData {
-            queue: Mutex::new(VecDeque::new()),
+            queue: Mutex::new(QueueState {
+                writers: VecDeque::new(),
+                unsynced_since: None,
+                durable_callbacks: Vec::new(),
+                sync_interval: Duration::ZERO,
+                stopped: false,
+            }),
             condition: Condvar::new(),
+            flush_condition: Condvar::new(),
+            group_commit,
         });
 
         let data_clone = data.clone();
 
         Self {
             data,
-            guard_finish_callback: Arc::new(move || {
-                let mut guard = data_clone.queue.lock().unwrap();
-                guard.pop_front();
-                data_clone.condition.notify_all();
+            guard_finish_callback: Arc::new(move |callbacks| {
+                data_clone.writer_finished(callbacks);
             }),
+            flusher: Mutex::new(None),
         }
     }
 
+    pub fn group_commit(&self) -> bool {
+        self.data.group_commit
+    }
+
+    /// Returns a callback that has to be called after every commit of a write transaction.
+    /// Writes that bypass the queue (CLI, tests, maintenance) get synced by the flusher too.
+    pub fn commit_observer(&self) -> Box<dyn Fn() + Send + Sync> {
+        let data: Weak<WriteQueueData> = Arc::downgrade(&self.data);
+        Box::new(move || {
+            if let Some(data) = data.upgrade() {
+                data.committed();
+            }
+        })
+    }
+
     /// Blocks until we are at the head of the queue and blocks other waiters until write_guard goes out of scope
     pub fn wait(&self, writer: Writer) -> WriteGuard {
         let mut lk = self.data.queue.lock().unwrap();
-        assert!(lk.iter().all(|i| *i != writer));
-        lk.push_back(writer);
+        assert!(lk.writers.iter().all(|i| *i != writer));
+        lk.writers.push_back(writer);
 
         let _result = self
             .data
             .condition
-            .wait_while(lk, |queue| queue.front() != Some(&writer));
+            .wait_while(lk, |queue| queue.writers.front() != Some(&writer));
 
         self.create_write_guard(writer)
     }
 
     /// Returns true if this writer is anywhere in the queue. Currently only used in tests
     pub fn contains(&self, writer: Writer) -> bool {
-        self.data.queue.lock().unwrap().contains(&writer)
+        self.data.queue.lock().unwrap().writers.contains(&writer)
     }
 
     fn create_write_guard(&self, writer: Writer) -> WriteGuard {
         WriteGuard::new(writer, Arc::clone(&self.guard_finish_callback))
     }
 }
+
+impl Default for WriteQueue {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for WriteQueue {
+    fn drop(&mut self) {
+        self.data.queue.lock().unwrap().stopped = true;
+        self.data.flush_condition.notify_all();
+        if let Some(handle) = self.flusher.lock().unwrap().take() {
+            handle.join().unwrap();
+        }
+    }
+}
+
+impl WriteQueueData {
+    fn committed(&self) {
+        if !self.group_commit {
+            return;
+        }
+        self.queue
+            .lock()
+            .unwrap()
+            .unsynced_since
+            .get_or_insert_with(Instant::now);
+        self.flush_condition.notify_all();
+    }
+
+    fn writer_finished(&self, callbacks: Vec<DurableCallback>) {
+        let mut guard = self.queue.lock().unwrap();
+        guard.writers.pop_front();
+        if self.group_commit {
+            guard.unsynced_since.get_or_insert_with(Instant::now);
+            guard.durable_callbacks.extend(callbacks);
+            drop(guard);
+            self.flush_condition.notify_all();
+        } else {
+            drop(guard);
+            callbacks.into_iter().for_each(|callback| callback());
+        }
+        self.condition.notify_all();
+    }
+
+    fn run_flusher(&self, sync: impl Fn() -> anyhow::Result<()>) {
+        let mut guard = self.queue.lock().unwrap();
+        loop {
+            let Some(unsynced_since) = guard.unsynced_since else {
+                if guard.stopped {
+                    break;
+                }
+                guard = self.flush_condition.wait(guard).unwrap();
+                continue;
+            };
+
+            let wait_time = guard.sync_interval.saturating_sub(unsynced_since.elapsed());
+            if !guard.writers.is_empty() && !guard.stopped && !wait_time.is_zero() {
+                guard = self
+                    .flush_condition
+                    .wait_timeout(guard, wait_time)
+                    .unwrap()
+                    .0;
+                continue;
+            }
+
+            guard.unsynced_since = None;
+            let callbacks = mem::take(&mut guard.durable_callbacks);
+            drop(guard);
+
+            let start = Instant::now();
+            if let Err(e) = sync() {
+                // The writes aren't durable yet, so the callbacks wait for the next attempt
+                error!("Group commit failed: {:?}", e);
+                guard = self.queue.lock().unwrap();
+                guard.unsynced_since.get_or_insert(unsynced_since);
+                let newer_callbacks = mem::replace(&mut guard.durable_callbacks, callbacks);
+                guard.durable_callbacks.extend(newer_callbacks);
+                if guard.stopped {
+                    break;
+                }
+                guard = self
+                    .flush_condition
+                    .wait_timeout(guard, WriteQueue::MAX_SYNC_INTERVAL)
+                    .unwrap()
+                    .0;
+                continue;
+            }
+            let sync_duration = start.elapsed();
+            callbacks.into_iter().for_each(|callback| callback());
+
+            guard = self.queue.lock().unwrap();
+            guard.sync_interval = sync_duration.min(WriteQueue::MAX_SYNC_INTERVAL);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::{
+        atomic::{AtomicUsize, Ordering},
+        mpsc,
+    };
+
+    #[test]
+    fn durable_callback_without_group_commit() {
+        let queue = WriteQueue::new();
+        let called = Arc::new(AtomicUsize::new(0));
+        let mut guard = queue.wait(Writer::Testing);
+        let called_clone = called.clone();
+        guard.on_durable(Box::new(move || {
+            called_clone.fetch_add(1, Ordering::SeqCst);
+        }));
+
+        drop(guard);
+
+        assert_eq!(called.load(Ordering::SeqCst), 1);
+    }
+
+    #[test]
+    fn sync_before_durable_callback() {
+        let syncs = Arc::new(AtomicUsize::new(0));
+        let syncs_clone = syncs.clone();
+        let queue = WriteQueue::with_group_commit(move || {
+            syncs_clone.fetch_add(1, Ordering::SeqCst);
+            Ok(())
+        });
+        let (tx, rx) = mpsc::channel();
+
+        let mut guard = queue.wait(Writer::Testing);
+        let syncs_clone = syncs.clone();
+        guard.on_durable(Box::new(move || {
+            tx.send(syncs_clone.load(Ordering::SeqCst)).unwrap();
+        }));
+        drop(guard);
+
+        let syncs_at_callback = rx.recv_timeout(Duration::from_secs(5)).unwrap();
+        assert_eq!(syncs_at_callback, 1);
+    }
+
+    #[test]
+    fn sync_once_for_queued_writers() {
+        let syncs = Arc::new(AtomicUsize::new(0));
+        let syncs_clone = syncs.clone();
+        let queue = WriteQueue::with_group_commit(move || {
+            syncs_clone.fetch_add(1, Ordering::SeqCst);
+            Ok(())
+        });
+        // Writers are still queued during the first release, so the flusher waits
+        queue.data.queue.lock().unwrap().sync_interval = WriteQueue::MAX_SYNC_INTERVAL;
+        let (tx, rx) = mpsc::channel();
+
+        let mut guard1 = queue.wait(Writer::BlockProcessor);
+        queue
+            .data
+            .queue
+            .lock()
+            .unwrap()
+            .writers
+            .push_back(Writer::Pruning);
+        let tx1 = tx.clone();
+        guard1.on_durable(Box::new(move || tx1.send(()).unwrap()));
+        drop(guard1);
+
+        let mut guard2 = queue.create_write_guard(Writer::Pruning);
+        guard2.on_durable(Box::new(move || tx.send(()).unwrap()));
+        drop(guard2);
+
+        rx.recv_timeout(Duration::from_secs(5)).unwrap();
+        rx.recv_timeout(Duration::from_secs(5)).unwrap();
+        assert_eq!(syncs.load(Ordering::SeqCst), 1);
+    }
+
+    #[test]
+    fn sync_commits_outside_of_the_queue() {
+        let (tx, rx) = mpsc::channel();
+        let queue = WriteQueue::with_group_commit(move || {
+            let _ = tx.send(());
+            Ok(())
+        });
+        let observer = queue.commit_observer();
+
+        observer();
+
+        rx.recv_timeout(Duration::from_secs(5)).unwrap();
+    }
+
+    #[test]
+    fn sync_pending_commits_on_drop() {
+        let syncs = Arc::new(AtomicUsize::new(0));
+        let syncs_clone = syncs.clone();
+        let queue = WriteQueue::with_group_commit(move || {
+            syncs_clone.fetch_add(1, Ordering::SeqCst);
+            Ok(())
+        });
+        queue.data.queue.lock().unwrap().sync_interval = WriteQueue::MAX_SYNC_INTERVAL;
+        let guard = queue.wait(Writer::Testing);
+        queue
+            .data
+            .queue
+            .lock()
+            .unwrap()
+            .writers
+            .push_back(Writer::Pruning);
+        drop(guard);
+
+        drop(queue);
+
+        assert_eq!(syncs.load(Ordering::SeqCst), 1);
+    }
+
+    #[test]
+    fn retry_failed_sync() {
+        let syncs = Arc::new(AtomicUsize::new(0));
+        let syncs_clone = syncs.clone();
+        let queue = WriteQueue::with_group_commit(move || {
+            if syncs_clone.fetch_add(1, Ordering::SeqCst) == 0 {
+                anyhow::bail!("disk full");
+            }
+            Ok(())
+        });
+        let (tx, rx) = mpsc::channel();
+
+        let mut guard = queue.wait(Writer::Testing);
+        let syncs_clone = syncs.clone();
+        guard.on_durable(Box::new(move || {
+            tx.send(syncs_clone.load(Ordering::SeqCst)).unwrap();
+        }));
+        drop(guard);
+
+        let syncs_at_callback = rx.recv_timeout(Duration::from_secs(5)).unwrap();
+        assert_eq!(syncs_at_callback, 2);
+    }
+}
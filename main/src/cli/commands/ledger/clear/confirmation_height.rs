@@ -4,7 +4,9 @@ use clap::{ArgGroup, Parser};
 use rsnano_core::{Account, ConfirmationHeightInfo, Networks};
 use rsnano_ledger::LedgerConstants;
 use rsnano_node::config::NetworkConstants;
-use rsnano_store_lmdb::{LmdbConfirmationHeightStore, LmdbEnv};
+use rsnano_store_lmdb::{
+    LmdbConfirmationHeightStore, LmdbEnv, LmdbUnconfirmedStore, LmdbVersionStore,
+};
 use std::sync::Arc;
 
 #[derive(Parser)]
@@ -46,9 +48,16 @@ impl ConfirmationHeightArgs {
         let env = Arc::new(LmdbEnv::new(&path)?);
 
         let confirmation_height_store = LmdbConfirmationHeightStore::new(env.clone())?;
+        let unconfirmed_store = LmdbUnconfirmedStore::new(env.clone())?;
+        let version_store = LmdbVersionStore::new(env.clone())?;
 
         let mut txn = env.tx_begin_write();
 
+        // The unconfirmed accounts index doesn't match the new confirmation heights.
+        // Without the index checkpoint the node rebuilds it on the next start
+        unconfirmed_store.clear(&mut txn);
+        version_store.del_index_checkpoint(&mut txn);
+
         if let Some(account_hex) = &self.account {
             let account = Account::decode_account(account_hex)?;
             let mut conf_height_reset_num = 0;
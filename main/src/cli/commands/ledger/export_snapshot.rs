@@ -0,0 +1,44 @@
+use crate::cli::get_path;
+use anyhow::{Context, Result};
+use clap::Parser;
+use rsnano_store_lmdb::{export_snapshot, LmdbStore};
+use std::{fs::File, io::BufWriter, path::PathBuf, time::Instant};
+
+#[derive(Parser)]
+pub(crate) struct ExportSnapshotArgs {
+    /// The file to which the snapshot is written
+    #[arg(long)]
+    file: PathBuf,
+    /// Uses the supplied path as the data directory
+    #[arg(long, group = "input")]
+    data_path: Option<String>,
+    /// Uses the supplied network (live, test, beta or dev)
+    #[arg(long, group = "input")]
+    network: Option<String>,
+}
+
+impl ExportSnapshotArgs {
+    pub(crate) fn export_snapshot(&self) -> Result<()> {
+        let source_path = get_path(&self.data_path, &self.network).join("data.ldb");
+
+        println!(
+            "Exporting ledger snapshot of {:?} to {:?}",
+            source_path, self.file
+        );
+        println!("This may take a while...");
+
+        let start = Instant::now();
+        let store = LmdbStore::open(&source_path).build()?;
+        let file = File::create(&self.file)
+            .with_context(|| format!("Could not create {:?}", self.file))?;
+        let mut writer = BufWriter::with_capacity(1024 * 1024, file);
+        let summary = export_snapshot(&store, &mut writer)?;
+
+        for (table, entries) in &summary.tables {
+            println!("{}: {} entries", table.as_str(), entries);
+        }
+        println!("Snapshot exported in {}s", start.elapsed().as_secs());
+
+        Ok(())
+    }
+}
@@ -0,0 +1,59 @@
+use crate::cli::get_path;
+use anyhow::{bail, Context, Result};
+use clap::Parser;
+use rsnano_store_lmdb::{import_snapshot, LmdbStore};
+use std::{fs::File, io::BufReader, path::PathBuf, time::Instant};
+
+#[derive(Parser)]
+pub(crate) struct ImportSnapshotArgs {
+    /// The snapshot file created with export-snapshot
+    #[arg(long)]
+    file: PathBuf,
+    /// Uses the supplied path as the data directory
+    #[arg(long, group = "input")]
+    data_path: Option<String>,
+    /// Uses the supplied network (live, test, beta or dev)
+    #[arg(long, group = "input")]
+    network: Option<String>,
+}
+
+impl ImportSnapshotArgs {
+    pub(crate) fn import_snapshot(&self) -> Result<()> {
+        let target_path = get_path(&self.data_path, &self.network).join("data.ldb");
+        if target_path.exists() {
+            bail!(
+                "{:?} already exists. The snapshot can only be imported into an empty data directory",
+                target_path
+            );
+        }
+
+        println!(
+            "Importing ledger snapshot {:?} into {:?}",
+            self.file, target_path
+        );
+        println!("This may take a while...");
+
+        let start = Instant::now();
+        let file =
+            File::open(&self.file).with_context(|| format!("Could not open {:?}", self.file))?;
+        let reader = BufReader::with_capacity(1024 * 1024, file);
+        let store = LmdbStore::open(&target_path).build()?;
+        let summary = match import_snapshot(&store, reader) {
+            Ok(summary) => summary,
+            Err(e) => {
+                eprintln!(
+                    "Import failed. Delete {:?} before trying again",
+                    target_path
+                );
+                return Err(e);
+            }
+        };
+
+        for (table, entries) in &summary.tables {
+            println!("{}: {} entries", table.as_str(), entries);
+        }
+        println!("Snapshot imported in {}s", start.elapsed().as_secs());
+
+        Ok(())
+    }
+}
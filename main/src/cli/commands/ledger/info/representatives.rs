@@ -32,10 +32,10 @@ impl RepresentativesArgs {
             Arc::new(RepWeightCache::new()),
         )?;
 
-        let rep_amounts = ledger.rep_weights.read().to_owned();
+        let rep_amounts = ledger.rep_weights.read();
         let mut total = Amount::zero();
 
-        for (account, amount) in rep_amounts {
+        for (&account, &amount) in rep_amounts.iter() {
             total += amount;
             println!(
                 "{} {:?} {}",
@@ -1,11 +1,15 @@
 use anyhow::Result;
 use clap::{CommandFactory, Parser, Subcommand};
 use clear::ClearCommand;
+use export_snapshot::ExportSnapshotArgs;
+use import_snapshot::ImportSnapshotArgs;
 use info::InfoCommand;
 use snapshot::SnapshotArgs;
 use vacuum::VacuumArgs;
 
 pub(crate) mod clear;
+pub(crate) mod export_snapshot;
+pub(crate) mod import_snapshot;
 pub(crate) mod info;
 pub(crate) mod snapshot;
 pub(crate) mod vacuum;
@@ -20,6 +24,10 @@ pub(crate) enum LedgerSubcommands {
     Vacuum(VacuumArgs),
     /// Similar to vacuum but does not replace the existing database
     Snapshot(SnapshotArgs),
+    /// Streams the ledger tables into a checksummed snapshot file, which can be taken while the node is running
+    ExportSnapshot(ExportSnapshotArgs),
+    /// Bulk loads a snapshot file into an empty data directory
+    ImportSnapshot(ImportSnapshotArgs),
 }
 
 #[derive(Parser)]
@@ -35,6 +43,8 @@ impl LedgerCommand {
             Some(LedgerSubcommands::Clear(command)) => command.run()?,
             Some(LedgerSubcommands::Vacuum(args)) => args.vacuum()?,
             Some(LedgerSubcommands::Snapshot(args)) => args.snapshot()?,
+            Some(LedgerSubcommands::ExportSnapshot(args)) => args.export_snapshot()?,
+            Some(LedgerSubcommands::ImportSnapshot(args)) => args.import_snapshot()?,
             None => LedgerCommand::command().print_long_help()?,
         }
 
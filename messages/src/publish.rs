@@ -4,7 +4,7 @@ use num_traits::FromPrimitive;
 use rsnano_core::{
     serialized_block_size,
     utils::{BufferWriter, Serialize, Stream},
-    Block, BlockType,
+    Block, BlockType, BlockView,
 };
 use serde_derive::Serialize;
 use std::fmt::{Debug, Display};
@@ -63,6 +63,11 @@ impl Publish {
         Some(payload)
     }
 
+    /// Borrowed view of the block in a serialized publish payload
+    pub fn block_view(payload: &[u8], extensions: BitArray<u16>) -> Option<BlockView> {
+        BlockView::new(Self::block_type(extensions), payload)
+    }
+
     pub fn serialized_size(extensions: BitArray<u16>) -> usize {
         serialized_block_size(Self::block_type(extensions))
     }
@@ -1,7 +1,7 @@
 use crate::{
     bandwidth_limiter::BandwidthLimiter,
     utils::into_ipv6_socket_address,
-    write_queue::{WriteQueue, WriteQueueReceiver},
+    write_queue::{Entry, WriteQueue, WriteQueueReceiver},
     AsyncBufferReader, ChannelDirection, ChannelId, ChannelInfo, DropPolicy, NetworkObserver,
     NullNetworkObserver, TrafficType, WriteQueueAdapter,
 };
@@ -11,6 +11,7 @@ use rsnano_nullable_clock::{SteadyClock, Timestamp};
 use rsnano_nullable_tcp::TcpStream;
 use std::{
     fmt::Display,
+    io::IoSlice,
     net::{Ipv6Addr, SocketAddrV6},
     sync::{Arc, Weak},
     time::Duration,
@@ -32,6 +33,8 @@ pub struct Channel {
 
 impl Channel {
     const MAX_QUEUE_SIZE: usize = 128;
+    /// Maximum number of queued buffers that get written with a single syscall
+    const MAX_COALESCED_WRITES: usize = 16;
 
     fn new(
         channel_info: Arc<ChannelInfo>,
@@ -119,8 +122,16 @@ impl Channel {
                 };
 
                 if let Some((entry, traffic_type)) = res {
+                    // Coalesce the buffers that are already queued into one vectored write
+                    let mut entries = vec![entry];
+                    while entries.len() < Self::MAX_COALESCED_WRITES {
+                        let Some(entry) = receiver.try_pop(traffic_type) else {
+                            break;
+                        };
+                        entries.push(entry);
+                    }
+                    let total_len: usize = entries.iter().map(|e| e.buffer.len()).sum();
                     let mut written = 0;
-                    let buffer = &entry.buffer;
                     loop {
                         select! {
                             _ = cancel_token.cancelled() =>{
@@ -128,10 +139,10 @@ impl Channel {
                             }
                             res = stream_l.writable() =>{
                             match res {
-                            Ok(()) => match stream_l.try_write(&buffer[written..]) {
+                            Ok(()) => match stream_l.try_write_vectored(&unwritten_slices(&entries, written)) {
                                 Ok(n) => {
                                     written += n;
-                                    if written >= buffer.len() {
+                                    if written >= total_len {
                                         observer.send_succeeded(written, traffic_type);
                                         info.set_last_activity(clock.now());
                                         break;
@@ -230,6 +241,18 @@ impl Channel {
         buffer: &[u8],
         drop_policy: DropPolicy,
         traffic_type: TrafficType,
+    ) -> bool {
+        self.try_send_shared_buffer(&Arc::new(buffer.to_vec()), drop_policy, traffic_type)
+        // TODO don't copy into vec. Split into fixed size packets
+    }
+
+    /// Queues the shared buffer without copying it. This allows sending the same
+    /// serialized message to many channels.
+    pub fn try_send_shared_buffer(
+        &self,
+        buffer: &Arc<Vec<u8>>,
+        drop_policy: DropPolicy,
+        traffic_type: TrafficType,
     ) -> bool {
         if self.info.is_closed() {
             return false;
@@ -246,9 +269,7 @@ impl Channel {
             // TODO notify bandwidth limiter that we are sending it anyway
         }
 
-        let (inserted, write_error) = self
-            .write_queue
-            .try_insert(Arc::new(buffer.to_vec()), traffic_type); // TODO don't copy into vec. Split into fixed size packets
+        let (inserted, write_error) = self.write_queue.try_insert(buffer.clone(), traffic_type);
 
         if write_error {
             self.observer.send_failed();
@@ -279,6 +300,21 @@ impl Channel {
     }
 }
 
+/// Returns the parts of the queued buffers that are not written yet
+fn unwritten_slices(entries: &[Entry], mut written: usize) -> Vec<IoSlice<'_>> {
+    let mut slices = Vec::with_capacity(entries.len());
+    for entry in entries {
+        let buffer = entry.buffer.as_slice();
+        if written >= buffer.len() {
+            written -= buffer.len();
+        } else {
+            slices.push(IoSlice::new(&buffer[written..]));
+            written = 0;
+        }
+    }
+    slices
+}
+
 impl Display for Channel {
     fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
         self.info.peer_addr().fmt(f)
@@ -382,3 +418,42 @@ impl WriteQueueAdapter for WriteQueueAdapterImpl {
         self.cancel_token.cancel();
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn unwritten_slices_of_new_entries() {
+        let entries = test_entries();
+        let slices = unwritten_slices(&entries, 0);
+        assert_eq!(to_vecs(&slices), vec![vec![1, 2, 3], vec![4, 5]]);
+    }
+
+    #[test]
+    fn unwritten_slices_after_partial_write() {
+        let entries = test_entries();
+        assert_eq!(
+            to_vecs(&unwritten_slices(&entries, 2)),
+            vec![vec![3], vec![4, 5]]
+        );
+        assert_eq!(to_vecs(&unwritten_slices(&entries, 3)), vec![vec![4, 5]]);
+        assert_eq!(to_vecs(&unwritten_slices(&entries, 4)), vec![vec![5]]);
+        assert!(unwritten_slices(&entries, 5).is_empty());
+    }
+
+    fn test_entries() -> Vec<Entry> {
+        vec![
+            Entry {
+                buffer: Arc::new(vec![1, 2, 3]),
+            },
+            Entry {
+                buffer: Arc::new(vec![4, 5]),
+            },
+        ]
+    }
+
+    fn to_vecs(slices: &[IoSlice]) -> Vec<Vec<u8>> {
+        slices.iter().map(|s| s.to_vec()).collect()
+    }
+}
@@ -139,6 +139,22 @@ impl Network {
         }
     }
 
+    /// Queues the shared buffer without copying it
+    pub fn try_send_shared_buffer(
+        &self,
+        channel_id: ChannelId,
+        buffer: &Arc<Vec<u8>>,
+        drop_policy: DropPolicy,
+        traffic_type: TrafficType,
+    ) -> bool {
+        let channel = self.channels.lock().unwrap().get(&channel_id).cloned();
+        if let Some(channel) = channel {
+            channel.try_send_shared_buffer(buffer, drop_policy, traffic_type)
+        } else {
+            false
+        }
+    }
+
     pub async fn send_buffer(
         &self,
         channel_id: ChannelId,
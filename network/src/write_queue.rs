@@ -76,6 +76,14 @@ impl WriteQueueReceiver {
             v = self.bootstrap.recv() => v.map(|i| (i, TrafficType::Bootstrap)),
         }
     }
+
+    /// Returns the next entry of the given queue if one is ready, without waiting
+    pub fn try_pop(&mut self, traffic_type: TrafficType) -> Option<Entry> {
+        match traffic_type {
+            TrafficType::Generic => self.generic.try_recv().ok(),
+            TrafficType::Bootstrap => self.bootstrap.try_recv().ok(),
+        }
+    }
 }
 
 pub struct Entry {
@@ -0,0 +1,133 @@
+//! Minimal benchmark harness for the `harness = false` bench targets of this crate.
+//!
+//! Every benchmark is measured in several samples after a short warm up. The mean
+//! time per operation and the spread between the fastest and the slowest sample
+//! are printed, so that the numbers of two builds can be compared side by side.
+//! Command line arguments that don't start with `-` are used as name filters:
+//! `cargo bench -p rsnano_node --bench ledger -- confirm`
+
+#![allow(dead_code)]
+
+pub use std::hint::black_box;
+use std::time::{Duration, Instant};
+
+const WARM_UP_TIME: Duration = Duration::from_millis(200);
+const MEASUREMENT_TIME: Duration = Duration::from_secs(2);
+const SAMPLES: u32 = 10;
+
+pub struct Bencher {
+    filters: Vec<String>,
+}
+
+impl Bencher {
+    pub fn from_args() -> Self {
+        let filters = std::env::args()
+            .skip(1)
+            .filter(|arg| !arg.starts_with('-'))
+            .collect();
+
+        println!(
+            "{:<45} {:>12} {:>12} {:>12} {:>14}",
+            "benchmark", "mean", "fastest", "slowest", "ops/s"
+        );
+
+        Self { filters }
+    }
+
+    pub fn is_enabled(&self, name: &str) -> bool {
+        self.filters.is_empty() || self.filters.iter().any(|f| name.contains(f.as_str()))
+    }
+
+    /// Measures a routine that is cheap enough to be called in a tight loop
+    pub fn bench<R>(&self, name: &str, routine: impl FnMut() -> R) {
+        self.bench_items(name, 1, routine)
+    }
+
+    /// Measures a routine that consumes its input. Every input is used exactly once,
+    /// in the given order. This is needed for operations that change state, like
+    /// inserting a chain of blocks into the ledger.
+    /// The inputs are split into samples, creating the inputs is not measured.
+    pub fn bench_inputs<I, R>(&self, name: &str, inputs: Vec<I>, mut routine: impl FnMut(I) -> R) {
+        if !self.is_enabled(name) || inputs.is_empty() {
+            return;
+        }
+
+        let sample_size = inputs.len().div_ceil(SAMPLES as usize);
+        let mut inputs = inputs.into_iter().peekable();
+        let mut samples = Vec::new();
+        while inputs.peek().is_some() {
+            let sample: Vec<I> = inputs.by_ref().take(sample_size).collect();
+            let count = sample.len() as u32;
+            let start = Instant::now();
+            for input in sample {
+                black_box(routine(input));
+            }
+            samples.push(start.elapsed() / count);
+        }
+
+        print_result(name, &samples, 1);
+    }
+
+    /// Measures a routine that processes `items_per_call` items per call, for example
+    /// a whole batch. The reported numbers are per item.
+    pub fn bench_items<R>(&self, name: &str, items_per_call: u32, mut routine: impl FnMut() -> R) {
+        if !self.is_enabled(name) {
+            return;
+        }
+
+        let iterations_per_sample = estimate_iterations(&mut routine);
+        let samples: Vec<Duration> = (0..SAMPLES)
+            .map(|_| {
+                let start = Instant::now();
+                for _ in 0..iterations_per_sample {
+                    black_box(routine());
+                }
+                start.elapsed() / iterations_per_sample
+            })
+            .collect();
+
+        print_result(name, &samples, items_per_call);
+    }
+}
+
+/// Runs the routine during the warm up time and returns how often it has to be
+/// called to fill one sample
+fn estimate_iterations<R>(routine: &mut impl FnMut() -> R) -> u32 {
+    let start = Instant::now();
+    let mut iterations: u32 = 0;
+    while start.elapsed() < WARM_UP_TIME {
+        black_box(routine());
+        iterations += 1;
+    }
+    let per_iteration = start.elapsed() / iterations;
+    let sample_time = MEASUREMENT_TIME / SAMPLES;
+    let nanos = per_iteration.as_nanos().max(1);
+    (sample_time.as_nanos() / nanos).clamp(1, u32::MAX as u128) as u32
+}
+
+fn print_result(name: &str, samples: &[Duration], items: u32) {
+    let per_item = |d: &Duration| *d / items;
+    let mean = per_item(&(samples.iter().sum::<Duration>() / samples.len() as u32));
+    let fastest = per_item(samples.iter().min().unwrap());
+    let slowest = per_item(samples.iter().max().unwrap());
+    let ops_per_sec = 1.0 / mean.as_secs_f64().max(f64::MIN_POSITIVE);
+    println!(
+        "{:<45} {:>12} {:>12} {:>12} {:>14.0}",
+        name,
+        format_duration(mean),
+        format_duration(fastest),
+        format_duration(slowest),
+        ops_per_sec
+    );
+}
+
+fn format_duration(duration: Duration) -> String {
+    let nanos = duration.as_nanos();
+    if nanos < 10_000 {
+        format!("{} ns", nanos)
+    } else if nanos < 10_000_000 {
+        format!("{:.2} µs", nanos as f64 / 1_000.0)
+    } else {
+        format!("{:.2} ms", nanos as f64 / 1_000_000.0)
+    }
+}
@@ -0,0 +1,41 @@
+//! Benchmarks for the vote cache.
+//! Run with `cargo bench -p rsnano_node --bench consensus`
+
+mod common;
+
+use common::Bencher;
+use rsnano_core::{Amount, BlockHash, PrivateKey, Vote};
+use rsnano_node::{
+    consensus::{VoteCache, VoteCacheConfig},
+    stats::Stats,
+};
+use std::{collections::HashMap, sync::Arc};
+
+const REPS: usize = 64;
+const HASHES: usize = 10_000;
+const VOTES: usize = 100_000;
+
+fn main() {
+    let bencher = Bencher::from_args();
+    let reps: Vec<PrivateKey> = (0..REPS).map(|_| PrivateKey::new()).collect();
+
+    // Every vote is for a single hash, from a random representative
+    let votes: Vec<(Arc<Vote>, Amount)> = (0..VOTES)
+        .map(|i| {
+            let rep = i % REPS;
+            let hash = BlockHash::from((i % HASHES) as u64 + 1);
+            let vote = Arc::new(Vote::new_final(&reps[rep], vec![hash]));
+            (vote, Amount::nano(rep as u128 + 1))
+        })
+        .collect();
+
+    let cache = VoteCache::new(VoteCacheConfig::default(), Arc::new(Stats::default()));
+    let no_results = HashMap::new();
+    bencher.bench_inputs("vote_cache/insert", votes, |(vote, weight)| {
+        cache.insert(&vote, weight, &no_results)
+    });
+
+    bencher.bench(&format!("vote_cache/top_of_{}", cache.size()), || {
+        cache.top(Amount::zero())
+    });
+}
@@ -0,0 +1,247 @@
+//! Benchmarks for inserting and cementing blocks. All of them run against a real
+//! LMDB environment in a temporary directory.
+//! Run with `cargo bench -p rsnano_node --bench ledger`
+
+mod common;
+
+use common::Bencher;
+use rsnano_core::{
+    Account, Amount, Block, BlockHash, Link, PrivateKey, PublicKey, TestBlockBuilder,
+    DEV_GENESIS_KEY,
+};
+use rsnano_ledger::{LedgerContext, DEV_GENESIS_HASH};
+use rsnano_store_lmdb::LmdbWriteTransaction;
+
+const BLOCKS_PER_BENCH: usize = 5_000;
+const CHAIN_DEPTH: usize = 1_000;
+
+fn main() {
+    let bencher = Bencher::from_args();
+    process_legacy_blocks(&bencher);
+    process_state_blocks(&bencher);
+    confirm_deep_chain(&bencher);
+}
+
+fn process_legacy_blocks(bencher: &Bencher) {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+    let mut genesis = TestAccount::genesis();
+
+    let sends = (0..BLOCKS_PER_BENCH)
+        .map(|_| genesis.legacy_send(Account::from(1), Amount::raw(1)))
+        .collect();
+    bencher.bench_inputs("ledger/process/legacy_send", sends, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+
+    let changes = (0..BLOCKS_PER_BENCH)
+        .map(|i| genesis.legacy_change(PublicKey::from(i as u64 + 1)))
+        .collect();
+    bencher.bench_inputs("ledger/process/legacy_change", changes, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+
+    let mut receivers: Vec<_> = (0..BLOCKS_PER_BENCH).map(|_| TestAccount::new()).collect();
+    let opens = receivers
+        .iter_mut()
+        .map(|receiver| {
+            let send = genesis.legacy_send(receiver.account(), Amount::raw(1));
+            process(&ctx, &mut txn, &send);
+            receiver.legacy_open(send.hash(), Amount::raw(1))
+        })
+        .collect();
+    bencher.bench_inputs("ledger/process/legacy_open", opens, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+
+    let receives = receivers
+        .iter_mut()
+        .map(|receiver| {
+            let send = genesis.legacy_send(receiver.account(), Amount::raw(1));
+            process(&ctx, &mut txn, &send);
+            receiver.legacy_receive(send.hash(), Amount::raw(1))
+        })
+        .collect();
+    bencher.bench_inputs("ledger/process/legacy_receive", receives, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+}
+
+fn process_state_blocks(bencher: &Bencher) {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+    let mut genesis = TestAccount::genesis();
+
+    let sends = (0..BLOCKS_PER_BENCH)
+        .map(|_| genesis.state_send(Account::from(1), Amount::raw(1)))
+        .collect();
+    bencher.bench_inputs("ledger/process/state_send", sends, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+
+    let changes = (0..BLOCKS_PER_BENCH)
+        .map(|i| genesis.state_change(PublicKey::from(i as u64 + 1)))
+        .collect();
+    bencher.bench_inputs("ledger/process/state_change", changes, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+
+    let mut receivers: Vec<_> = (0..BLOCKS_PER_BENCH).map(|_| TestAccount::new()).collect();
+    let opens = receivers
+        .iter_mut()
+        .map(|receiver| {
+            let send = genesis.state_send(receiver.account(), Amount::raw(1));
+            process(&ctx, &mut txn, &send);
+            receiver.state_open(send.hash(), Amount::raw(1))
+        })
+        .collect();
+    bencher.bench_inputs("ledger/process/state_open", opens, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+
+    let receives = receivers
+        .iter_mut()
+        .map(|receiver| {
+            let send = genesis.state_send(receiver.account(), Amount::raw(1));
+            process(&ctx, &mut txn, &send);
+            receiver.state_receive(send.hash(), Amount::raw(1))
+        })
+        .collect();
+    bencher.bench_inputs("ledger/process/state_receive", receives, |block| {
+        process(&ctx, &mut txn, &block)
+    });
+}
+
+/// Cements a long chain in steps of `CHAIN_DEPTH` blocks. Every step has to walk
+/// and cement `CHAIN_DEPTH` unconfirmed blocks.
+fn confirm_deep_chain(bencher: &Bencher) {
+    let ctx = LedgerContext::empty();
+    let mut txn = ctx.ledger.rw_txn();
+    let mut genesis = TestAccount::genesis();
+
+    let mut targets = Vec::new();
+    for i in 1..=CHAIN_DEPTH * 10 {
+        let send = genesis.state_send(Account::from(1), Amount::raw(1));
+        process(&ctx, &mut txn, &send);
+        if i % CHAIN_DEPTH == 0 {
+            targets.push(send.hash());
+        }
+    }
+
+    let name = format!("ledger/confirm_max/chain_of_{}", CHAIN_DEPTH);
+    bencher.bench_inputs(&name, targets, |target| {
+        let cemented = ctx.ledger.confirm_max(&mut txn, target, 128 * 128);
+        assert_eq!(cemented.len(), CHAIN_DEPTH);
+    });
+}
+
+fn process(ctx: &LedgerContext, txn: &mut LmdbWriteTransaction, block: &Block) {
+    ctx.ledger.process(txn, block).unwrap();
+}
+
+/// Keeps track of an account chain, so that blocks can be created without
+/// reading the ledger
+struct TestAccount {
+    key: PrivateKey,
+    head: BlockHash,
+    balance: Amount,
+    representative: PublicKey,
+}
+
+impl TestAccount {
+    fn new() -> Self {
+        let key = PrivateKey::new();
+        Self {
+            representative: key.public_key(),
+            key,
+            head: BlockHash::zero(),
+            balance: Amount::zero(),
+        }
+    }
+
+    fn genesis() -> Self {
+        Self {
+            key: DEV_GENESIS_KEY.clone(),
+            head: *DEV_GENESIS_HASH,
+            balance: Amount::MAX,
+            representative: DEV_GENESIS_KEY.public_key(),
+        }
+    }
+
+    fn account(&self) -> Account {
+        self.key.account()
+    }
+
+    fn update(&mut self, block: Block, balance: Amount) -> Block {
+        self.head = block.hash();
+        self.balance = balance;
+        block
+    }
+
+    fn legacy_send(&mut self, destination: Account, amount: Amount) -> Block {
+        let block = TestBlockBuilder::legacy_send()
+            .previous(self.head)
+            .destination(destination)
+            .previous_balance(self.balance)
+            .amount(amount)
+            .sign(self.key.clone())
+            .build();
+        self.update(block, self.balance - amount)
+    }
+
+    fn legacy_open(&mut self, source: BlockHash, amount: Amount) -> Block {
+        let block = TestBlockBuilder::legacy_open()
+            .source(source)
+            .representative(self.representative)
+            .sign(&self.key)
+            .build();
+        self.update(block, amount)
+    }
+
+    fn legacy_receive(&mut self, source: BlockHash, amount: Amount) -> Block {
+        let block = TestBlockBuilder::legacy_receive()
+            .previous(self.head)
+            .source(source)
+            .sign(&self.key)
+            .build();
+        self.update(block, self.balance + amount)
+    }
+
+    fn legacy_change(&mut self, representative: PublicKey) -> Block {
+        self.representative = representative;
+        let block = TestBlockBuilder::legacy_change()
+            .previous(self.head)
+            .representative(representative)
+            .sign(&self.key)
+            .build();
+        self.update(block, self.balance)
+    }
+
+    fn state_send(&mut self, destination: Account, amount: Amount) -> Block {
+        self.state_block(self.balance - amount, destination.into())
+    }
+
+    fn state_open(&mut self, source: BlockHash, amount: Amount) -> Block {
+        self.state_block(amount, source.into())
+    }
+
+    fn state_receive(&mut self, source: BlockHash, amount: Amount) -> Block {
+        self.state_block(self.balance + amount, source.into())
+    }
+
+    fn state_change(&mut self, representative: PublicKey) -> Block {
+        self.representative = representative;
+        self.state_block(self.balance, Link::zero())
+    }
+
+    fn state_block(&mut self, balance: Amount, link: Link) -> Block {
+        let block = TestBlockBuilder::state()
+            .previous(self.head)
+            .representative(self.representative)
+            .balance(balance)
+            .link(link)
+            .key(&self.key)
+            .build();
+        self.update(block, balance)
+    }
+}
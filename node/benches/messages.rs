@@ -0,0 +1,83 @@
+//! Benchmarks for the inbound message path: duplicate filtering and parsing.
+//! Run with `cargo bench -p rsnano_node --bench messages`
+
+mod common;
+
+use common::Bencher;
+use rsnano_core::{work::WORK_THRESHOLDS_STUB, BlockHash, PrivateKey, TestBlockBuilder, Vote};
+use rsnano_messages::{ConfirmAck, Message, MessageSerializer, ProtocolInfo, Publish};
+use rsnano_node::transport::{MessageDeserializer, NetworkFilter, VecBufferReader};
+use std::sync::Arc;
+
+const MESSAGES: usize = 20_000;
+
+fn main() {
+    let bencher = Bencher::from_args();
+    let key = PrivateKey::new();
+
+    let publish_messages: Vec<Message> = (0..MESSAGES)
+        .map(|i| {
+            let block = TestBlockBuilder::state()
+                .previous(BlockHash::from(i as u64 + 1))
+                .key(&key)
+                .build();
+            Message::Publish(Publish::new_forward(block))
+        })
+        .collect();
+
+    let confirm_ack_messages: Vec<Message> = (0..MESSAGES)
+        .map(|i| {
+            let hashes = (0..12).map(|h| BlockHash::from((i * 12 + h) as u64 + 1));
+            let vote = Vote::new_final(&key, hashes.collect());
+            Message::ConfirmAck(ConfirmAck::new_with_rebroadcasted_vote(vote))
+        })
+        .collect();
+
+    network_filter(&bencher, "network_filter/apply_publish", &publish_messages);
+    deserialize(&bencher, "message_deserializer/publish", &publish_messages);
+    deserialize(
+        &bencher,
+        "message_deserializer/confirm_ack",
+        &confirm_ack_messages,
+    );
+}
+
+fn network_filter(bencher: &Bencher, name: &str, messages: &[Message]) {
+    let mut serializer = MessageSerializer::new(ProtocolInfo::default());
+    let payloads: Vec<Vec<u8>> = messages
+        .iter()
+        .map(|m| serializer.serialize(m).to_vec())
+        .collect();
+
+    let filter = NetworkFilter::new(1024 * 1024);
+    let mut index = 0;
+    bencher.bench(name, || {
+        index = (index + 1) % payloads.len();
+        filter.apply(&payloads[index])
+    });
+}
+
+/// Reads all messages from one stream, every message is unique so that the
+/// duplicate filter never drops them
+fn deserialize(bencher: &Bencher, name: &str, messages: &[Message]) {
+    let protocol = ProtocolInfo::default();
+    let mut serializer = MessageSerializer::new(protocol);
+    let mut buffer = Vec::new();
+    for message in messages {
+        buffer.extend_from_slice(serializer.serialize(message));
+    }
+
+    let runtime = tokio::runtime::Builder::new_current_thread()
+        .build()
+        .unwrap();
+    let mut deserializer = MessageDeserializer::new(
+        protocol,
+        WORK_THRESHOLDS_STUB.clone(),
+        Arc::new(NetworkFilter::new(1024 * 1024)),
+        VecBufferReader::new(buffer),
+    );
+
+    bencher.bench_inputs(name, vec![(); messages.len()], |_| {
+        runtime.block_on(deserializer.read()).unwrap()
+    });
+}
@@ -0,0 +1,60 @@
+//! Compares the sharded NetworkFilter with a single lock (= the previous implementation)
+//! under concurrent load. Run with `cargo bench -p rsnano_node --bench network_filter`
+
+use rand::{thread_rng, Rng};
+use rsnano_node::transport::NetworkFilter;
+use std::{
+    thread,
+    time::{Duration, Instant},
+};
+
+const FILTER_SIZE: usize = 1024 * 1024;
+const OPS_PER_THREAD: usize = 500_000;
+
+fn main() {
+    println!(
+        "{:>8} {:>8} {:>14} {:>14}",
+        "shards", "threads", "ns/op", "Mops/s"
+    );
+    for shards in [1, <NetworkFilter>::DEFAULT_SHARDS] {
+        for threads in [1, 8, 32] {
+            let elapsed = run(shards, threads);
+            let total_ops = (threads * OPS_PER_THREAD) as f64;
+            println!(
+                "{:>8} {:>8} {:>14.1} {:>14.2}",
+                shards,
+                threads,
+                elapsed.as_nanos() as f64 * threads as f64 / total_ops,
+                total_ops / elapsed.as_secs_f64() / 1_000_000.0
+            );
+        }
+    }
+}
+
+fn run(shards: usize, threads: usize) -> Duration {
+    let filter = NetworkFilter::with_shards(FILTER_SIZE, shards);
+
+    // Half of the messages are duplicates, like on the live network
+    let digests: Vec<Vec<u128>> = (0..threads)
+        .map(|_| {
+            let mut rng = thread_rng();
+            let unique: Vec<u128> = (0..OPS_PER_THREAD / 2).map(|_| rng.gen()).collect();
+            unique.iter().chain(unique.iter()).copied().collect()
+        })
+        .collect();
+
+    let start = Instant::now();
+    thread::scope(|s| {
+        for digests in &digests {
+            let filter = &filter;
+            s.spawn(move || {
+                for digest in digests {
+                    if !filter.apply_digest(*digest) {
+                        filter.check(*digest);
+                    }
+                }
+            });
+        }
+    });
+    start.elapsed()
+}
@@ -0,0 +1,84 @@
+//! Benchmarks for the fair queue and the unchecked map.
+//! Run with `cargo bench -p rsnano_node --bench queues`
+
+mod common;
+
+use common::Bencher;
+use rsnano_core::{BlockHash, HashOrAccount, PrivateKey, TestBlockBuilder, UncheckedInfo};
+use rsnano_node::{block_processing::UncheckedMap, stats::Stats, transport::FairQueue};
+use std::{
+    sync::{
+        atomic::{AtomicUsize, Ordering},
+        Arc,
+    },
+    thread,
+};
+
+const SOURCES: usize = 64;
+const BATCH_SIZE: usize = 256;
+const UNCHECKED_BLOCKS: usize = 20_000;
+const TRIGGER_BATCH: usize = 1_000;
+
+fn main() {
+    let bencher = Bencher::from_args();
+    fair_queue(&bencher);
+    unchecked_map(&bencher);
+}
+
+fn fair_queue(bencher: &Bencher) {
+    let mut queue: FairQueue<usize, u64> =
+        FairQueue::new(Box::new(|_| BATCH_SIZE), Box::new(|source| source % 4 + 1));
+
+    bencher.bench_items("fair_queue/push_and_next_batch", BATCH_SIZE as u32, || {
+        for i in 0..BATCH_SIZE {
+            queue.push(i % SOURCES, i as u64);
+        }
+        queue.next_batch(BATCH_SIZE)
+    });
+}
+
+fn unchecked_map(bencher: &Bencher) {
+    let key = PrivateKey::new();
+    let entries: Vec<(HashOrAccount, UncheckedInfo)> = (0..UNCHECKED_BLOCKS)
+        .map(|i| {
+            let dependency = BlockHash::from(i as u64 + 1);
+            let block = TestBlockBuilder::state()
+                .previous(dependency)
+                .key(&key)
+                .build();
+            (dependency.into(), UncheckedInfo::new(block))
+        })
+        .collect();
+
+    let dependencies: Vec<HashOrAccount> = entries.iter().map(|(dep, _)| *dep).collect();
+
+    let unchecked = UncheckedMap::new(UNCHECKED_BLOCKS, Arc::new(Stats::default()), false);
+    bencher.bench_inputs("unchecked/put", entries, |(dependency, info)| {
+        unchecked.put(dependency, info)
+    });
+
+    let satisfied = Arc::new(AtomicUsize::new(0));
+    let satisfied_l = satisfied.clone();
+    unchecked.set_satisfied_observer(Box::new(move |_| {
+        satisfied_l.fetch_add(1, Ordering::Relaxed);
+    }));
+    unchecked.start();
+
+    // Measures until all blocks of the batch were handed to the satisfied observer
+    let batches: Vec<Vec<HashOrAccount>> = dependencies
+        .chunks(TRIGGER_BATCH)
+        .map(|c| c.to_vec())
+        .collect();
+    let name = format!("unchecked/trigger_{}", TRIGGER_BATCH);
+    bencher.bench_inputs(&name, batches, |batch| {
+        let expected = satisfied.load(Ordering::Relaxed) + batch.len();
+        for dependency in &batch {
+            unchecked.trigger(dependency);
+        }
+        while satisfied.load(Ordering::Relaxed) < expected {
+            thread::yield_now();
+        }
+    });
+
+    unchecked.stop();
+}
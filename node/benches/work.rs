@@ -0,0 +1,41 @@
+//! Benchmarks for the CPU proof of work generation.
+//! Run with `cargo bench -p rsnano_node --bench work`
+
+mod common;
+
+use common::Bencher;
+use rsnano_core::{
+    work::{WorkPool, WorkPoolImpl, WorkThresholds},
+    Difficulty, DifficultyV1, Root,
+};
+use std::time::Duration;
+
+/// On average 2^16 hashes are needed to find work for this threshold
+const EXPECTED_HASHES: u64 = 1 << 16;
+const THRESHOLD: u64 = u64::MAX - (u64::MAX / EXPECTED_HASHES);
+const HASHES_PER_CALL: u64 = 1024;
+
+fn main() {
+    let bencher = Bencher::from_args();
+    let root = Root::from(12345);
+
+    // This is the inner loop of the CPU work generator
+    let difficulty = DifficultyV1::default();
+    let mut work: u64 = 0;
+    bencher.bench_items("work/blake2b_hash", HASHES_PER_CALL as u32, || {
+        let mut max = 0;
+        for _ in 0..HASHES_PER_CALL {
+            work += 1;
+            max = max.max(difficulty.get_difficulty(&root, work));
+        }
+        max
+    });
+
+    // The reported time is per expected hash, so it can be compared with the number above
+    let pool = WorkPoolImpl::new(WorkThresholds::publish_dev().clone(), 1, Duration::ZERO);
+    let mut next_root: u64 = 0;
+    bencher.bench_items("work/cpu_work_generator", EXPECTED_HASHES as u32, || {
+        next_root += 1;
+        pool.generate(Root::from(next_root), THRESHOLD).unwrap()
+    });
+}
@@ -22,6 +22,10 @@ pub struct BacklogPopulationConfig {
 
     /** Number of batches to run per second. Batches run in 1 second / `frequency` intervals */
     pub frequency: u32,
+
+    /** Only scan the accounts which have unconfirmed blocks, instead of the whole account table.
+     *  The ledger has to maintain an index of these accounts for that. */
+    pub use_unconfirmed_index: bool,
 }
 
 impl Default for BacklogPopulationConfig {
@@ -30,6 +34,7 @@ impl Default for BacklogPopulationConfig {
             enabled: true,
             batch_size: 10 * 1000,
             frequency: 10,
+            use_unconfirmed_index: true,
         }
     }
 }
@@ -188,7 +193,7 @@ impl BacklogPopulationThread {
                 let mut transaction = self.ledger.store.tx_begin_read();
 
                 let mut count = 0u32;
-                let mut it = self.ledger.any().accounts_range(&transaction, next..);
+                let mut it = self.accounts_range(&transaction, next);
                 while let Some((account, info)) = it.next() {
                     if count >= chunk_size {
                         break;
@@ -196,7 +201,7 @@ impl BacklogPopulationThread {
                     if transaction.is_refresh_needed_with(Duration::from_millis(100)) {
                         drop(it);
                         transaction.refresh();
-                        it = self.ledger.any().accounts_range(&transaction, account..);
+                        it = self.accounts_range(&transaction, account);
                     }
 
                     self.stats.inc(StatType::Backlog, DetailType::Total);
@@ -207,12 +212,7 @@ impl BacklogPopulationThread {
                     count += 1;
                 }
                 done = next == Account::zero()
-                    || self
-                        .ledger
-                        .any()
-                        .accounts_range(&transaction, next..)
-                        .next()
-                        .is_none();
+                    || self.accounts_range(&transaction, next).next().is_none();
             }
             lock = self.mutex.lock().unwrap();
             // Give the rest of the node time to progress without holding database lock
@@ -227,6 +227,29 @@ impl BacklogPopulationThread {
         }
     }
 
+    /// All accounts starting at `start`. If the ledger maintains the unconfirmed index,
+    /// only the accounts with unconfirmed blocks are returned.
+    fn accounts_range<'txn>(
+        &self,
+        txn: &'txn dyn Transaction,
+        start: Account,
+    ) -> Box<dyn Iterator<Item = (Account, AccountInfo)> + 'txn> {
+        if self.ledger.unconfirmed_index_enabled() {
+            let accounts = self.ledger.store.account.clone();
+            Box::new(
+                self.ledger
+                    .store
+                    .unconfirmed
+                    .iter_range(txn, start..)
+                    .filter_map(move |account| {
+                        accounts.get(txn, &account).map(|info| (account, info))
+                    }),
+            )
+        } else {
+            Box::new(self.ledger.any().accounts_range(txn, start..))
+        }
+    }
+
     fn activate(&self, txn: &dyn Transaction, account: &Account, account_info: &AccountInfo) {
         let conf_info = self
             .ledger
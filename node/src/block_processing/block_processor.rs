@@ -1,16 +1,17 @@
 use super::UncheckedMap;
 use crate::{
-    stats::{DetailType, StatType, Stats},
+    stats::{DetailType, LatencyStage, StatType, Stats},
     transport::{FairQueue, FairQueueInfo},
-    utils::{ThreadPool, ThreadPoolImpl},
+    utils::{place_current_thread, SignatureChecker, ThreadPool, ThreadPoolImpl},
 };
 use rsnano_core::{
-    utils::ContainerInfo, work::WorkThresholds, Block, BlockType, Epoch, HashOrAccount, Networks,
-    SavedBlock, UncheckedInfo,
+    utils::{ContainerInfo, ThreadRole},
+    work::WorkThresholds,
+    Block, BlockType, Epoch, HashOrAccount, Networks, PublicKey, SavedBlock, UncheckedInfo,
 };
-use rsnano_ledger::{BlockStatus, Ledger, Writer};
+use rsnano_ledger::{BlockStatus, Ledger, PrevalidatedBlock, WriteGuard, Writer};
 use rsnano_network::{ChannelId, DeadChannelCleanupStep};
-use rsnano_store_lmdb::LmdbWriteTransaction;
+use rsnano_store_lmdb::{LmdbReadTransaction, LmdbWriteTransaction};
 use std::{
     collections::VecDeque,
     mem::size_of,
@@ -178,6 +179,7 @@ impl BlockProcessor {
         ledger: Arc<Ledger>,
         unchecked_map: Arc<UncheckedMap>,
         stats: Arc<Stats>,
+        signature_checker: Arc<SignatureChecker>,
     ) -> Self {
         let config_l = config.clone();
         let max_size_query = Box::new(move |origin: &(BlockSource, ChannelId)| match origin.0 {
@@ -207,6 +209,7 @@ impl BlockProcessor {
                 unchecked_map,
                 config,
                 stats,
+                signature_checker,
                 workers: ThreadPoolImpl::create(1, "Blck proc notif"),
                 blocks_rolled_back: Mutex::new(None),
                 block_rolled_back: Mutex::new(Vec::new()),
@@ -223,6 +226,7 @@ impl BlockProcessor {
             ledger,
             Arc::new(UncheckedMap::default()),
             Arc::new(Stats::default()),
+            Arc::new(SignatureChecker::default()),
         )
     }
 
@@ -237,6 +241,7 @@ impl BlockProcessor {
             std::thread::Builder::new()
                 .name("Blck processing".to_string())
                 .spawn(move || {
+                    place_current_thread(ThreadRole::BlockProcessor);
                     processor_loop.run();
                 })
                 .unwrap(),
@@ -343,6 +348,7 @@ pub(crate) struct BlockProcessorLoopImpl {
     unchecked_map: Arc<UncheckedMap>,
     config: BlockProcessorConfig,
     stats: Arc<Stats>,
+    signature_checker: Arc<SignatureChecker>,
     workers: ThreadPoolImpl,
     blocks_rolled_back: Mutex<Option<Box<dyn Fn(Vec<SavedBlock>, SavedBlock) + Send + Sync>>>,
     block_rolled_back: Mutex<Vec<Box<dyn Fn(&Block) + Send + Sync>>>,
@@ -382,23 +388,29 @@ impl BlockProcessorLoop for Arc<BlockProcessorLoopImpl> {
                     );
                 }
 
-                let mut processed = self.process_batch(guard);
-                guard = self.mutex.lock().unwrap();
+                let (mut processed, mut write_guard) = self.process_batch(guard);
 
-                // Queue notifications to be dispatched in the background
-                let stats = self.stats.clone();
+                // Queue notifications to be dispatched in the background, once the
+                // blocks are durable. With group commit that is after the next sync
                 let self_l = Arc::clone(self);
-                self.workers.post(Box::new(move || {
-                    stats.inc(StatType::Blockprocessor, DetailType::Notify);
-                    // Set results for futures when not holding the lock
-                    for (result, context) in processed.iter_mut() {
-                        if let Some(cb) = &context.callback {
-                            cb(*result);
+                write_guard.on_durable(Box::new(move || {
+                    let self_w = Arc::clone(&self_l);
+                    self_l.workers.post(Box::new(move || {
+                        self_w
+                            .stats
+                            .inc(StatType::Blockprocessor, DetailType::Notify);
+                        // Set results for futures when not holding the lock
+                        for (result, context) in processed.iter_mut() {
+                            if let Some(cb) = &context.callback {
+                                cb(*result);
+                            }
+                            context.set_result(*result);
                         }
-                        context.set_result(*result);
-                    }
-                    self_l.notify_batch_processed(&processed);
+                        self_w.notify_batch_processed(&processed);
+                    }));
                 }));
+                drop(write_guard);
+                guard = self.mutex.lock().unwrap();
             } else {
                 guard = self
                     .condition
@@ -553,6 +565,10 @@ impl BlockProcessorLoopImpl {
         }
         if added {
             self.condition.notify_all();
+            if self.stats.latency().is_enabled() {
+                let hash = context.block.lock().unwrap().hash();
+                self.stats.latency().record(&hash, LatencyStage::Queued);
+            }
         } else {
             self.stats
                 .inc(StatType::Blockprocessor, DetailType::Overfill);
@@ -578,13 +594,27 @@ impl BlockProcessorLoopImpl {
         results
     }
 
+    /// Returns the processed blocks and the write guard. The blocks are committed, but
+    /// the guard is still held, so that the caller can register for their durability
     fn process_batch(
         &self,
         mut guard: MutexGuard<BlockProcessorImpl>,
-    ) -> Vec<(BlockStatus, Arc<BlockProcessorContext>)> {
-        let batch = self.next_batch(&mut guard, self.config.batch_size);
+    ) -> (Vec<(BlockStatus, Arc<BlockProcessorContext>)>, WriteGuard) {
+        let mut batch = self.next_batch(&mut guard, self.config.batch_size);
         drop(guard);
 
+        // Verify signatures and validate the blocks speculatively on read transactions
+        // before taking the write lock. Only the insertion has to happen under the lock.
+        // Each chunk of the batch shares one read transaction.
+        let prevalidated = self.signature_checker.verify_with(
+            batch.make_contiguous(),
+            || self.ledger.read_txn(),
+            |txn, ctx| self.prevalidate(txn, ctx),
+        );
+
+        // Rolling back competitors changes the ledger in ways the speculation can't see
+        let has_forced = batch.iter().any(|ctx| ctx.source == BlockSource::Forced);
+
         let mut write_guard = self.ledger.write_queue.wait(Writer::BlockProcessor);
         let mut tx = self.ledger.rw_txn();
 
@@ -595,7 +625,7 @@ impl BlockProcessorLoopImpl {
         let mut number_of_forced_processed = 0;
 
         let mut processed = Vec::new();
-        for ctx in batch {
+        for (ctx, (verified_signer, prevalidated)) in batch.into_iter().zip(prevalidated) {
             let force = ctx.source == BlockSource::Forced;
 
             (write_guard, tx) = self.ledger.refresh_if_needed(write_guard, tx);
@@ -608,7 +638,11 @@ impl BlockProcessorLoopImpl {
 
             number_of_blocks_processed += 1;
 
-            let result = self.process_one(&mut tx, &ctx);
+            let prevalidated = match prevalidated {
+                Err(status) if has_forced || !Self::is_final_rejection(status) => None,
+                other => Some(other),
+            };
+            let result = self.process_one(&mut tx, &ctx, verified_signer, prevalidated);
             processed.push((result, ctx));
         }
 
@@ -620,19 +654,74 @@ impl BlockProcessorLoopImpl {
                 timer.elapsed().as_millis(),
             );
         }
-        processed
+        tx.commit();
+        (processed, write_guard)
     }
 
+    fn prevalidate(
+        &self,
+        txn: &LmdbReadTransaction,
+        context: &BlockProcessorContext,
+    ) -> (Option<PublicKey>, Result<PrevalidatedBlock, BlockStatus>) {
+        let block = context.block.lock().unwrap();
+        let verified_signer = self.ledger.verify_block_signer(&block);
+        let prevalidated = self.ledger.prevalidate(txn, &block, verified_signer);
+        (verified_signer, prevalidated)
+    }
+
+    /// Rejections that only depend on the block itself or on blocks that are already
+    /// in the ledger. Blocks of the same batch can't change them, unlike a missing
+    /// dependency (gap) or an account head that moves while the batch is inserted.
+    fn is_final_rejection(status: BlockStatus) -> bool {
+        matches!(
+            status,
+            BlockStatus::BadSignature
+                | BlockStatus::InsufficientWork
+                | BlockStatus::OpenedBurnAccount
+                | BlockStatus::Old
+        )
+    }
+
+    /// `prevalidated` is the result of the speculative validation. Blocks that were
+    /// rejected with a final status aren't validated again.
     pub fn process_one(
         &self,
         txn: &mut LmdbWriteTransaction,
         context: &BlockProcessorContext,
+        verified_signer: Option<PublicKey>,
+        prevalidated: Option<Result<PrevalidatedBlock, BlockStatus>>,
     ) -> BlockStatus {
         let mut block = context.block.lock().unwrap().clone();
         let hash = block.hash();
         let mut saved_block = None;
 
-        let result = match self.ledger.process(txn, &mut block) {
+        let process_result = match prevalidated {
+            Some(Err(status)) => {
+                self.stats
+                    .inc(StatType::Blockprocessor, DetailType::PrevalidationRejected);
+                Err(status)
+            }
+            Some(Ok(prevalidated)) => {
+                match self.ledger.insert_prevalidated(txn, &block, &prevalidated) {
+                    Some(saved) => {
+                        self.stats
+                            .inc(StatType::Blockprocessor, DetailType::Prevalidated);
+                        Ok(saved)
+                    }
+                    None => {
+                        self.stats
+                            .inc(StatType::Blockprocessor, DetailType::PrevalidationStale);
+                        self.ledger
+                            .process_verified(txn, &mut block, verified_signer)
+                    }
+                }
+            }
+            None => self
+                .ledger
+                .process_verified(txn, &mut block, verified_signer),
+        };
+
+        let result = match process_result {
             Ok(saved) => {
                 saved_block = Some(saved.clone());
                 *context.saved_block.lock().unwrap() = Some(saved);
@@ -650,6 +739,12 @@ impl BlockProcessorLoopImpl {
             .inc(StatType::BlockprocessorSource, context.source.into());
         trace!(?result, block = %block.hash(), source = ?context.source, "Block processed");
 
+        if result == BlockStatus::Progress {
+            self.stats.latency().record(&hash, LatencyStage::Processed);
+        } else {
+            self.stats.latency().discard(&hash);
+        }
+
         match result {
             BlockStatus::Progress => {
                 self.queue_unchecked(&hash.into());
@@ -833,7 +928,13 @@ mod tests {
         let ledger = Arc::new(Ledger::new_null());
         let unchecked = Arc::new(UncheckedMap::default());
         let stats = Arc::new(Stats::default());
-        let block_processor = BlockProcessor::new(config, ledger, unchecked, stats.clone());
+        let block_processor = BlockProcessor::new(
+            config,
+            ledger,
+            unchecked,
+            stats.clone(),
+            Arc::new(SignatureChecker::default()),
+        );
 
         let mut block = Block::new_test_instance();
         block.set_work(3);
@@ -851,4 +952,21 @@ mod tests {
 
         assert_eq!(block_processor.total_queue_len(), 0);
     }
+
+    #[test]
+    fn gaps_are_validated_again() {
+        // The missing dependency may be inserted by the same batch
+        assert!(!BlockProcessorLoopImpl::is_final_rejection(
+            BlockStatus::GapPrevious
+        ));
+        assert!(!BlockProcessorLoopImpl::is_final_rejection(
+            BlockStatus::GapSource
+        ));
+        assert!(!BlockProcessorLoopImpl::is_final_rejection(
+            BlockStatus::Fork
+        ));
+        assert!(BlockProcessorLoopImpl::is_final_rejection(
+            BlockStatus::BadSignature
+        ));
+    }
 }
@@ -2,6 +2,7 @@ mod backlog_population;
 mod block_processor;
 mod local_block_broadcaster;
 mod unchecked_map;
+mod unchecked_spill;
 
 pub use backlog_population::{BacklogPopulation, BacklogPopulationConfig};
 pub use block_processor::*;
@@ -1,13 +1,52 @@
+use super::unchecked_spill::UncheckedSpill;
 use crate::stats::{DetailType, StatType, Stats};
 use rsnano_core::{utils::ContainerInfo, BlockHash, HashOrAccount, UncheckedInfo, UncheckedKey};
 use std::{
-    cmp::Ordering,
+    cmp::{min, Ordering},
     collections::{BTreeMap, VecDeque},
     mem::size_of,
     ops::DerefMut,
+    path::PathBuf,
     sync::{Arc, Condvar, Mutex},
     thread::JoinHandle,
 };
+use tracing::warn;
+
+#[derive(Clone, Debug, PartialEq)]
+pub struct UncheckedMapConfig {
+    pub max_blocks: usize,
+    /// Maximum memory used by the in-memory entries in bytes. 0 means that only `max_blocks` applies
+    pub memory_budget: usize,
+    /// Entries that get evicted from memory are moved to this file instead of being dropped
+    pub spill_file: Option<PathBuf>,
+    /// Maximum size of the spill file in bytes
+    pub max_spill_size: usize,
+}
+
+impl Default for UncheckedMapConfig {
+    fn default() -> Self {
+        Self {
+            max_blocks: 65536,
+            memory_budget: 0,
+            spill_file: None,
+            max_spill_size: 0,
+        }
+    }
+}
+
+impl UncheckedMapConfig {
+    /// Number of entries that are kept in memory
+    pub fn memory_capacity(&self) -> usize {
+        if self.memory_budget == 0 {
+            self.max_blocks
+        } else {
+            min(
+                self.max_blocks,
+                (self.memory_budget / EntriesContainer::entry_size()).max(1),
+            )
+        }
+    }
+}
 
 pub struct UncheckedMap {
     join_handle: Mutex<Option<JoinHandle<()>>>,
@@ -15,11 +54,38 @@ pub struct UncheckedMap {
     mutable: Arc<Mutex<ThreadMutableData>>,
     condition: Arc<Condvar>,
     stats: Arc<Stats>,
-    max_unchecked_blocks: usize,
+    memory_capacity: usize,
+    /// Not guarded by `mutable`, so that the file I/O doesn't block the map
+    spill: Option<Arc<UncheckedSpill>>,
 }
 
 impl UncheckedMap {
     pub fn new(max_unchecked_blocks: usize, stats: Arc<Stats>, disable_delete: bool) -> Self {
+        let config = UncheckedMapConfig {
+            max_blocks: max_unchecked_blocks,
+            ..Default::default()
+        };
+        Self::with_config(config, stats, disable_delete)
+    }
+
+    pub fn with_config(
+        config: UncheckedMapConfig,
+        stats: Arc<Stats>,
+        disable_delete: bool,
+    ) -> Self {
+        let spill = match &config.spill_file {
+            Some(path) if config.max_spill_size > 0 => {
+                match UncheckedSpill::open(path, config.max_spill_size, stats.clone()) {
+                    Ok(spill) => Some(Arc::new(spill)),
+                    Err(e) => {
+                        warn!("Could not open unchecked spill file {:?}: {}", path, e);
+                        None
+                    }
+                }
+            }
+            _ => None,
+        };
+
         let mutable = Arc::new(Mutex::new(ThreadMutableData::new()));
         let condition = Arc::new(Condvar::new());
 
@@ -29,6 +95,7 @@ impl UncheckedMap {
             condition: condition.clone(),
             stats: stats.clone(),
             back_buffer: Mutex::new(VecDeque::new()),
+            spill: spill.clone(),
         });
 
         Self {
@@ -37,12 +104,16 @@ impl UncheckedMap {
             mutable,
             condition,
             stats,
-            max_unchecked_blocks,
+            memory_capacity: config.memory_capacity(),
+            spill,
         }
     }
 
     pub fn start(&self) {
         debug_assert!(self.join_handle.lock().unwrap().is_none());
+        if let Some(spill) = &self.spill {
+            spill.start();
+        }
         let thread_clone = Arc::clone(&self.thread);
         *self.join_handle.lock().unwrap() = Some(
             std::thread::Builder::new()
@@ -61,27 +132,53 @@ impl UncheckedMap {
         if let Some(handle) = handle {
             handle.join().unwrap();
         }
+        if let Some(spill) = &self.spill {
+            spill.stop();
+        }
     }
 
     pub fn exists(&self, key: &UncheckedKey) -> bool {
         let lock = self.mutable.lock().unwrap();
-        lock.entries_container.exists(key)
+        lock.entries_container.exists(key) || self.spill.as_ref().is_some_and(|s| s.exists(key))
     }
 
     pub fn put(&self, dependency: HashOrAccount, info: UncheckedInfo) {
         let mut lock = self.mutable.lock().unwrap();
         let key = UncheckedKey::new(dependency.into(), info.block.hash());
+        if self.spill.as_ref().is_some_and(|s| s.exists(&key)) {
+            return;
+        }
         let inserted = lock.entries_container.insert(Entry::new(key, info));
-        if lock.entries_container.len() > self.max_unchecked_blocks {
-            lock.entries_container.pop_front();
+        let evicted = if lock.entries_container.len() > self.memory_capacity {
+            lock.entries_container.pop_front()
+        } else {
+            None
+        };
+        drop(lock);
+        if let Some(evicted) = evicted {
+            self.spill_entry(evicted);
         }
         if inserted {
             self.stats.inc(StatType::Unchecked, DetailType::Put);
         }
     }
 
+    /// Queues an entry that was evicted from memory for the spill file.
+    /// Without a spill file the entry gets dropped.
+    fn spill_entry(&self, entry: Entry) {
+        let Some(spill) = &self.spill else {
+            return;
+        };
+        if spill.put(entry.key, entry.info) {
+            self.stats.inc(StatType::Unchecked, DetailType::Spilled);
+        } else {
+            self.stats
+                .inc(StatType::Unchecked, DetailType::SpillOverfill);
+        }
+    }
+
     pub fn get(&self, hash: &HashOrAccount) -> Vec<UncheckedInfo> {
-        let lock = self.mutable.lock().unwrap();
+        let mut lock = self.mutable.lock().unwrap();
         let mut result = Vec::new();
         lock.entries_container.for_each_with_dependency(
             hash,
@@ -90,12 +187,22 @@ impl UncheckedMap {
             },
             || true,
         );
+        drop(lock);
+        result.extend(
+            spilled_with_dependency(&self.spill, hash)
+                .into_iter()
+                .map(|(_, info)| info),
+        );
         result
     }
 
     pub fn clear(&self) {
-        let mut lock = self.mutable.lock().unwrap();
-        lock.entries_container.clear();
+        self.mutable.lock().unwrap().entries_container.clear();
+        if let Some(spill) = &self.spill {
+            if let Err(e) = spill.clear() {
+                warn!("Could not clear unchecked spill file: {}", e);
+            }
+        }
     }
 
     pub fn trigger(&self, dependency: &HashOrAccount) {
@@ -107,18 +214,24 @@ impl UncheckedMap {
     }
 
     pub fn remove(&self, key: &UncheckedKey) {
-        let mut lock = self.mutable.lock().unwrap();
-        lock.entries_container.remove(key);
+        let removed = self.mutable.lock().unwrap().entries_container.remove(key);
+        if removed.is_none() {
+            if let Some(spill) = &self.spill {
+                spill.remove(key);
+            }
+        }
     }
 
     pub fn len(&self) -> usize {
-        let lock = self.mutable.lock().unwrap();
-        lock.entries_container.len()
+        self.mutable.lock().unwrap().entries_container.len() + self.spilled_count()
     }
 
     pub fn is_empty(&self) -> bool {
-        let lock = self.mutable.lock().unwrap();
-        lock.entries_container.is_empty()
+        self.len() == 0
+    }
+
+    pub fn spilled_count(&self) -> usize {
+        self.spill.as_ref().map(|s| s.len()).unwrap_or_default()
     }
 
     pub fn entries_size() -> usize {
@@ -136,22 +249,55 @@ impl UncheckedMap {
 
     pub fn for_each(
         &self,
-        action: impl FnMut(&UncheckedKey, &UncheckedInfo),
-        predicate: impl FnMut() -> bool,
+        mut action: impl FnMut(&UncheckedKey, &UncheckedInfo),
+        mut predicate: impl FnMut() -> bool,
     ) {
-        let lock = self.mutable.lock().unwrap();
-        lock.entries_container.for_each(action, predicate)
+        let mut lock = self.mutable.lock().unwrap();
+        let mut stopped = false;
+        lock.entries_container.for_each(&mut action, || {
+            stopped = !predicate();
+            !stopped
+        });
+        drop(lock);
+        if stopped {
+            return;
+        }
+        let Some(spill) = &self.spill else {
+            return;
+        };
+        for key in spill.keys() {
+            if !predicate() {
+                break;
+            }
+            if let Some(info) = read_spilled(spill, &key) {
+                action(&key, &info);
+            }
+        }
     }
 
     pub fn for_each_with_dependency(
         &self,
         dependency: &HashOrAccount,
-        action: impl FnMut(&UncheckedKey, &UncheckedInfo),
-        predicate: impl FnMut() -> bool,
+        mut action: impl FnMut(&UncheckedKey, &UncheckedInfo),
+        mut predicate: impl FnMut() -> bool,
     ) {
-        let lock = self.mutable.lock().unwrap();
+        let mut lock = self.mutable.lock().unwrap();
+        let mut stopped = false;
         lock.entries_container
-            .for_each_with_dependency(dependency, action, predicate)
+            .for_each_with_dependency(dependency, &mut action, || {
+                stopped = !predicate();
+                !stopped
+            });
+        drop(lock);
+        if stopped {
+            return;
+        }
+        for (key, info) in spilled_with_dependency(&self.spill, dependency) {
+            if !predicate() {
+                break;
+            }
+            action(&key, &info);
+        }
     }
 
     pub fn set_satisfied_observer(&self, callback: Box<dyn Fn(&UncheckedInfo) + Send>) {
@@ -162,6 +308,11 @@ impl UncheckedMap {
         [
             ("entries", self.len(), Self::entries_size()),
             ("queries", self.buffer_count(), Self::buffer_entry_size()),
+            (
+                "spilled",
+                self.spilled_count(),
+                size_of::<UncheckedKey>() * 2,
+            ),
         ]
         .into()
     }
@@ -200,12 +351,37 @@ impl ThreadMutableData {
     }
 }
 
+fn spilled_with_dependency(
+    spill: &Option<Arc<UncheckedSpill>>,
+    dependency: &HashOrAccount,
+) -> Vec<(UncheckedKey, UncheckedInfo)> {
+    let Some(spill) = spill else {
+        return Vec::new();
+    };
+    spill
+        .keys_with_dependency(dependency)
+        .into_iter()
+        .filter_map(|key| read_spilled(spill, &key).map(|info| (key, info)))
+        .collect()
+}
+
+fn read_spilled(spill: &UncheckedSpill, key: &UncheckedKey) -> Option<UncheckedInfo> {
+    match spill.get(key) {
+        Ok(info) => info,
+        Err(e) => {
+            warn!("Could not read from unchecked spill file: {}", e);
+            None
+        }
+    }
+}
+
 pub struct UncheckedMapThread {
     disable_delete: bool,
     mutable: Arc<Mutex<ThreadMutableData>>,
     condition: Arc<Condvar>,
     stats: Arc<Stats>,
     back_buffer: Mutex<VecDeque<HashOrAccount>>,
+    spill: Option<Arc<UncheckedSpill>>,
 }
 
 impl UncheckedMapThread {
@@ -257,6 +433,28 @@ impl UncheckedMapThread {
                 lock.entries_container.remove(key);
             }
         }
+        drop(lock);
+
+        // Look in the spill file too. It is read without holding the lock of the map
+        let spilled = spilled_with_dependency(&self.spill, hash);
+        if spilled.is_empty() {
+            return;
+        }
+        let lock = self.mutable.lock().unwrap();
+        for (_, info) in &spilled {
+            self.stats.inc(StatType::Unchecked, DetailType::Satisfied);
+            if let Some(callback) = &lock.satisfied_callback {
+                callback(info);
+            }
+        }
+        drop(lock);
+        if !self.disable_delete {
+            if let Some(spill) = &self.spill {
+                for (key, _) in &spilled {
+                    spill.remove(key);
+                }
+            }
+        }
     }
 }
 
@@ -397,7 +595,7 @@ impl EntriesContainer {
 
 #[cfg(test)]
 mod tests {
-    use rsnano_core::Block;
+    use rsnano_core::{Block, TestBlockBuilder};
 
     use super::*;
 
@@ -499,6 +697,77 @@ mod tests {
         assert_eq!(container.exists(&entry.key), false);
     }
 
+    #[test]
+    fn memory_capacity_from_budget() {
+        let config = UncheckedMapConfig {
+            max_blocks: 1000,
+            memory_budget: EntriesContainer::entry_size() * 10,
+            ..Default::default()
+        };
+        assert_eq!(config.memory_capacity(), 10);
+
+        let unlimited = UncheckedMapConfig {
+            max_blocks: 1000,
+            ..Default::default()
+        };
+        assert_eq!(unlimited.memory_capacity(), 1000);
+    }
+
+    #[test]
+    fn spill_evicted_entries() {
+        let map = create_spilling_map();
+        let (dependency1, info1) = test_unchecked(1);
+        let (dependency2, info2) = test_unchecked(2);
+
+        map.put(dependency1, info1.clone());
+        map.put(dependency2, info2);
+
+        assert_eq!(map.len(), 2);
+        assert_eq!(map.spilled_count(), 1);
+        let key = UncheckedKey::new(dependency1.into(), info1.block.hash());
+        assert!(map.exists(&key));
+        let found = map.get(&dependency1);
+        assert_eq!(found.len(), 1);
+        assert_eq!(found[0].block, info1.block);
+    }
+
+    #[test]
+    fn trigger_finds_spilled_entries() {
+        let map = create_spilling_map();
+        let (dependency1, info1) = test_unchecked(1);
+        let (dependency2, info2) = test_unchecked(2);
+        map.put(dependency1, info1.clone());
+        map.put(dependency2, info2);
+        let satisfied = Arc::new(Mutex::new(Vec::new()));
+        let satisfied_clone = satisfied.clone();
+        map.set_satisfied_observer(Box::new(move |info| {
+            satisfied_clone.lock().unwrap().push(info.block.hash())
+        }));
+
+        map.thread.query_impl(&dependency1);
+
+        assert_eq!(*satisfied.lock().unwrap(), vec![info1.block.hash()]);
+        assert_eq!(map.spilled_count(), 0);
+        assert_eq!(map.len(), 1);
+    }
+
+    fn create_spilling_map() -> UncheckedMap {
+        let config = UncheckedMapConfig {
+            max_blocks: 1,
+            spill_file: Some(crate::unique_path().unwrap().join("unchecked.spill")),
+            max_spill_size: 1024 * 1024,
+            ..Default::default()
+        };
+        UncheckedMap::with_config(config, Arc::new(Stats::default()), false)
+    }
+
+    fn test_unchecked(previous: u64) -> (HashOrAccount, UncheckedInfo) {
+        let block = TestBlockBuilder::legacy_send()
+            .previous(BlockHash::from(previous))
+            .build();
+        (HashOrAccount::from(previous), UncheckedInfo::new(block))
+    }
+
     fn test_entry<T: Into<BlockHash>>(hash: T) -> Entry {
         Entry::new(
             UncheckedKey::new(hash.into(), BlockHash::default()),
@@ -0,0 +1,537 @@
+use crate::stats::{DetailType, StatType, Stats};
+use rsnano_core::{
+    utils::{BufferReader, Deserialize},
+    BlockHash, HashOrAccount, UncheckedInfo, UncheckedKey,
+};
+use std::{
+    collections::{BTreeMap, VecDeque},
+    fs::{self, File, OpenOptions},
+    io::{self, Read, Seek, SeekFrom, Write},
+    path::{Path, PathBuf},
+    sync::{Arc, Condvar, Mutex},
+    thread::JoinHandle,
+};
+use tracing::warn;
+
+/// Maximum number of evicted entries that wait for the spill thread
+const MAX_QUEUED: usize = 1024;
+
+/// Append-only segment file for unchecked blocks that were evicted from memory.
+/// Only the index (key -> location in the file) is kept in memory.
+/// Evicted entries are queued and written by the spill thread, so no file I/O happens
+/// while the unchecked map is locked. When the file is full, the oldest spilled entries
+/// get dropped. The garbage of removed entries is compacted into a new file which then
+/// replaces the old one.
+/// Unchecked blocks are transient, so the file is truncated when it gets opened.
+pub(crate) struct UncheckedSpill {
+    path: PathBuf,
+    max_size: u64,
+    stats: Arc<Stats>,
+    /// Lock order: `file` before `state`
+    file: Mutex<SpillFile>,
+    state: Mutex<SpillState>,
+    condition: Condvar,
+    join_handle: Mutex<Option<JoinHandle<()>>>,
+}
+
+struct SpillFile {
+    file: File,
+    len: u64,
+}
+
+#[derive(Default)]
+struct SpillState {
+    stopped: bool,
+    index: BTreeMap<UncheckedKey, Slot>,
+    /// Sequence number -> key. The oldest entry comes first
+    order: BTreeMap<u64, UncheckedKey>,
+    next_sequence: u64,
+    /// Entries that wait for the spill thread
+    queue: VecDeque<(u64, UncheckedKey)>,
+    /// Bytes of the written entries that weren't removed yet
+    live_bytes: u64,
+}
+
+struct Slot {
+    sequence: u64,
+    data: SlotData,
+}
+
+enum SlotData {
+    Queued(UncheckedInfo),
+    Written(Location),
+}
+
+#[derive(Clone, Copy)]
+struct Location {
+    offset: u64,
+    len: u32,
+}
+
+impl UncheckedSpill {
+    pub fn open(path: impl AsRef<Path>, max_size: usize, stats: Arc<Stats>) -> io::Result<Self> {
+        let path = path.as_ref().to_owned();
+        let file = open_truncated(&path)?;
+
+        Ok(Self {
+            path,
+            max_size: max_size as u64,
+            stats,
+            file: Mutex::new(SpillFile { file, len: 0 }),
+            state: Mutex::new(SpillState::default()),
+            condition: Condvar::new(),
+            join_handle: Mutex::new(None),
+        })
+    }
+
+    pub fn start(self: &Arc<Self>) {
+        debug_assert!(self.join_handle.lock().unwrap().is_none());
+        let self_l = Arc::clone(self);
+        *self.join_handle.lock().unwrap() = Some(
+            std::thread::Builder::new()
+                .name("Unchecked spill".to_string())
+                .spawn(move || self_l.run())
+                .unwrap(),
+        );
+    }
+
+    pub fn stop(&self) {
+        self.state.lock().unwrap().stopped = true;
+        self.condition.notify_all();
+        let handle = self.join_handle.lock().unwrap().take();
+        if let Some(handle) = handle {
+            handle.join().unwrap();
+        }
+    }
+
+    /// Queues the entry for the spill thread.
+    /// Returns false if the entry already exists or if too many entries are queued
+    pub fn put(&self, key: UncheckedKey, info: UncheckedInfo) -> bool {
+        let mut state = self.state.lock().unwrap();
+        if state.index.contains_key(&key) || state.queue.len() >= MAX_QUEUED {
+            return false;
+        }
+        let sequence = state.next_sequence;
+        state.next_sequence += 1;
+        state.order.insert(sequence, key.clone());
+        state.queue.push_back((sequence, key.clone()));
+        state.index.insert(
+            key,
+            Slot {
+                sequence,
+                data: SlotData::Queued(info),
+            },
+        );
+        drop(state);
+        self.condition.notify_all();
+        true
+    }
+
+    /// Writes all queued entries to the file
+    pub fn flush(&self) -> io::Result<()> {
+        let mut file = self.file.lock().unwrap();
+        let batch: Vec<_> = {
+            let mut guard = self.state.lock().unwrap();
+            let state = &mut *guard;
+            state
+                .queue
+                .drain(..)
+                .filter_map(|(sequence, key)| match state.index.get(&key) {
+                    Some(Slot {
+                        sequence: s,
+                        data: SlotData::Queued(info),
+                    }) if *s == sequence => Some((sequence, key, info.to_bytes())),
+                    _ => None,
+                })
+                .collect()
+        };
+
+        let mut batch = batch.into_iter();
+        while let Some((sequence, key, bytes)) = batch.next() {
+            if let Err(e) = self.write_entry(&mut file, sequence, &key, &bytes) {
+                // The entries which couldn't be written are lost
+                let mut state = self.state.lock().unwrap();
+                state.discard(&key);
+                for (_, key, _) in batch {
+                    state.discard(&key);
+                }
+                return Err(e);
+            }
+        }
+        Ok(())
+    }
+
+    pub fn get(&self, key: &UncheckedKey) -> io::Result<Option<UncheckedInfo>> {
+        let mut file = self.file.lock().unwrap();
+        let location = match self.state.lock().unwrap().index.get(key) {
+            None => return Ok(None),
+            Some(Slot {
+                data: SlotData::Queued(info),
+                ..
+            }) => return Ok(Some(info.clone())),
+            Some(Slot {
+                data: SlotData::Written(location),
+                ..
+            }) => *location,
+        };
+        let bytes = file.read(location)?;
+        UncheckedInfo::deserialize(&mut BufferReader::new(&bytes))
+            .map(Some)
+            .map_err(|e| io::Error::new(io::ErrorKind::InvalidData, e))
+    }
+
+    /// All keys of the entries that wait for the given dependency
+    pub fn keys_with_dependency(&self, dependency: &HashOrAccount) -> Vec<UncheckedKey> {
+        let previous: BlockHash = dependency.into();
+        let start = UncheckedKey::new(previous, BlockHash::zero());
+        self.state
+            .lock()
+            .unwrap()
+            .index
+            .range(start..)
+            .take_while(|(key, _)| key.previous == previous)
+            .map(|(key, _)| key.clone())
+            .collect()
+    }
+
+    pub fn keys(&self) -> Vec<UncheckedKey> {
+        self.state.lock().unwrap().index.keys().cloned().collect()
+    }
+
+    pub fn remove(&self, key: &UncheckedKey) -> bool {
+        self.state.lock().unwrap().discard(key)
+    }
+
+    pub fn exists(&self, key: &UncheckedKey) -> bool {
+        self.state.lock().unwrap().index.contains_key(key)
+    }
+
+    pub fn len(&self) -> usize {
+        self.state.lock().unwrap().index.len()
+    }
+
+    pub fn clear(&self) -> io::Result<()> {
+        let mut file = self.file.lock().unwrap();
+        {
+            let mut state = self.state.lock().unwrap();
+            state.index.clear();
+            state.order.clear();
+            state.queue.clear();
+            state.live_bytes = 0;
+        }
+        file.file.set_len(0)?;
+        file.len = 0;
+        Ok(())
+    }
+
+    fn run(&self) {
+        let mut state = self.state.lock().unwrap();
+        while !state.stopped {
+            if state.queue.is_empty() {
+                state = self.condition.wait(state).unwrap();
+            } else {
+                drop(state);
+                if let Err(e) = self.flush() {
+                    warn!("Could not write to unchecked spill file: {}", e);
+                }
+                state = self.state.lock().unwrap();
+            }
+        }
+    }
+
+    fn write_entry(
+        &self,
+        file: &mut SpillFile,
+        sequence: u64,
+        key: &UncheckedKey,
+        bytes: &[u8],
+    ) -> io::Result<()> {
+        let len = bytes.len() as u64;
+        {
+            let mut state = self.state.lock().unwrap();
+            if !state.is_queued(key, sequence) {
+                return Ok(());
+            }
+            if len > self.max_size {
+                state.discard(key);
+                self.stats
+                    .inc(StatType::Unchecked, DetailType::SpillOverfill);
+                return Ok(());
+            }
+            // Newer entries are more likely to get their dependency soon
+            while state.live_bytes + len > self.max_size {
+                if !state.discard_oldest(sequence) {
+                    break;
+                }
+                self.stats
+                    .inc(StatType::Unchecked, DetailType::SpillOverfill);
+            }
+        }
+
+        if file.len + len > self.max_size {
+            self.compact(file)?;
+        }
+
+        file.file.seek(SeekFrom::Start(file.len))?;
+        file.file.write_all(bytes)?;
+        let location = Location {
+            offset: file.len,
+            len: bytes.len() as u32,
+        };
+        file.len += len;
+
+        let mut guard = self.state.lock().unwrap();
+        let state = &mut *guard;
+        if let Some(slot) = state.index.get_mut(key) {
+            if slot.sequence == sequence {
+                slot.data = SlotData::Written(location);
+                state.live_bytes += len;
+            }
+        }
+        Ok(())
+    }
+
+    /// Copies all live entries into a new file which then replaces the current one.
+    /// The current file stays intact until the new one is complete
+    fn compact(&self, file: &mut SpillFile) -> io::Result<()> {
+        let mut written: Vec<_> = self
+            .state
+            .lock()
+            .unwrap()
+            .index
+            .iter()
+            .filter_map(|(key, slot)| match slot.data {
+                SlotData::Written(location) => Some((key.clone(), slot.sequence, location)),
+                SlotData::Queued(_) => None,
+            })
+            .collect();
+        written.sort_unstable_by_key(|(_, _, location)| location.offset);
+
+        let compact_path = self.path.with_extension("compact");
+        let mut compacted = open_truncated(&compact_path)?;
+        let mut compacted_len = 0;
+        for (_, _, location) in &mut written {
+            let bytes = file.read(*location)?;
+            compacted.write_all(&bytes)?;
+            location.offset = compacted_len;
+            compacted_len += location.len as u64;
+        }
+        fs::rename(&compact_path, &self.path)?;
+        file.file = compacted;
+        file.len = compacted_len;
+
+        let mut guard = self.state.lock().unwrap();
+        let state = &mut *guard;
+        state.live_bytes = 0;
+        for (key, sequence, location) in written {
+            if let Some(slot) = state.index.get_mut(&key) {
+                if slot.sequence == sequence {
+                    slot.data = SlotData::Written(location);
+                    state.live_bytes += location.len as u64;
+                }
+            }
+        }
+        Ok(())
+    }
+}
+
+impl SpillFile {
+    fn read(&mut self, location: Location) -> io::Result<Vec<u8>> {
+        let mut bytes = vec![0; location.len as usize];
+        self.file.seek(SeekFrom::Start(location.offset))?;
+        self.file.read_exact(&mut bytes)?;
+        Ok(bytes)
+    }
+}
+
+impl SpillState {
+    fn is_queued(&self, key: &UncheckedKey, sequence: u64) -> bool {
+        matches!(
+            self.index.get(key),
+            Some(Slot { sequence: s, data: SlotData::Queued(_) }) if *s == sequence
+        )
+    }
+
+    fn discard(&mut self, key: &UncheckedKey) -> bool {
+        let Some(slot) = self.index.remove(key) else {
+            return false;
+        };
+        self.order.remove(&slot.sequence);
+        if let SlotData::Written(location) = slot.data {
+            self.live_bytes -= location.len as u64;
+        }
+        true
+    }
+
+    /// Discards the oldest entry, except the one with the given sequence number
+    fn discard_oldest(&mut self, except: u64) -> bool {
+        let Some(key) = self
+            .order
+            .iter()
+            .find(|(sequence, _)| **sequence != except)
+            .map(|(_, key)| key.clone())
+        else {
+            return false;
+        };
+        self.discard(&key)
+    }
+}
+
+fn open_truncated(path: &Path) -> io::Result<File> {
+    OpenOptions::new()
+        .read(true)
+        .write(true)
+        .create(true)
+        .truncate(true)
+        .open(path)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{stats::Direction, unique_path};
+    use rsnano_core::{Block, TestBlockBuilder};
+    use std::time::{Duration, Instant};
+
+    #[test]
+    fn put_and_get() {
+        let spill = open_spill(1024 * 1024);
+        let (key, info) = test_entry(1);
+
+        assert!(spill.put(key.clone(), info.clone()));
+
+        assert_eq!(spill.len(), 1);
+        assert!(spill.exists(&key));
+        assert_eq!(spill.get(&key).unwrap().unwrap().block, info.block);
+        spill.flush().unwrap();
+        assert_eq!(spill.get(&key).unwrap().unwrap().block, info.block);
+    }
+
+    #[test]
+    fn put_same_key_twice() {
+        let spill = open_spill(1024 * 1024);
+        let (key, info) = test_entry(1);
+        assert!(spill.put(key.clone(), info.clone()));
+        assert!(!spill.put(key, info));
+        assert_eq!(spill.len(), 1);
+    }
+
+    #[test]
+    fn find_by_dependency() {
+        let spill = open_spill(1024 * 1024);
+        let (key1, info1) = test_entry(1);
+        let (key2, info2) = test_entry(2);
+        spill.put(key1.clone(), info1);
+        spill.put(key2, info2);
+
+        assert_eq!(
+            spill.keys_with_dependency(&key1.previous.into()),
+            vec![key1]
+        );
+        assert!(spill
+            .keys_with_dependency(&HashOrAccount::from(3))
+            .is_empty());
+    }
+
+    #[test]
+    fn drop_oldest_when_full() {
+        let (key1, info1) = test_entry(1);
+        let (key2, info2) = test_entry(2);
+        let spill = open_spill(info1.to_bytes().len());
+        spill.put(key1.clone(), info1);
+        spill.flush().unwrap();
+
+        spill.put(key2.clone(), info2.clone());
+        spill.flush().unwrap();
+
+        assert_eq!(spill.len(), 1);
+        assert!(!spill.exists(&key1));
+        assert_eq!(spill.get(&key2).unwrap().unwrap().block, info2.block);
+        assert_eq!(
+            spill.stats.count(
+                StatType::Unchecked,
+                DetailType::SpillOverfill,
+                Direction::In
+            ),
+            1
+        );
+    }
+
+    #[test]
+    fn compact_into_new_file_when_full() {
+        let (key1, info1) = test_entry(1);
+        let (key2, info2) = test_entry(2);
+        let (key3, info3) = test_entry(3);
+        let entry_len = info1.to_bytes().len();
+        let spill = open_spill(entry_len * 2);
+        spill.put(key1.clone(), info1);
+        spill.put(key2.clone(), info2.clone());
+        spill.flush().unwrap();
+        spill.remove(&key1);
+
+        spill.put(key3.clone(), info3.clone());
+        spill.flush().unwrap();
+
+        assert_eq!(spill.file.lock().unwrap().len, entry_len as u64 * 2);
+        assert_eq!(
+            fs::metadata(&spill.path).unwrap().len(),
+            entry_len as u64 * 2
+        );
+        assert!(!spill.path.with_extension("compact").exists());
+        assert_eq!(spill.get(&key2).unwrap().unwrap().block, info2.block);
+        assert_eq!(spill.get(&key3).unwrap().unwrap().block, info3.block);
+        assert_eq!(spill.get(&key1).unwrap().is_none(), true);
+    }
+
+    #[test]
+    fn spill_thread_writes_queued_entries() {
+        let spill = Arc::new(open_spill(1024 * 1024));
+        let (key, info) = test_entry(1);
+        spill.start();
+
+        spill.put(key.clone(), info.clone());
+
+        let start = Instant::now();
+        while !matches!(
+            spill.state.lock().unwrap().index.get(&key),
+            Some(Slot {
+                data: SlotData::Written(_),
+                ..
+            })
+        ) {
+            assert!(
+                start.elapsed() < Duration::from_secs(5),
+                "entry not written"
+            );
+            std::thread::yield_now();
+        }
+        spill.stop();
+        assert_eq!(spill.get(&key).unwrap().unwrap().block, info.block);
+    }
+
+    #[test]
+    fn clear() {
+        let spill = open_spill(1024 * 1024);
+        let (key, info) = test_entry(1);
+        spill.put(key, info);
+        spill.flush().unwrap();
+
+        spill.clear().unwrap();
+
+        assert_eq!(spill.len(), 0);
+        assert_eq!(spill.file.lock().unwrap().len, 0);
+    }
+
+    fn open_spill(max_size: usize) -> UncheckedSpill {
+        let path = unique_path().unwrap().join("unchecked.spill");
+        UncheckedSpill::open(path, max_size, Arc::new(Stats::default())).unwrap()
+    }
+
+    fn test_entry(previous: u64) -> (UncheckedKey, UncheckedInfo) {
+        let block: Block = TestBlockBuilder::legacy_send()
+            .previous(BlockHash::from(previous))
+            .build();
+        let key = UncheckedKey::new(BlockHash::from(previous), block.hash());
+        (key, UncheckedInfo::new(block))
+    }
+}
@@ -0,0 +1,66 @@
+use crate::utils::{CancellationToken, Runnable};
+use rsnano_ledger::{Ledger, Writer};
+use std::sync::Arc;
+use tracing::{debug, info};
+
+/// Re-encodes the blocks that were written in the encoding before store version 25.
+/// The blocks are migrated in small batches, so that the block processor isn't blocked
+/// for long. The position of the migration is persisted, so that it resumes after a restart
+pub(crate) struct BlockTableMigration {
+    ledger: Arc<Ledger>,
+    batch_size: usize,
+    finished: bool,
+}
+
+impl BlockTableMigration {
+    pub(crate) const DEFAULT_BATCH_SIZE: usize = 1024;
+
+    pub(crate) fn new(ledger: Arc<Ledger>, batch_size: usize) -> Self {
+        Self {
+            ledger,
+            batch_size,
+            finished: false,
+        }
+    }
+
+    /// Returns true if there are still entries left to migrate
+    fn migrate_batch(&mut self) -> bool {
+        let _guard = self.ledger.write_queue.wait(Writer::BlockTableMigration);
+        let mut tx = self.ledger.rw_txn();
+        let store = &self.ledger.store;
+
+        let Some(start) = store.version.get_block_migration_cursor(&tx) else {
+            return false;
+        };
+
+        let (migrated, next) = store
+            .block
+            .reencode_legacy_entries(&mut tx, start, self.batch_size);
+
+        let more = match next {
+            Some(next) => {
+                store.version.put_block_migration_cursor(&mut tx, &next);
+                true
+            }
+            None => {
+                store.version.del_block_migration_cursor(&mut tx);
+                info!("Block table migration finished");
+                false
+            }
+        };
+        tx.commit();
+
+        if migrated > 0 {
+            debug!("Re-encoded {} blocks", migrated);
+        }
+        more
+    }
+}
+
+impl Runnable for BlockTableMigration {
+    fn run(&mut self, _cancel_token: &CancellationToken) {
+        if !self.finished {
+            self.finished = !self.migrate_batch();
+        }
+    }
+}
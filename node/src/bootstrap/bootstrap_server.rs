@@ -1,8 +1,9 @@
+use super::chain_cache::ChainCache;
 use crate::{
     stats::{DetailType, Direction, StatType, Stats},
     transport::{FairQueue, MessagePublisher},
 };
-use rsnano_core::{Block, BlockHash, Frontier};
+use rsnano_core::{Account, AccountInfo, Block, BlockHash, Frontier, HashOrAccount};
 use rsnano_ledger::Ledger;
 use rsnano_messages::{
     AccountInfoAckPayload, AccountInfoReqPayload, AscPullAck, AscPullAckType, AscPullReq,
@@ -25,6 +26,8 @@ pub struct BootstrapServerConfig {
     pub max_queue: usize,
     pub threads: usize,
     pub batch_size: usize,
+    /// Number of recently served block chains that are kept in memory. 0 disables the cache
+    pub chain_cache_size: usize,
 }
 
 impl Default for BootstrapServerConfig {
@@ -33,6 +36,7 @@ impl Default for BootstrapServerConfig {
             max_queue: 16,
             threads: 1,
             batch_size: 64,
+            chain_cache_size: 256,
         }
     }
 }
@@ -63,6 +67,7 @@ impl BootstrapServer {
             stats: Arc::clone(&stats),
             ledger,
             batch_size: config.batch_size,
+            chain_cache: Mutex::new(ChainCache::new(config.chain_cache_size)),
             on_response: Arc::new(Mutex::new(None)),
             condition: Condvar::new(),
             stopped: AtomicBool::new(false),
@@ -174,6 +179,7 @@ pub(crate) struct BootstrapServerImpl {
     condition: Condvar,
     queue: Mutex<FairQueue<ChannelId, (AscPullReq, Arc<ChannelInfo>)>>,
     batch_size: usize,
+    chain_cache: Mutex<ChainCache>,
     message_publisher: Mutex<MessagePublisher>,
 }
 
@@ -202,33 +208,52 @@ impl BootstrapServerImpl {
         let batch = queue.next_batch(self.batch_size);
         drop(queue);
 
-        let mut tx = self.ledger.read_txn();
+        let mut lookups = Vec::with_capacity(batch.len());
+        let mut frontier_requests = Vec::new();
         for (_, (request, channel)) in batch {
-            tx.refresh_if_needed();
-
-            if !channel.is_queue_full(TrafficType::Bootstrap) {
-                let response = self.process(&tx, request);
-                self.respond(response, channel.channel_id());
-            } else {
+            if channel.is_queue_full(TrafficType::Bootstrap) {
                 self.stats.inc_dir(
                     StatType::BootstrapServer,
                     DetailType::ChannelFull,
                     Direction::Out,
                 );
+                continue;
+            }
+
+            match request.req_type {
+                AscPullReqType::Frontiers(payload) => {
+                    frontier_requests.push((request.id, payload, channel.channel_id()))
+                }
+                req_type => lookups.push((request.id, req_type, channel.channel_id())),
             }
         }
 
-        self.queue.lock().unwrap()
-    }
+        // Serve the requests in key order, so that the reads of a batch
+        // sweep over the tables instead of jumping around
+        lookups.sort_by_key(|(_, req_type, _)| lookup_key(req_type));
+        frontier_requests.sort_by_key(|(_, payload, _)| payload.start);
+
+        let mut tx = self.ledger.read_txn();
+        for (id, req_type, channel_id) in lookups {
+            tx.refresh_if_needed();
+            let response = match req_type {
+                AscPullReqType::Blocks(blocks) => self.process_blocks(&tx, id, blocks),
+                AscPullReqType::AccountInfo(account) => self.process_account(&tx, id, account),
+                AscPullReqType::Frontiers(_) => unreachable!(),
+            };
+            self.respond(response, channel_id);
+        }
 
-    fn process(&self, tx: &LmdbReadTransaction, message: AscPullReq) -> AscPullAck {
-        match message.req_type {
-            AscPullReqType::Blocks(blocks) => self.process_blocks(tx, message.id, blocks),
-            AscPullReqType::AccountInfo(account) => self.process_account(tx, message.id, account),
-            AscPullReqType::Frontiers(frontiers) => {
-                self.process_frontiers(tx, message.id, frontiers)
+        if !frontier_requests.is_empty() {
+            tx.refresh_if_needed();
+            let mut sweep = FrontierSweep::new(&self.ledger, &tx);
+            for (id, request, channel_id) in frontier_requests {
+                let response = self.process_frontiers(&mut sweep, id, request);
+                self.respond(response, channel_id);
             }
         }
+
+        self.queue.lock().unwrap()
     }
 
     fn process_blocks(
@@ -306,17 +331,11 @@ impl BootstrapServerImpl {
      */
     fn process_frontiers(
         &self,
-        tx: &LmdbReadTransaction,
+        sweep: &mut FrontierSweep,
         id: u64,
         request: FrontiersReqPayload,
     ) -> AscPullAck {
-        let frontiers = self
-            .ledger
-            .any()
-            .accounts_range(tx, request.start..)
-            .map(|(account, info)| Frontier::new(account, info.head))
-            .take(request.count as usize)
-            .collect();
+        let frontiers = sweep.frontiers(request.start, request.count as usize);
 
         AscPullAck {
             id,
@@ -354,21 +373,63 @@ impl BootstrapServerImpl {
         count: usize,
     ) -> VecDeque<Block> {
         let mut result = VecDeque::new();
-        if !start_block.is_zero() {
-            let mut current = self.ledger.any().get_block(tx, &start_block);
-            while let Some(c) = current.take() {
-                let successor = c.successor().unwrap_or_default();
-                result.push_back(c.into());
-
-                if result.len() == count {
-                    break;
-                }
-                current = self.ledger.any().get_block(tx, &successor);
+        if start_block.is_zero() {
+            return result;
+        }
+
+        if let Some(blocks) = self.cached_chain(tx, &start_block, count) {
+            return blocks;
+        }
+
+        let mut current = self.ledger.any().get_block(tx, &start_block);
+        while let Some(c) = current.take() {
+            let successor = c.successor().unwrap_or_default();
+            result.push_back(c.into());
+
+            if result.len() == count {
+                break;
+            }
+            current = self.ledger.any().get_block(tx, &successor);
+        }
+
+        if result.len() == count {
+            let mut cache = self.chain_cache.lock().unwrap();
+            if !cache.is_disabled() {
+                cache.insert(start_block, count, Arc::new(result.clone()));
             }
         }
         result
     }
 
+    fn cached_chain(
+        &self,
+        tx: &LmdbReadTransaction,
+        start_block: &BlockHash,
+        count: usize,
+    ) -> Option<VecDeque<Block>> {
+        let mut cache = self.chain_cache.lock().unwrap();
+        if cache.is_disabled() {
+            return None;
+        }
+
+        if let Some(blocks) = cache.get(start_block, count) {
+            // The chain is unchanged as long as its last block wasn't rolled back
+            let valid = blocks
+                .back()
+                .map(|last| self.ledger.any().block_exists(tx, &last.hash()))
+                .unwrap_or_default();
+            if valid {
+                drop(cache);
+                self.stats.inc(StatType::BootstrapServer, DetailType::Hit);
+                return Some((*blocks).clone());
+            }
+            cache.remove(start_block, count);
+        }
+        drop(cache);
+        self.stats.inc(StatType::BootstrapServer, DetailType::Miss);
+        None
+    }
+
     fn respond(&self, response: AscPullAck, channel_id: ChannelId) {
         self.stats.inc_dir(
             StatType::BootstrapServer,
@@ -418,6 +479,84 @@ impl BootstrapServerImpl {
     }
 }
 
+/// Sort key for the lookups of account info and block requests
+fn lookup_key(req_type: &AscPullReqType) -> (u8, u8, HashOrAccount) {
+    match req_type {
+        AscPullReqType::Blocks(i) => (0, i.start_type as u8, i.start),
+        AscPullReqType::AccountInfo(i) => (1, i.target_type as u8, i.target),
+        AscPullReqType::Frontiers(i) => (2, HashType::Account as u8, i.start.into()),
+    }
+}
+
+/// Serves the frontier requests of a batch with a single cursor over the account table.
+/// The requests have to be sorted by start account. The frontiers that were read already
+/// are buffered, so that overlapping requests don't read them again.
+struct FrontierSweep<'a> {
+    ledger: &'a Ledger,
+    tx: &'a LmdbReadTransaction,
+    it: Option<Box<dyn Iterator<Item = (Account, AccountInfo)> + 'a>>,
+    /// Contiguous run of the account table, which continues with the items of `it`
+    buffer: VecDeque<Frontier>,
+    end_reached: bool,
+}
+
+impl<'a> FrontierSweep<'a> {
+    const SEQUENTIAL_ATTEMPTS: usize = 10;
+
+    fn new(ledger: &'a Ledger, tx: &'a LmdbReadTransaction) -> Self {
+        Self {
+            ledger,
+            tx,
+            it: None,
+            buffer: VecDeque::new(),
+            end_reached: false,
+        }
+    }
+
+    fn frontiers(&mut self, start: Account, count: usize) -> Vec<Frontier> {
+        // Requests are sorted, so frontiers before `start` are not needed anymore
+        while self.buffer.front().is_some_and(|f| f.account < start) {
+            self.buffer.pop_front();
+        }
+
+        if self.buffer.is_empty() && !self.end_reached {
+            self.advance_to(start);
+        }
+
+        while self.buffer.len() < count && !self.end_reached {
+            match self.it.as_mut().and_then(|it| it.next()) {
+                Some((account, info)) => self.buffer.push_back(Frontier::new(account, info.head)),
+                None => self.end_reached = true,
+            }
+        }
+
+        self.buffer.iter().take(count).cloned().collect()
+    }
+
+    fn advance_to(&mut self, start: Account) {
+        if let Some(it) = &mut self.it {
+            // First try advancing sequentially
+            for _ in 0..Self::SEQUENTIAL_ATTEMPTS {
+                match it.next() {
+                    Some((account, info)) => {
+                        if account >= start {
+                            self.buffer.push_back(Frontier::new(account, info.head));
+                            return;
+                        }
+                    }
+                    None => {
+                        self.end_reached = true;
+                        return;
+                    }
+                }
+            }
+        }
+
+        // If that fails, perform a fresh lookup
+        self.it = Some(Box::new(self.ledger.any().accounts_range(self.tx, start..)));
+    }
+}
+
 impl From<&AscPullAckType> for DetailType {
     fn from(value: &AscPullAckType) -> Self {
         match value {
@@ -0,0 +1,91 @@
+use rsnano_core::{utils::ClockCache, Block, BlockHash};
+use std::{collections::VecDeque, sync::Arc};
+
+/// Recently served block chains of the bootstrap server, keyed by start block and count.
+/// Only complete chains (as many blocks as requested) are cached, so that a new block
+/// at the end of the account doesn't make an entry stale. A chain is still valid as long
+/// as its last block exists, because a rollback removes blocks from the head downwards.
+pub(crate) struct ChainCache {
+    entries: ClockCache<(BlockHash, usize), Arc<VecDeque<Block>>>,
+}
+
+impl ChainCache {
+    pub fn new(capacity: usize) -> Self {
+        Self {
+            entries: ClockCache::new(capacity),
+        }
+    }
+
+    pub fn get(&mut self, start: &BlockHash, count: usize) -> Option<Arc<VecDeque<Block>>> {
+        self.entries.get(&(*start, count)).cloned()
+    }
+
+    pub fn insert(&mut self, start: BlockHash, count: usize, blocks: Arc<VecDeque<Block>>) {
+        if blocks.len() == count {
+            self.entries.insert((start, count), blocks);
+        }
+    }
+
+    pub fn remove(&mut self, start: &BlockHash, count: usize) {
+        self.entries.remove(&(*start, count));
+    }
+
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    pub fn is_disabled(&self) -> bool {
+        self.entries.capacity() == 0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn empty() {
+        let mut cache = ChainCache::new(10);
+        assert!(cache.get(&BlockHash::from(1), 1).is_none());
+        assert_eq!(cache.len(), 0);
+    }
+
+    #[test]
+    fn cache_complete_chains_only() {
+        let mut cache = ChainCache::new(10);
+        let blocks = Arc::new(VecDeque::from([Block::new_test_instance()]));
+
+        cache.insert(BlockHash::from(1), 1, blocks.clone());
+        cache.insert(BlockHash::from(2), 5, blocks);
+
+        assert!(cache.get(&BlockHash::from(1), 1).is_some());
+        assert!(cache.get(&BlockHash::from(1), 2).is_none());
+        assert!(cache.get(&BlockHash::from(2), 5).is_none());
+    }
+
+    #[test]
+    fn evict_chains_that_were_not_hit() {
+        let mut cache = ChainCache::new(2);
+        let blocks = Arc::new(VecDeque::from([Block::new_test_instance()]));
+        cache.insert(BlockHash::from(1), 1, blocks.clone());
+        cache.insert(BlockHash::from(2), 1, blocks.clone());
+        cache.get(&BlockHash::from(1), 1);
+
+        cache.insert(BlockHash::from(3), 1, blocks);
+
+        assert_eq!(cache.len(), 2);
+        assert!(cache.get(&BlockHash::from(1), 1).is_some());
+        assert!(cache.get(&BlockHash::from(2), 1).is_none());
+        assert!(cache.get(&BlockHash::from(3), 1).is_some());
+    }
+
+    #[test]
+    fn disabled() {
+        let mut cache = ChainCache::new(0);
+        let blocks = Arc::new(VecDeque::from([Block::new_test_instance()]));
+
+        cache.insert(BlockHash::from(1), 1, blocks);
+
+        assert_eq!(cache.len(), 0);
+    }
+}
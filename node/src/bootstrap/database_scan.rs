@@ -6,18 +6,44 @@ use std::{collections::VecDeque, sync::Arc};
 
 const BATCH_SIZE: usize = 512;
 
+/// Scans the account and pending tables for accounts to bootstrap.
+/// The account number space is divided into consecutive ranges, which are scanned
+/// independently. Each fill takes a batch from every range and interleaves them,
+/// so that the requests that are in flight at the same time cover the whole ledger
+/// instead of a single spot of the key space.
 pub(crate) struct DatabaseScan {
     queue: VecDeque<Account>,
+    ranges: Vec<ScanRange>,
+    ledger: Arc<Ledger>,
+}
+
+struct ScanRange {
     account_scanner: AccountDatabaseScanner,
     pending_scanner: PendingDatabaseScanner,
-    ledger: Arc<Ledger>,
 }
 
 impl DatabaseScan {
-    pub fn new(ledger: Arc<Ledger>) -> Self {
+    pub fn new(ledger: Arc<Ledger>, range_count: usize) -> Self {
+        let range_count = range_count.max(1);
+        let range_size = Account::MAX.number() / range_count;
+        let ranges = (0..range_count)
+            .map(|i| {
+                let start = Account::from(range_size * i);
+                // The last range is open ended
+                let end = if i == range_count - 1 {
+                    None
+                } else {
+                    Some(Account::from(range_size * (i + 1)))
+                };
+                ScanRange {
+                    account_scanner: AccountDatabaseScanner::new(ledger.clone(), start, end),
+                    pending_scanner: PendingDatabaseScanner::new(ledger.clone(), start, end),
+                }
+            })
+            .collect();
+
         Self {
-            account_scanner: AccountDatabaseScanner::new(ledger.clone()),
-            pending_scanner: PendingDatabaseScanner::new(ledger.clone()),
+            ranges,
             ledger,
             queue: Default::default(),
         }
@@ -39,36 +65,85 @@ impl DatabaseScan {
 
     fn fill(&mut self) {
         let tx = self.ledger.read_txn();
-        let set1 = self.account_scanner.next_batch(&tx, BATCH_SIZE);
-        let set2 = self.pending_scanner.next_batch(&tx, BATCH_SIZE);
-        self.queue.extend(set1);
-        self.queue.extend(set2);
+        let batch_size = (BATCH_SIZE / self.ranges.len()).max(1);
+        let mut batches: Vec<_> = self
+            .ranges
+            .iter_mut()
+            .map(|range| {
+                let mut batch = range.account_scanner.next_batch(&tx, batch_size);
+                batch.extend(range.pending_scanner.next_batch(&tx, batch_size));
+                batch.into_iter()
+            })
+            .collect();
+
+        // Interleave the ranges
+        loop {
+            let mut added = false;
+            for batch in &mut batches {
+                if let Some(account) = batch.next() {
+                    self.queue.push_back(account);
+                    added = true;
+                }
+            }
+            if !added {
+                break;
+            }
+        }
     }
 
+    /// True if every range was scanned completely at least once
     pub fn warmed_up(&self) -> bool {
-        self.account_scanner.completed > 0 && self.pending_scanner.completed > 0
+        self.ranges
+            .iter()
+            .all(|range| range.account_scanner.completed > 0 && range.pending_scanner.completed > 0)
     }
 
     pub fn container_info(&self) -> ContainerInfo {
+        let accounts_completed = self
+            .ranges
+            .iter()
+            .map(|r| r.account_scanner.completed)
+            .min()
+            .unwrap_or_default();
+        let pending_completed = self
+            .ranges
+            .iter()
+            .map(|r| r.pending_scanner.completed)
+            .min()
+            .unwrap_or_default();
         [
-            ("accounts_iterator", self.account_scanner.completed, 0),
-            ("pending_iterator", self.pending_scanner.completed, 0),
+            ("accounts_iterator", accounts_completed, 0),
+            ("pending_iterator", pending_completed, 0),
+            ("ranges", self.ranges.len(), 0),
         ]
         .into()
     }
 }
 
+/// True if `account` lies behind the exclusive end of a scan range
+fn past_end(account: &Account, end: &Option<Account>) -> bool {
+    match end {
+        Some(end) => account >= end,
+        None => false,
+    }
+}
+
 struct AccountDatabaseScanner {
     ledger: Arc<Ledger>,
+    start: Account,
+    end: Option<Account>,
     next: Account,
     completed: usize,
 }
 
 impl AccountDatabaseScanner {
-    fn new(ledger: Arc<Ledger>) -> Self {
+    /// Scans the accounts in [start, end)
+    fn new(ledger: Arc<Ledger>, start: Account, end: Option<Account>) -> Self {
         Self {
             ledger,
-            next: Account::zero(),
+            start,
+            end,
+            next: start,
             completed: 0,
         }
     }
@@ -82,6 +157,9 @@ impl AccountDatabaseScanner {
             let Some((account, _)) = &crawler.current else {
                 break;
             };
+            if past_end(account, &self.end) {
+                break;
+            }
 
             result.push(*account);
             self.next = account.inc().unwrap_or_default(); // TODO: Handle account number overflow
@@ -89,10 +167,14 @@ impl AccountDatabaseScanner {
             crawler.advance();
         }
 
-        // Empty current value indicates the end of the table
-        if crawler.current.is_none() {
+        // Empty current value indicates the end of the table, or we left the range
+        let end_reached = match &crawler.current {
+            Some((account, _)) => past_end(account, &self.end),
+            None => true,
+        };
+        if end_reached {
             // Reset for the next ledger iteration
-            self.next = Account::zero();
+            self.next = self.start;
             self.completed += 1;
         }
 
@@ -102,15 +184,20 @@ impl AccountDatabaseScanner {
 
 struct PendingDatabaseScanner {
     ledger: Arc<Ledger>,
+    start: Account,
+    end: Option<Account>,
     next: Account,
     completed: usize,
 }
 
 impl PendingDatabaseScanner {
-    fn new(ledger: Arc<Ledger>) -> Self {
+    /// Scans the accounts in [start, end)
+    fn new(ledger: Arc<Ledger>, start: Account, end: Option<Account>) -> Self {
         Self {
             ledger,
-            next: Account::zero(),
+            start,
+            end,
+            next: start,
             completed: 0,
         }
     }
@@ -124,6 +211,9 @@ impl PendingDatabaseScanner {
             let Some((key, _)) = crawler.current else {
                 break;
             };
+            if past_end(&key.receiving_account, &self.end) {
+                break;
+            }
             result.push(key.receiving_account);
 
             // TODO: Handle account number overflow
@@ -131,10 +221,14 @@ impl PendingDatabaseScanner {
             crawler.advance();
         }
 
-        // Empty current value indicates the end of the table
-        if crawler.current.is_none() {
+        // Empty current value indicates the end of the table, or we left the range
+        let end_reached = match &crawler.current {
+            Some((key, _)) => past_end(&key.receiving_account, &self.end),
+            None => true,
+        };
+        if end_reached {
             // Reset for the next ledger iteration
-            self.next = Account::zero();
+            self.next = self.start;
             self.completed += 1;
         }
 
@@ -179,7 +273,8 @@ mod tests {
             }
             // Single batch
             {
-                let mut scanner = PendingDatabaseScanner::new(ledger_ctx.ledger.clone());
+                let mut scanner =
+                    PendingDatabaseScanner::new(ledger_ctx.ledger.clone(), Account::zero(), None);
                 let tx = ledger_ctx.ledger.read_txn();
                 let accounts = scanner.next_batch(&tx, 256);
 
@@ -195,7 +290,8 @@ mod tests {
 
             // Multi batch
             {
-                let mut scanner = PendingDatabaseScanner::new(ledger_ctx.ledger.clone());
+                let mut scanner =
+                    PendingDatabaseScanner::new(ledger_ctx.ledger.clone(), Account::zero(), None);
                 let tx = ledger_ctx.ledger.read_txn();
 
                 // Request accounts in multiple batches
@@ -248,7 +344,8 @@ mod tests {
 
         // Single batch
         {
-            let mut scanner = AccountDatabaseScanner::new(ledger_ctx.ledger.clone());
+            let mut scanner =
+                AccountDatabaseScanner::new(ledger_ctx.ledger.clone(), Account::zero(), None);
             let tx = ledger_ctx.ledger.read_txn();
             let accounts = scanner.next_batch(&tx, 256);
 
@@ -262,7 +359,8 @@ mod tests {
 
         // Multi batch
         {
-            let mut scanner = AccountDatabaseScanner::new(ledger_ctx.ledger.clone());
+            let mut scanner =
+                AccountDatabaseScanner::new(ledger_ctx.ledger.clone(), Account::zero(), None);
             let tx = ledger_ctx.ledger.read_txn();
 
             // Request accounts in multiple batches
@@ -285,4 +383,65 @@ mod tests {
             assert_eq!(scanner.completed, 1);
         }
     }
+
+    #[test]
+    fn scan_multiple_ranges() {
+        let mut lattice = UnsavedBlockLatticeBuilder::new();
+        let ledger_ctx = LedgerContext::empty_dev();
+        let mut keys = Vec::new();
+        for _ in 0..8 {
+            let key = PrivateKey::new();
+            let mut send = lattice.genesis().send(&key, 1);
+            let mut open = lattice.account(&key).receive(&send);
+            let mut txn = ledger_ctx.ledger.rw_txn();
+            ledger_ctx.ledger.process(&mut txn, &mut send).unwrap();
+            ledger_ctx.ledger.process(&mut txn, &mut open).unwrap();
+            keys.push(key);
+        }
+        let mut scan = DatabaseScan::new(ledger_ctx.ledger.clone(), 4);
+        assert_eq!(scan.warmed_up(), false);
+
+        scan.fill();
+
+        assert!(scan.warmed_up());
+        let accounts: Vec<_> = scan.queue.drain(..).collect();
+        assert_eq!(accounts.len(), keys.len() + 1); // +1 for genesis
+        for key in &keys {
+            assert!(accounts.contains(&key.account()));
+        }
+    }
+
+    #[test]
+    fn ranges_progress_concurrently() {
+        const RANGES: usize = 4;
+        let range_size = Account::MAX.number() / RANGES;
+        let range_of = |account: &Account| {
+            ((account.number() / range_size).low_u64() as usize).min(RANGES - 1)
+        };
+        let mut lattice = UnsavedBlockLatticeBuilder::new();
+        let ledger_ctx = LedgerContext::empty_dev();
+        let mut per_range = [0; RANGES];
+        while per_range.iter().any(|count| *count < 2) {
+            let key = PrivateKey::new();
+            let range = range_of(&key.account());
+            if per_range[range] >= 2 {
+                continue;
+            }
+            per_range[range] += 1;
+            let mut send = lattice.genesis().send(&key, 1);
+            let mut open = lattice.account(&key).receive(&send);
+            let mut txn = ledger_ctx.ledger.rw_txn();
+            ledger_ctx.ledger.process(&mut txn, &mut send).unwrap();
+            ledger_ctx.ledger.process(&mut txn, &mut open).unwrap();
+        }
+        let mut scan = DatabaseScan::new(ledger_ctx.ledger.clone(), RANGES);
+
+        // The first requests that are in flight at the same time cover every range
+        let mut ranges: Vec<_> = (0..RANGES)
+            .map(|_| range_of(&scan.next(|_| true)))
+            .collect();
+        ranges.sort();
+
+        assert_eq!(ranges, vec![0, 1, 2, 3]);
+    }
 }
@@ -1,5 +1,6 @@
 mod account_sets;
 mod bootstrap_server;
+mod chain_cache;
 mod crawlers;
 mod database_scan;
 mod frontier_scan;
@@ -81,9 +82,9 @@ pub struct BootstrapService {
 struct Threads {
     cleanup: JoinHandle<()>,
     priorities: Option<JoinHandle<()>>,
-    database: Option<JoinHandle<()>>,
+    database: Vec<JoinHandle<()>>,
     dependencies: Option<JoinHandle<()>>,
-    frontiers: Option<JoinHandle<()>>,
+    frontiers: Vec<JoinHandle<()>>,
 }
 
 impl BootstrapService {
@@ -103,7 +104,7 @@ impl BootstrapService {
                 stopped: false,
                 accounts: AccountSets::new(config.account_sets.clone()),
                 scoring: PeerScoring::new(config.clone()),
-                database_scan: DatabaseScan::new(ledger.clone()),
+                database_scan: DatabaseScan::new(ledger.clone(), config.database_scan_ranges),
                 frontiers: FrontierScan::new(
                     config.frontier_scan.clone(),
                     stats.clone(),
@@ -140,13 +141,13 @@ impl BootstrapService {
                 handle.join().unwrap();
             }
             threads.cleanup.join().unwrap();
-            if let Some(database) = threads.database {
+            for database in threads.database {
                 database.join().unwrap();
             }
             if let Some(dependencies) = threads.dependencies {
                 dependencies.join().unwrap();
             }
-            if let Some(frontiers) = threads.frontiers {
+            for frontiers in threads.frontiers {
                 frontiers.join().unwrap();
             }
         }
@@ -955,15 +956,17 @@ impl BootstrapExt for Arc<BootstrapService> {
         };
 
         let database = if self.config.enable_database_scan {
-            let self_l = Arc::clone(self);
-            Some(
-                std::thread::Builder::new()
-                    .name("Bootstrap db".to_string())
-                    .spawn(Box::new(move || self_l.run_database()))
-                    .unwrap(),
-            )
+            (0..self.config.database_threads.max(1))
+                .map(|_| {
+                    let self_l = Arc::clone(self);
+                    std::thread::Builder::new()
+                        .name("Bootstrap db".to_string())
+                        .spawn(Box::new(move || self_l.run_database()))
+                        .unwrap()
+                })
+                .collect()
         } else {
-            None
+            Vec::new()
         };
 
         let dependencies = if self.config.enable_dependency_walker {
@@ -979,15 +982,17 @@ impl BootstrapExt for Arc<BootstrapService> {
         };
 
         let frontiers = if self.config.enable_frontier_scan {
-            let self_l = Arc::clone(self);
-            Some(
-                std::thread::Builder::new()
-                    .name("Bootstrap front".to_string())
-                    .spawn(Box::new(move || self_l.run_frontiers()))
-                    .unwrap(),
-            )
+            (0..self.config.frontier_threads.max(1))
+                .map(|_| {
+                    let self_l = Arc::clone(self);
+                    std::thread::Builder::new()
+                        .name("Bootstrap front".to_string())
+                        .spawn(Box::new(move || self_l.run_frontiers()))
+                        .unwrap()
+                })
+                .collect()
         } else {
-            None
+            Vec::new()
         };
 
         let self_l = Arc::clone(self);
@@ -1314,6 +1319,13 @@ pub struct BootstrapConfig {
     pub min_protocol_version: u8,
     pub max_requests: usize,
     pub optimistic_request_percentage: u8,
+    /// Number of threads that request accounts from the database scan concurrently.
+    /// Every thread waits for its own channel, so the requests get spread over the peers
+    pub database_threads: usize,
+    /// Number of consecutive account ranges the database scan iterates independently
+    pub database_scan_ranges: usize,
+    /// Number of threads that request frontiers concurrently
+    pub frontier_threads: usize,
     pub account_sets: AccountSetsConfig,
     pub frontier_scan: FrontierScanConfig,
 }
@@ -1339,6 +1351,10 @@ impl Default for BootstrapConfig {
             min_protocol_version: 0x14, // TODO don't hard code
             max_requests: 1024,
             optimistic_request_percentage: 75,
+            // One database request in flight per range
+            database_threads: 4,
+            database_scan_ranges: 4,
+            frontier_threads: 2,
             account_sets: Default::default(),
             frontier_scan: Default::default(),
         }
@@ -1,16 +1,19 @@
 use crate::{
     consensus::Election,
-    stats::{DetailType, StatType, Stats},
-    utils::{ThreadPool, ThreadPoolImpl},
+    stats::{DetailType, LatencyStage, StatType, Stats},
+    utils::{place_current_thread, ThreadPool, ThreadPoolImpl},
+};
+use rsnano_core::{
+    utils::{ContainerInfo, ThreadRole},
+    BlockHash, SavedBlock,
 };
-use rsnano_core::{utils::ContainerInfo, BlockHash, SavedBlock};
 use rsnano_ledger::{Ledger, WriteGuard, Writer};
 use rsnano_store_lmdb::LmdbWriteTransaction;
 use std::{
     collections::{HashSet, VecDeque},
     sync::{
         atomic::{AtomicBool, Ordering},
-        Arc, Condvar, Mutex,
+        mpsc, Arc, Condvar, Mutex,
     },
     thread::JoinHandle,
     time::Duration,
@@ -25,6 +28,13 @@ pub struct ConfirmingSetConfig {
     /// Maximum number of dependent blocks to be stored in memory during processing
     pub max_blocks: usize,
     pub max_queued_notifications: usize,
+    /// Number of threads that walk the dependency trees of a batch in parallel on read
+    /// transactions before the write lock is taken. With 0 or 1 the dependencies are
+    /// only walked while holding the write lock.
+    pub parallel_walks: usize,
+    /// Maximum number of dependent blocks that get planned per entry of a batch.
+    /// The rest of a deeper dependency tree is walked while holding the write lock.
+    pub max_planned_blocks: usize,
 }
 
 impl Default for ConfirmingSetConfig {
@@ -33,6 +43,8 @@ impl Default for ConfirmingSetConfig {
             batch_size: 256,
             max_blocks: 128 * 128,
             max_queued_notifications: 8,
+            parallel_walks: 0,
+            max_planned_blocks: 512,
         }
     }
 }
@@ -45,6 +57,8 @@ pub struct ConfirmingSet {
 
 impl ConfirmingSet {
     pub fn new(config: ConfirmingSetConfig, ledger: Arc<Ledger>, stats: Arc<Stats>) -> Self {
+        let planners = (config.parallel_walks > 1)
+            .then(|| Arc::new(ThreadPoolImpl::create(config.parallel_walks, "Cement plan")));
         Self {
             join_handle: Mutex::new(None),
             thread: Arc::new(ConfirmingSetThread {
@@ -58,7 +72,8 @@ impl ConfirmingSet {
                 stats,
                 config,
                 observers: Arc::new(Mutex::new(Observers::default())),
-                workers: ThreadPoolImpl::create(1, "Conf notif"),
+                workers: Arc::new(ThreadPoolImpl::create(1, "Conf notif")),
+                planners,
             }),
         }
     }
@@ -106,7 +121,10 @@ impl ConfirmingSet {
         *self.join_handle.lock().unwrap() = Some(
             std::thread::Builder::new()
                 .name("Conf height".to_string())
-                .spawn(move || thread.run())
+                .spawn(move || {
+                    place_current_thread(ThreadRole::ConfirmingSet);
+                    thread.run()
+                })
                 .unwrap(),
         );
     }
@@ -118,6 +136,9 @@ impl ConfirmingSet {
             handle.join().unwrap();
         }
         self.thread.workers.stop();
+        if let Some(planners) = &self.thread.planners {
+            planners.stop();
+        }
     }
 
     /// Added blocks will remain in this set until after ledger has them marked as confirmed.
@@ -166,7 +187,9 @@ struct ConfirmingSetThread {
     ledger: Arc<Ledger>,
     stats: Arc<Stats>,
     config: ConfirmingSetConfig,
-    workers: ThreadPoolImpl,
+    workers: Arc<ThreadPoolImpl>,
+    /// Walks the dependency trees of a batch. Only exists with more than one parallel walk
+    planners: Option<Arc<ThreadPoolImpl>>,
     observers: Arc<Mutex<Observers>>,
 }
 
@@ -230,10 +253,27 @@ impl ConfirmingSetThread {
         }
     }
 
-    fn notify(&self, cemented: &mut VecDeque<Context>) {
-        let mut batch = VecDeque::new();
-        std::mem::swap(&mut batch, cemented);
+    /// Hands the cemented blocks to the observers once their confirmation heights are
+    /// durable. The write transaction has to be committed before the guard is released.
+    fn notify(&self, write_guard: &mut WriteGuard, cemented: &mut VecDeque<Context>) {
+        let batch = std::mem::take(cemented);
+        let workers = self.workers.clone();
+        let observers = self.observers.clone();
+        let stats = self.stats.clone();
+        write_guard.on_durable(Box::new(move || {
+            workers.post(Box::new(move || {
+                stats.inc(StatType::ConfirmingSet, DetailType::Notify);
+                observers.lock().unwrap().notify_batch(&batch);
+                for context in &batch {
+                    stats
+                        .latency()
+                        .record(&context.block.hash(), LatencyStage::Notified);
+                }
+            }));
+        }));
+    }
 
+    fn cooldown(&self) {
         let mut guard = self.mutex.lock().unwrap();
 
         // It's possible that ledger cementing happens faster than the notifications can be processed by other components, cooldown here
@@ -251,13 +291,6 @@ impl ConfirmingSetThread {
                 return;
             }
         }
-
-        let observers = self.observers.clone();
-        let stats = self.stats.clone();
-        self.workers.post(Box::new(move || {
-            stats.inc(StatType::ConfirmingSet, DetailType::Notify);
-            observers.lock().unwrap().notify_batch(batch);
-        }));
     }
 
     /// We might need to issue multiple notifications if the block we're confirming implicitly confirms more
@@ -270,10 +303,11 @@ impl ConfirmingSetThread {
         if cemented.len() >= self.config.max_blocks {
             self.stats
                 .inc(StatType::ConfirmingSet, DetailType::NotifyIntermediate);
-            drop(write_guard);
             tx.commit();
+            self.notify(&mut write_guard, cemented);
+            drop(write_guard);
 
-            self.notify(cemented);
+            self.cooldown();
 
             write_guard = self.ledger.write_queue.wait(Writer::ConfirmationHeight);
             tx.renew();
@@ -281,19 +315,64 @@ impl ConfirmingSetThread {
         (write_guard, tx)
     }
 
+    /// Walks the dependency trees of the batch entries in parallel on read transactions.
+    /// Returns one plan per entry. The plans are cemented later under the write lock,
+    /// so that the lock is only held for the writes and not for the tree walks.
+    fn plan_batch(&self, batch: &VecDeque<Entry>) -> Vec<Vec<SavedBlock>> {
+        let unplanned = || vec![Vec::new(); batch.len()];
+        let Some(planners) = &self.planners else {
+            return unplanned();
+        };
+        if batch.is_empty() {
+            return unplanned();
+        }
+
+        let chunk_size = batch.len().div_ceil(self.config.parallel_walks);
+        let entries: Vec<_> = batch.iter().map(|e| e.hash).collect();
+        let (sender, receiver) = mpsc::channel();
+        let mut chunk_count = 0;
+        for (index, chunk) in entries.chunks(chunk_size).enumerate() {
+            let chunk = chunk.to_vec();
+            let ledger = self.ledger.clone();
+            let sender = sender.clone();
+            let max_blocks = self.config.max_planned_blocks;
+            planners.post(Box::new(move || {
+                place_current_thread(ThreadRole::ConfirmingSet);
+                let tx = ledger.read_txn();
+                let plans: Vec<_> = chunk
+                    .iter()
+                    .map(|hash| ledger.plan_confirmation(&tx, *hash, max_blocks))
+                    .collect();
+                let _ = sender.send((index, plans));
+            }));
+            chunk_count += 1;
+        }
+        drop(sender);
+
+        let mut chunks: Vec<_> = receiver.iter().collect();
+        if chunks.len() != chunk_count {
+            // The planners were stopped
+            return unplanned();
+        }
+        chunks.sort_unstable_by_key(|(index, _)| *index);
+        chunks.into_iter().flat_map(|(_, plans)| plans).collect()
+    }
+
     fn run_batch(&self, batch: VecDeque<Entry>) {
         let mut cemented = VecDeque::new();
         let mut already_cemented = VecDeque::new();
+        let plans = self.plan_batch(&batch);
 
         {
             let mut write_guard = self.ledger.write_queue.wait(Writer::ConfirmationHeight);
             let mut tx = self.ledger.rw_txn();
 
-            for entry in batch {
+            for (entry, plan) in batch.into_iter().zip(plans) {
                 let hash = entry.hash;
                 let election = entry.election;
                 let mut cemented_count = 0;
                 let mut success = false;
+                let mut plan = Some(plan).filter(|p| !p.is_empty());
                 loop {
                     (write_guard, tx) = self.ledger.refresh_if_needed(write_guard, tx);
 
@@ -315,9 +394,19 @@ impl ConfirmingSetThread {
                         break;
                     }
 
-                    let added = self
-                        .ledger
-                        .confirm_max(&mut tx, hash, self.config.max_blocks);
+                    // Cement the prepared plan first. If the ledger changed in the meantime,
+                    // the remaining dependencies are walked under the write lock.
+                    let planned = plan.is_some();
+                    let added = match plan.take() {
+                        Some(plan) => {
+                            self.stats
+                                .inc(StatType::ConfirmingSet, DetailType::CementingPlanned);
+                            self.ledger.confirm_planned(&mut tx, plan)
+                        }
+                        None => self
+                            .ledger
+                            .confirm_max(&mut tx, hash, self.config.max_blocks),
+                    };
                     let added_len = added.len();
                     if !added.is_empty() {
                         // Confirming this block may implicitly confirm more
@@ -328,16 +417,21 @@ impl ConfirmingSetThread {
                         );
                         cemented_count += added.len();
                         for block in added {
+                            self.stats
+                                .latency()
+                                .record(&block.hash(), LatencyStage::Cemented);
                             cemented.push_back(Context {
                                 block,
                                 confirmation_root: hash,
                                 election: election.clone(),
                             });
                         }
-                    } else {
+                    } else if !planned || self.ledger.confirmed().block_exists(&tx, &hash) {
                         self.stats
                             .inc(StatType::ConfirmingSet, DetailType::AlreadyCemented);
                         already_cemented.push_back(hash);
+                    } else {
+                        // The plan went stale
                     }
 
                     success = self.ledger.confirmed().block_exists(&tx, &hash);
@@ -359,9 +453,12 @@ impl ConfirmingSetThread {
                     debug!("Failed to cement block: {}", hash);
                 }
             }
+
+            tx.commit();
+            self.notify(&mut write_guard, &mut cemented);
         }
 
-        self.notify(&mut cemented);
+        self.cooldown();
 
         {
             let mut guard = self.observers.lock().unwrap();
@@ -406,15 +503,15 @@ struct Observers {
 }
 
 impl Observers {
-    fn notify_batch(&mut self, cemented: VecDeque<Context>) {
-        for context in &cemented {
+    fn notify_batch(&mut self, cemented: &VecDeque<Context>) {
+        for context in cemented {
             for observer in &mut self.cemented {
                 observer(&context.block);
             }
         }
 
         for observer in &mut self.batch_cemented {
-            observer(&cemented);
+            observer(cemented);
         }
     }
 }
@@ -480,4 +577,42 @@ mod tests {
             .1;
         assert_eq!(result.timed_out(), false);
     }
+    #[test]
+    fn plan_budget_is_per_entry() {
+        let mut chain = SavedAccountChain::genesis();
+        chain.add_state();
+        chain.add_state();
+        let head = chain.add_state().hash();
+        let ledger = Arc::new(
+            Ledger::new_null_builder()
+                .blocks(chain.blocks())
+                .confirmation_height(
+                    &chain.account(),
+                    &ConfirmationHeightInfo {
+                        height: 1,
+                        frontier: chain.open(),
+                    },
+                )
+                .finish(),
+        );
+        let config = ConfirmingSetConfig {
+            max_blocks: 2,
+            parallel_walks: 2,
+            ..Default::default()
+        };
+        let confirming_set = ConfirmingSet::new(config, ledger, Arc::new(Stats::default()));
+        let batch: VecDeque<_> = [head, BlockHash::from(42)]
+            .into_iter()
+            .map(|hash| Entry {
+                hash,
+                election: None,
+            })
+            .collect();
+
+        let plans = confirming_set.thread.plan_batch(&batch);
+
+        assert_eq!(plans.len(), 2);
+        assert_eq!(plans[0].len(), 3);
+        assert!(plans[1].is_empty());
+    }
 }
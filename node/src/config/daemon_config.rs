@@ -1,6 +1,4 @@
-use super::{
-    get_node_toml_config_path, read_toml_file, DaemonToml, NodeConfig, NodeRpcConfig, OpenclConfig,
-};
+use super::{read_daemon_toml, DaemonToml, NodeConfig, NodeRpcConfig, OpenclConfig};
 use crate::NetworkParams;
 use rsnano_core::Networks;
 use std::path::Path;
@@ -43,11 +41,10 @@ impl DaemonConfig {
         network: Networks,
         parallelism: usize,
         data_path: impl AsRef<Path>,
+        config_overrides: &[String],
     ) -> anyhow::Result<Self> {
-        let file_path = get_node_toml_config_path(data_path.as_ref());
         let mut result = Self::new2(network, parallelism);
-        if file_path.exists() {
-            let toml: DaemonToml = read_toml_file(file_path)?;
+        if let Some(toml) = read_daemon_toml(data_path.as_ref(), config_overrides)? {
             result.merge_toml(&toml);
         }
         Ok(result)
@@ -10,6 +10,7 @@ mod toml;
 mod websocket_config;
 
 use crate::NetworkParams;
+use anyhow::anyhow;
 pub use daemon_config::*;
 pub use diagnostics_config::*;
 pub use network_constants::*;
@@ -63,3 +64,80 @@ pub fn read_toml_file<T: DeserializeOwned>(path: impl AsRef<Path>) -> anyhow::Re
     let toml_str = std::fs::read_to_string(path)?;
     ::toml::from_str(&toml_str).map_err(|e| e.into())
 }
+
+/// Reads the node config of the data path and applies the overrides on top of it.
+/// An override is a dotted key with a TOML value, e.g. `node.enable_voting=false`.
+/// Returns `None` if there is neither a config file nor an override
+pub fn read_daemon_toml(
+    data_path: impl Into<PathBuf>,
+    config_overrides: &[String],
+) -> anyhow::Result<Option<DaemonToml>> {
+    let file_path = get_node_toml_config_path(data_path);
+    let mut table = if file_path.exists() {
+        read_toml_file(file_path)?
+    } else if config_overrides.is_empty() {
+        return Ok(None);
+    } else {
+        ::toml::Table::new()
+    };
+    apply_config_overrides(&mut table, config_overrides)?;
+    Ok(Some(::toml::Value::Table(table).try_into()?))
+}
+
+fn apply_config_overrides(
+    table: &mut ::toml::Table,
+    config_overrides: &[String],
+) -> anyhow::Result<()> {
+    for config_override in config_overrides {
+        let value: ::toml::Table = config_override
+            .parse()
+            .map_err(|e| anyhow!("invalid config override {}: {}", config_override, e))?;
+        merge_toml_tables(table, value);
+    }
+    Ok(())
+}
+
+fn merge_toml_tables(target: &mut ::toml::Table, source: ::toml::Table) {
+    for (key, value) in source {
+        match (target.get_mut(&key), value) {
+            (Some(::toml::Value::Table(existing)), ::toml::Value::Table(value)) => {
+                merge_toml_tables(existing, value);
+            }
+            (_, value) => {
+                target.insert(key, value);
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn override_config_values() {
+        let mut table: ::toml::Table = "[node]\nenable_voting = true\nbandwidth_limit = 5"
+            .parse()
+            .unwrap();
+
+        apply_config_overrides(
+            &mut table,
+            &[
+                "node.enable_voting=false".to_string(),
+                "node.preconfigured_peers=[]".to_string(),
+            ],
+        )
+        .unwrap();
+
+        let node = table["node"].as_table().unwrap();
+        assert_eq!(node["enable_voting"].as_bool(), Some(false));
+        assert_eq!(node["bandwidth_limit"].as_integer(), Some(5));
+        assert_eq!(node["preconfigured_peers"].as_array().unwrap().len(), 0);
+    }
+
+    #[test]
+    fn reject_invalid_override() {
+        let mut table = ::toml::Table::new();
+        assert!(apply_config_overrides(&mut table, &["node.enable_voting".to_string()]).is_err());
+    }
+}
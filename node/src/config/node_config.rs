@@ -16,11 +16,15 @@ use crate::{
 use once_cell::sync::Lazy;
 use rand::{thread_rng, Rng};
 use rsnano_core::{
-    utils::{get_env_or_default_string, is_sanitizer_build, Peer},
+    utils::{get_env_or_default_string, is_sanitizer_build, Peer, ThreadTopology},
     Account, Amount, PublicKey,
 };
 use rsnano_store_lmdb::LmdbConfig;
-use std::{cmp::max, net::Ipv6Addr, time::Duration};
+use std::{
+    cmp::{max, min},
+    net::Ipv6Addr,
+    time::Duration,
+};
 
 #[derive(Clone, Debug, PartialEq)]
 pub struct NodeConfig {
@@ -53,6 +57,7 @@ pub struct NodeConfig {
     pub allow_local_peers: bool,
     pub vote_minimum: Amount,
     pub vote_generator_delay_ms: i64,
+    pub vote_signer_threads: u32,
     pub unchecked_cutoff_time_s: i64,
     pub tcp_io_timeout_s: i64,
     pub pow_sleep_interval_ns: i64,
@@ -74,6 +79,13 @@ pub struct NodeConfig {
     pub max_queued_requests: u32,
     pub request_aggregator_threads: u32,
     pub max_unchecked_blocks: u32,
+    /// Maintain a representative -> delegators index for the delegators RPCs
+    pub enable_delegators_index: bool,
+    /// Memory budget in bytes for unchecked blocks. 0 means that only max_unchecked_blocks applies
+    pub unchecked_memory_budget: usize,
+    /// Maximum size in bytes of the file that unchecked blocks are spilled to when they
+    /// don't fit into memory. 0 disables spilling
+    pub unchecked_spill_size: usize,
     pub rep_crawler_weight_minimum: Amount,
     pub work_peers: Vec<Peer>,
     pub secondary_work_peers: Vec<Peer>,
@@ -81,6 +93,8 @@ pub struct NodeConfig {
     pub preconfigured_representatives: Vec<PublicKey>,
     pub max_pruning_age_s: i64,
     pub max_pruning_depth: u64,
+    /// Search pruning targets in parallel while pruning, instead of alternating between both
+    pub pipelined_pruning: bool,
     pub callback_address: String,
     pub callback_port: u16,
     pub callback_target: String,
@@ -100,6 +114,8 @@ pub struct NodeConfig {
     pub local_block_broadcaster: LocalBlockBroadcasterConfig,
     pub confirming_set: ConfirmingSetConfig,
     pub monitor: MonitorConfig,
+    /// Places the threads of the node subsystems on CPUs
+    pub thread_topology: ThreadTopology,
     pub backlog: BacklogPopulationConfig,
     pub network_duplicate_filter_cutoff: u64,
 }
@@ -248,6 +264,8 @@ impl NodeConfig {
                 || network_params.network.is_test_network()), // disable by default for live network
             vote_minimum: Amount::nano(1000),
             vote_generator_delay_ms: 100,
+            /* Extra threads for signing the votes of multiple local representatives. The calling thread signs votes as well */
+            vote_signer_threads: min(parallelism / 2, 4) as u32,
             unchecked_cutoff_time_s: 4 * 60 * 60, // 4 hours
             tcp_io_timeout_s: if network_params.network.is_dev_network() && !is_sanitizer_build() {
                 5
@@ -278,6 +296,9 @@ impl NodeConfig {
             max_queued_requests: 512,
             request_aggregator_threads: max(parallelism, 4) as u32,
             max_unchecked_blocks: 65536,
+            enable_delegators_index: false,
+            unchecked_memory_budget: 0,
+            unchecked_spill_size: 0,
             rep_crawler_weight_minimum: Amount::decode_hex("FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF")
                 .unwrap(),
             work_peers: Vec::new(),
@@ -290,6 +311,7 @@ impl NodeConfig {
                 5 * 60
             }, // 1 day; 5 minutes for beta network
             max_pruning_depth: 0,
+            pipelined_pruning: false,
             callback_address: String::new(),
             callback_port: 0,
             callback_target: String::new(),
@@ -324,8 +346,12 @@ impl NodeConfig {
             local_block_broadcaster: LocalBlockBroadcasterConfig::new(
                 network_params.network.current_network,
             ),
-            confirming_set: Default::default(),
+            confirming_set: ConfirmingSetConfig {
+                parallel_walks: parallelism / 2,
+                ..Default::default()
+            },
             monitor: Default::default(),
+            thread_topology: ThreadTopology::default(),
             backlog: Default::default(),
             network_duplicate_filter_cutoff: 60,
         }
@@ -6,6 +6,7 @@ pub struct BacklogPopulationToml {
     pub enable: Option<bool>,
     pub batch_size: Option<u32>,
     pub frequency: Option<u32>,
+    pub use_unconfirmed_index: Option<bool>,
 }
 
 impl From<&BacklogPopulationConfig> for BacklogPopulationToml {
@@ -14,6 +15,7 @@ impl From<&BacklogPopulationConfig> for BacklogPopulationToml {
             enable: Some(value.enabled),
             batch_size: Some(value.batch_size),
             frequency: Some(value.frequency),
+            use_unconfirmed_index: Some(value.use_unconfirmed_index),
         }
     }
 }
@@ -31,5 +33,9 @@ impl BacklogPopulationConfig {
         if let Some(freq) = toml.frequency {
             self.frequency = freq;
         }
+
+        if let Some(use_index) = toml.use_unconfirmed_index {
+            self.use_unconfirmed_index = use_index;
+        }
     }
 }
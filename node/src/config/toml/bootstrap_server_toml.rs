@@ -4,6 +4,7 @@ use serde::{Deserialize, Serialize};
 #[derive(Deserialize, Serialize)]
 pub struct BootstrapServerToml {
     pub batch_size: Option<usize>,
+    pub chain_cache_size: Option<usize>,
     pub max_queue: Option<usize>,
     pub threads: Option<usize>,
 }
@@ -28,6 +29,9 @@ impl From<&BootstrapServerToml> for BootstrapServerConfig {
         if let Some(batch_size) = toml.batch_size {
             config.batch_size = batch_size;
         }
+        if let Some(chain_cache_size) = toml.chain_cache_size {
+            config.chain_cache_size = chain_cache_size;
+        }
         config
     }
 }
@@ -38,6 +42,7 @@ impl From<&BootstrapServerConfig> for BootstrapServerToml {
             max_queue: Some(config.max_queue),
             threads: Some(config.threads),
             batch_size: Some(config.batch_size),
+            chain_cache_size: Some(config.chain_cache_size),
         }
     }
 }
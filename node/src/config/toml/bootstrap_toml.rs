@@ -19,6 +19,9 @@ pub struct BootstrapToml {
     pub request_timeout: Option<u64>,
     pub max_requests: Option<usize>,
     pub optimistic_request_percentage: Option<u8>,
+    pub database_threads: Option<usize>,
+    pub database_scan_ranges: Option<usize>,
+    pub frontier_threads: Option<usize>,
     pub account_sets: Option<AccountSetsToml>,
 }
 
@@ -41,6 +44,9 @@ impl From<&BootstrapConfig> for BootstrapToml {
             block_processor_threshold: Some(config.block_processor_theshold),
             max_requests: Some(config.max_requests),
             optimistic_request_percentage: Some(config.optimistic_request_percentage),
+            database_threads: Some(config.database_threads),
+            database_scan_ranges: Some(config.database_scan_ranges),
+            frontier_threads: Some(config.frontier_threads),
         }
     }
 }
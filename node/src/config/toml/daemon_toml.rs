@@ -81,6 +81,9 @@ mod tests {
         bootstrap_frontier_request_count = 9999
         bootstrap_fraction_numerator = 999
         confirming_set_batch_time = 999
+        confirming_set_parallel_walks = 999
+        confirming_set_max_planned_blocks = 999
+        enable_delegators_index = true
         enable_voting = true
         external_address = "0:0:0:0:0:ffff:7f01:101"
         external_port = 999
@@ -101,9 +104,12 @@ mod tests {
         tcp_incoming_connections_max = 999
         tcp_io_timeout = 999
         unchecked_cutoff_time = 999
+        unchecked_memory_budget = 999
+        unchecked_spill_size = 999
         use_memory_pools = false
         vote_generator_delay = 999
         vote_minimum = "999"
+        vote_signer_threads = 999
         work_peers = ["dev.org:999"]
         work_threads = 999
         max_work_generate_multiplier = 999
@@ -115,6 +121,7 @@ mod tests {
         enable = false
         batch_size = 999
         frequency = 999
+        use_unconfirmed_index = false
 
         [node.block_processor]
         max_peer_queue = 999
@@ -153,6 +160,17 @@ mod tests {
         enable = false
         interval = 999
 
+        [node.thread_topology]
+        block_processor_cpus = [0]
+        confirming_set_cpus = [1]
+        vote_processor_cpus = [2]
+        network_cpus = [3]
+        io_cpus = [4]
+        io_threads = 999
+        work_cpus = [5, 6]
+        work_nice = 10
+        traversal_cpus = [7]
+
         [node.ipc.local]
         allow_unsafe = true
         enable = true
@@ -171,6 +189,8 @@ mod tests {
         verify_buffers = false
 
         [node.statistics]
+        enable = false
+        latency_sampling = 999
         max_samples = 999
 
         [node.statistics.log]
@@ -183,13 +203,17 @@ mod tests {
 
         [node.websocket]
         address = "0:0:0:0:0:ffff:7f01:101"
+        disconnect_slow_clients = true
         enable = true
         port = 999
+        send_queue_size = 999
 
         [node.lmdb]
         sync = "nosync_safe"
         max_databases = 999
         map_size = 999
+        block_cache_size = 999
+        account_cache_size = 999
 
         [node.optimistic_scheduler]
         enable = false
@@ -207,11 +231,13 @@ mod tests {
         secondary_work_peers = ["dev.org:998"]
         max_pruning_age = 999
         max_pruning_depth = 999
+        pipelined_pruning = true
 
         [node.vote_cache]
         age_cutoff = 999
         max_size = 999
         max_voters = 999
+        shards = 999
 
         [node.vote_processor]
         max_pr_queue = 999
@@ -233,6 +259,9 @@ mod tests {
         throttle_wait = 999
         request_timeout = 999
         max_requests = 999
+        database_threads = 999
+        database_scan_ranges = 999
+        frontier_threads = 999
 
         [node.bootstrap.account_sets]
         blocking_max = 999
@@ -244,11 +273,13 @@ mod tests {
         max_queue = 999
         threads = 999
         batch_size = 999
+        chain_cache_size = 999
 
         [node.request_aggregator]
         max_queue = 999
         threads = 999
         batch_size = 999
+        coalescing_window = 999
 
         [node.message_processor]
         threads = 999
@@ -323,6 +354,18 @@ mod tests {
             deserialized.node.confirming_set_batch_time,
             default_cfg.node.confirming_set_batch_time
         );
+        assert_ne!(
+            deserialized.node.confirming_set.parallel_walks,
+            default_cfg.node.confirming_set.parallel_walks
+        );
+        assert_ne!(
+            deserialized.node.confirming_set.max_planned_blocks,
+            default_cfg.node.confirming_set.max_planned_blocks
+        );
+        assert_ne!(
+            deserialized.node.enable_delegators_index,
+            default_cfg.node.enable_delegators_index
+        );
         assert_ne!(
             deserialized.node.enable_voting,
             default_cfg.node.enable_voting
@@ -400,6 +443,14 @@ mod tests {
             deserialized.node.unchecked_cutoff_time_s,
             default_cfg.node.unchecked_cutoff_time_s
         );
+        assert_ne!(
+            deserialized.node.unchecked_memory_budget,
+            default_cfg.node.unchecked_memory_budget
+        );
+        assert_ne!(
+            deserialized.node.unchecked_spill_size,
+            default_cfg.node.unchecked_spill_size
+        );
         assert_ne!(
             deserialized.node.use_memory_pools,
             default_cfg.node.use_memory_pools
@@ -412,6 +463,14 @@ mod tests {
             deserialized.node.vote_minimum,
             default_cfg.node.vote_minimum
         );
+        assert_ne!(
+            deserialized.node.pipelined_pruning,
+            default_cfg.node.pipelined_pruning
+        );
+        assert_ne!(
+            deserialized.node.vote_signer_threads,
+            default_cfg.node.vote_signer_threads
+        );
         assert_ne!(deserialized.node.work_peers, default_cfg.node.work_peers);
         assert_ne!(
             deserialized.node.work_threads,
@@ -437,6 +496,10 @@ mod tests {
             deserialized.node.backlog.frequency,
             default_cfg.node.backlog.frequency
         );
+        assert_ne!(
+            deserialized.node.backlog.use_unconfirmed_index,
+            default_cfg.node.backlog.use_unconfirmed_index
+        );
 
         // Block Processor section
         assert_ne!(
@@ -574,6 +637,44 @@ mod tests {
             default_cfg.node.monitor.interval
         );
 
+        // Thread topology section
+        assert_ne!(
+            deserialized.node.thread_topology.block_processor,
+            default_cfg.node.thread_topology.block_processor
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.confirming_set,
+            default_cfg.node.thread_topology.confirming_set
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.vote_processor,
+            default_cfg.node.thread_topology.vote_processor
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.network,
+            default_cfg.node.thread_topology.network
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.io,
+            default_cfg.node.thread_topology.io
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.io_threads,
+            default_cfg.node.thread_topology.io_threads
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.work.cpus,
+            default_cfg.node.thread_topology.work.cpus
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.work.nice,
+            default_cfg.node.thread_topology.work.nice
+        );
+        assert_ne!(
+            deserialized.node.thread_topology.traversal,
+            default_cfg.node.thread_topology.traversal
+        );
+
         // IPC Local section
         assert_ne!(
             deserialized
@@ -693,6 +794,14 @@ mod tests {
         );
 
         // Statistics section
+        assert_ne!(
+            deserialized.node.stat_config.enable,
+            default_cfg.node.stat_config.enable
+        );
+        assert_ne!(
+            deserialized.node.stat_config.latency_sampling,
+            default_cfg.node.stat_config.latency_sampling
+        );
         assert_ne!(
             deserialized.node.stat_config.max_samples,
             default_cfg.node.stat_config.max_samples
@@ -737,6 +846,14 @@ mod tests {
             deserialized.node.websocket_config.port,
             default_cfg.node.websocket_config.port
         );
+        assert_ne!(
+            deserialized.node.websocket_config.send_queue_size,
+            default_cfg.node.websocket_config.send_queue_size
+        );
+        assert_ne!(
+            deserialized.node.websocket_config.disconnect_slow_clients,
+            default_cfg.node.websocket_config.disconnect_slow_clients
+        );
 
         // LMDB section
         assert_ne!(
@@ -751,6 +868,14 @@ mod tests {
             deserialized.node.lmdb_config.map_size,
             default_cfg.node.lmdb_config.map_size
         );
+        assert_ne!(
+            deserialized.node.lmdb_config.block_cache_size,
+            default_cfg.node.lmdb_config.block_cache_size
+        );
+        assert_ne!(
+            deserialized.node.lmdb_config.account_cache_size,
+            default_cfg.node.lmdb_config.account_cache_size
+        );
 
         // Optimistic Scheduler section
         assert_ne!(
@@ -801,6 +926,10 @@ mod tests {
             deserialized.node.vote_cache.max_voters,
             default_cfg.node.vote_cache.max_voters
         );
+        assert_ne!(
+            deserialized.node.vote_cache.shards,
+            default_cfg.node.vote_cache.shards
+        );
 
         // Vote Processor section
         assert_ne!(
@@ -833,6 +962,18 @@ mod tests {
             deserialized.node.bootstrap.database_rate_limit,
             default_cfg.node.bootstrap.database_rate_limit
         );
+        assert_ne!(
+            deserialized.node.bootstrap.database_threads,
+            default_cfg.node.bootstrap.database_threads
+        );
+        assert_ne!(
+            deserialized.node.bootstrap.database_scan_ranges,
+            default_cfg.node.bootstrap.database_scan_ranges
+        );
+        assert_ne!(
+            deserialized.node.bootstrap.frontier_threads,
+            default_cfg.node.bootstrap.frontier_threads
+        );
         assert_ne!(
             deserialized.node.bootstrap.max_pull_count,
             default_cfg.node.bootstrap.max_pull_count
@@ -889,6 +1030,10 @@ mod tests {
             deserialized.node.bootstrap_server.batch_size,
             default_cfg.node.bootstrap_server.batch_size
         );
+        assert_ne!(
+            deserialized.node.bootstrap_server.chain_cache_size,
+            default_cfg.node.bootstrap_server.chain_cache_size
+        );
 
         // Request Aggregator section
         assert_ne!(
@@ -903,6 +1048,10 @@ mod tests {
             deserialized.node.request_aggregator.batch_size,
             default_cfg.node.request_aggregator.batch_size
         );
+        assert_ne!(
+            deserialized.node.request_aggregator.coalescing_window,
+            default_cfg.node.request_aggregator.coalescing_window
+        );
 
         // Message Processor section
         assert_ne!(
@@ -7,6 +7,7 @@ use std::str::FromStr;
 pub struct ExperimentalToml {
     pub max_pruning_age: Option<u64>,
     pub max_pruning_depth: Option<u64>,
+    pub pipelined_pruning: Option<bool>,
     pub secondary_work_peers: Option<Vec<String>>,
 }
 
@@ -18,6 +19,9 @@ impl NodeConfig {
         if let Some(max_pruning_depth) = toml.max_pruning_depth {
             self.max_pruning_depth = max_pruning_depth;
         }
+        if let Some(pipelined_pruning) = toml.pipelined_pruning {
+            self.pipelined_pruning = pipelined_pruning;
+        }
         if let Some(secondary_work_peers) = &toml.secondary_work_peers {
             self.secondary_work_peers = secondary_work_peers
                 .iter()
@@ -39,6 +43,7 @@ impl From<&NodeConfig> for ExperimentalToml {
             ),
             max_pruning_age: Some(config.max_pruning_age_s as u64),
             max_pruning_depth: Some(config.max_pruning_depth),
+            pipelined_pruning: Some(config.pipelined_pruning),
         }
     }
 }
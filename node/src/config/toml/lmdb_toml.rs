@@ -6,6 +6,8 @@ pub struct LmdbToml {
     pub map_size: Option<usize>,
     pub max_databases: Option<u32>,
     pub sync: Option<String>,
+    pub block_cache_size: Option<usize>,
+    pub account_cache_size: Option<usize>,
 }
 
 impl Default for LmdbToml {
@@ -25,6 +27,7 @@ impl From<&LmdbToml> for LmdbConfig {
                 "nosync_safe" => SyncStrategy::NosyncSafe,
                 "nosync_unsafe" => SyncStrategy::NosyncUnsafe,
                 "nosync_unsafe_large_memory" => SyncStrategy::NosyncUnsafeLargeMemory,
+                "group_commit" => SyncStrategy::GroupCommit,
                 _ => panic!("Invalid sync value"),
             }
         }
@@ -34,6 +37,12 @@ impl From<&LmdbToml> for LmdbConfig {
         if let Some(map_size) = toml.map_size {
             config.map_size = map_size;
         }
+        if let Some(block_cache_size) = toml.block_cache_size {
+            config.block_cache_size = block_cache_size;
+        }
+        if let Some(account_cache_size) = toml.account_cache_size {
+            config.account_cache_size = account_cache_size;
+        }
         config
     }
 }
@@ -46,9 +55,12 @@ impl From<&LmdbConfig> for LmdbToml {
                 SyncStrategy::NosyncSafe => "nosync_safe".to_string(),
                 SyncStrategy::NosyncUnsafe => "nosync_unsafe".to_string(),
                 SyncStrategy::NosyncUnsafeLargeMemory => "nosync_unsafe_large_memory".to_string(),
+                SyncStrategy::GroupCommit => "group_commit".to_string(),
             }),
             max_databases: Some(config.max_databases),
             map_size: Some(config.map_size),
+            block_cache_size: Some(config.block_cache_size),
+            account_cache_size: Some(config.account_cache_size),
         }
     }
 }
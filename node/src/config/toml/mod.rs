@@ -20,6 +20,7 @@ mod priority_bucket_toml;
 mod rep_crawler_toml;
 mod request_aggregator_toml;
 mod stats_toml;
+mod thread_topology_toml;
 mod vote_cache_toml;
 mod vote_processor_toml;
 mod websocket_toml;
@@ -46,6 +47,7 @@ pub use priority_bucket_toml::*;
 pub use rep_crawler_toml::*;
 pub use request_aggregator_toml::*;
 pub use stats_toml::*;
+pub use thread_topology_toml::*;
 pub use vote_cache_toml::*;
 pub use vote_processor_toml::*;
 pub use websocket_toml::*;
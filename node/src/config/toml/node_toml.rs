@@ -20,6 +20,9 @@ pub struct NodeToml {
     pub bootstrap_initiator_threads: Option<u32>,
     pub bootstrap_serving_threads: Option<u32>,
     pub confirming_set_batch_time: Option<u64>,
+    pub confirming_set_parallel_walks: Option<usize>,
+    pub confirming_set_max_planned_blocks: Option<usize>,
+    pub enable_delegators_index: Option<bool>,
     pub enable_voting: Option<bool>,
     pub external_address: Option<String>,
     pub external_port: Option<u16>,
@@ -42,9 +45,12 @@ pub struct NodeToml {
     pub tcp_incoming_connections_max: Option<u32>,
     pub tcp_io_timeout: Option<i64>,
     pub unchecked_cutoff_time: Option<i64>,
+    pub unchecked_memory_budget: Option<usize>,
+    pub unchecked_spill_size: Option<usize>,
     pub use_memory_pools: Option<bool>,
     pub vote_generator_delay: Option<i64>,
     pub vote_minimum: Option<String>,
+    pub vote_signer_threads: Option<u32>,
     pub work_peers: Option<Vec<String>>,
     pub work_threads: Option<u32>,
     pub active_elections: Option<ActiveElectionsToml>,
@@ -64,6 +70,7 @@ pub struct NodeToml {
     pub rep_crawler: Option<RepCrawlerToml>,
     pub request_aggregator: Option<RequestAggregatorToml>,
     pub statistics: Option<StatsToml>,
+    pub thread_topology: Option<ThreadTopologyToml>,
     pub vote_cache: Option<VoteCacheToml>,
     pub vote_processor: Option<VoteProcessorToml>,
     pub websocket: Option<WebsocketToml>,
@@ -114,6 +121,15 @@ impl NodeConfig {
         if let Some(confirming_set_batch_time) = &toml.confirming_set_batch_time {
             self.confirming_set_batch_time = Duration::from_millis(*confirming_set_batch_time);
         }
+        if let Some(parallel_walks) = toml.confirming_set_parallel_walks {
+            self.confirming_set.parallel_walks = parallel_walks;
+        }
+        if let Some(max_planned_blocks) = toml.confirming_set_max_planned_blocks {
+            self.confirming_set.max_planned_blocks = max_planned_blocks;
+        }
+        if let Some(enable_delegators_index) = toml.enable_delegators_index {
+            self.enable_delegators_index = enable_delegators_index;
+        }
         if let Some(enable_voting) = toml.enable_voting {
             self.enable_voting = enable_voting;
         }
@@ -137,6 +153,12 @@ impl NodeConfig {
         if let Some(max_unchecked_blocks) = toml.max_unchecked_blocks {
             self.max_unchecked_blocks = max_unchecked_blocks;
         }
+        if let Some(unchecked_memory_budget) = toml.unchecked_memory_budget {
+            self.unchecked_memory_budget = unchecked_memory_budget;
+        }
+        if let Some(unchecked_spill_size) = toml.unchecked_spill_size {
+            self.unchecked_spill_size = unchecked_spill_size;
+        }
         if let Some(max_work_generate_multiplier) = toml.max_work_generate_multiplier {
             self.max_work_generate_multiplier = max_work_generate_multiplier;
         }
@@ -208,6 +230,9 @@ impl NodeConfig {
         if let Some(vote_minimum) = &toml.vote_minimum {
             self.vote_minimum = Amount::decode_dec(&vote_minimum).expect("Invalid vote minimum");
         }
+        if let Some(vote_signer_threads) = toml.vote_signer_threads {
+            self.vote_signer_threads = vote_signer_threads;
+        }
         if let Some(work_peers) = &toml.work_peers {
             self.work_peers = work_peers
                 .iter()
@@ -282,6 +307,15 @@ impl NodeConfig {
             if let Some(percent) = ascending_toml.optimistic_request_percentage {
                 config.optimistic_request_percentage = percent;
             }
+            if let Some(threads) = ascending_toml.database_threads {
+                config.database_threads = threads;
+            }
+            if let Some(ranges) = ascending_toml.database_scan_ranges {
+                config.database_scan_ranges = ranges;
+            }
+            if let Some(threads) = ascending_toml.frontier_threads {
+                config.frontier_threads = threads;
+            }
         }
         if let Some(bootstrap_server_toml) = &toml.bootstrap_server {
             self.bootstrap_server = bootstrap_server_toml.into();
@@ -319,6 +353,9 @@ impl NodeConfig {
         if let Some(message_processor_toml) = &toml.message_processor {
             self.message_processor.merge_toml(message_processor_toml);
         }
+        if let Some(thread_topology) = &toml.thread_topology {
+            thread_topology.merge_into(&mut self.thread_topology);
+        }
         if let Some(cfg) = &toml.monitor {
             if let Some(enable) = cfg.enable {
                 self.enable_monitor = enable;
@@ -365,6 +402,9 @@ impl From<&NodeConfig> for NodeToml {
             bootstrap_initiator_threads: Some(config.bootstrap_initiator_threads),
             bootstrap_serving_threads: Some(config.bootstrap_serving_threads),
             confirming_set_batch_time: Some(config.confirming_set_batch_time.as_millis() as u64),
+            confirming_set_parallel_walks: Some(config.confirming_set.parallel_walks),
+            confirming_set_max_planned_blocks: Some(config.confirming_set.max_planned_blocks),
+            enable_delegators_index: Some(config.enable_delegators_index),
             enable_voting: Some(config.enable_voting),
             external_address: Some(config.external_address.clone()),
             external_port: Some(config.external_port),
@@ -401,9 +441,12 @@ impl From<&NodeConfig> for NodeToml {
             tcp_incoming_connections_max: Some(config.tcp_incoming_connections_max),
             tcp_io_timeout: Some(config.tcp_io_timeout_s),
             unchecked_cutoff_time: Some(config.unchecked_cutoff_time_s),
+            unchecked_memory_budget: Some(config.unchecked_memory_budget),
+            unchecked_spill_size: Some(config.unchecked_spill_size),
             use_memory_pools: Some(config.use_memory_pools),
             vote_generator_delay: Some(config.vote_generator_delay_ms),
             vote_minimum: Some(config.vote_minimum.to_string_dec()),
+            vote_signer_threads: Some(config.vote_signer_threads),
             work_peers: Some(
                 config
                     .work_peers
@@ -431,6 +474,7 @@ impl From<&NodeConfig> for NodeToml {
             ipc: Some((&config.ipc_config).into()),
             diagnostics: Some((&config.diagnostics_config).into()),
             statistics: Some((&config.stat_config).into()),
+            thread_topology: Some((&config.thread_topology).into()),
             lmdb: Some((&config.lmdb_config).into()),
             vote_cache: Some((&config.vote_cache).into()),
             block_processor: Some((&config.block_processor).into()),
@@ -480,6 +524,9 @@ mod tests {
             max_requests: Some(107),
             optimistic_request_percentage: Some(42),
             database_warmup_ratio: Some(108),
+            database_threads: Some(109),
+            database_scan_ranges: Some(110),
+            frontier_threads: Some(111),
             account_sets: Some(sets_toml),
         };
 
@@ -507,6 +554,9 @@ mod tests {
         assert_eq!(ascending.max_requests, 107);
         assert_eq!(ascending.optimistic_request_percentage, 42);
         assert_eq!(ascending.database_warmup_ratio, 108);
+        assert_eq!(ascending.database_threads, 109);
+        assert_eq!(ascending.database_scan_ranges, 110);
+        assert_eq!(ascending.frontier_threads, 111);
 
         let sets = &cfg.bootstrap.account_sets;
         assert_eq!(sets.blocking_max, 200);
@@ -534,6 +584,9 @@ mod tests {
         assert_eq!(ascending_toml.request_timeout, Some(3000));
         assert_eq!(ascending_toml.max_requests, Some(1024));
         assert_eq!(ascending_toml.optimistic_request_percentage, Some(75));
+        assert_eq!(ascending_toml.database_threads, Some(4));
+        assert_eq!(ascending_toml.database_scan_ranges, Some(4));
+        assert_eq!(ascending_toml.frontier_threads, Some(2));
 
         let sets_toml = ascending_toml.account_sets.as_ref().unwrap();
         assert_eq!(sets_toml.consideration_count, Some(4));
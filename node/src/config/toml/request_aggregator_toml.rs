@@ -1,9 +1,11 @@
 use crate::consensus::RequestAggregatorConfig;
 use serde::{Deserialize, Serialize};
+use std::time::Duration;
 
 #[derive(Deserialize, Serialize)]
 pub struct RequestAggregatorToml {
     pub batch_size: Option<usize>,
+    pub coalescing_window: Option<u64>,
     pub max_queue: Option<usize>,
     pub threads: Option<usize>,
 }
@@ -19,6 +21,9 @@ impl RequestAggregatorConfig {
         if let Some(batch_size) = toml.batch_size {
             self.batch_size = batch_size;
         }
+        if let Some(coalescing_window) = toml.coalescing_window {
+            self.coalescing_window = Duration::from_millis(coalescing_window);
+        }
     }
 }
 
@@ -28,6 +33,7 @@ impl From<&RequestAggregatorConfig> for RequestAggregatorToml {
             threads: Some(config.threads),
             max_queue: Some(config.max_queue),
             batch_size: Some(config.batch_size),
+            coalescing_window: Some(config.coalescing_window.as_millis() as u64),
         }
     }
 }
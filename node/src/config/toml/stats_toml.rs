@@ -21,6 +21,8 @@ impl Default for LogToml {
 
 #[derive(Deserialize, Serialize)]
 pub struct StatsToml {
+    pub enable: Option<bool>,
+    pub latency_sampling: Option<u64>,
     pub max_samples: Option<usize>,
     pub log: Option<LogToml>,
 }
@@ -36,6 +38,12 @@ impl From<&StatsToml> for StatsConfig {
     fn from(toml: &StatsToml) -> Self {
         let mut config = StatsConfig::default();
 
+        if let Some(enable) = toml.enable {
+            config.enable = enable;
+        }
+        if let Some(latency_sampling) = toml.latency_sampling {
+            config.latency_sampling = latency_sampling;
+        }
         if let Some(max_samples) = toml.max_samples {
             config.max_samples = max_samples;
         }
@@ -66,6 +74,8 @@ impl From<&StatsToml> for StatsConfig {
 impl From<&StatsConfig> for StatsToml {
     fn from(config: &StatsConfig) -> Self {
         Self {
+            enable: Some(config.enable),
+            latency_sampling: Some(config.latency_sampling),
             max_samples: Some(config.max_samples),
             log: Some(config.into()),
         }
@@ -0,0 +1,63 @@
+use rsnano_core::utils::ThreadTopology;
+use serde::{Deserialize, Serialize};
+
+#[derive(Deserialize, Serialize)]
+pub struct ThreadTopologyToml {
+    pub block_processor_cpus: Option<Vec<usize>>,
+    pub confirming_set_cpus: Option<Vec<usize>>,
+    pub vote_processor_cpus: Option<Vec<usize>>,
+    pub network_cpus: Option<Vec<usize>>,
+    pub io_cpus: Option<Vec<usize>>,
+    pub io_threads: Option<usize>,
+    pub work_cpus: Option<Vec<usize>>,
+    pub work_nice: Option<i32>,
+    pub traversal_cpus: Option<Vec<usize>>,
+}
+
+impl ThreadTopologyToml {
+    pub fn merge_into(&self, topology: &mut ThreadTopology) {
+        if let Some(cpus) = &self.block_processor_cpus {
+            topology.block_processor.cpus = cpus.clone();
+        }
+        if let Some(cpus) = &self.confirming_set_cpus {
+            topology.confirming_set.cpus = cpus.clone();
+        }
+        if let Some(cpus) = &self.vote_processor_cpus {
+            topology.vote_processor.cpus = cpus.clone();
+        }
+        if let Some(cpus) = &self.network_cpus {
+            topology.network.cpus = cpus.clone();
+        }
+        if let Some(cpus) = &self.io_cpus {
+            topology.io.cpus = cpus.clone();
+        }
+        if let Some(threads) = self.io_threads {
+            topology.io_threads = threads;
+        }
+        if let Some(cpus) = &self.work_cpus {
+            topology.work.cpus = cpus.clone();
+        }
+        if let Some(nice) = self.work_nice {
+            topology.work.nice = nice;
+        }
+        if let Some(cpus) = &self.traversal_cpus {
+            topology.traversal.cpus = cpus.clone();
+        }
+    }
+}
+
+impl From<&ThreadTopology> for ThreadTopologyToml {
+    fn from(topology: &ThreadTopology) -> Self {
+        Self {
+            block_processor_cpus: Some(topology.block_processor.cpus.clone()),
+            confirming_set_cpus: Some(topology.confirming_set.cpus.clone()),
+            vote_processor_cpus: Some(topology.vote_processor.cpus.clone()),
+            network_cpus: Some(topology.network.cpus.clone()),
+            io_cpus: Some(topology.io.cpus.clone()),
+            io_threads: Some(topology.io_threads),
+            work_cpus: Some(topology.work.cpus.clone()),
+            work_nice: Some(topology.work.nice),
+            traversal_cpus: Some(topology.traversal.cpus.clone()),
+        }
+    }
+}
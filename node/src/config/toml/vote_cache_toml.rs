@@ -7,6 +7,7 @@ pub struct VoteCacheToml {
     pub age_cutoff: Option<u64>,
     pub max_size: Option<usize>,
     pub max_voters: Option<usize>,
+    pub shards: Option<usize>,
 }
 
 impl Default for VoteCacheToml {
@@ -29,6 +30,9 @@ impl From<&VoteCacheToml> for VoteCacheConfig {
         if let Some(age_cutoff) = &toml.age_cutoff {
             config.age_cutoff = Duration::from_secs(*age_cutoff);
         }
+        if let Some(shards) = toml.shards {
+            config.shards = shards;
+        }
         config
     }
 }
@@ -39,6 +43,7 @@ impl From<&VoteCacheConfig> for VoteCacheToml {
             max_size: Some(config.max_size),
             max_voters: Some(config.max_voters),
             age_cutoff: Some(config.age_cutoff.as_secs() as u64),
+            shards: Some(config.shards),
         }
     }
 }
@@ -4,8 +4,10 @@ use serde::{Deserialize, Serialize};
 #[derive(Deserialize, Serialize)]
 pub struct WebsocketToml {
     pub address: Option<String>,
+    pub disconnect_slow_clients: Option<bool>,
     pub enable: Option<bool>,
     pub port: Option<u16>,
+    pub send_queue_size: Option<usize>,
 }
 
 impl WebsocketConfig {
@@ -19,6 +21,12 @@ impl WebsocketConfig {
         if let Some(address) = &toml.address {
             self.address = address.clone();
         }
+        if let Some(send_queue_size) = toml.send_queue_size {
+            self.send_queue_size = send_queue_size;
+        }
+        if let Some(disconnect) = toml.disconnect_slow_clients {
+            self.disconnect_slow_clients = disconnect;
+        }
     }
 }
 
@@ -28,6 +36,8 @@ impl From<&WebsocketConfig> for WebsocketToml {
             enable: Some(websocket_config.enabled),
             port: Some(websocket_config.port),
             address: Some(websocket_config.address.clone()),
+            send_queue_size: Some(websocket_config.send_queue_size),
+            disconnect_slow_clients: Some(websocket_config.disconnect_slow_clients),
         }
     }
 }
@@ -6,6 +6,10 @@ pub struct WebsocketConfig {
     pub enabled: bool,
     pub port: u16,
     pub address: String,
+    /// Maximum number of messages queued for a client that doesn't keep up
+    pub send_queue_size: usize,
+    /// Disconnect clients with a full send queue, instead of dropping their messages
+    pub disconnect_slow_clients: bool,
 }
 
 impl WebsocketConfig {
@@ -14,6 +18,8 @@ impl WebsocketConfig {
             enabled: false,
             port: network.default_websocket_port,
             address: Ipv6Addr::LOCALHOST.to_string(),
+            send_queue_size: 1024,
+            disconnect_slow_clients: false,
         }
     }
 }
@@ -32,5 +38,7 @@ mod tests {
         assert_eq!(cfg.enabled, false);
         assert_eq!(cfg.port, 7078);
         assert_eq!(cfg.address, "::1");
+        assert_eq!(cfg.send_queue_size, 1024);
+        assert_eq!(cfg.disconnect_slow_clients, false);
     }
 }
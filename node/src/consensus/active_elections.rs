@@ -9,7 +9,7 @@ use crate::{
     config::{NodeConfig, NodeFlags},
     consensus::VoteApplierExt,
     representatives::OnlineReps,
-    stats::{DetailType, Direction, Sample, StatType, Stats},
+    stats::{DetailType, Direction, LatencyStage, Sample, StatType, Stats},
     transport::{MessageFlooder, NetworkFilter},
     utils::HardenedConstants,
     wallets::Wallets,
@@ -28,10 +28,14 @@ use rsnano_nullable_clock::SteadyClock;
 use rsnano_store_lmdb::{LmdbReadTransaction, Transaction};
 use std::{
     cmp::{max, min},
-    collections::{BTreeMap, HashMap},
+    collections::{hash_map::RandomState, BTreeMap, HashMap},
+    hash::BuildHasher,
     mem::size_of,
     ops::Deref,
-    sync::{atomic::Ordering, Arc, Condvar, Mutex, MutexGuard, RwLock},
+    sync::{
+        atomic::{AtomicUsize, Ordering},
+        Arc, Condvar, Mutex, MutexGuard, RwLock, RwLockWriteGuard,
+    },
     thread::JoinHandle,
     time::{Duration, Instant},
 };
@@ -82,9 +86,14 @@ impl Default for ActiveElectionsConfig {
     }
 }
 
+/// The elections are looked up in `roots`, which is sharded by root, so that votes and
+/// inserts for different roots don't contend. The main mutex only guards the insertion
+/// order for the request loop. Lock order: root shard, then main mutex.
 pub struct ActiveElections {
     steady_clock: Arc<SteadyClock>,
     mutex: Mutex<ActiveElectionsState>,
+    roots: RootShards,
+    counts: BehaviorCounts,
     condition: Condvar,
     network_params: NetworkParams,
     wallets: Arc<Wallets>,
@@ -99,7 +108,7 @@ pub struct ActiveElections {
     vote_generators: Arc<VoteGenerators>,
     network_filter: Arc<NetworkFilter>,
     network_info: Arc<RwLock<NetworkInfo>>,
-    vote_cache: Arc<Mutex<VoteCache>>,
+    vote_cache: Arc<VoteCache>,
     stats: Arc<Stats>,
     active_started_observer: Mutex<Vec<Box<dyn Fn(BlockHash) + Send + Sync>>>,
     active_stopped_observer: Mutex<Vec<Box<dyn Fn(BlockHash) + Send + Sync>>>,
@@ -125,7 +134,7 @@ impl ActiveElections {
         vote_generators: Arc<VoteGenerators>,
         network_filter: Arc<NetworkFilter>,
         network_info: Arc<RwLock<NetworkInfo>>,
-        vote_cache: Arc<Mutex<VoteCache>>,
+        vote_cache: Arc<VoteCache>,
         stats: Arc<Stats>,
         online_reps: Arc<Mutex<OnlineReps>>,
         flags: NodeFlags,
@@ -138,13 +147,11 @@ impl ActiveElections {
     ) -> Self {
         Self {
             mutex: Mutex::new(ActiveElectionsState {
-                roots: OrderedRoots::default(),
+                sequenced: Vec::new(),
                 stopped: false,
-                manual_count: 0,
-                priority_count: 0,
-                hinted_count: 0,
-                optimistic_count: 0,
             }),
+            roots: RootShards::new(),
+            counts: BehaviorCounts::default(),
             condition: Condvar::new(),
             network_params,
             wallets,
@@ -178,17 +185,16 @@ impl ActiveElections {
     }
 
     pub fn len(&self) -> usize {
-        self.mutex.lock().unwrap().roots.len()
+        self.counts.total()
     }
 
     pub fn info(&self) -> ActiveElectionsInfo {
-        let guard = self.mutex.lock().unwrap();
         ActiveElectionsInfo {
             max_queue: self.config.size,
-            total: guard.roots.len(),
-            priority: guard.priority_count,
-            hinted: guard.hinted_count,
-            optimistic: guard.optimistic_count,
+            total: self.counts.total(),
+            priority: self.counts.get(ElectionBehavior::Priority),
+            hinted: self.counts.get(ElectionBehavior::Hinted),
+            optimistic: self.counts.get(ElectionBehavior::Optimistic),
         }
     }
 
@@ -400,14 +406,13 @@ impl ActiveElections {
     }
 
     fn election_vacancy(&self, behavior: ElectionBehavior) -> i64 {
-        let guard = self.mutex.lock().unwrap();
         match behavior {
             ElectionBehavior::Manual => i64::MAX,
             ElectionBehavior::Priority => {
-                self.limit(ElectionBehavior::Priority) as i64 - guard.roots.len() as i64
+                self.limit(ElectionBehavior::Priority) as i64 - self.counts.total() as i64
             }
             ElectionBehavior::Hinted | ElectionBehavior::Optimistic => {
-                self.limit(behavior) as i64 - guard.count_by_behavior(behavior) as i64
+                self.limit(behavior) as i64 - self.counts.get(behavior) as i64
             }
         }
     }
@@ -419,8 +424,13 @@ impl ActiveElections {
     pub fn clear(&self) {
         // TODO: Call erased_callback for each election
         {
-            let mut guard = self.mutex.lock().unwrap();
-            guard.roots.clear();
+            let mut shards: Vec<_> = self.roots.iter().map(|s| s.write().unwrap()).collect();
+            for shard in &mut shards {
+                for (_, entry) in shard.drain() {
+                    self.counts.dec(entry.election.behavior);
+                }
+            }
+            self.mutex.lock().unwrap().sequenced.clear();
         }
 
         self.vacancy_updated();
@@ -435,8 +445,7 @@ impl ActiveElections {
     }
 
     pub fn active_root(&self, root: &QualifiedRoot) -> bool {
-        let guard = self.mutex.lock().unwrap();
-        guard.roots.get(root).is_some()
+        self.roots.shard(root).read().unwrap().contains_key(root)
     }
 
     pub fn active(&self, block: &Block) -> bool {
@@ -471,7 +480,7 @@ impl ActiveElections {
         };
 
         // Replace if lowest tally is below inactive cache new block weight
-        let inactive_existing = self.vote_cache.lock().unwrap().find(hash);
+        let inactive_existing = self.vote_cache.find(hash);
         let inactive_tally = votes_tally(&inactive_existing);
         if inactive_tally > Amount::zero() && sorted.len() < ELECTION_MAX_BLOCKS {
             // If count of tally items is less than 10, remove any block without tally
@@ -623,14 +632,9 @@ impl ActiveElections {
     }
 
     /// Erase all blocks from active and, if not confirmed, clear digests from network filters
-    fn cleanup_election<'a>(
-        &self,
-        mut guard: MutexGuard<'a, ActiveElectionsState>,
-        election: &'a Arc<Election>,
-    ) {
+    fn cleanup_election(&self, mut shard: RwLockWriteGuard<RootMap>, election: &Arc<Election>) {
         // Keep track of election count by election type
-        debug_assert!(guard.count_by_behavior(election.behavior) > 0);
-        *guard.count_by_behavior_mut(election.behavior) -= 1;
+        self.counts.dec(election.behavior);
 
         let election_winner: BlockHash;
         let election_state;
@@ -645,10 +649,14 @@ impl ActiveElections {
         self.vote_router.disconnect_election(election);
 
         // Erase root info
-        let entry = guard
-            .roots
-            .erase(&election.qualified_root)
+        let entry = shard
+            .remove(&election.qualified_root)
             .expect("election not found");
+        self.mutex
+            .lock()
+            .unwrap()
+            .sequenced
+            .retain(|e| !Arc::ptr_eq(e, election));
 
         let state = election.state();
         self.stats
@@ -678,7 +686,7 @@ impl ActiveElections {
             election_state
         );
 
-        drop(guard);
+        drop(shard);
 
         // Track election duration
         self.stats.sample(
@@ -753,8 +761,7 @@ impl ActiveElections {
     }
 
     pub fn election(&self, root: &QualifiedRoot) -> Option<Arc<Election>> {
-        let guard = self.mutex.lock().unwrap();
-        guard.election(root)
+        self.roots.election(root)
     }
 
     pub fn votes_with_weight(&self, election: &Election) -> Vec<VoteWithWeightInfo> {
@@ -799,7 +806,7 @@ impl ActiveElections {
         &'a self,
         guard: MutexGuard<'a, ActiveElectionsState>,
     ) -> MutexGuard<'a, ActiveElectionsState> {
-        let this_loop_target = guard.roots.len();
+        let this_loop_target = guard.sequenced.len();
         let elections = Self::list_active_impl(this_loop_target, &guard);
         drop(guard);
 
@@ -828,14 +835,8 @@ impl ActiveElections {
 
     // Returns a list of elections sorted by difficulty
     pub fn list_active(&self, max: usize) -> Vec<Arc<Election>> {
-        self.mutex
-            .lock()
-            .unwrap()
-            .roots
-            .iter_sequenced()
-            .map(|i| i.election.clone())
-            .take(max)
-            .collect()
+        let guard = self.mutex.lock().unwrap();
+        Self::list_active_impl(max, &guard)
     }
 
     /// Returns a list of elections sorted by difficulty, mutex must be locked
@@ -843,19 +844,14 @@ impl ActiveElections {
         max: usize,
         guard: &MutexGuard<ActiveElectionsState>,
     ) -> Vec<Arc<Election>> {
-        guard
-            .roots
-            .iter_sequenced()
-            .map(|i| i.election.clone())
-            .take(max)
-            .collect()
+        guard.sequenced.iter().take(max).cloned().collect()
     }
 
     pub fn erase(&self, root: &QualifiedRoot) -> bool {
-        let guard = self.mutex.lock().unwrap();
-        if let Some(entry) = guard.roots.get(root) {
+        let shard = self.roots.shard(root).write().unwrap();
+        if let Some(entry) = shard.get(root) {
             let election = entry.election.clone();
-            self.cleanup_election(guard, &election);
+            self.cleanup_election(shard, &election);
             true
         } else {
             false
@@ -943,8 +939,6 @@ impl ActiveElections {
     }
 
     pub fn container_info(&self) -> ContainerInfo {
-        let guard = self.mutex.lock().unwrap();
-
         let recently_cemented: ContainerInfo = [(
             "cemented",
             self.recently_cemented.lock().unwrap().len(),
@@ -953,20 +947,16 @@ impl ActiveElections {
         .into();
 
         ContainerInfo::builder()
-            .leaf("roots", guard.roots.len(), OrderedRoots::ELEMENT_SIZE)
-            .leaf(
-                "normal",
-                guard.count_by_behavior(ElectionBehavior::Priority),
-                0,
-            )
+            .leaf("roots", self.counts.total(), RootShards::ELEMENT_SIZE)
+            .leaf("normal", self.counts.get(ElectionBehavior::Priority), 0)
             .leaf(
                 "hinted".to_string(),
-                guard.count_by_behavior(ElectionBehavior::Hinted),
+                self.counts.get(ElectionBehavior::Hinted),
                 0,
             )
             .leaf(
                 "optimistic".to_string(),
-                guard.count_by_behavior(ElectionBehavior::Optimistic),
+                self.counts.get(ElectionBehavior::Optimistic),
                 0,
             )
             .node(
@@ -1021,77 +1011,87 @@ impl From<Amount> for TallyKey {
 }
 
 pub struct ActiveElectionsState {
-    roots: OrderedRoots,
+    /// Elections in insertion order, for the request loop
+    sequenced: Vec<Arc<Election>>,
     stopped: bool,
-    manual_count: usize,
-    priority_count: usize,
-    hinted_count: usize,
-    optimistic_count: usize,
 }
 
-impl ActiveElectionsState {
-    pub fn count_by_behavior(&self, behavior: ElectionBehavior) -> usize {
-        match behavior {
-            ElectionBehavior::Manual => self.manual_count,
-            ElectionBehavior::Priority => self.priority_count,
-            ElectionBehavior::Hinted => self.hinted_count,
-            ElectionBehavior::Optimistic => self.optimistic_count,
+type RootMap = HashMap<QualifiedRoot, Entry>;
+
+/// The active elections by root, split into independently locked shards
+pub(crate) struct RootShards {
+    shards: Vec<RwLock<RootMap>>,
+    hasher: RandomState,
+}
+
+impl RootShards {
+    pub const SHARDS: usize = 16;
+    pub const ELEMENT_SIZE: usize = size_of::<QualifiedRoot>() * 2 + size_of::<Arc<Election>>();
+
+    fn new() -> Self {
+        Self {
+            shards: (0..Self::SHARDS)
+                .map(|_| RwLock::new(HashMap::new()))
+                .collect(),
+            hasher: RandomState::new(),
         }
     }
 
-    pub fn count_by_behavior_mut(&mut self, behavior: ElectionBehavior) -> &mut usize {
-        match behavior {
-            ElectionBehavior::Manual => &mut self.manual_count,
-            ElectionBehavior::Priority => &mut self.priority_count,
-            ElectionBehavior::Hinted => &mut self.hinted_count,
-            ElectionBehavior::Optimistic => &mut self.optimistic_count,
-        }
+    fn shard(&self, root: &QualifiedRoot) -> &RwLock<RootMap> {
+        let index = self.hasher.hash_one(root) as usize % self.shards.len();
+        &self.shards[index]
     }
 
-    pub fn election(&self, root: &QualifiedRoot) -> Option<Arc<Election>> {
-        self.roots.get(root).map(|i| i.election.clone())
+    fn election(&self, root: &QualifiedRoot) -> Option<Arc<Election>> {
+        self.shard(root)
+            .read()
+            .unwrap()
+            .get(root)
+            .map(|i| i.election.clone())
+    }
+
+    fn iter(&self) -> impl Iterator<Item = &RwLock<RootMap>> {
+        self.shards.iter()
     }
 }
 
+/// Election count by election type. Readable without taking any lock
 #[derive(Default)]
-pub(crate) struct OrderedRoots {
-    by_root: HashMap<QualifiedRoot, Entry>,
-    sequenced: Vec<QualifiedRoot>,
+struct BehaviorCounts {
+    manual: AtomicUsize,
+    priority: AtomicUsize,
+    hinted: AtomicUsize,
+    optimistic: AtomicUsize,
 }
 
-impl OrderedRoots {
-    pub const ELEMENT_SIZE: usize = size_of::<QualifiedRoot>() * 2 + size_of::<Arc<Election>>();
-
-    pub fn insert(&mut self, entry: Entry) {
-        let root = entry.root.clone();
-        if self.by_root.insert(root.clone(), entry).is_none() {
-            self.sequenced.push(root);
+impl BehaviorCounts {
+    fn counter(&self, behavior: ElectionBehavior) -> &AtomicUsize {
+        match behavior {
+            ElectionBehavior::Manual => &self.manual,
+            ElectionBehavior::Priority => &self.priority,
+            ElectionBehavior::Hinted => &self.hinted,
+            ElectionBehavior::Optimistic => &self.optimistic,
         }
     }
 
-    pub fn get(&self, root: &QualifiedRoot) -> Option<&Entry> {
-        self.by_root.get(root)
-    }
-
-    pub fn erase(&mut self, root: &QualifiedRoot) -> Option<Entry> {
-        let erased = self.by_root.remove(root);
-        if erased.is_some() {
-            self.sequenced.retain(|x| x != root)
-        }
-        erased
+    fn get(&self, behavior: ElectionBehavior) -> usize {
+        self.counter(behavior).load(Ordering::Relaxed)
     }
 
-    pub fn clear(&mut self) {
-        self.sequenced.clear();
-        self.by_root.clear();
+    fn total(&self) -> usize {
+        self.get(ElectionBehavior::Manual)
+            + self.get(ElectionBehavior::Priority)
+            + self.get(ElectionBehavior::Hinted)
+            + self.get(ElectionBehavior::Optimistic)
     }
 
-    pub fn len(&self) -> usize {
-        self.sequenced.len()
+    fn inc(&self, behavior: ElectionBehavior) {
+        self.counter(behavior).fetch_add(1, Ordering::Relaxed);
     }
 
-    pub fn iter_sequenced(&self) -> impl Iterator<Item = &Entry> {
-        self.sequenced.iter().map(|r| self.by_root.get(r).unwrap())
+    fn dec(&self, behavior: ElectionBehavior) {
+        let previous = self.counter(behavior).fetch_sub(1, Ordering::Relaxed);
+        debug_assert!(previous > 0);
     }
 }
 
@@ -1104,7 +1104,6 @@ pub trait ActiveElectionsExt {
     /// Distinguishes replay votes, cannot be determined if the block is not in any election
     fn block_cemented(
         &self,
-        guard: &mut ActiveElectionsState,
         block: &SavedBlock,
         confirmation_root: &BlockHash,
         source_election: &Option<Arc<Election>>,
@@ -1128,13 +1127,8 @@ impl ActiveElectionsExt for Arc<ActiveElections> {
                     {
                         let mut results = Vec::new();
                         {
-                            let mut guard = active.mutex.lock().unwrap();
-                            // Process all cemented blocks while holding the lock to avoid
-                            // races where an election for a block that is already
-                            // cemented is inserted
                             for context in cemented {
                                 let result = active.block_cemented(
-                                    &mut guard,
                                     &context.block,
                                     &context.confirmation_root,
                                     &context.election,
@@ -1215,20 +1209,26 @@ impl ActiveElectionsExt for Arc<ActiveElections> {
 
     fn block_cemented(
         &self,
-        guard: &mut ActiveElectionsState,
         block: &SavedBlock,
         confirmation_root: &BlockHash,
         source_election: &Option<Arc<Election>>,
     ) -> (ElectionStatus, Vec<VoteWithWeightInfo>) {
-        // Dependent elections are implicitly confirmed when their block is cemented
-        let dependent_election = guard.election(&block.qualified_root());
-        if let Some(dependent_election) = &dependent_election {
-            self.stats
-                .inc(StatType::ActiveElections, DetailType::ConfirmDependent);
+        let root = block.qualified_root();
+        let dependent_election = {
+            // Holding the shard lock avoids races where an election for a block that is
+            // already cemented is inserted
+            let shard = self.roots.shard(&root).read().unwrap();
+            // Dependent elections are implicitly confirmed when their block is cemented
+            let dependent_election = shard.get(&root).map(|i| i.election.clone());
+            if let Some(dependent_election) = &dependent_election {
+                self.stats
+                    .inc(StatType::ActiveElections, DetailType::ConfirmDependent);
 
-            // TODO: This should either confirm or cancel the election
-            self.try_confirm(&dependent_election, &block.hash());
-        }
+                // TODO: This should either confirm or cancel the election
+                self.try_confirm(&dependent_election, &block.hash());
+            }
+            dependent_election
+        };
 
         let mut status = ElectionStatus::default();
         let mut votes = Vec::new();
@@ -1272,18 +1272,15 @@ impl ActiveElectionsExt for Arc<ActiveElections> {
     }
 
     fn publish_block(&self, block: &Block) -> bool {
-        let mut guard = self.mutex.lock().unwrap();
         let root = block.qualified_root();
         let mut result = true;
-        if let Some(entry) = guard.roots.get(&root) {
-            let election = entry.election.clone();
-            drop(guard);
+        if let Some(election) = self.roots.election(&root) {
             result = self.publish(block, &election);
             if !result {
-                guard = self.mutex.lock().unwrap();
+                let shard = self.roots.shard(&root).read().unwrap();
                 self.vote_router
                     .connect(block.hash(), Arc::downgrade(&election));
-                drop(guard);
+                drop(shard);
 
                 self.vote_cache_processor.trigger(block.hash());
 
@@ -1305,20 +1302,19 @@ impl ActiveElectionsExt for Arc<ActiveElections> {
         let mut election_result = None;
         let mut inserted = false;
 
-        let mut guard = self.mutex.lock().unwrap();
-
-        if guard.stopped {
-            return (false, None);
-        }
-
         let root = block.qualified_root();
         let hash = block.hash();
-        let existing = guard.roots.get(&root);
+        let mut shard = self.roots.shard(&root).write().unwrap();
 
-        if let Some(existing) = existing {
+        if let Some(existing) = shard.get(&root) {
             election_result = Some(existing.election.clone());
         } else {
             if !self.recently_confirmed.root_exists(&root) {
+                let mut guard = self.mutex.lock().unwrap();
+                if guard.stopped {
+                    return (false, None);
+                }
+
                 inserted = true;
                 let online_reps = self.online_reps.clone();
                 let clock = self.steady_clock.clone();
@@ -1335,20 +1331,27 @@ impl ActiveElectionsExt for Arc<ActiveElections> {
                     Box::new(|_| {}),
                     observer_rep_cb,
                 ));
-                guard.roots.insert(Entry {
+                guard.sequenced.push(election.clone());
+                drop(guard);
+                shard.insert(
                     root,
-                    election: election.clone(),
-                    erased_callback,
-                });
+                    Entry {
+                        election: election.clone(),
+                        erased_callback,
+                    },
+                );
                 self.vote_router.connect(hash, Arc::downgrade(&election));
 
                 // Keep track of election count by election type
-                *guard.count_by_behavior_mut(election.behavior) += 1;
+                self.counts.inc(election.behavior);
 
                 self.stats
                     .inc(StatType::ActiveElections, DetailType::Started);
                 self.stats
                     .inc(StatType::ActiveElectionsStarted, election_behavior.into());
+                self.stats
+                    .latency()
+                    .record(&hash, LatencyStage::ElectionStarted);
 
                 trace!(behavior = ?election_behavior, ?election, "active started");
 
@@ -1362,7 +1365,7 @@ impl ActiveElectionsExt for Arc<ActiveElections> {
                 // result is not set
             }
         }
-        drop(guard);
+        drop(shard);
 
         if inserted {
             debug_assert!(election_result.is_some());
@@ -1398,9 +1401,36 @@ pub struct ActiveElectionsInfo {
 }
 
 pub(crate) struct Entry {
-    root: QualifiedRoot,
     election: Arc<Election>,
     erased_callback: Option<ErasedCallback>,
 }
 
 pub(crate) type ErasedCallback = Box<dyn Fn(&Arc<Election>) + Send + Sync>;
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn count_by_behavior() {
+        let counts = BehaviorCounts::default();
+        counts.inc(ElectionBehavior::Priority);
+        counts.inc(ElectionBehavior::Priority);
+        counts.inc(ElectionBehavior::Hinted);
+        counts.dec(ElectionBehavior::Priority);
+
+        assert_eq!(counts.get(ElectionBehavior::Priority), 1);
+        assert_eq!(counts.get(ElectionBehavior::Hinted), 1);
+        assert_eq!(counts.get(ElectionBehavior::Optimistic), 0);
+        assert_eq!(counts.total(), 2);
+    }
+
+    #[test]
+    fn same_root_same_shard() {
+        let roots = RootShards::new();
+        let root = QualifiedRoot::new_test_instance();
+
+        assert!(std::ptr::eq(roots.shard(&root), roots.shard(&root.clone())));
+        assert!(roots.election(&root).is_none());
+    }
+}
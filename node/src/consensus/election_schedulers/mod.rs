@@ -32,7 +32,7 @@ impl ElectionSchedulers {
         active_elections: Arc<ActiveElections>,
         ledger: Arc<Ledger>,
         stats: Arc<Stats>,
-        vote_cache: Arc<Mutex<VoteCache>>,
+        vote_cache: Arc<VoteCache>,
         confirming_set: Arc<ConfirmingSet>,
         online_reps: Arc<Mutex<OnlineReps>>,
     ) -> Self {
@@ -57,7 +57,7 @@ pub struct HintedScheduler {
     ledger: Arc<Ledger>,
     confirming_set: Arc<ConfirmingSet>,
     stats: Arc<Stats>,
-    vote_cache: Arc<Mutex<VoteCache>>,
+    vote_cache: Arc<VoteCache>,
     online_reps: Arc<Mutex<OnlineReps>>,
     stopped: AtomicBool,
     stopped_mutex: Mutex<()>,
@@ -70,7 +70,7 @@ impl HintedScheduler {
         active: Arc<ActiveElections>,
         ledger: Arc<Ledger>,
         stats: Arc<Stats>,
-        vote_cache: Arc<Mutex<VoteCache>>,
+        vote_cache: Arc<VoteCache>,
         confirming_set: Arc<ConfirmingSet>,
         online_reps: Arc<Mutex<OnlineReps>>,
     ) -> Self {
@@ -149,7 +149,7 @@ impl HintedScheduler {
                 {
                     self.stats
                         .inc(StatType::Hinting, DetailType::AlreadyConfirmed);
-                    self.vote_cache.lock().unwrap().erase(&current_hash); // Remove from vote cache
+                    self.vote_cache.erase(&current_hash); // Remove from vote cache
                     continue; // Move on to the next item in the stack
                 }
 
@@ -192,7 +192,7 @@ impl HintedScheduler {
         let minimum_final_tally = self.final_tally_threshold();
 
         // Get the list before db transaction starts to avoid unnecessary slowdowns
-        let tops = self.vote_cache.lock().unwrap().top(minimum_tally);
+        let tops = self.vote_cache.top(minimum_tally);
 
         let mut tx = self.ledger.read_txn();
 
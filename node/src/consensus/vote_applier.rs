@@ -4,7 +4,7 @@ use crate::{
     config::NodeConfig,
     consensus::{ElectionState, VoteInfo},
     representatives::OnlineReps,
-    stats::{DetailType, StatType, Stats},
+    stats::{DetailType, LatencyStage, StatType, Stats},
     utils::ThreadPool,
     wallets::Wallets,
     NetworkParams,
@@ -284,6 +284,10 @@ impl VoteApplierExt for Arc<VoteApplier> {
             );
 
             self.stats.inc(StatType::Election, DetailType::ConfirmOnce);
+            self.stats.latency().record(
+                &status.winner.as_ref().unwrap().hash(),
+                LatencyStage::QuorumReached,
+            );
             trace!(
                 qualified_root = ?election.qualified_root,
                 "election confirmed"
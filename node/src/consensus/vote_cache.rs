@@ -10,7 +10,7 @@ use std::{
     collections::{BTreeMap, HashMap},
     fmt::Debug,
     mem::size_of,
-    sync::Arc,
+    sync::{Arc, Mutex, MutexGuard},
     time::Duration,
 };
 
@@ -19,6 +19,8 @@ pub struct VoteCacheConfig {
     pub max_size: usize,
     pub max_voters: usize,
     pub age_cutoff: Duration,
+    /// Number of independently locked shards. Every shard holds up to `max_size / shards` entries
+    pub shards: usize,
 }
 
 impl Default for VoteCacheConfig {
@@ -27,6 +29,7 @@ impl Default for VoteCacheConfig {
             max_size: 1024 * 64,
             max_voters: 64,
             age_cutoff: Duration::from_secs(15 * 60),
+            shards: 16,
         }
     }
 }
@@ -36,28 +39,41 @@ impl Default for VoteCacheConfig {
 ///
 ///	Cache: Stores votes associated with a particular block hash with a bounded maximum number of votes per hash.
 ///			When cache size exceeds `max_size` oldest entries are evicted first.
+///
+/// The entries are sharded by block hash, so that votes for different blocks can be
+/// inserted concurrently.
 pub struct VoteCache {
     config: VoteCacheConfig,
-    cache: CacheEntryCollection,
-    next_id: usize,
-    last_cleanup: Instant,
+    shards: Vec<Mutex<VoteCacheShard>>,
+    max_shard_size: usize,
+    last_cleanup: Mutex<Instant>,
     stats: Arc<Stats>,
 }
 
 impl VoteCache {
     pub fn new(config: VoteCacheConfig, stats: Arc<Stats>) -> Self {
+        let shard_count = config.shards.max(1);
         VoteCache {
-            last_cleanup: Instant::now(),
+            last_cleanup: Mutex::new(Instant::now()),
+            shards: (0..shard_count)
+                .map(|_| Mutex::new(VoteCacheShard::default()))
+                .collect(),
+            max_shard_size: config.max_size.div_ceil(shard_count),
             config,
-            cache: CacheEntryCollection::default(),
-            next_id: 0,
             stats,
         }
     }
 
+    fn shard(&self, hash: &BlockHash) -> MutexGuard<'_, VoteCacheShard> {
+        let bytes = hash.as_bytes();
+        let index =
+            u64::from_le_bytes(bytes[24..].try_into().unwrap()) as usize % self.shards.len();
+        self.shards[index].lock().unwrap()
+    }
+
     /// Adds a new vote to cache
     pub fn insert(
-        &mut self,
+        &self,
         vote: &Arc<Vote>,
         rep_weight: Amount,
         results: &HashMap<BlockHash, VoteCode>,
@@ -80,38 +96,51 @@ impl VoteCache {
         }
     }
 
-    fn insert_impl(&mut self, vote: &Arc<Vote>, hash: &BlockHash, rep_weight: Amount) {
-        let cache_entry_exists = self.cache.modify_by_hash(hash, |existing| {
+    fn insert_impl(&self, vote: &Arc<Vote>, hash: &BlockHash, rep_weight: Amount) {
+        let mut shard = self.shard(hash);
+        let mut tally_changed = false;
+        let cache_entry_exists = shard.cache.modify_by_hash(hash, |existing| {
             self.stats.inc(StatType::VoteCache, DetailType::Update);
-            existing.vote(vote, rep_weight, self.config.max_voters);
+            tally_changed = existing.vote(vote, rep_weight, self.config.max_voters);
         });
 
-        if !cache_entry_exists {
+        if cache_entry_exists {
+            if tally_changed {
+                shard.top = None;
+            }
+        } else {
             self.stats.inc(StatType::VoteCache, DetailType::Insert);
-            let id = self.next_id;
-            self.next_id += 1;
+            let id = shard.next_id;
+            shard.next_id += 1;
             let mut cache_entry = CacheEntry::new(id, *hash);
             cache_entry.vote(vote, rep_weight, self.config.max_voters);
-            self.cache.insert(cache_entry);
+            shard.cache.insert(cache_entry);
 
             // Remove the oldest entry if we have reached the capacity limit
-            if self.cache.len() > self.config.max_size {
-                self.cache.pop_front();
+            if shard.cache.len() > self.max_shard_size {
+                shard.cache.pop_front();
             }
+            shard.top = None;
         }
     }
 
     pub fn empty(&self) -> bool {
-        self.cache.is_empty()
+        self.shards
+            .iter()
+            .all(|s| s.lock().unwrap().cache.is_empty())
     }
 
     pub fn size(&self) -> usize {
-        self.cache.len()
+        self.shards
+            .iter()
+            .map(|s| s.lock().unwrap().cache.len())
+            .sum()
     }
 
     /// Tries to find an entry associated with block hash
     pub fn find(&self, hash: &BlockHash) -> Vec<Arc<Vote>> {
-        self.cache
+        self.shard(hash)
+            .cache
             .get_by_hash(hash)
             .map(|entry| entry.votes())
             .unwrap_or_default()
@@ -119,37 +148,41 @@ impl VoteCache {
 
     /// Removes an entry associated with block hash, does nothing if entry does not exist
     /// return true if hash existed and was erased, false otherwise
-    pub fn erase(&mut self, hash: &BlockHash) -> bool {
-        self.cache.remove_by_hash(hash).is_some()
+    pub fn erase(&self, hash: &BlockHash) -> bool {
+        let mut shard = self.shard(hash);
+        let erased = shard.cache.remove_by_hash(hash).is_some();
+        if erased {
+            shard.top = None;
+        }
+        erased
     }
 
-    pub fn clear(&mut self) {
-        self.cache.clear()
+    pub fn clear(&self) {
+        for shard in &self.shards {
+            let mut shard = shard.lock().unwrap();
+            shard.cache.clear();
+            shard.top = None;
+        }
     }
 
     /// Returns blocks with highest observed tally, greater than `min_tally`
     /// The blocks are sorted in descending order by final tally, then by tally
     /// @param min_tally minimum tally threshold, entries below with their voting weight
     /// below this will be ignore
-    pub fn top(&mut self, min_tally: impl Into<Amount>) -> Vec<TopEntry> {
+    pub fn top(&self, min_tally: impl Into<Amount>) -> Vec<TopEntry> {
         let min_tally = min_tally.into();
         self.stats.inc(StatType::VoteCache, DetailType::Top);
-        if self.last_cleanup.elapsed() >= self.config.age_cutoff / 2 {
-            self.cleanup();
-            self.last_cleanup = Instant::now();
+        {
+            let mut last_cleanup = self.last_cleanup.lock().unwrap();
+            if last_cleanup.elapsed() >= self.config.age_cutoff / 2 {
+                self.cleanup();
+                *last_cleanup = Instant::now();
+            }
         }
 
         let mut results = Vec::new();
-        for entry in self.cache.iter_by_tally_desc() {
-            let tally = entry.tally();
-            if tally < min_tally {
-                break;
-            }
-            results.push(TopEntry {
-                hash: entry.hash,
-                tally,
-                final_tally: entry.final_tally(),
-            })
+        for shard in &self.shards {
+            results.extend_from_slice(shard.lock().unwrap().top(min_tally));
         }
 
         // Sort by final tally then by normal tally, descending
@@ -165,16 +198,22 @@ impl VoteCache {
         results
     }
 
-    fn cleanup(&mut self) {
+    fn cleanup(&self) {
         self.stats.inc(StatType::VoteCache, DetailType::Cleanup);
-        let to_delete: Vec<_> = self
-            .cache
-            .iter()
-            .filter(|i| i.last_vote.elapsed() >= self.config.age_cutoff)
-            .map(|i| i.hash)
-            .collect();
-        for hash in to_delete {
-            self.cache.remove_by_hash(&hash);
+        for shard in &self.shards {
+            let mut shard = shard.lock().unwrap();
+            let to_delete: Vec<_> = shard
+                .cache
+                .iter()
+                .filter(|i| i.last_vote.elapsed() >= self.config.age_cutoff)
+                .map(|i| i.hash)
+                .collect();
+            if !to_delete.is_empty() {
+                shard.top = None;
+            }
+            for hash in to_delete {
+                shard.cache.remove_by_hash(&hash);
+            }
         }
     }
 
@@ -183,7 +222,43 @@ impl VoteCache {
     }
 }
 
-#[derive(PartialEq, Eq, Debug)]
+#[derive(Default)]
+struct VoteCacheShard {
+    cache: CacheEntryCollection,
+    next_id: usize,
+    /// Result of the last `top` call. It is reset whenever a tally in this shard changes,
+    /// so that unchanged shards don't have to be scanned again.
+    top: Option<ShardTop>,
+}
+
+struct ShardTop {
+    min_tally: Amount,
+    entries: Vec<TopEntry>,
+}
+
+impl VoteCacheShard {
+    fn top(&mut self, min_tally: Amount) -> &[TopEntry] {
+        let cached = self.top.as_ref().is_some_and(|t| t.min_tally == min_tally);
+        if !cached {
+            let entries = self
+                .cache
+                .iter_by_tally_desc()
+                .map_while(|entry| {
+                    let tally = entry.tally();
+                    (tally >= min_tally).then(|| TopEntry {
+                        hash: entry.hash,
+                        tally,
+                        final_tally: entry.final_tally(),
+                    })
+                })
+                .collect();
+            self.top = Some(ShardTop { min_tally, entries });
+        }
+        &self.top.as_ref().unwrap().entries
+    }
+}
+
+#[derive(Clone, PartialEq, Eq, Debug)]
 pub struct TopEntry {
     pub hash: BlockHash,
     pub tally: Amount,
@@ -540,6 +615,7 @@ mod tests {
             max_size: 3,
             max_voters: 80,
             age_cutoff: Duration::from_secs(5 * 60),
+            shards: 1,
         }
     }
 
@@ -558,7 +634,7 @@ mod tests {
 
     #[test]
     fn insert_one_hash() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let rep = PrivateKey::new();
         let hash = BlockHash::from(1);
         let vote = create_vote(&rep, &hash, 1);
@@ -577,7 +653,7 @@ mod tests {
      */
     #[test]
     fn insert_one_hash_many_votes() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
 
         let hash = BlockHash::random();
         let rep1 = PrivateKey::new();
@@ -599,7 +675,7 @@ mod tests {
 
     #[test]
     fn insert_many_hashes_many_votes() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
 
         // There will be 3 hashes to vote for
         let hash1 = BlockHash::from(1);
@@ -644,7 +720,7 @@ mod tests {
      */
     #[test]
     fn insert_duplicate() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
 
         let hash = BlockHash::from(1);
         let rep = PrivateKey::new();
@@ -662,7 +738,7 @@ mod tests {
      */
     #[test]
     fn insert_newer() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
 
         let hash = BlockHash::from(1);
         let rep = PrivateKey::new();
@@ -687,7 +763,7 @@ mod tests {
      */
     #[test]
     fn insert_older() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash = BlockHash::from(1);
         let rep = PrivateKey::new();
         let vote1 = create_vote(&rep, &hash, 2);
@@ -711,7 +787,7 @@ mod tests {
      */
     #[test]
     fn erase() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash1 = BlockHash::from(1);
         let hash2 = BlockHash::from(2);
         let hash3 = BlockHash::from(3);
@@ -750,7 +826,7 @@ mod tests {
      */
     #[test]
     fn overfill() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
 
         let hash1 = BlockHash::from(1);
         let hash2 = BlockHash::from(2);
@@ -788,7 +864,7 @@ mod tests {
      */
     #[test]
     fn overfill_entry() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash = BlockHash::from(1);
 
         let rep1 = PrivateKey::new();
@@ -808,7 +884,7 @@ mod tests {
 
     #[test]
     fn change_vote_to_final_vote() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash = BlockHash::from(1);
 
         let rep = PrivateKey::new();
@@ -824,7 +900,7 @@ mod tests {
 
     #[test]
     fn add_final_vote() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash = BlockHash::from(1);
 
         let rep = PrivateKey::new();
@@ -838,15 +914,15 @@ mod tests {
 
     #[test]
     fn top_empty() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         assert_eq!(cache.top(0), Vec::new());
     }
 
     #[test]
     fn top_one_entry() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash = BlockHash::from(1);
-        add_test_vote(&mut cache, &hash, Amount::raw(1));
+        add_test_vote(&cache, &hash, Amount::raw(1));
 
         assert_eq!(
             cache.top(0),
@@ -860,15 +936,15 @@ mod tests {
 
     #[test]
     fn top_multiple_entries_sorted_by_tally() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash1 = BlockHash::from(1);
         let hash2 = BlockHash::from(2);
         let hash3 = BlockHash::from(3);
-        add_test_vote(&mut cache, &hash1, Amount::raw(1));
-        add_test_vote(&mut cache, &hash2, Amount::raw(4));
-        add_test_vote(&mut cache, &hash3, Amount::raw(3));
-        add_test_final_vote(&mut cache, &hash2, Amount::raw(5));
-        add_test_final_vote(&mut cache, &hash3, Amount::raw(5));
+        add_test_vote(&cache, &hash1, Amount::raw(1));
+        add_test_vote(&cache, &hash2, Amount::raw(4));
+        add_test_vote(&cache, &hash3, Amount::raw(3));
+        add_test_final_vote(&cache, &hash2, Amount::raw(5));
+        add_test_final_vote(&cache, &hash3, Amount::raw(5));
 
         let top = cache.top(0);
 
@@ -880,13 +956,13 @@ mod tests {
 
     #[test]
     fn top_min_tally() {
-        let mut cache = create_vote_cache();
+        let cache = create_vote_cache();
         let hash1 = BlockHash::from(1);
         let hash2 = BlockHash::from(2);
         let hash3 = BlockHash::from(3);
-        add_test_vote(&mut cache, &hash1, Amount::raw(1));
-        add_test_vote(&mut cache, &hash2, Amount::raw(2));
-        add_test_vote(&mut cache, &hash3, Amount::raw(3));
+        add_test_vote(&cache, &hash1, Amount::raw(1));
+        add_test_vote(&cache, &hash2, Amount::raw(2));
+        add_test_vote(&cache, &hash3, Amount::raw(3));
 
         let top = cache.top(2);
         assert_eq!(top.len(), 2);
@@ -897,9 +973,9 @@ mod tests {
     #[test]
     fn top_age_cutoff() {
         let stats = Arc::new(Stats::new(Default::default()));
-        let mut cache = VoteCache::new(test_config(), Arc::clone(&stats));
+        let cache = VoteCache::new(test_config(), Arc::clone(&stats));
         let hash = BlockHash::from(1);
-        add_test_vote(&mut cache, &hash, Amount::raw(1));
+        add_test_vote(&cache, &hash, Amount::raw(1));
         assert_eq!(
             stats.count(StatType::VoteCache, DetailType::Cleanup, Direction::In),
             0
@@ -918,12 +994,89 @@ mod tests {
         );
     }
 
-    fn add_test_vote(cache: &mut VoteCache, hash: &BlockHash, rep_weight: Amount) {
+    #[test]
+    fn top_is_updated_after_tally_change() {
+        let cache = create_vote_cache();
+        let hash1 = BlockHash::from(1);
+        let hash2 = BlockHash::from(2);
+        add_test_vote(&cache, &hash1, Amount::raw(2));
+        add_test_vote(&cache, &hash2, Amount::raw(1));
+        assert_eq!(cache.top(0)[0].hash, hash1);
+
+        add_test_vote(&cache, &hash2, Amount::raw(5));
+
+        let top = cache.top(0);
+        assert_eq!(top[0].hash, hash2);
+        assert_eq!(top[0].tally, Amount::raw(6));
+    }
+
+    #[test]
+    fn top_is_updated_after_erase() {
+        let cache = create_vote_cache();
+        let hash = BlockHash::from(1);
+        add_test_vote(&cache, &hash, Amount::raw(2));
+        assert_eq!(cache.top(0).len(), 1);
+
+        cache.erase(&hash);
+
+        assert_eq!(cache.top(0), Vec::new());
+    }
+
+    #[test]
+    fn multiple_shards() {
+        let cache = VoteCache::new(
+            VoteCacheConfig {
+                max_size: 1000,
+                shards: 4,
+                ..test_config()
+            },
+            Arc::new(Stats::default()),
+        );
+        let hashes: Vec<_> = (0..100).map(|_| BlockHash::random()).collect();
+        for (i, hash) in hashes.iter().enumerate() {
+            add_test_vote(&cache, hash, Amount::raw(i as u128 + 1));
+        }
+
+        assert_eq!(cache.size(), 100);
+        assert!(hashes.iter().all(|h| cache.find(h).len() == 1));
+        let top = cache.top(0);
+        assert_eq!(top.len(), 100);
+        assert_eq!(top[0].hash, hashes[99]);
+        assert_eq!(top[99].hash, hashes[0]);
+    }
+
+    #[test]
+    fn concurrent_inserts() {
+        let cache = Arc::new(VoteCache::new(
+            VoteCacheConfig {
+                max_size: 1000,
+                shards: 4,
+                ..test_config()
+            },
+            Arc::new(Stats::default()),
+        ));
+        let handles: Vec<_> = (0..4)
+            .map(|_| {
+                let cache = cache.clone();
+                std::thread::spawn(move || {
+                    for _ in 0..50 {
+                        add_test_vote(&cache, &BlockHash::random(), Amount::raw(1));
+                    }
+                })
+            })
+            .collect();
+        for handle in handles {
+            handle.join().unwrap();
+        }
+        assert_eq!(cache.size(), 200);
+    }
+
+    fn add_test_vote(cache: &VoteCache, hash: &BlockHash, rep_weight: Amount) {
         let vote = create_vote(&PrivateKey::new(), &hash, 0);
         cache.insert(&vote, rep_weight, &HashMap::new());
     }
 
-    fn add_test_final_vote(cache: &mut VoteCache, hash: &BlockHash, rep_weight: Amount) {
+    fn add_test_final_vote(cache: &VoteCache, hash: &BlockHash, rep_weight: Amount) {
         let vote = create_final_vote(&PrivateKey::new(), &hash);
         cache.insert(&vote, rep_weight, &HashMap::new());
     }
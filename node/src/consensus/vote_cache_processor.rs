@@ -11,7 +11,7 @@ pub(crate) struct VoteCacheProcessor {
     state: Arc<Mutex<State>>,
     condition: Arc<Condvar>,
     stats: Arc<Stats>,
-    vote_cache: Arc<Mutex<VoteCache>>,
+    vote_cache: Arc<VoteCache>,
     vote_router: Arc<VoteRouter>,
     config: VoteProcessorConfig,
 }
@@ -19,7 +19,7 @@ pub(crate) struct VoteCacheProcessor {
 impl VoteCacheProcessor {
     pub(crate) fn new(
         stats: Arc<Stats>,
-        vote_cache: Arc<Mutex<VoteCache>>,
+        vote_cache: Arc<VoteCache>,
         vote_router: Arc<VoteRouter>,
         config: VoteProcessorConfig,
     ) -> Self {
@@ -111,7 +111,7 @@ struct VoteCacheLoop {
     state: Arc<Mutex<State>>,
     condition: Arc<Condvar>,
     stats: Arc<Stats>,
-    vote_cache: Arc<Mutex<VoteCache>>,
+    vote_cache: Arc<VoteCache>,
     vote_router: Arc<VoteRouter>,
 }
 
@@ -146,7 +146,7 @@ impl VoteCacheLoop {
         );
 
         for hash in hashes {
-            let cached = self.vote_cache.lock().unwrap().find(&hash);
+            let cached = self.vote_cache.find(&hash);
             for cached_vote in cached {
                 self.vote_router
                     .vote_filter(&cached_vote, VoteSource::Cache, &hash);
@@ -38,7 +38,27 @@ impl LocalVoteHistory {
 
     pub fn add(&self, root: &Root, hash: &BlockHash, vote: &Arc<Vote>) {
         let mut data_lk = self.data.lock().unwrap();
-        let data: &mut LocalVoteHistoryData = &mut data_lk;
+        self.add_locked(&mut data_lk, root, hash, vote);
+    }
+
+    /// Adds every vote for every (root, hash) pair while taking the lock only once
+    pub fn add_batch(&self, roots: &[Root], hashes: &[BlockHash], votes: &[Arc<Vote>]) {
+        debug_assert_eq!(roots.len(), hashes.len());
+        let mut data_lk = self.data.lock().unwrap();
+        for vote in votes {
+            for (root, hash) in roots.iter().zip(hashes) {
+                self.add_locked(&mut data_lk, root, hash, vote);
+            }
+        }
+    }
+
+    fn add_locked(
+        &self,
+        data: &mut LocalVoteHistoryData,
+        root: &Root,
+        hash: &BlockHash,
+        vote: &Arc<Vote>,
+    ) {
         clean(data, self.max_cache);
 
         let mut add_vote = true;
@@ -251,4 +271,21 @@ mod tests {
         assert_eq!(votes.len(), 1);
         assert!(Arc::ptr_eq(&votes[0], &vote3));
     }
+
+    #[test]
+    fn add_batch() {
+        let history = LocalVoteHistory::new(256);
+        let roots = [Root::from(1), Root::from(2)];
+        let hashes = [BlockHash::from(3), BlockHash::from(4)];
+        let votes = [
+            Arc::new(Vote::new(&PrivateKey::new(), 0, 0, hashes.to_vec())),
+            Arc::new(Vote::new(&PrivateKey::new(), 0, 0, hashes.to_vec())),
+        ];
+
+        history.add_batch(&roots, &hashes, &votes);
+
+        assert_eq!(history.size(), 4);
+        assert_eq!(history.votes(&roots[0], &hashes[0], false).len(), 2);
+        assert_eq!(history.votes(&roots[1], &hashes[1], false).len(), 2);
+    }
 }
@@ -3,6 +3,7 @@ mod request_aggregator;
 mod request_aggregator_impl;
 mod vote_generator;
 mod vote_generators;
+mod vote_signer;
 mod vote_spacing;
 
 pub use local_vote_history::*;
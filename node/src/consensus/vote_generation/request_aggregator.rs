@@ -6,14 +6,15 @@ use crate::{
     stats::{DetailType, Direction, StatType, Stats},
     transport::FairQueue,
 };
-use rsnano_core::{utils::ContainerInfo, BlockHash, Root};
+use rsnano_core::{utils::ContainerInfo, BlockHash, Root, SavedBlock};
 use rsnano_ledger::Ledger;
 use rsnano_network::{ChannelId, DeadChannelCleanupStep, NetworkInfo, TrafficType};
-use rsnano_store_lmdb::{LmdbReadTransaction, Transaction};
+use rsnano_store_lmdb::Transaction;
 use std::{
     cmp::{max, min},
     sync::{Arc, Condvar, Mutex, MutexGuard, RwLock},
     thread::JoinHandle,
+    time::Duration,
 };
 
 #[derive(Clone, Debug, PartialEq)]
@@ -21,6 +22,9 @@ pub struct RequestAggregatorConfig {
     pub threads: usize,
     pub max_queue: usize,
     pub batch_size: usize,
+    /// How long to wait for more requests before a batch that isn't full is processed.
+    /// Requests of different channels for the same blocks are answered together within a batch
+    pub coalescing_window: Duration,
 }
 
 impl RequestAggregatorConfig {
@@ -29,6 +33,7 @@ impl RequestAggregatorConfig {
             threads: max(1, min(parallelism / 2, 4)),
             max_queue: 128,
             batch_size: 16,
+            coalescing_window: Duration::from_millis(5),
         }
     }
 }
@@ -197,6 +202,16 @@ impl RequestAggregatorLoop {
         let mut guard = self.mutex.lock().unwrap();
         while !guard.stopped {
             if !guard.queue.is_empty() {
+                guard = self
+                    .condition
+                    .wait_timeout_while(guard, self.config.coalescing_window, |g| {
+                        !g.stopped && g.queue.len() < self.config.batch_size
+                    })
+                    .unwrap()
+                    .0;
+                if guard.stopped {
+                    break;
+                }
                 guard = self.run_batch(guard);
             } else {
                 guard = self
@@ -215,6 +230,7 @@ impl RequestAggregatorLoop {
         drop(state);
 
         let mut tx = self.ledger.read_txn();
+        let mut aggregator = RequestAggregatorImpl::new(&self.ledger, &self.stats);
 
         for (channel_id, request) in &batch {
             tx.refresh_if_needed();
@@ -226,7 +242,7 @@ impl RequestAggregatorLoop {
                 .is_queue_full(*channel_id, TrafficType::Generic);
 
             if !queue_full {
-                self.process(&tx, request, *channel_id);
+                aggregator.add_votes(&tx, *channel_id, request);
             } else {
                 self.stats.inc_dir(
                     StatType::RequestAggregator,
@@ -235,53 +251,57 @@ impl RequestAggregatorLoop {
                 );
             }
         }
+        drop(tx);
+
+        self.generate(aggregator.get_result());
 
         self.mutex.lock().unwrap()
     }
 
-    fn process(&self, tx: &LmdbReadTransaction, request: &RequestType, channel_id: ChannelId) {
-        let remaining = self.aggregate(tx, request);
-
+    /// Generate votes for the blocks which were requested by the channels of a batch
+    fn generate(&self, remaining: AggregateResult) {
         if !remaining.remaining_normal.is_empty() {
-            self.stats
-                .inc(StatType::RequestAggregatorReplies, DetailType::NormalVote);
+            self.stats.add(
+                StatType::RequestAggregatorReplies,
+                DetailType::NormalVote,
+                remaining.remaining_normal.len() as u64,
+            );
 
             // Generate votes for the remaining hashes
             let generated = self
                 .vote_generators
-                .generate_non_final_votes(&remaining.remaining_normal, channel_id);
+                .generate_non_final_votes(&remaining.remaining_normal);
             self.stats.add_dir(
                 StatType::Requests,
                 DetailType::RequestsCannotVote,
                 Direction::In,
-                (remaining.remaining_normal.len() - generated) as u64,
+                (block_count(&remaining.remaining_normal) - generated) as u64,
             );
         }
 
         if !remaining.remaining_final.is_empty() {
-            self.stats
-                .inc(StatType::RequestAggregatorReplies, DetailType::FinalVote);
+            self.stats.add(
+                StatType::RequestAggregatorReplies,
+                DetailType::FinalVote,
+                remaining.remaining_final.len() as u64,
+            );
 
             // Generate final votes for the remaining hashes
             let generated = self
                 .vote_generators
-                .generate_final_votes(&remaining.remaining_final, channel_id);
+                .generate_final_votes(&remaining.remaining_final);
             self.stats.add_dir(
                 StatType::Requests,
                 DetailType::RequestsCannotVote,
                 Direction::In,
-                (remaining.remaining_final.len() - generated) as u64,
+                (block_count(&remaining.remaining_final) - generated) as u64,
             );
         }
     }
+}
 
-    /// Aggregate requests and send cached votes to channel.
-    /// Return the remaining hashes that need vote generation for each block for regular & final vote generators
-    fn aggregate(&self, tx: &LmdbReadTransaction, requests: &RequestType) -> AggregateResult {
-        let mut aggregator = RequestAggregatorImpl::new(&self.ledger, &self.stats, tx);
-        aggregator.add_votes(requests);
-        aggregator.get_result()
-    }
+fn block_count(requests: &[(ChannelId, Vec<SavedBlock>)]) -> usize {
+    requests.iter().map(|(_, blocks)| blocks.len()).sum()
 }
 
 pub(crate) struct RequestAggregatorCleanup {
@@ -1,70 +1,115 @@
 use crate::stats::{DetailType, StatType, Stats};
 use rsnano_core::{Block, BlockHash, Root, SavedBlock};
 use rsnano_ledger::Ledger;
+use rsnano_network::ChannelId;
 use rsnano_store_lmdb::LmdbReadTransaction;
+use std::collections::HashMap;
 
+/// The outcome of the ledger lookup for a requested (hash, root) pair
+#[derive(Clone)]
+enum Lookup {
+    Final(SavedBlock),
+    NonFinal,
+    Unknown,
+}
+
+/// Aggregates the requests of a batch. Many peers ask for the same roots at
+/// the same time, so the ledger is only queried once per (hash, root) pair
+/// of the batch, no matter how many channels requested it.
 pub(super) struct RequestAggregatorImpl<'a> {
     ledger: &'a Ledger,
     stats: &'a Stats,
-    tx: &'a LmdbReadTransaction,
+    lookups: HashMap<(BlockHash, Root), Lookup>,
 
-    pub to_generate: Vec<SavedBlock>,
-    pub to_generate_final: Vec<SavedBlock>,
+    pub to_generate: Vec<(ChannelId, Vec<SavedBlock>)>,
+    pub to_generate_final: Vec<(ChannelId, Vec<SavedBlock>)>,
 }
 
 impl<'a> RequestAggregatorImpl<'a> {
-    pub fn new(ledger: &'a Ledger, stats: &'a Stats, tx: &'a LmdbReadTransaction) -> Self {
+    pub fn new(ledger: &'a Ledger, stats: &'a Stats) -> Self {
         Self {
             ledger,
             stats,
-            tx,
+            lookups: HashMap::new(),
             to_generate: Vec::new(),
             to_generate_final: Vec::new(),
         }
     }
 
-    pub fn add_votes(&mut self, requests: &[(BlockHash, Root)]) {
+    pub fn add_votes(
+        &mut self,
+        tx: &LmdbReadTransaction,
+        channel_id: ChannelId,
+        requests: &[(BlockHash, Root)],
+    ) {
+        let mut to_generate_final = Vec::new();
         for (hash, root) in requests {
-            // Ledger by hash
-            let mut block = self.ledger.any().get_block(self.tx, hash);
-
-            // Ledger by root
-            if block.is_none() && !root.is_zero() {
-                // Search for block root
-                if let Some(successor) = self.ledger.any().block_successor(self.tx, &(*root).into())
-                {
-                    block = self.ledger.any().get_block(self.tx, &successor);
+            let lookup = match self.lookups.get(&(*hash, *root)) {
+                Some(lookup) => {
+                    self.stats
+                        .inc(StatType::Requests, DetailType::RequestsCachedHashes);
+                    lookup.clone()
                 }
-            }
-
-            let should_generate_final_vote = |block: &Block| {
-                // Check if final vote is set for this block
-                if let Some(final_hash) = self
-                    .ledger
-                    .store
-                    .final_vote
-                    .get(self.tx, &block.qualified_root())
-                {
-                    final_hash == block.hash()
-                } else {
-                    // If the final vote is not set, generate vote if the block is confirmed
-                    self.ledger.confirmed().block_exists(self.tx, &block.hash())
+                None => {
+                    let lookup = self.lookup(tx, hash, root);
+                    self.lookups.insert((*hash, *root), lookup.clone());
+                    lookup
                 }
             };
 
-            if let Some(block) = block {
-                if should_generate_final_vote(&block) {
-                    self.to_generate_final.push(block);
+            match lookup {
+                Lookup::Final(block) => {
+                    to_generate_final.push(block);
                     self.stats
                         .inc(StatType::Requests, DetailType::RequestsFinal);
-                } else {
+                }
+                Lookup::NonFinal => {
                     self.stats
                         .inc(StatType::Requests, DetailType::RequestsNonFinal);
                 }
+                Lookup::Unknown => {
+                    self.stats
+                        .inc(StatType::Requests, DetailType::RequestsUnknown);
+                }
+            }
+        }
+
+        if !to_generate_final.is_empty() {
+            self.to_generate_final.push((channel_id, to_generate_final));
+        }
+    }
+
+    fn lookup(&self, tx: &LmdbReadTransaction, hash: &BlockHash, root: &Root) -> Lookup {
+        // Ledger by hash
+        let mut block = self.ledger.any().get_block(tx, hash);
+
+        // Ledger by root
+        if block.is_none() && !root.is_zero() {
+            // Search for block root
+            if let Some(successor) = self.ledger.any().block_successor(tx, &(*root).into()) {
+                block = self.ledger.any().get_block(tx, &successor);
+            }
+        }
+
+        let should_generate_final_vote = |block: &Block| {
+            // Check if final vote is set for this block
+            if let Some(final_hash) = self
+                .ledger
+                .store
+                .final_vote
+                .get(tx, &block.qualified_root())
+            {
+                final_hash == block.hash()
             } else {
-                self.stats
-                    .inc(StatType::Requests, DetailType::RequestsUnknown);
+                // If the final vote is not set, generate vote if the block is confirmed
+                self.ledger.confirmed().block_exists(tx, &block.hash())
             }
+        };
+
+        match block {
+            Some(block) if should_generate_final_vote(&block) => Lookup::Final(block),
+            Some(_) => Lookup::NonFinal,
+            None => Lookup::Unknown,
         }
     }
 
@@ -77,6 +122,6 @@ impl<'a> RequestAggregatorImpl<'a> {
 }
 
 pub(super) struct AggregateResult {
-    pub remaining_normal: Vec<SavedBlock>,
-    pub remaining_final: Vec<SavedBlock>,
+    pub remaining_normal: Vec<(ChannelId, Vec<SavedBlock>)>,
+    pub remaining_final: Vec<(ChannelId, Vec<SavedBlock>)>,
 }
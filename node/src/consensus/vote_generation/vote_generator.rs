@@ -1,4 +1,4 @@
-use super::{LocalVoteHistory, VoteSpacing};
+use super::{vote_signer::VoteSigner, LocalVoteHistory, VoteSpacing};
 use crate::{
     consensus::VoteBroadcaster,
     stats::{DetailType, Direction, Sample, StatType, Stats},
@@ -8,14 +8,15 @@ use crate::{
 };
 use rsnano_core::{
     utils::{milliseconds_since_epoch, ContainerInfo},
-    BlockHash, Root, SavedBlock, Vote,
+    BlockHash, PrivateKey, Root, SavedBlock, Vote,
 };
 use rsnano_ledger::{Ledger, Writer};
 use rsnano_messages::{ConfirmAck, Message};
 use rsnano_network::{ChannelId, DropPolicy, TrafficType};
 use rsnano_store_lmdb::{LmdbReadTransaction, LmdbWriteTransaction, Transaction};
 use std::{
-    collections::VecDeque,
+    cmp::min,
+    collections::{HashMap, VecDeque},
     mem::size_of,
     sync::{
         atomic::{AtomicBool, Ordering},
@@ -36,6 +37,8 @@ pub(crate) struct VoteGenerator {
 impl VoteGenerator {
     const MAX_REQUESTS: usize = 2048;
     const MAX_HASHES: usize = 255;
+    /// Maximum number of queued requests which are answered together
+    const MAX_COALESCED_REQUESTS: usize = 64;
 
     pub(crate) fn new(
         ledger: Arc<Ledger>,
@@ -47,6 +50,7 @@ impl VoteGenerator {
         voting_delay: Duration,
         vote_generator_delay: Duration,
         vote_broadcaster: Arc<VoteBroadcaster>,
+        signer: Arc<VoteSigner>,
     ) -> Self {
         let shared_state = Arc::new(SharedState {
             ledger: Arc::clone(&ledger),
@@ -65,6 +69,7 @@ impl VoteGenerator {
             vote_broadcaster,
             spacing: Mutex::new(VoteSpacing::new(voting_delay)),
             vote_generator_delay,
+            signer,
         });
 
         let shared_state_clone = Arc::clone(&shared_state);
@@ -116,25 +121,32 @@ impl VoteGenerator {
         self.vote_generation_queue.add((*root, *hash));
     }
 
-    /// Queue blocks for vote generation, returning the number of successful candidates.
-    pub(crate) fn generate(&self, blocks: &[SavedBlock], channel_id: ChannelId) -> usize {
-        let req_candidates = {
+    /// Queue the blocks requested by each channel for vote generation,
+    /// returning the number of successful candidates.
+    pub(crate) fn generate(&self, requests: &[(ChannelId, Vec<SavedBlock>)]) -> usize {
+        let mut result = 0;
+        let mut req_candidates = Vec::with_capacity(requests.len());
+        {
             let txn = self.ledger.read_txn();
-            blocks
-                .iter()
-                .filter_map(|i| {
-                    if self.ledger.dependents_confirmed(&txn, i) {
-                        Some((i.root(), i.hash()))
-                    } else {
-                        None
-                    }
-                })
-                .collect::<Vec<_>>()
-        };
+            // The requests of different channels usually ask for the same blocks
+            let mut dependents_confirmed = HashMap::new();
+            for (channel_id, blocks) in requests {
+                let candidates = blocks
+                    .iter()
+                    .filter(|block| {
+                        *dependents_confirmed
+                            .entry(block.hash())
+                            .or_insert_with(|| self.ledger.dependents_confirmed(&txn, block))
+                    })
+                    .map(|block| (block.root(), block.hash()))
+                    .collect::<Vec<_>>();
+                result += candidates.len();
+                req_candidates.push((candidates, *channel_id));
+            }
+        }
 
-        let result = req_candidates.len();
         let mut guard = self.shared_state.queues.lock().unwrap();
-        guard.requests.push_back((req_candidates, channel_id));
+        guard.requests.extend(req_candidates);
         while guard.requests.len() > Self::MAX_REQUESTS {
             // On a large queue of requests, erase the oldest one
             guard.requests.pop_front();
@@ -191,6 +203,7 @@ struct SharedState {
     vote_broadcaster: Arc<VoteBroadcaster>,
     spacing: Mutex<VoteSpacing>,
     vote_generator_delay: Duration,
+    signer: Arc<VoteSigner>,
 }
 
 impl SharedState {
@@ -216,9 +229,13 @@ impl SharedState {
                 queues.next_broadcast = Instant::now() + self.vote_generator_delay;
             }
 
-            if let Some(request) = queues.requests.pop_front() {
+            if !queues.requests.is_empty() {
+                // Requests which piled up are answered together, so that
+                // the channels asking for the same blocks share the votes
+                let count = min(queues.requests.len(), VoteGenerator::MAX_COALESCED_REQUESTS);
+                let requests = queues.requests.drain(..count).collect::<Vec<_>>();
                 drop(queues);
-                self.reply(request);
+                self.reply(requests);
                 queues = self.queues.lock().unwrap();
             }
         }
@@ -247,7 +264,8 @@ impl SharedState {
 
         if !hashes.is_empty() {
             drop(queues);
-            self.vote(&hashes, &roots, |generated_vote| {
+            let keys = self.representatives();
+            self.vote(&keys, &hashes, &roots, |generated_vote| {
                 self.stats
                     .inc(StatType::VoteGenerator, DetailType::GeneratorBroadcasts);
                 let sample = if self.is_final {
@@ -268,45 +286,128 @@ impl SharedState {
         queues
     }
 
-    fn vote<F>(&self, hashes: &Vec<BlockHash>, roots: &Vec<Root>, action: F)
+    fn representatives(&self) -> Vec<PrivateKey> {
+        let mut keys = Vec::new();
+        self.wallets
+            .foreach_representative(|key| keys.push(key.clone()));
+        keys
+    }
+
+    fn vote<F>(&self, keys: &[PrivateKey], hashes: &Vec<BlockHash>, roots: &Vec<Root>, action: F)
     where
         F: Fn(Arc<Vote>),
     {
         debug_assert_eq!(hashes.len(), roots.len());
-        let mut votes = Vec::new();
-        self.wallets.foreach_representative(|keys| {
-            let timestamp = if self.is_final {
-                Vote::TIMESTAMP_MAX
-            } else {
-                milliseconds_since_epoch()
-            };
-            let duration = if self.is_final {
-                Vote::DURATION_MAX
-            } else {
-                0x9 /*8192ms*/
-            };
-            votes.push(Arc::new(Vote::new(
-                keys,
-                timestamp,
-                duration,
-                hashes.clone(),
-            )));
-        });
+        if keys.is_empty() {
+            return;
+        }
+
+        let timestamp = if self.is_final {
+            Vote::TIMESTAMP_MAX
+        } else {
+            milliseconds_since_epoch()
+        };
+        let duration = if self.is_final {
+            Vote::DURATION_MAX
+        } else {
+            0x9 /*8192ms*/
+        };
+        let votes = self.signer.sign(keys, timestamp, duration, hashes);
+
+        self.history.add_batch(roots, hashes, &votes);
+        self.spacing.lock().unwrap().flag_batch(roots, hashes);
 
         for vote in votes {
-            {
-                let mut spacing = self.spacing.lock().unwrap();
-                for i in 0..hashes.len() {
-                    self.history.add(&roots[i], &hashes[i], &vote);
-                    spacing.flag(&roots[i], &hashes[i]);
+            action(vote);
+        }
+    }
+
+    fn reply(&self, requests: Vec<(Vec<(Root, BlockHash)>, ChannelId)>) {
+        let keys = self.representatives();
+
+        // Collect the channels which requested each (root, hash) pair
+        let mut pairs = Vec::new();
+        let mut channels_by_pair: HashMap<(Root, BlockHash), Vec<ChannelId>> = HashMap::new();
+        for (candidates, channel_id) in &requests {
+            for pair in candidates {
+                let channels = channels_by_pair.entry(*pair).or_insert_with(|| {
+                    pairs.push(*pair);
+                    Vec::new()
+                });
+                if !channels.contains(channel_id) {
+                    channels.push(*channel_id);
                 }
             }
-            action(vote);
         }
+
+        // Pairs requested by the same set of channels can be answered with the same votes
+        let mut groups: Vec<ReplyGroup> = Vec::new();
+        let mut group_index: HashMap<Vec<ChannelId>, usize> = HashMap::new();
+        for pair in pairs {
+            let mut channels = channels_by_pair.remove(&pair).unwrap();
+            channels.sort();
+            let index = *group_index.entry(channels.clone()).or_insert_with(|| {
+                groups.push(ReplyGroup::new(channels));
+                groups.len() - 1
+            });
+            let group = &mut groups[index];
+
+            if self.is_final {
+                // Final votes never change, so the ones in the history can be sent again
+                let cached = self.history.votes(&pair.0, &pair.1, true);
+                if !keys.is_empty()
+                    && keys.iter().all(|key| {
+                        cached
+                            .iter()
+                            .any(|vote| vote.voting_account == key.public_key())
+                    })
+                {
+                    for vote in cached {
+                        if !group.cached.iter().any(|i| Arc::ptr_eq(i, &vote)) {
+                            group.cached.push(vote);
+                        }
+                    }
+                    continue;
+                }
+            }
+            group.pairs.push(pair);
+        }
+
+        for group in &groups {
+            if self.stopped.load(Ordering::SeqCst) {
+                break;
+            }
+            self.send_cached(group);
+            self.reply_group(&keys, group);
+        }
+
+        self.stats.add(
+            StatType::VoteGenerator,
+            DetailType::GeneratorReplies,
+            requests.len() as u64,
+        );
     }
 
-    fn reply(&self, request: (Vec<(Root, BlockHash)>, ChannelId)) {
-        let mut i = request.0.iter().peekable();
+    fn send_cached(&self, group: &ReplyGroup) {
+        for vote in &group.cached {
+            let confirm = Message::ConfirmAck(ConfirmAck::new_with_own_vote((**vote).clone()));
+            self.message_publisher.lock().unwrap().try_broadcast(
+                group.channels.iter().copied(),
+                &confirm,
+                DropPolicy::CanDrop,
+                TrafficType::Generic,
+            );
+            self.stats.add_dir(
+                StatType::Requests,
+                DetailType::RequestsCachedVotes,
+                Direction::In,
+                group.channels.len() as u64,
+            );
+        }
+    }
+
+    fn reply_group(&self, keys: &[PrivateKey], group: &ReplyGroup) {
+        let mut i = group.pairs.iter().peekable();
         while i.peek().is_some() && !self.stopped.load(Ordering::SeqCst) {
             let mut hashes = Vec::with_capacity(VoteGenerator::MAX_HASHES);
             let mut roots = Vec::with_capacity(VoteGenerator::MAX_HASHES);
@@ -334,29 +435,28 @@ impl SharedState {
                     Direction::In,
                     hashes.len() as u64,
                 );
-                self.vote(&hashes, &roots, |vote| {
-                    let channel_id = &request.1;
+                self.vote(keys, &hashes, &roots, |vote| {
+                    // The message is serialized once for all channels of the group
                     let confirm =
                         Message::ConfirmAck(ConfirmAck::new_with_own_vote((*vote).clone()));
-                    self.message_publisher.lock().unwrap().try_send(
-                        *channel_id,
+                    self.message_publisher.lock().unwrap().try_broadcast(
+                        group.channels.iter().copied(),
                         &confirm,
                         DropPolicy::CanDrop,
                         TrafficType::Generic,
                     );
-                    self.stats.inc_dir(
+                    self.stats.add_dir(
                         StatType::Requests,
                         DetailType::RequestsGeneratedVotes,
                         Direction::In,
+                        group.channels.len() as u64,
                     );
                 });
             }
         }
-        self.stats
-            .inc(StatType::VoteGenerator, DetailType::GeneratorReplies);
     }
 
-    fn process_batch(&self, batch: VecDeque<(Root, BlockHash)>) {
+    fn process_batch(self: &Arc<Self>, batch: VecDeque<(Root, BlockHash)>) {
         let mut verified = VecDeque::new();
 
         if self.is_final {
@@ -368,6 +468,16 @@ impl SharedState {
                     verified.push_back((*root, *hash));
                 }
             }
+            tx.commit();
+
+            // The final votes may only be sent once they are on disk. Otherwise the node
+            // could sign a conflicting final vote for the same root after a crash
+            let self_w = Arc::downgrade(self);
+            write_guard.on_durable(Box::new(move || {
+                if let Some(self_l) = self_w.upgrade() {
+                    self_l.submit_candidates(verified);
+                }
+            }));
         } else {
             let mut tx = self.ledger.read_txn();
             for (root, hash) in &batch {
@@ -376,9 +486,12 @@ impl SharedState {
                     verified.push_back((*root, *hash));
                 }
             }
-        };
+            self.submit_candidates(verified);
+        }
+    }
 
-        // Submit verified candidates to the main processing thread
+    /// Submit verified candidates to the main processing thread
+    fn submit_candidates(&self, verified: VecDeque<(Root, BlockHash)>) {
         if !verified.is_empty() {
             let should_notify = {
                 let mut queues = self.queues.lock().unwrap();
@@ -424,6 +537,24 @@ impl SharedState {
     }
 }
 
+/// The requested pairs which are answered with the same votes,
+/// because the same channels asked for them
+struct ReplyGroup {
+    channels: Vec<ChannelId>,
+    pairs: Vec<(Root, BlockHash)>,
+    cached: Vec<Arc<Vote>>,
+}
+
+impl ReplyGroup {
+    fn new(channels: Vec<ChannelId>) -> Self {
+        Self {
+            channels,
+            pairs: Vec::new(),
+            cached: Vec::new(),
+        }
+    }
+}
+
 struct Queues {
     candidates: VecDeque<(Root, BlockHash)>,
     requests: VecDeque<(Vec<(Root, BlockHash)>, ChannelId)>,
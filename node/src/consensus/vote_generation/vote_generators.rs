@@ -1,4 +1,4 @@
-use super::{vote_generator::VoteGenerator, LocalVoteHistory};
+use super::{vote_generator::VoteGenerator, vote_signer::VoteSigner, LocalVoteHistory};
 use crate::{
     config::NodeConfig, consensus::VoteBroadcaster, stats::Stats, transport::MessagePublisher,
     wallets::Wallets, NetworkParams,
@@ -24,6 +24,8 @@ impl VoteGenerators {
         vote_broadcaster: Arc<VoteBroadcaster>,
         message_publisher: MessagePublisher,
     ) -> Self {
+        // Both generators sign on the same worker threads
+        let signer = Arc::new(VoteSigner::new(config.vote_signer_threads as usize));
         let non_final_vote_generator = VoteGenerator::new(
             ledger.clone(),
             wallets.clone(),
@@ -34,6 +36,7 @@ impl VoteGenerators {
             Duration::from_secs(network_params.voting.delay_s as u64),
             Duration::from_millis(config.vote_generator_delay_ms as u64),
             vote_broadcaster.clone(),
+            signer.clone(),
         );
 
         let final_vote_generator = VoteGenerator::new(
@@ -46,6 +49,7 @@ impl VoteGenerators {
             Duration::from_secs(network_params.voting.delay_s as u64),
             Duration::from_millis(config.vote_generator_delay_ms as u64),
             vote_broadcaster,
+            signer,
         );
 
         Self {
@@ -68,20 +72,16 @@ impl VoteGenerators {
         self.final_vote_generator.add(root, hash);
     }
 
-    pub(crate) fn generate_final_votes(
-        &self,
-        blocks: &[SavedBlock],
-        channel_id: ChannelId,
-    ) -> usize {
-        self.final_vote_generator.generate(blocks, channel_id)
+    pub(crate) fn generate_final_votes(&self, requests: &[(ChannelId, Vec<SavedBlock>)]) -> usize {
+        self.final_vote_generator.generate(requests)
     }
 
     pub fn generate_non_final_vote(&self, root: &Root, hash: &BlockHash) {
         self.non_final_vote_generator.add(root, hash);
     }
 
-    pub fn generate_non_final_votes(&self, blocks: &[SavedBlock], channel_id: ChannelId) -> usize {
-        self.non_final_vote_generator.generate(blocks, channel_id)
+    pub fn generate_non_final_votes(&self, requests: &[(ChannelId, Vec<SavedBlock>)]) -> usize {
+        self.non_final_vote_generator.generate(requests)
     }
 
     pub(crate) fn container_info(&self) -> ContainerInfo {
@@ -0,0 +1,110 @@
+use rsnano_core::{BlockHash, PrivateKey, Vote};
+use scoped_threadpool::Pool;
+use std::{
+    cmp::min,
+    sync::{Arc, Mutex},
+};
+
+/// Signs the votes of all local representatives for one batch of hashes in parallel.
+/// The representatives are split into one chunk per thread. One chunk is signed on the
+/// calling thread and the others on a persistent pool of worker threads.
+/// The pool is shared by the vote generators. A generator which finds it busy signs all
+/// its votes on the calling thread.
+pub(crate) struct VoteSigner {
+    num_threads: usize,
+    pool: Option<Mutex<Pool>>,
+}
+
+impl VoteSigner {
+    /// With 0 threads all votes get signed on the calling thread
+    pub fn new(num_threads: usize) -> Self {
+        Self {
+            num_threads,
+            pool: (num_threads > 0).then(|| Mutex::new(Pool::new(num_threads as u32))),
+        }
+    }
+
+    /// Returns the votes in the same order as the keys
+    pub fn sign(
+        &self,
+        keys: &[PrivateKey],
+        timestamp: u64,
+        duration: u8,
+        hashes: &[BlockHash],
+    ) -> Vec<Arc<Vote>> {
+        let sign_chunk = |chunk: &[PrivateKey]| -> Vec<Arc<Vote>> {
+            chunk
+                .iter()
+                .map(|key| Arc::new(Vote::new(key, timestamp, duration, hashes.to_vec())))
+                .collect()
+        };
+
+        // A signature takes long enough to be worth handing even a single key to a worker
+        let chunk_count = min(self.num_threads + 1, keys.len());
+        if chunk_count <= 1 {
+            return sign_chunk(keys);
+        }
+
+        let Some(Ok(mut pool)) = self.pool.as_ref().map(|p| p.try_lock()) else {
+            return sign_chunk(keys);
+        };
+
+        let chunk_size = keys.len().div_ceil(chunk_count);
+        let sign_chunk = &sign_chunk;
+        let mut votes: Vec<Vec<Arc<Vote>>> = (0..chunk_count).map(|_| Vec::new()).collect();
+
+        pool.scoped(|scope| {
+            let mut chunks = keys.chunks(chunk_size);
+            let own_chunk = chunks.next().unwrap();
+            let (own_votes, other_votes) = votes.split_first_mut().unwrap();
+
+            for (chunk, votes) in chunks.zip(other_votes.iter_mut()) {
+                scope.execute(move || *votes = sign_chunk(chunk));
+            }
+
+            *own_votes = sign_chunk(own_chunk);
+        });
+
+        votes.into_iter().flatten().collect()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn no_representatives() {
+        let signer = VoteSigner::new(4);
+        let votes = signer.sign(&[], Vote::TIMESTAMP_MAX, Vote::DURATION_MAX, &[1.into()]);
+        assert!(votes.is_empty());
+    }
+
+    #[test]
+    fn sign_in_order_of_keys() {
+        let signer = VoteSigner::new(3);
+        let keys: Vec<_> = (0..11).map(|_| PrivateKey::new()).collect();
+        let hashes = vec![BlockHash::from(1), BlockHash::from(2)];
+
+        let votes = signer.sign(&keys, Vote::TIMESTAMP_MAX, Vote::DURATION_MAX, &hashes);
+
+        assert_eq!(votes.len(), keys.len());
+        for (vote, key) in votes.iter().zip(&keys) {
+            assert_eq!(vote.voting_account, key.public_key());
+            assert_eq!(vote.hashes, hashes);
+            assert!(vote.validate().is_ok());
+        }
+    }
+
+    #[test]
+    fn split_few_representatives() {
+        let signer = VoteSigner::new(1);
+        let keys = vec![PrivateKey::new(), PrivateKey::new()];
+
+        let votes = signer.sign(&keys, Vote::TIMESTAMP_MAX, Vote::DURATION_MAX, &[1.into()]);
+
+        assert_eq!(votes.len(), 2);
+        assert_eq!(votes[0].voting_account, keys[0].public_key());
+        assert_eq!(votes[1].voting_account, keys[1].public_key());
+    }
+}
@@ -28,8 +28,21 @@ impl VoteSpacing {
     }
 
     pub fn flag(&mut self, root: &Root, hash: &BlockHash) {
+        self.trim();
+        self.flag_at(root, hash, Instant::now());
+    }
+
+    /// Flags all (root, hash) pairs of a generated batch of votes
+    pub fn flag_batch(&mut self, roots: &[Root], hashes: &[BlockHash]) {
+        debug_assert_eq!(roots.len(), hashes.len());
         self.trim();
         let time = Instant::now();
+        for (root, hash) in roots.iter().zip(hashes) {
+            self.flag_at(root, hash, time);
+        }
+    }
+
+    fn flag_at(&mut self, root: &Root, hash: &BlockHash, time: Instant) {
         if !self.recent.change_time_for_root(root, time) {
             self.recent.insert(Entry {
                 root: *root,
@@ -214,6 +227,19 @@ mod tests {
         assert_eq!(spacing.len(), 2);
     }
 
+    #[test]
+    fn flag_batch() {
+        let mut spacing = VoteSpacing::new(Duration::from_millis(100));
+        let roots = [Root::from(1), Root::from(2)];
+        let hashes = [BlockHash::from(3), BlockHash::from(4)];
+
+        spacing.flag_batch(&roots, &hashes);
+
+        assert_eq!(spacing.len(), 2);
+        assert!(spacing.votable(&roots[0], &hashes[0]));
+        assert!(!spacing.votable(&roots[1], &BlockHash::from(5)));
+    }
+
     #[test]
     fn prune() {
         let length = Duration::from_millis(100);
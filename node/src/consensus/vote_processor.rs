@@ -1,6 +1,9 @@
 use super::{VoteProcessorQueue, VoteRouter};
-use crate::stats::{DetailType, StatType, Stats};
-use rsnano_core::{Vote, VoteCode, VoteSource};
+use crate::{
+    stats::{DetailType, StatType, Stats},
+    utils::{place_current_thread, SignatureChecker},
+};
+use rsnano_core::{utils::ThreadRole, Vote, VoteCode, VoteSource};
 use rsnano_network::ChannelId;
 use std::{
     cmp::{max, min},
@@ -44,6 +47,7 @@ pub struct VoteProcessor {
     queue: Arc<VoteProcessorQueue>,
     vote_router: Arc<VoteRouter>,
     stats: Arc<Stats>,
+    signature_checker: Arc<SignatureChecker>,
     vote_processed: Mutex<Vec<VoteProcessedCallback2>>,
     pub total_processed: AtomicU64,
 }
@@ -53,12 +57,14 @@ impl VoteProcessor {
         queue: Arc<VoteProcessorQueue>,
         vote_router: Arc<VoteRouter>,
         stats: Arc<Stats>,
+        signature_checker: Arc<SignatureChecker>,
         on_vote: VoteProcessedCallback2,
     ) -> Self {
         Self {
             queue,
             vote_router,
             stats,
+            signature_checker,
             vote_processed: Mutex::new(vec![on_vote]),
             threads: Mutex::new(Vec::new()),
             total_processed: AtomicU64::new(0),
@@ -82,15 +88,22 @@ impl VoteProcessor {
         loop {
             self.stats.inc(StatType::VoteProcessor, DetailType::Loop);
 
-            let batch = self.queue.wait_for_votes(self.queue.config.batch_size);
+            let mut batch = self.queue.wait_for_votes(self.queue.config.batch_size);
             if batch.is_empty() {
                 break; //stopped
             }
 
             let start = Instant::now();
 
-            for ((_, channel_id), (vote, source)) in &batch {
-                self.vote_blocking(vote, *channel_id, *source);
+            // Verify all signatures of the batch up front, so that it can be done in parallel
+            let batch = batch.make_contiguous();
+            let valid = self
+                .signature_checker
+                .verify(batch, |(_, (vote, _))| vote.validate().is_ok());
+
+            for (((_, channel_id), (vote, source)), valid) in batch.iter().zip(valid) {
+                self.vote_blocking_verified(vote, *channel_id, *source, valid);
+                self.stats.latency().vote_processed(vote);
             }
 
             self.total_processed
@@ -113,9 +126,20 @@ impl VoteProcessor {
         vote: &Arc<Vote>,
         channel_id: ChannelId,
         source: VoteSource,
+    ) -> VoteCode {
+        let signature_valid = vote.validate().is_ok();
+        self.vote_blocking_verified(vote, channel_id, source, signature_valid)
+    }
+
+    fn vote_blocking_verified(
+        &self,
+        vote: &Arc<Vote>,
+        channel_id: ChannelId,
+        source: VoteSource,
+        signature_valid: bool,
     ) -> VoteCode {
         let mut result = VoteCode::Invalid;
-        if vote.validate().is_ok() {
+        if signature_valid {
             let vote_results = self.vote_router.vote(vote, source);
 
             // Aggregate results for individual hashes
@@ -174,6 +198,7 @@ impl VoteProcessorExt for Arc<VoteProcessor> {
                 std::thread::Builder::new()
                     .name("Vote processing".to_string())
                     .spawn(Box::new(move || {
+                        place_current_thread(ThreadRole::VoteProcessor);
                         self_l.run();
                     }))
                     .unwrap(),
@@ -57,6 +57,7 @@ impl VoteProcessorQueue {
     /// Queue vote for processing. @returns true if the vote was queued
     pub fn vote(&self, vote: Arc<Vote>, channel_id: ChannelId, source: VoteSource) -> bool {
         let tier = self.rep_tiers.tier(&vote.voting_account);
+        self.stats.latency().vote_queued(&vote);
 
         let added = {
             let mut guard = self.data.lock().unwrap();
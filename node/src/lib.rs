@@ -8,6 +8,7 @@ extern crate anyhow;
 extern crate core;
 
 pub mod block_processing;
+mod block_table_migration;
 pub mod bootstrap;
 pub mod cementation;
 pub mod config;
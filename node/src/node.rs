@@ -1,8 +1,9 @@
 use crate::{
     block_processing::{
         BacklogPopulation, BlockProcessor, BlockProcessorCleanup, BlockSource,
-        LocalBlockBroadcaster, LocalBlockBroadcasterExt, UncheckedMap,
+        LocalBlockBroadcaster, LocalBlockBroadcasterExt, UncheckedMap, UncheckedMapConfig,
     },
+    block_table_migration::BlockTableMigration,
     bootstrap::{BootstrapExt, BootstrapServer, BootstrapServerCleanup, BootstrapService},
     cementation::ConfirmingSet,
     config::{GlobalConfig, NodeConfig, NodeFlags},
@@ -19,7 +20,7 @@ use crate::{
     pruning::{LedgerPruning, LedgerPruningExt},
     representatives::{OnlineReps, OnlineRepsCleanup, RepCrawler, RepCrawlerExt},
     stats::{
-        adapters::{LedgerStats, NetworkStats},
+        adapters::{LedgerStats, NetworkStats, StoreStats},
         DetailType, Direction, StatType, Stats,
     },
     transport::{
@@ -30,7 +31,8 @@ use crate::{
         RealtimeMessageHandler, SynCookies,
     },
     utils::{
-        LongRunningTransactionLogger, ThreadPool, ThreadPoolImpl, TimerThread, TxnTrackingConfig,
+        LongRunningTransactionLogger, SignatureChecker, ThreadPool, ThreadPoolImpl, TimerThread,
+        TxnTrackingConfig,
     },
     wallets::{Wallets, WalletsExt},
     work::DistributedWorkFactory,
@@ -53,8 +55,8 @@ use rsnano_nullable_clock::{SteadyClock, SystemTimeFactory};
 use rsnano_nullable_http_client::{HttpClient, Url};
 use rsnano_output_tracker::OutputListenerMt;
 use rsnano_store_lmdb::{
-    EnvOptions, LmdbConfig, LmdbEnv, LmdbStore, NullTransactionTracker, SyncStrategy,
-    TransactionTracker,
+    EnvOptions, LmdbConfig, LmdbEnv, LmdbStore, NullTransactionTracker, ReadCacheObserver,
+    SyncStrategy, TransactionTracker,
 };
 use serde::Serialize;
 use std::{
@@ -97,7 +99,7 @@ pub struct Node {
     pub vote_processor_queue: Arc<VoteProcessorQueue>,
     pub history: Arc<LocalVoteHistory>,
     pub confirming_set: Arc<ConfirmingSet>,
-    pub vote_cache: Arc<Mutex<VoteCache>>,
+    pub vote_cache: Arc<VoteCache>,
     pub block_processor: Arc<BlockProcessor>,
     pub wallets: Arc<Wallets>,
     pub vote_generators: Arc<VoteGenerators>,
@@ -121,6 +123,7 @@ pub struct Node {
     peer_cache_connector: TimerThread<PeerCacheConnector>,
     pub inbound_message_queue: Arc<InboundMessageQueue>,
     monitor: TimerThread<Monitor>,
+    block_table_migration: TimerThread<BlockTableMigration>,
     stopped: AtomicBool,
     pub network_filter: Arc<NetworkFilter>,
     pub message_publisher: Arc<Mutex<MessagePublisher>>, // TODO remove this. It is needed right now
@@ -209,6 +212,7 @@ impl Node {
                 Duration::from_millis(config.block_processor_batch_max_time_ms as u64),
                 config.lmdb_config.clone(),
                 config.backup_before_upgrade,
+                Arc::new(StoreStats::new(stats.clone())),
             )
             .expect("Could not create LMDB store")
         };
@@ -249,6 +253,22 @@ impl Node {
         )
         .expect("Could not initialize ledger");
         ledger.set_observer(Arc::new(LedgerStats::new(stats.clone())));
+        if config.enable_delegators_index {
+            info!("Enabling delegators index...");
+            if ledger.enable_delegators_index() {
+                info!("Delegators index built");
+            }
+        } else {
+            ledger.disable_delegators_index();
+        }
+        if config.backlog.use_unconfirmed_index {
+            info!("Enabling unconfirmed accounts index...");
+            if ledger.enable_unconfirmed_index() {
+                info!("Unconfirmed accounts index built");
+            }
+        } else {
+            ledger.disable_unconfirmed_index();
+        }
         let ledger = Arc::new(ledger);
 
         log_bootstrap_weights(&ledger.rep_weights);
@@ -315,8 +335,14 @@ impl Node {
             enable_ongoing_broadcasts: !flags.disable_providing_telemetry_metrics,
         };
 
-        let unchecked = Arc::new(UncheckedMap::new(
-            config.max_unchecked_blocks as usize,
+        let unchecked_config = UncheckedMapConfig {
+            max_blocks: config.max_unchecked_blocks as usize,
+            memory_budget: config.unchecked_memory_budget,
+            spill_file: Some(application_path.join("unchecked.spill")),
+            max_spill_size: config.unchecked_spill_size,
+        };
+        let unchecked = Arc::new(UncheckedMap::with_config(
+            unchecked_config,
             stats.clone(),
             flags.disable_block_processor_unchecked_deletion,
         ));
@@ -398,20 +424,22 @@ impl Node {
             stats.clone(),
         ));
 
-        let vote_cache = Arc::new(Mutex::new(VoteCache::new(
-            config.vote_cache.clone(),
-            stats.clone(),
-        )));
+        let vote_cache = Arc::new(VoteCache::new(config.vote_cache.clone(), stats.clone()));
 
         let recently_confirmed = Arc::new(RecentlyConfirmedCache::new(
             config.active_elections.confirmation_cache,
         ));
 
+        let signature_checker = Arc::new(SignatureChecker::new(
+            config.signature_checker_threads as usize,
+        ));
+
         let block_processor = Arc::new(BlockProcessor::new(
             global_config.into(),
             ledger.clone(),
             unchecked.clone(),
             stats.clone(),
+            signature_checker.clone(),
         ));
         dead_channel_cleanup.add_step(BlockProcessorCleanup::new(
             block_processor.processor_loop.clone(),
@@ -504,6 +532,7 @@ impl Node {
             vote_processor_queue.clone(),
             vote_router.clone(),
             stats.clone(),
+            signature_checker.clone(),
             on_vote,
         ));
 
@@ -1062,6 +1091,11 @@ impl Node {
             ),
         );
 
+        let block_table_migration = TimerThread::new_run_immedately(
+            "Block migration",
+            BlockTableMigration::new(ledger.clone(), BlockTableMigration::DEFAULT_BATCH_SIZE),
+        );
+
         Self {
             is_nulled,
             steady_clock,
@@ -1118,6 +1152,7 @@ impl Node {
             message_processor,
             inbound_message_queue,
             monitor,
+            block_table_migration,
             message_publisher: message_publisher_l,
             message_flooder: Arc::new(Mutex::new(message_flooder.clone())),
             network_filter,
@@ -1130,7 +1165,7 @@ impl Node {
     pub fn container_info(&self) -> ContainerInfo {
         let tcp_channels = self.network_info.read().unwrap().container_info();
         let online_reps = self.online_reps.lock().unwrap().container_info();
-        let vote_cache = self.vote_cache.lock().unwrap().container_info();
+        let vote_cache = self.vote_cache.container_info();
 
         let network = ContainerInfo::builder()
             .node("tcp_channels", tcp_channels)
@@ -1439,6 +1474,7 @@ impl NodeExt for Arc<Node> {
         if self.config.enable_monitor {
             self.monitor.start(self.config.monitor.interval);
         }
+        self.block_table_migration.start(Duration::from_millis(50));
     }
 
     fn stop(&self) {
@@ -1483,11 +1519,15 @@ impl NodeExt for Arc<Node> {
         self.message_processor.lock().unwrap().stop();
         self.network_threads.lock().unwrap().stop(); // Stop network last to avoid killing in-use sockets
         self.monitor.stop();
+        self.block_table_migration.stop();
 
         self.wallet_workers.stop();
         self.election_workers.stop();
         self.workers.stop();
 
+        // Everything that writes to the ledger is stopped now
+        self.ledger.write_cache_checkpoint();
+
         // work pool is not stopped on purpose due to testing setup
     }
 
@@ -1580,6 +1620,7 @@ fn make_store(
     block_processor_batch_max_time: Duration,
     lmdb_config: LmdbConfig,
     backup_before_upgrade: bool,
+    cache_observer: Arc<dyn ReadCacheObserver>,
 ) -> anyhow::Result<Arc<LmdbStore>> {
     let mut path = PathBuf::from(path);
     if add_db_postfix {
@@ -1604,6 +1645,7 @@ fn make_store(
         .options(&options)
         .backup_before_upgrade(backup_before_upgrade)
         .txn_tracker(txn_tracker)
+        .cache_observer(cache_observer)
         .build()?;
     Ok(Arc::new(store))
 }
@@ -1,12 +1,13 @@
 use crate::{
-    config::{get_node_toml_config_path, DaemonConfig, DaemonToml, NodeConfig, NodeFlags},
+    config::{read_daemon_toml, DaemonConfig, NodeConfig, NodeFlags},
     consensus::{ElectionEndCallback, ElectionStatus, VoteProcessedCallback2},
     transport::MessageCallback,
     working_path_for, NetworkParams, Node, NodeArgs,
 };
 use rsnano_core::{
-    utils::get_cpu_count, work::WorkPoolImpl, Account, Amount, Networks, SavedBlock, Vote,
-    VoteCode, VoteSource, VoteWithWeightInfo,
+    utils::{get_cpu_count, set_thread_topology},
+    work::WorkPoolImpl,
+    Account, Amount, Networks, SavedBlock, Vote, VoteCode, VoteSource, VoteWithWeightInfo,
 };
 use rsnano_messages::Message;
 use rsnano_network::ChannelId;
@@ -151,6 +152,13 @@ impl NodeBuilder {
         self
     }
 
+    pub fn get_config_overrides(&self) -> &[String] {
+        match &self.flags {
+            Some(flags) => &flags.config_overrides,
+            None => &[],
+        }
+    }
+
     pub fn get_data_path(&self) -> anyhow::Result<PathBuf> {
         match &self.data_path {
             Some(path) => Ok(path.clone()),
@@ -168,22 +176,27 @@ impl NodeBuilder {
             .network_params
             .unwrap_or_else(|| NetworkParams::new(self.network));
 
+        let flags = self.flags.unwrap_or_default();
         let config = match self.config {
             Some(c) => c,
             None => {
                 let cpu_count = get_cpu_count();
                 let mut daemon_config = DaemonConfig::new(&network_params, cpu_count);
-                let config_path = get_node_toml_config_path(&data_path);
-                if config_path.exists() {
-                    let toml_str = std::fs::read_to_string(config_path)?;
-                    let daemon_toml: DaemonToml = toml::de::from_str(&toml_str)?;
+                if let Some(daemon_toml) = read_daemon_toml(&data_path, &flags.config_overrides)? {
                     daemon_config.merge_toml(&daemon_toml);
                 }
                 daemon_config.node
             }
         };
 
-        let flags = self.flags.unwrap_or_default();
+        // Must be set before the work pool and the other threads are spawned
+        set_thread_topology(config.thread_topology.clone())?;
+        if config.thread_topology.io_placement_ignored() {
+            tracing::warn!(
+                "The io thread placement is ignored, because io_threads is 0 and the node shares the tokio runtime of the process"
+            );
+        }
+
         let work = self.work.unwrap_or_else(|| {
             Arc::new(WorkPoolImpl::new(
                 network_params.work.clone(),
@@ -2,15 +2,17 @@ use crate::{
     config::{NodeConfig, NodeFlags},
     utils::ThreadPool,
 };
-use rsnano_core::{Account, BlockHash};
+use rsnano_core::{Account, BlockHash, ConfirmationHeightInfo};
 use rsnano_ledger::{Ledger, Writer};
-use rsnano_store_lmdb::Transaction;
+use rsnano_store_lmdb::{parallel_traversal, LmdbReadTransaction, Transaction};
 use std::{
     collections::VecDeque,
     sync::{
         atomic::{AtomicBool, Ordering},
+        mpsc::{sync_channel, Receiver, SyncSender},
         Arc,
     },
+    thread,
     time::{Duration, SystemTime, UNIX_EPOCH},
 };
 use tracing::debug;
@@ -24,6 +26,12 @@ pub struct LedgerPruning {
 }
 
 impl LedgerPruning {
+    /// Maximum number of pruning targets that are searched ahead of the writer
+    pub const PIPELINE_CAPACITY: usize = 64 * 1024;
+    /// A write transaction of the pipelined mode is committed after this time,
+    /// so that other writers get their turn
+    pub const WRITE_TIME_BUDGET: Duration = Duration::from_millis(500);
+
     pub fn new(
         config: NodeConfig,
         flags: NodeFlags,
@@ -57,6 +65,12 @@ impl LedgerPruning {
         } else {
             u64::MAX
         };
+
+        if self.config.pipelined_pruning {
+            self.pipelined_pruning(batch_size_a, max_depth, cutoff_time);
+            return;
+        }
+
         let mut pruned_count = 0;
         let mut transaction_write_count = 0;
         let mut last_account = Account::from(1); // 0 Burn account is never opened. So it can be used to break loop
@@ -103,6 +117,85 @@ impl LedgerPruning {
         debug!("Total recently pruned block count: {}", pruned_count);
     }
 
+    /// Searches the pruning targets of all account ranges in parallel and prunes them
+    /// while the search is still running. Targets are handed over in a bounded channel,
+    /// so that the search doesn't run too far ahead of the writer.
+    fn pipelined_pruning(&self, batch_size: u64, max_depth: u64, cutoff_time: u64) {
+        let (tx_targets, rx_targets) = sync_channel(Self::PIPELINE_CAPACITY);
+
+        thread::scope(|scope| {
+            thread::Builder::new()
+                .name("Pruning targets".to_owned())
+                .spawn_scoped(scope, move || {
+                    self.search_pruning_targets(tx_targets, batch_size, max_depth, cutoff_time)
+                })
+                .unwrap();
+
+            let pruned_count = self.prune_targets(rx_targets, batch_size);
+            debug!("Total recently pruned block count: {}", pruned_count);
+        });
+    }
+
+    fn search_pruning_targets(
+        &self,
+        tx_targets: SyncSender<BlockHash>,
+        batch_size: u64,
+        max_depth: u64,
+        cutoff_time: u64,
+    ) {
+        parallel_traversal(&|start, end, is_last| {
+            // 0 Burn account is never opened
+            let mut last_account = Account::from(start).max(Account::from(1));
+            let end = if is_last {
+                None
+            } else {
+                Some(Account::from(end))
+            };
+            let mut targets = VecDeque::new();
+            let mut finished = false;
+            while !finished && !self.stopped.load(Ordering::SeqCst) {
+                finished = self.collect_pruning_targets_in_range(
+                    &mut targets,
+                    &mut last_account,
+                    end,
+                    batch_size * 2,
+                    max_depth,
+                    cutoff_time,
+                );
+                for hash in targets.drain(..) {
+                    if tx_targets.send(hash).is_err() {
+                        return; // Writer stopped
+                    }
+                }
+            }
+        });
+    }
+
+    /// Prunes the targets in write transactions that are bounded by `WRITE_TIME_BUDGET`.
+    /// Returns once all targets are pruned or pruning is stopped
+    fn prune_targets(&self, rx_targets: Receiver<BlockHash>, batch_size: u64) -> u64 {
+        let mut pruned_count = 0;
+        while let Ok(first) = rx_targets.recv() {
+            if self.stopped.load(Ordering::SeqCst) {
+                break;
+            }
+            let _write_guard = self.ledger.write_queue.wait(Writer::Pruning);
+            let mut tx = self.ledger.rw_txn();
+            let mut next = Some(first);
+            while let Some(pruning_hash) = next {
+                pruned_count += self
+                    .ledger
+                    .pruning_action(&mut tx, &pruning_hash, batch_size);
+                if tx.elapsed() >= Self::WRITE_TIME_BUDGET || self.stopped.load(Ordering::SeqCst) {
+                    break;
+                }
+                next = rx_targets.try_recv().ok();
+            }
+            debug!("Pruned blocks: {}", pruned_count);
+        }
+        pruned_count
+    }
+
     pub fn collect_ledger_pruning_targets(
         &self,
         pruning_targets_a: &mut VecDeque<BlockHash>,
@@ -110,15 +203,32 @@ impl LedgerPruning {
         batch_read_size_a: u64,
         max_depth_a: u64,
         cutoff_time_a: u64,
+    ) -> bool {
+        self.collect_pruning_targets_in_range(
+            pruning_targets_a,
+            last_account_a,
+            None,
+            batch_read_size_a,
+            max_depth_a,
+            cutoff_time_a,
+        )
+    }
+
+    /// Collects targets of the accounts from `last_account_a` up to `end` (exclusive).
+    /// Returns true if the end of the range was reached
+    fn collect_pruning_targets_in_range(
+        &self,
+        pruning_targets_a: &mut VecDeque<BlockHash>,
+        last_account_a: &mut Account,
+        end: Option<Account>,
+        batch_read_size_a: u64,
+        max_depth_a: u64,
+        cutoff_time_a: u64,
     ) -> bool {
         let mut read_operations = 0;
         let mut finish_transaction = false;
         let mut tx = self.ledger.read_txn();
-        let mut it = self
-            .ledger
-            .store
-            .confirmation_height
-            .iter_range(&tx, *last_account_a..);
+        let mut it = self.confirmation_heights(&tx, *last_account_a, end);
 
         while let Some((account, info)) = it.next() {
             read_operations += 1;
@@ -139,11 +249,7 @@ impl LedgerPruning {
                 if depth % batch_read_size_a == 0 {
                     drop(it);
                     tx.refresh();
-                    it = self
-                        .ledger
-                        .store
-                        .confirmation_height
-                        .iter_range(&tx, account..);
+                    it = self.confirmation_heights(&tx, account, end);
                 }
             }
             if !hash.is_zero() {
@@ -159,6 +265,19 @@ impl LedgerPruning {
 
         !finish_transaction || last_account_a.is_zero()
     }
+
+    fn confirmation_heights<'a>(
+        &self,
+        tx: &'a LmdbReadTransaction,
+        start: Account,
+        end: Option<Account>,
+    ) -> Box<dyn Iterator<Item = (Account, ConfirmationHeightInfo)> + 'a> {
+        let store = &self.ledger.store.confirmation_height;
+        match end {
+            Some(end) => Box::new(store.iter_range(tx, start..end)),
+            None => Box::new(store.iter_range(tx, start..)),
+        }
+    }
 }
 
 pub trait LedgerPruningExt {
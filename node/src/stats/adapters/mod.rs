@@ -1,8 +1,10 @@
 mod ledger_stats;
 mod network_stats;
 mod parse_message_error;
+mod store_stats;
 pub use ledger_stats::LedgerStats;
 pub use network_stats::*;
+pub use store_stats::StoreStats;
 
 use rsnano_core::VoteSource;
 use rsnano_ledger::BlockStatus;
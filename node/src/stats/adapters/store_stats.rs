@@ -0,0 +1,32 @@
+use crate::stats::{DetailType, StatType, Stats};
+use rsnano_store_lmdb::{ReadCacheKind, ReadCacheObserver};
+use std::sync::Arc;
+
+pub struct StoreStats {
+    stats: Arc<Stats>,
+}
+
+impl StoreStats {
+    pub fn new(stats: Arc<Stats>) -> Self {
+        Self { stats }
+    }
+}
+
+impl ReadCacheObserver for StoreStats {
+    fn cache_hit(&self, kind: ReadCacheKind) {
+        self.stats.inc(kind.into(), DetailType::Hit);
+    }
+
+    fn cache_miss(&self, kind: ReadCacheKind) {
+        self.stats.inc(kind.into(), DetailType::Miss);
+    }
+}
+
+impl From<ReadCacheKind> for StatType {
+    fn from(kind: ReadCacheKind) -> Self {
+        match kind {
+            ReadCacheKind::Block => StatType::BlockCache,
+            ReadCacheKind::Account => StatType::AccountCache,
+        }
+    }
+}
@@ -0,0 +1,422 @@
+use rsnano_core::{BlockHash, Vote};
+use std::{
+    collections::HashMap,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Mutex,
+    },
+    time::{Duration, Instant},
+};
+use strum::{EnumCount, IntoEnumIterator};
+use strum_macros::{EnumIter, IntoStaticStr};
+
+/// The stages of a block on its way from the network to the observers of cemented blocks
+#[derive(
+    Clone,
+    Copy,
+    PartialEq,
+    Eq,
+    PartialOrd,
+    Ord,
+    Debug,
+    strum_macros::EnumCount,
+    EnumIter,
+    IntoStaticStr,
+)]
+#[strum(serialize_all = "snake_case")]
+pub enum LatencyStage {
+    /// Received as a publish message
+    Received,
+    /// Added to the block processor queue
+    Queued,
+    /// Inserted into the ledger
+    Processed,
+    ElectionStarted,
+    QuorumReached,
+    /// Cemented by the confirming set
+    Cemented,
+    /// All observers of the cemented block were called
+    Notified,
+}
+
+impl LatencyStage {
+    pub fn as_str(&self) -> &'static str {
+        self.into()
+    }
+
+    /// A timeline can only start at these stages
+    fn is_entry(&self) -> bool {
+        matches!(self, Self::Received | Self::Queued)
+    }
+}
+
+/// Tracks how long sampled blocks spend in each stage of the confirmation pipeline.
+///
+/// Only every n-th block hash is sampled, so that all other blocks only pay for a
+/// modulo operation. The histograms are lock-free. The timelines of the sampled blocks
+/// are kept in a bounded map: blocks that never reach the end of the pipeline get
+/// purged after `TIMEOUT`.
+pub struct LatencyTracker {
+    sampling: u64,
+    blocks: Mutex<HashMap<BlockHash, Timeline>>,
+    votes: Mutex<HashMap<u64, Instant>>,
+    /// Time since the previous recorded stage of the block
+    stages: [LatencyHistogram; LatencyStage::COUNT],
+    /// Time from the first to the last stage of the block
+    total: LatencyHistogram,
+    /// Time from queueing a vote in the vote processor until it was applied
+    vote_processing: LatencyHistogram,
+}
+
+struct Timeline {
+    started: Instant,
+    last_time: Instant,
+    last_stage: LatencyStage,
+}
+
+impl LatencyTracker {
+    pub const MAX_TRACKED: usize = 1024 * 16;
+    pub const TIMEOUT: Duration = Duration::from_secs(5 * 60);
+
+    /// Samples 1 out of `sampling` blocks and votes. 0 disables the tracking
+    pub fn new(sampling: u64) -> Self {
+        Self {
+            sampling,
+            blocks: Mutex::new(HashMap::new()),
+            votes: Mutex::new(HashMap::new()),
+            stages: std::array::from_fn(|_| LatencyHistogram::new()),
+            total: LatencyHistogram::new(),
+            vote_processing: LatencyHistogram::new(),
+        }
+    }
+
+    pub fn sampling(&self) -> u64 {
+        self.sampling
+    }
+
+    pub fn is_enabled(&self) -> bool {
+        self.sampling > 0
+    }
+
+    pub fn record(&self, hash: &BlockHash, stage: LatencyStage) {
+        if !self.is_sampled(hash) {
+            return;
+        }
+
+        let now = Instant::now();
+        let mut blocks = self.blocks.lock().unwrap();
+        match blocks.get_mut(hash) {
+            Some(timeline) => {
+                // Ignore repeated and out of order stages, e.g. when a fork wins an election
+                if stage <= timeline.last_stage {
+                    return;
+                }
+                self.stages[stage as usize].record(now - timeline.last_time);
+                timeline.last_time = now;
+                timeline.last_stage = stage;
+                if stage == LatencyStage::Notified {
+                    self.total.record(now - timeline.started);
+                    blocks.remove(hash);
+                }
+            }
+            None => {
+                if !stage.is_entry() {
+                    return;
+                }
+                if blocks.len() >= Self::MAX_TRACKED {
+                    blocks.retain(|_, t| now - t.started < Self::TIMEOUT);
+                    if blocks.len() >= Self::MAX_TRACKED {
+                        return;
+                    }
+                }
+                blocks.insert(
+                    *hash,
+                    Timeline {
+                        started: now,
+                        last_time: now,
+                        last_stage: stage,
+                    },
+                );
+            }
+        }
+    }
+
+    /// Stops tracking a block that won't make it through the pipeline, e.g. an old block
+    pub fn discard(&self, hash: &BlockHash) {
+        if self.is_sampled(hash) {
+            self.blocks.lock().unwrap().remove(hash);
+        }
+    }
+
+    pub fn vote_queued(&self, vote: &Vote) {
+        let Some(key) = self.vote_key(vote) else {
+            return;
+        };
+        let now = Instant::now();
+        let mut votes = self.votes.lock().unwrap();
+        if votes.len() >= Self::MAX_TRACKED {
+            votes.retain(|_, queued| now - *queued < Self::TIMEOUT);
+            if votes.len() >= Self::MAX_TRACKED {
+                return;
+            }
+        }
+        votes.entry(key).or_insert(now);
+    }
+
+    pub fn vote_processed(&self, vote: &Vote) {
+        let Some(key) = self.vote_key(vote) else {
+            return;
+        };
+        if let Some(queued) = self.votes.lock().unwrap().remove(&key) {
+            self.vote_processing.record(queued.elapsed());
+        }
+    }
+
+    pub fn stage(&self, stage: LatencyStage) -> LatencySummary {
+        self.stages[stage as usize].summary()
+    }
+
+    pub fn total(&self) -> LatencySummary {
+        self.total.summary()
+    }
+
+    pub fn vote_processing(&self) -> LatencySummary {
+        self.vote_processing.summary()
+    }
+
+    /// The summaries of all stages that can be measured, i.e. all except the entry stage
+    pub fn stages(&self) -> impl Iterator<Item = (LatencyStage, LatencySummary)> + '_ {
+        LatencyStage::iter()
+            .filter(|s| *s != LatencyStage::Received)
+            .map(|s| (s, self.stage(s)))
+    }
+
+    pub fn tracked_blocks(&self) -> usize {
+        self.blocks.lock().unwrap().len()
+    }
+
+    pub fn clear(&self) {
+        self.blocks.lock().unwrap().clear();
+        self.votes.lock().unwrap().clear();
+        for histogram in &self.stages {
+            histogram.clear();
+        }
+        self.total.clear();
+        self.vote_processing.clear();
+    }
+
+    fn is_sampled(&self, hash: &BlockHash) -> bool {
+        self.sample_key(&hash.as_bytes()[24..]).is_some()
+    }
+
+    fn vote_key(&self, vote: &Vote) -> Option<u64> {
+        // The hash of a vote is the same for all representatives, the signature isn't
+        self.sample_key(&vote.signature.as_bytes()[..8])
+    }
+
+    fn sample_key(&self, bytes: &[u8]) -> Option<u64> {
+        if self.sampling == 0 {
+            return None;
+        }
+        let key = u64::from_be_bytes(bytes.try_into().unwrap());
+        (key % self.sampling == 0).then_some(key)
+    }
+}
+
+/// A lock-free histogram of durations in microseconds with logarithmic buckets, each of
+/// which is split into `SUB_BUCKETS` linear sub-buckets like an HDR histogram.
+/// The relative error of the quantiles is at most 1/`SUB_BUCKETS`.
+pub struct LatencyHistogram {
+    buckets: Box<[AtomicU64]>,
+    sum: AtomicU64,
+    max: AtomicU64,
+}
+
+impl LatencyHistogram {
+    const SUB_BUCKET_BITS: u32 = 4;
+    const SUB_BUCKETS: u64 = 1 << Self::SUB_BUCKET_BITS;
+    const BUCKETS: usize = (Self::SUB_BUCKETS * (64 - Self::SUB_BUCKET_BITS + 1) as u64) as usize;
+
+    pub fn new() -> Self {
+        Self {
+            buckets: (0..Self::BUCKETS).map(|_| AtomicU64::new(0)).collect(),
+            sum: AtomicU64::new(0),
+            max: AtomicU64::new(0),
+        }
+    }
+
+    pub fn record(&self, duration: Duration) {
+        let micros = duration.as_micros().min(u64::MAX as u128) as u64;
+        self.buckets[Self::bucket_index(micros)].fetch_add(1, Ordering::Relaxed);
+        self.sum.fetch_add(micros, Ordering::Relaxed);
+        self.max.fetch_max(micros, Ordering::Relaxed);
+    }
+
+    /// The concurrent recordings make the summary approximate, which is fine for monitoring
+    pub fn summary(&self) -> LatencySummary {
+        let counts: Vec<u64> = self
+            .buckets
+            .iter()
+            .map(|b| b.load(Ordering::Relaxed))
+            .collect();
+        let max = self.max.load(Ordering::Relaxed);
+        LatencySummary {
+            count: counts.iter().sum(),
+            sum_us: self.sum.load(Ordering::Relaxed),
+            max_us: max,
+            p50_us: Self::quantile(&counts, 0.5, max),
+            p99_us: Self::quantile(&counts, 0.99, max),
+            p999_us: Self::quantile(&counts, 0.999, max),
+        }
+    }
+
+    pub fn clear(&self) {
+        for bucket in self.buckets.iter() {
+            bucket.store(0, Ordering::Relaxed);
+        }
+        self.sum.store(0, Ordering::Relaxed);
+        self.max.store(0, Ordering::Relaxed);
+    }
+
+    fn bucket_index(value: u64) -> usize {
+        if value < Self::SUB_BUCKETS {
+            return value as usize;
+        }
+        let shift = 63 - value.leading_zeros() - Self::SUB_BUCKET_BITS;
+        let sub_bucket = (value >> shift) - Self::SUB_BUCKETS;
+        ((shift as u64 + 1) * Self::SUB_BUCKETS + sub_bucket) as usize
+    }
+
+    /// The highest value that falls into the bucket
+    fn bucket_upper_bound(index: usize) -> u64 {
+        let index = index as u64;
+        if index < Self::SUB_BUCKETS {
+            return index;
+        }
+        let shift = index / Self::SUB_BUCKETS - 1;
+        let sub_bucket = index % Self::SUB_BUCKETS;
+        ((Self::SUB_BUCKETS + sub_bucket) << shift) + ((1 << shift) - 1)
+    }
+
+    fn quantile(counts: &[u64], quantile: f64, max: u64) -> u64 {
+        let total: u64 = counts.iter().sum();
+        if total == 0 {
+            return 0;
+        }
+        let rank = ((quantile * total as f64).ceil() as u64).max(1);
+        let mut seen = 0;
+        for (index, count) in counts.iter().enumerate() {
+            seen += count;
+            if seen >= rank {
+                return Self::bucket_upper_bound(index).min(max);
+            }
+        }
+        max
+    }
+}
+
+impl Default for LatencyHistogram {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+#[derive(Clone, Copy, Default, PartialEq, Eq, Debug)]
+pub struct LatencySummary {
+    pub count: u64,
+    pub sum_us: u64,
+    pub max_us: u64,
+    pub p50_us: u64,
+    pub p99_us: u64,
+    pub p999_us: u64,
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn bucket_bounds() {
+        for value in [0, 1, 15, 16, 17, 31, 32, 33, 1000, 123_456_789, u64::MAX] {
+            let index = LatencyHistogram::bucket_index(value);
+            assert!(index < LatencyHistogram::BUCKETS);
+            assert!(LatencyHistogram::bucket_upper_bound(index) >= value);
+            if index > 0 {
+                assert!(LatencyHistogram::bucket_upper_bound(index - 1) < value);
+            }
+        }
+    }
+
+    #[test]
+    fn empty_histogram() {
+        let histogram = LatencyHistogram::new();
+        assert_eq!(histogram.summary(), LatencySummary::default());
+    }
+
+    #[test]
+    fn quantiles() {
+        let histogram = LatencyHistogram::new();
+        for micros in 1..=1000 {
+            histogram.record(Duration::from_micros(micros));
+        }
+
+        let summary = histogram.summary();
+
+        assert_eq!(summary.count, 1000);
+        assert_eq!(summary.sum_us, 500_500);
+        assert_eq!(summary.max_us, 1000);
+        assert!((500..=532).contains(&summary.p50_us));
+        assert!((990..=1000).contains(&summary.p99_us));
+        assert_eq!(summary.p999_us, 1000);
+    }
+
+    #[test]
+    fn track_block_through_pipeline() {
+        let tracker = LatencyTracker::new(1);
+        let hash = BlockHash::from(1);
+
+        for stage in LatencyStage::iter() {
+            tracker.record(&hash, stage);
+        }
+
+        for (_, summary) in tracker.stages() {
+            assert_eq!(summary.count, 1);
+        }
+        assert_eq!(tracker.total().count, 1);
+        assert_eq!(tracker.tracked_blocks(), 0);
+    }
+
+    #[test]
+    fn start_at_entry_stages_only() {
+        let tracker = LatencyTracker::new(1);
+        tracker.record(&BlockHash::from(1), LatencyStage::Cemented);
+        assert_eq!(tracker.tracked_blocks(), 0);
+
+        tracker.record(&BlockHash::from(1), LatencyStage::Queued);
+        tracker.record(&BlockHash::from(1), LatencyStage::Processed);
+        tracker.record(&BlockHash::from(1), LatencyStage::Processed);
+
+        assert_eq!(tracker.stage(LatencyStage::Queued).count, 0);
+        assert_eq!(tracker.stage(LatencyStage::Processed).count, 1);
+        assert_eq!(tracker.tracked_blocks(), 1);
+    }
+
+    #[test]
+    fn disabled() {
+        let tracker = LatencyTracker::new(0);
+        tracker.record(&BlockHash::from(1), LatencyStage::Queued);
+        assert_eq!(tracker.tracked_blocks(), 0);
+    }
+
+    #[test]
+    fn vote_processing() {
+        let tracker = LatencyTracker::new(1);
+        let vote = Vote::new_test_instance();
+
+        tracker.vote_queued(&vote);
+        tracker.vote_processed(&vote);
+        tracker.vote_processed(&vote);
+
+        assert_eq!(tracker.vote_processing().count, 1);
+    }
+}
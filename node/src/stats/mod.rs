@@ -1,9 +1,11 @@
 pub mod adapters;
+mod latency;
 mod stats;
 mod stats_config;
 mod stats_enums;
 mod stats_log_sink;
 
+pub use latency::{LatencyHistogram, LatencyStage, LatencySummary, LatencyTracker};
 pub use stats::*;
 pub use stats_config::StatsConfig;
 pub use stats_enums::*;
@@ -1,24 +1,32 @@
-use super::{DetailType, Direction, Sample, StatType};
+use super::{DetailType, Direction, LatencyTracker, Sample, StatType};
 use super::{StatFileWriter, StatsConfig, StatsLogSink};
 use anyhow::Result;
 use bounded_vec_deque::BoundedVecDeque;
+use num_traits::FromPrimitive;
 use once_cell::sync::Lazy;
 use rsnano_core::utils::get_env_bool;
 use rsnano_messages::MessageType;
 use std::{
+    cell::Cell,
     collections::BTreeMap,
-    sync::{atomic::AtomicU64, Arc, Condvar, Mutex, RwLock},
+    sync::{
+        atomic::{AtomicU64, AtomicUsize, Ordering},
+        Arc, Condvar, Mutex, OnceLock, RwLock,
+    },
     thread::JoinHandle,
     time::{Duration, Instant, SystemTime},
 };
+use strum::EnumCount;
 use tracing::debug;
 
 pub struct Stats {
     config: StatsConfig,
+    counters: Arc<Counters>,
     mutables: Arc<RwLock<StatMutables>>,
     thread: Mutex<Option<JoinHandle<()>>>,
     stats_loop: Arc<StatsLoop>,
     enable_logging: bool,
+    latency: LatencyTracker,
 }
 
 impl Default for Stats {
@@ -30,15 +38,21 @@ impl Default for Stats {
 impl Stats {
     pub fn new(config: StatsConfig) -> Self {
         let mutables = Arc::new(RwLock::new(StatMutables {
-            counters: BTreeMap::new(),
             samplers: BTreeMap::new(),
             timestamp: Instant::now(),
         }));
+        let counters = Arc::new(Counters::new());
+        let latency_sampling = if config.enable {
+            config.latency_sampling
+        } else {
+            0
+        };
         Self {
             config: config.clone(),
             thread: Mutex::new(None),
             stats_loop: Arc::new(StatsLoop {
                 condition: Condvar::new(),
+                counters: Arc::clone(&counters),
                 mutables: Arc::clone(&mutables),
                 config,
                 loop_state: Mutex::new(StatsLoopState {
@@ -47,8 +61,10 @@ impl Stats {
                     log_last_sample_writeout: Instant::now(),
                 }),
             }),
+            counters,
             mutables,
             enable_logging: get_env_bool("NANO_LOG_STATS").unwrap_or(false),
+            latency: LatencyTracker::new(latency_sampling),
         }
     }
 
@@ -87,34 +103,13 @@ impl Stats {
 
     /// Add `value` to given counter
     pub fn add_dir(&self, stat_type: StatType, detail: DetailType, dir: Direction, value: u64) {
-        if value == 0 {
+        if value == 0 || !self.config.enable {
             return;
         }
 
         self.log_add(stat_type, detail, dir, value);
-
-        let key = CounterKey::new(stat_type, detail, dir);
-
-        // This is a two-step process to avoid exclusively locking the mutex in the common case
-        {
-            let lock = self.mutables.read().unwrap();
-
-            if let Some(counter) = lock.counters.get(&key) {
-                counter.add(value);
-                return;
-            }
-        }
-        // Not found, create a new entry
-        {
-            let mut lock = self.mutables.write().unwrap();
-            let counter = lock.counters.entry(key).or_insert(CounterEntry::new());
-            counter.add(value);
-
-            let all_key = CounterKey::new(stat_type, DetailType::All, dir);
-            if key != all_key {
-                lock.counters.entry(all_key).or_insert(CounterEntry::new());
-            }
-        }
+        self.counters
+            .add(CounterKey::new(stat_type, detail, dir), value);
     }
 
     fn log_add(&self, stat_type: StatType, detail: DetailType, dir: Direction, value: u64) {
@@ -133,7 +128,7 @@ impl Stats {
         dir: Direction,
         value: u64,
     ) {
-        if value == 0 {
+        if value == 0 || !self.config.enable {
             return;
         }
 
@@ -141,29 +136,9 @@ impl Stats {
 
         let key = CounterKey::new(stat_type, detail, dir);
         let all_key = CounterKey::new(stat_type, DetailType::All, dir);
-
-        // This is a two-step process to avoid exclusively locking the mutex in the common case
-        {
-            let lock = self.mutables.read().unwrap();
-
-            if let Some(counter) = lock.counters.get(&key) {
-                counter.add(value);
-                if key != all_key {
-                    let all_counter = lock.counters.get(&all_key).unwrap();
-                    all_counter.add(value);
-                }
-                return;
-            }
-        }
-        // Not found, create a new entry
-        {
-            let mut lock = self.mutables.write().unwrap();
-            let counter = lock.counters.entry(key).or_insert(CounterEntry::new());
-            counter.add(value);
-            if key != all_key {
-                let all_counter = lock.counters.entry(all_key).or_insert(CounterEntry::new());
-                all_counter.add(value);
-            }
+        self.counters.add(key, value);
+        if key != all_key {
+            self.counters.add(all_key, value);
         }
     }
 
@@ -180,6 +155,9 @@ impl Stats {
     }
 
     pub fn sample(&self, sample: Sample, value: i64, expected_min_max: (i64, i64)) {
+        if !self.config.enable {
+            return;
+        }
         self.log_sample(sample, value);
         let key = SamplerKey::new(sample);
         // This is a two-step process to avoid exclusively locking the mutex in the common case
@@ -217,11 +195,15 @@ impl Stats {
         }
     }
 
+    /// Per-stage latencies of sampled blocks and votes
+    pub fn latency(&self) -> &LatencyTracker {
+        &self.latency
+    }
+
     /// Log counters to the given log link
     pub fn log_counters(&self, sink: &mut dyn StatsLogSink) -> Result<()> {
         let now = SystemTime::now();
-        let lock = self.mutables.write().unwrap();
-        lock.log_counters_impl(sink, &self.config, now)
+        self.counters.log(sink, &self.config, now)
     }
 
     /// Log samples to the given log sink
@@ -240,37 +222,23 @@ impl Stats {
     /// Clear all stats
     pub fn clear(&self) {
         let mut lock = self.mutables.write().unwrap();
-        lock.counters.clear();
+        self.counters.clear();
         lock.samplers.clear();
+        self.latency.clear();
         lock.timestamp = Instant::now();
     }
     ///
     /// Returns current value for the given counter at the type level
     pub fn count_all(&self, stat_type: StatType, dir: Direction) -> u64 {
-        let guard = self.mutables.read().unwrap();
-        let start = CounterKey::new(stat_type, DetailType::All, dir);
-        let mut result = 0u64;
-        for (key, entry) in guard.counters.range(start..) {
-            if key.stat_type != stat_type {
-                break;
-            }
-            if key.dir == dir && key.detail != DetailType::All {
-                result += u64::from(entry);
-            }
-        }
-        result
+        (1..DetailType::COUNT)
+            .filter_map(DetailType::from_usize)
+            .map(|detail| self.count(stat_type, detail, dir))
+            .sum()
     }
 
     /// Returns current value for the given counter at the type level
     pub fn count(&self, stat_type: StatType, detail: DetailType, dir: Direction) -> u64 {
-        let key = CounterKey::new(stat_type, detail, dir);
-        self.mutables
-            .read()
-            .unwrap()
-            .counters
-            .get(&key)
-            .map(|i| i.into())
-            .unwrap_or_default()
+        self.counters.get(CounterKey::new(stat_type, detail, dir))
     }
 }
 
@@ -282,6 +250,8 @@ struct CounterKey {
 }
 
 impl CounterKey {
+    const COUNT: usize = StatType::COUNT * DetailType::COUNT * Direction::COUNT;
+
     fn new(stat_type: StatType, detail: DetailType, dir: Direction) -> Self {
         Self {
             stat_type,
@@ -289,6 +259,126 @@ impl CounterKey {
             dir,
         }
     }
+
+    /// Position in the counter array. The array is sorted like the keys,
+    /// so that the log output has the same order as before
+    fn index(&self) -> usize {
+        (self.stat_type as usize * DetailType::COUNT + self.detail as usize) * Direction::COUNT
+            + self.dir as usize
+    }
+
+    fn from_index(index: usize) -> Option<Self> {
+        let dir = Direction::from_usize(index % Direction::COUNT)?;
+        let index = index / Direction::COUNT;
+        let detail = DetailType::from_usize(index % DetailType::COUNT)?;
+        let stat_type = StatType::from_usize(index / DetailType::COUNT)?;
+        Some(Self::new(stat_type, detail, dir))
+    }
+}
+
+/// All counters, indexed by `CounterKey::index`.
+///
+/// Every thread writes to its own shard, so that threads which count the same stats
+/// don't fight over the cache lines of the counters. The shards are allocated on first
+/// use and only get summed up when a counter is read.
+struct Counters {
+    shards: Vec<OnceLock<Box<[AtomicU64]>>>,
+}
+
+impl Counters {
+    const SHARDS: usize = 8;
+
+    fn new() -> Self {
+        Self {
+            shards: (0..Self::SHARDS).map(|_| OnceLock::new()).collect(),
+        }
+    }
+
+    fn add(&self, key: CounterKey, value: u64) {
+        let shard = self.shards[current_shard()]
+            .get_or_init(|| (0..CounterKey::COUNT).map(|_| AtomicU64::new(0)).collect());
+        shard[key.index()].fetch_add(value, Ordering::Relaxed);
+    }
+
+    fn get(&self, key: CounterKey) -> u64 {
+        let index = key.index();
+        self.initialized_shards()
+            .map(|shard| shard[index].load(Ordering::Relaxed))
+            .sum()
+    }
+
+    fn clear(&self) {
+        for shard in self.initialized_shards() {
+            for counter in shard.iter() {
+                counter.store(0, Ordering::Relaxed);
+            }
+        }
+    }
+
+    fn initialized_shards(&self) -> impl Iterator<Item = &Box<[AtomicU64]>> {
+        self.shards.iter().filter_map(|shard| shard.get())
+    }
+
+    /// Sums up all shards. Counters that were never incremented are omitted
+    fn aggregate(&self) -> Vec<(CounterKey, u64)> {
+        let mut totals = vec![0u64; CounterKey::COUNT];
+        for shard in self.initialized_shards() {
+            for (total, counter) in totals.iter_mut().zip(shard.iter()) {
+                *total += counter.load(Ordering::Relaxed);
+            }
+        }
+        totals
+            .into_iter()
+            .enumerate()
+            .filter(|(_, value)| *value > 0)
+            .filter_map(|(index, value)| Some((CounterKey::from_index(index)?, value)))
+            .collect()
+    }
+
+    fn log(
+        &self,
+        sink: &mut dyn StatsLogSink,
+        config: &StatsConfig,
+        time: SystemTime,
+    ) -> Result<()> {
+        sink.begin()?;
+        if sink.entries() >= config.log_rotation_count {
+            sink.rotate()?;
+        }
+
+        if config.log_headers {
+            let walltime = SystemTime::now();
+            sink.write_header("counters", walltime)?;
+        }
+
+        for (key, value) in self.aggregate() {
+            let type_str = key.stat_type.as_str();
+            let detail = key.detail.as_str();
+            let dir = key.dir.as_str();
+            sink.write_counter_entry(time, type_str, detail, dir, value)?;
+        }
+        sink.inc_entries();
+        sink.finalize();
+        Ok(())
+    }
+}
+
+static NEXT_SHARD: AtomicUsize = AtomicUsize::new(0);
+
+thread_local! {
+    static SHARD: Cell<Option<usize>> = Cell::new(None);
+}
+
+/// The threads get assigned to the shards round robin
+fn current_shard() -> usize {
+    SHARD.with(|shard| match shard.get() {
+        Some(index) => index,
+        None => {
+            let index = NEXT_SHARD.fetch_add(1, Ordering::Relaxed) % Counters::SHARDS;
+            shard.set(Some(index));
+            index
+        }
+    })
 }
 
 #[derive(PartialEq, Eq, PartialOrd, Ord, Clone, Copy)]
@@ -309,7 +399,6 @@ pub enum StatCategory {
 
 struct StatMutables {
     /// Stat entries are sorted by key to simplify processing of log output
-    counters: BTreeMap<CounterKey, CounterEntry>,
     samplers: BTreeMap<SamplerKey, SamplerEntry>,
 
     /// Time of last clear() call
@@ -342,52 +431,6 @@ impl StatMutables {
         sink.finalize();
         Ok(())
     }
-
-    /// Unlocked implementation of log_counters() to avoid using recursive locking
-    fn log_counters_impl(
-        &self,
-        sink: &mut dyn StatsLogSink,
-        config: &StatsConfig,
-        time: SystemTime,
-    ) -> Result<()> {
-        sink.begin()?;
-        if sink.entries() >= config.log_rotation_count {
-            sink.rotate()?;
-        }
-
-        if config.log_headers {
-            let walltime = SystemTime::now();
-            sink.write_header("counters", walltime)?;
-        }
-
-        for (&key, entry) in &self.counters {
-            let type_str = key.stat_type.as_str();
-            let detail = key.detail.as_str();
-            let dir = key.dir.as_str();
-            sink.write_counter_entry(time, type_str, detail, dir, entry.into())?;
-        }
-        sink.inc_entries();
-        sink.finalize();
-        Ok(())
-    }
-}
-
-struct CounterEntry(AtomicU64);
-
-impl CounterEntry {
-    fn new() -> Self {
-        Self(AtomicU64::new(0))
-    }
-
-    fn add(&self, value: u64) {
-        self.0.fetch_add(value, std::sync::atomic::Ordering::SeqCst);
-    }
-}
-
-impl From<&CounterEntry> for u64 {
-    fn from(value: &CounterEntry) -> Self {
-        value.0.load(std::sync::atomic::Ordering::SeqCst)
-    }
 }
 
 struct SamplerEntry {
@@ -436,6 +479,7 @@ impl From<MessageType> for DetailType {
 }
 
 struct StatsLoop {
+    counters: Arc<Counters>,
     mutables: Arc<RwLock<StatMutables>>,
     condition: Condvar,
     loop_state: Mutex<StatsLoopState>,
@@ -473,7 +517,7 @@ impl StatsLoop {
                 }
             };
 
-            stats.log_counters_impl(writer, &self.config, SystemTime::now())?;
+            self.counters.log(writer, &self.config, SystemTime::now())?;
             lock.log_last_count_writeout = Instant::now();
         }
 
@@ -558,4 +602,74 @@ mod tests {
         let samples4 = stats.samples(Sample::BootstrapTagDuration);
         assert_eq!(samples4, [2137]);
     }
+
+    #[test]
+    fn count_all_details() {
+        let stats = Stats::new(StatsConfig::new());
+        stats.inc(StatType::Ledger, DetailType::Send);
+        stats.add(StatType::Ledger, DetailType::Receive, 3);
+        stats.inc_dir(StatType::Ledger, DetailType::Send, Direction::Out);
+        stats.inc(StatType::Vote, DetailType::Send);
+
+        assert_eq!(stats.count_all(StatType::Ledger, Direction::In), 4);
+        assert_eq!(stats.count_all(StatType::Ledger, Direction::Out), 1);
+    }
+
+    #[test]
+    fn count_from_multiple_threads() {
+        let stats = Arc::new(Stats::new(StatsConfig::new()));
+        let threads: Vec<_> = (0..4)
+            .map(|_| {
+                let stats = stats.clone();
+                std::thread::spawn(move || {
+                    for _ in 0..1000 {
+                        stats.inc(StatType::Ledger, DetailType::Send);
+                    }
+                })
+            })
+            .collect();
+        for thread in threads {
+            thread.join().unwrap();
+        }
+
+        assert_eq!(
+            stats.count(StatType::Ledger, DetailType::Send, Direction::In),
+            4000
+        );
+    }
+
+    #[test]
+    fn clear() {
+        let stats = Stats::new(StatsConfig::new());
+        stats.inc(StatType::Ledger, DetailType::Send);
+
+        stats.clear();
+
+        assert_eq!(
+            stats.count(StatType::Ledger, DetailType::Send, Direction::In),
+            0
+        );
+    }
+
+    #[test]
+    fn disabled() {
+        let stats = Stats::new(StatsConfig {
+            enable: false,
+            ..Default::default()
+        });
+        stats.inc(StatType::Ledger, DetailType::Send);
+        stats.sample(Sample::ActiveElectionDuration, 5, (1, 10));
+
+        assert_eq!(
+            stats.count(StatType::Ledger, DetailType::Send, Direction::In),
+            0
+        );
+        assert!(stats.samples(Sample::ActiveElectionDuration).is_empty());
+    }
+
+    #[test]
+    fn counter_key_index_roundtrip() {
+        let key = CounterKey::new(StatType::Vote, DetailType::Send, Direction::Out);
+        assert!(CounterKey::from_index(key.index()) == Some(key));
+    }
 }
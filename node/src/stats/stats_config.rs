@@ -2,6 +2,9 @@ use std::time::Duration;
 
 #[derive(Clone, Debug, PartialEq)]
 pub struct StatsConfig {
+    /** If false, counters and samples are not recorded at all */
+    pub enable: bool,
+
     /** How many sample intervals to keep in the ring buffer */
     pub max_samples: usize,
 
@@ -22,11 +25,15 @@ pub struct StatsConfig {
 
     /** Filename for the sampling log */
     pub log_samples_filename: String,
+
+    /** Track the pipeline latencies of 1 out of this many blocks and votes. 0 disables the tracking */
+    pub latency_sampling: u64,
 }
 
 impl Default for StatsConfig {
     fn default() -> Self {
         Self {
+            enable: true,
             max_samples: 1024 * 16,
             log_samples_interval: Duration::ZERO,
             log_counters_interval: Duration::ZERO,
@@ -34,6 +41,7 @@ impl Default for StatsConfig {
             log_headers: true,
             log_counters_filename: "counters.stat".to_string(),
             log_samples_filename: "samples.stat".to_string(),
+            latency_sampling: 32,
         }
     }
 }
@@ -1,9 +1,12 @@
 use serde::Serialize;
 use serde_variant::to_variant_name;
+use strum_macros::EnumCount;
 
 /// Primary statistics type
 #[repr(u8)]
-#[derive(FromPrimitive, Serialize, Copy, Clone, PartialEq, Eq, PartialOrd, Ord, Debug)]
+#[derive(
+    FromPrimitive, Serialize, Copy, Clone, PartialEq, Eq, PartialOrd, Ord, Debug, EnumCount,
+)]
 #[serde(rename_all = "snake_case")]
 pub enum StatType {
     Error,
@@ -91,6 +94,9 @@ pub enum StatType {
     MessageProcessorOverfill,
     MessageProcessorType,
     ProcessConfirmed,
+    BlockCache,
+    AccountCache,
+    Websocket,
 }
 
 impl StatType {
@@ -101,7 +107,9 @@ impl StatType {
 
 // Optional detail type
 #[repr(u16)]
-#[derive(FromPrimitive, Serialize, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Debug)]
+#[derive(
+    FromPrimitive, Serialize, Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Debug, EnumCount,
+)]
 #[serde(rename_all = "snake_case")]
 pub enum DetailType {
     // common
@@ -185,6 +193,9 @@ pub enum DetailType {
     ProcessBlocking,
     ProcessBlockingTimeout,
     Force,
+    Prevalidated,
+    PrevalidationStale,
+    PrevalidationRejected,
 
     // block source
     Live,
@@ -420,6 +431,8 @@ pub enum DetailType {
     Put,
     Satisfied,
     Trigger,
+    Spilled,
+    SpillOverfill,
 
     // election scheduler
     InsertManual,
@@ -516,6 +529,8 @@ pub enum DetailType {
     BroadcastAggressive,
     EraseOld,
     EraseConfirmed,
+    Hit,
+    Miss,
 
     // rep tiers
     Tier1,
@@ -528,6 +543,7 @@ pub enum DetailType {
     NotifyIntermediate,
     AlreadyCemented,
     Cementing,
+    CementingPlanned,
     CementedHash,
     CementingFailed,
 
@@ -552,6 +568,11 @@ pub enum DetailType {
     BlocksByHash,
     BlocksByAccount,
     AccountInfoByHash,
+
+    // websocket
+    BroadcastOverflow,
+    SendQueueOverflow,
+    SlowClientDisconnected,
 }
 
 impl DetailType {
@@ -561,7 +582,7 @@ impl DetailType {
 }
 
 /// Direction of the stat. If the direction is irrelevant, use In
-#[derive(FromPrimitive, PartialEq, PartialOrd, Eq, Ord, Clone, Copy, Debug)]
+#[derive(FromPrimitive, PartialEq, PartialOrd, Eq, Ord, Clone, Copy, Debug, EnumCount)]
 #[repr(u8)]
 pub enum Direction {
     In,
@@ -7,7 +7,7 @@ use std::{
 };
 
 /// Queue items of type T from source S
-pub(crate) struct FairQueue<S, T>
+pub struct FairQueue<S, T>
 where
     S: Ord + Copy,
 {
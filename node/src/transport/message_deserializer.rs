@@ -65,24 +65,30 @@ impl<T: AsyncBufferReader + Send> MessageDeserializer<T> {
     ) -> Result<DeserializedMessage, ParseMessageError> {
         let payload_bytes = &self.read_buffer[..payload_size];
         let digest = self.filter_duplicate_messages(header.message_type, payload_bytes)?;
+        self.validate_work(&header, payload_bytes)?;
         let message = Message::deserialize(payload_bytes, &header, digest)
             .ok_or(ParseMessageError::InvalidMessage(header.message_type))?;
-        self.validate_work(&message)?;
         Ok(DeserializedMessage::new(message, header.protocol))
     }
 
-    fn validate_work(&self, message: &Message) -> Result<(), ParseMessageError> {
-        let block = match message {
-            Message::Publish(msg) => Some(&msg.block),
-            _ => None,
-        };
+    /// The work is checked on the serialized block in the read buffer, so that
+    /// blocks with insufficient work are dropped before they get copied into an owned `Block`
+    fn validate_work(
+        &self,
+        header: &MessageHeader,
+        payload_bytes: &[u8],
+    ) -> Result<(), ParseMessageError> {
+        if header.message_type != MessageType::Publish {
+            return Ok(());
+        }
 
-        if let Some(block) = block {
-            // work is checked multiple times - here and in the block processor and maybe
-            // even more... TODO eliminate duplicate work checks
-            if !self.work_thresholds.validate_entry_block(block) {
-                return Err(ParseMessageError::InsufficientWork);
-            }
+        let block = Publish::block_view(payload_bytes, header.extensions)
+            .ok_or(ParseMessageError::InvalidMessage(header.message_type))?;
+
+        // work is checked multiple times - here and in the block processor and maybe
+        // even more... TODO eliminate duplicate work checks
+        if !self.work_thresholds.validate_entry_view(&block) {
+            return Err(ParseMessageError::InsufficientWork);
         }
 
         Ok(())
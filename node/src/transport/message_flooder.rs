@@ -1,4 +1,4 @@
-use super::{try_send_serialized_message, MessagePublisher};
+use super::{try_send_shared_message, MessagePublisher};
 use crate::{representatives::OnlineReps, stats::Stats};
 use rsnano_messages::{Message, MessageSerializer};
 use rsnano_network::{ChannelInfo, DropPolicy, Network, TrafficType};
@@ -50,10 +50,6 @@ impl MessageFlooder {
         scale: f32,
     ) {
         let peered_prs = self.online_reps.lock().unwrap().peered_principal_reps();
-        for rep in peered_prs {
-            self.publisher
-                .try_send(rep.channel_id, &message, drop_policy, traffic_type);
-        }
 
         let mut channels;
         let fanout;
@@ -64,10 +60,14 @@ impl MessageFlooder {
         }
 
         self.remove_no_pr(&mut channels, fanout);
-        for peer in channels {
-            self.publisher
-                .try_send(peer.channel_id(), &message, drop_policy, traffic_type);
-        }
+
+        let channel_ids = peered_prs
+            .iter()
+            .map(|rep| rep.channel_id)
+            .chain(channels.iter().map(|c| c.channel_id()));
+
+        self.publisher
+            .try_broadcast(channel_ids, message, drop_policy, traffic_type);
     }
 
     fn remove_no_pr(&self, channels: &mut Vec<Arc<ChannelInfo>>, count: usize) {
@@ -79,7 +79,7 @@ impl MessageFlooder {
     }
 
     pub fn flood(&mut self, message: &Message, drop_policy: DropPolicy, scale: f32) {
-        let buffer = self.message_serializer.serialize(message);
+        let buffer = Arc::new(self.message_serializer.serialize(message).to_vec());
         let channels = self
             .network
             .info
@@ -88,11 +88,11 @@ impl MessageFlooder {
             .random_fanout_realtime(scale);
 
         for channel in channels {
-            try_send_serialized_message(
+            try_send_shared_message(
                 &self.network,
                 &self.stats,
                 channel.channel_id(),
-                buffer,
+                &buffer,
                 message,
                 drop_policy,
                 TrafficType::Generic,
@@ -1,5 +1,9 @@
 use super::{InboundMessageQueue, RealtimeMessageHandler};
-use crate::config::{NodeConfig, NodeFlags};
+use crate::{
+    config::{NodeConfig, NodeFlags},
+    utils::place_current_thread,
+};
+use rsnano_core::utils::ThreadRole;
 use rsnano_messages::Message;
 use rsnano_network::{ChannelId, ChannelInfo};
 use std::{
@@ -64,6 +68,7 @@ impl MessageProcessor {
                     std::thread::Builder::new()
                         .name("Msg processing".to_string())
                         .spawn(move || {
+                            place_current_thread(ThreadRole::Network);
                             state.run();
                         })
                         .unwrap(),
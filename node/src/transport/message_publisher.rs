@@ -76,6 +76,37 @@ impl MessagePublisher {
         sent
     }
 
+    /// Serializes the message once and queues the same shared buffer for all channels.
+    /// Returns the number of channels the message was queued for.
+    pub fn try_broadcast(
+        &mut self,
+        channel_ids: impl IntoIterator<Item = ChannelId>,
+        message: &Message,
+        drop_policy: DropPolicy,
+        traffic_type: TrafficType,
+    ) -> usize {
+        let buffer = Arc::new(self.message_serializer.serialize(message).to_vec());
+        let mut sent_count = 0;
+        for channel_id in channel_ids {
+            if try_send_shared_message(
+                &self.network,
+                &self.stats,
+                channel_id,
+                &buffer,
+                message,
+                drop_policy,
+                traffic_type,
+            ) {
+                sent_count += 1;
+            }
+
+            if let Some(callback) = &self.published_callback {
+                callback(channel_id, message);
+            }
+        }
+        sent_count
+    }
+
     pub async fn send(
         &mut self,
         channel_id: ChannelId,
@@ -138,7 +169,26 @@ pub(crate) fn try_send_serialized_message(
     traffic_type: TrafficType,
 ) -> bool {
     let sent = network.try_send_buffer(channel_id, buffer, drop_policy, traffic_type);
+    track_send_result(stats, channel_id, message, sent);
+    sent
+}
 
+/// Same as `try_send_serialized_message`, but the buffer is shared between all receivers
+pub(crate) fn try_send_shared_message(
+    network: &Network,
+    stats: &Stats,
+    channel_id: ChannelId,
+    buffer: &Arc<Vec<u8>>,
+    message: &Message,
+    drop_policy: DropPolicy,
+    traffic_type: TrafficType,
+) -> bool {
+    let sent = network.try_send_shared_buffer(channel_id, buffer, drop_policy, traffic_type);
+    track_send_result(stats, channel_id, message, sent);
+    sent
+}
+
+fn track_send_result(stats: &Stats, channel_id: ChannelId, message: &Message, sent: bool) {
     if sent {
         stats.inc_dir_aggregate(StatType::Message, message.into(), Direction::Out);
         trace!(%channel_id, message = ?message, "Message sent");
@@ -147,6 +197,4 @@ pub(crate) fn try_send_serialized_message(
         stats.inc_dir_aggregate(StatType::Drop, detail_type, Direction::Out);
         trace!(%channel_id, message = ?message, "Message dropped");
     }
-
-    sent
 }
@@ -1,8 +1,11 @@
 use rand::{thread_rng, Rng};
 use siphasher::{prelude::*, sip128::SipHasher};
-use std::sync::{
-    atomic::{AtomicU64, Ordering},
-    Mutex, MutexGuard,
+use std::{
+    cmp::max,
+    sync::{
+        atomic::{AtomicU64, Ordering},
+        Mutex, MutexGuard,
+    },
 };
 
 #[derive(Clone, Default)]
@@ -14,23 +17,46 @@ struct Entry {
 /// A probabilistic duplicate filter based on directed map caches, using SipHash 2/4/128
 /// The probability of false negatives (unique packet marked as duplicate) is the probability of a 128-bit SipHash collision.
 /// The probability of false positives (duplicate packet marked as unique) shrinks with a larger filter.
+///
+/// The entries are striped over multiple independently locked shards, so that
+/// concurrent lookups of different digests rarely contend for the same lock.
+/// Entry `i` of the filter lives in shard `i % shard_count`, so the filter behaves
+/// exactly like a single table of `size` entries.
 pub struct NetworkFilter<T: NetworkFilterHasher = DefaultNetworkFilterHasher> {
-    items: Mutex<Vec<Entry>>,
+    shards: Vec<Mutex<Vec<Entry>>>,
+    size: usize,
     hasher: T,
     pub age_cutoff: u64,
     current_epoch: AtomicU64,
 }
 
 impl<T: NetworkFilterHasher> NetworkFilter<T> {
+    pub const DEFAULT_SHARDS: usize = 64;
+
     pub fn with_hasher(hasher: T, size: usize) -> Self {
+        Self::with_hasher_and_shards(hasher, size, Self::DEFAULT_SHARDS)
+    }
+
+    pub fn with_hasher_and_shards(hasher: T, size: usize, shards: usize) -> Self {
+        let shard_count = shards.clamp(1, max(size, 1));
         Self {
-            items: Mutex::new(vec![Entry::default(); size]),
+            shards: (0..shard_count)
+                .map(|shard| {
+                    let len = (size + shard_count - 1 - shard) / shard_count;
+                    Mutex::new(vec![Entry::default(); len])
+                })
+                .collect(),
+            size,
             hasher,
             age_cutoff: 0,
             current_epoch: AtomicU64::new(0),
         }
     }
 
+    pub fn shard_count(&self) -> usize {
+        self.shards.len()
+    }
+
     pub fn update(&self, epoch_inc: u64) {
         self.current_epoch.fetch_add(epoch_inc, Ordering::SeqCst);
     }
@@ -52,8 +78,8 @@ impl<T: NetworkFilterHasher> NetworkFilter<T> {
     }
 
     pub fn apply_digest(&self, digest: u128) -> bool {
-        let mut lock = self.items.lock().unwrap();
-        let element = self.get_element(digest, &mut lock);
+        let (mut lock, slot) = self.lock_shard(digest);
+        let element = &mut lock[slot];
         let existed = self.compare(element, digest);
         if !existed {
             // Replace likely old element with a new one
@@ -72,21 +98,22 @@ impl<T: NetworkFilterHasher> NetworkFilter<T> {
 
     /// Checks if the digest is in the filter.
     pub fn check(&self, digest: u128) -> bool {
-        let mut guard = self.items.lock().unwrap();
-        let element = self.get_element(digest, &mut guard);
-        self.compare(element, digest)
+        let (lock, slot) = self.lock_shard(digest);
+        self.compare(&lock[slot], digest)
     }
 
     /// Sets the corresponding element in the filter to zero, if it matches `digest` exactly.
     pub fn clear(&self, digest: u128) {
-        let mut lock = self.items.lock().unwrap();
-        self.clear_locked(digest, &mut lock);
+        let (mut lock, slot) = self.lock_shard(digest);
+        let element = &mut lock[slot];
+        if self.compare(element, digest) {
+            *element = Default::default();
+        }
     }
 
     pub fn clear_many(&self, digests: impl IntoIterator<Item = u128>) {
-        let mut lock = self.items.lock().unwrap();
         for digest in digests.into_iter() {
-            self.clear_locked(digest, &mut lock);
+            self.clear(digest);
         }
     }
 
@@ -95,20 +122,18 @@ impl<T: NetworkFilterHasher> NetworkFilter<T> {
     }
 
     pub fn clear_all(&self) {
-        let mut lock = self.items.lock().unwrap();
-        lock.fill(Default::default());
-    }
-
-    fn clear_locked(&self, digest: u128, lock: &mut MutexGuard<Vec<Entry>>) {
-        let element = self.get_element(digest, lock);
-        if self.compare(&element, digest) {
-            *element = Default::default();
+        for shard in &self.shards {
+            shard.lock().unwrap().fill(Default::default());
         }
     }
 
-    fn get_element<'a>(&self, hash: u128, items: &'a mut MutexGuard<Vec<Entry>>) -> &'a mut Entry {
-        let index = (hash % items.len() as u128) as usize;
-        items.get_mut(index).unwrap()
+    /// Locks the shard which contains the entry for the given digest
+    /// and returns the index of the entry inside that shard
+    fn lock_shard(&self, digest: u128) -> (MutexGuard<Vec<Entry>>, usize) {
+        let index = (digest % self.size as u128) as usize;
+        let shard_count = self.shards.len();
+        let lock = self.shards[index % shard_count].lock().unwrap();
+        (lock, index / shard_count)
     }
 
     pub fn hash(&self, bytes: &[u8]) -> u128 {
@@ -120,6 +145,10 @@ impl NetworkFilter {
     pub fn new(size: usize) -> Self {
         NetworkFilter::with_hasher(DefaultNetworkFilterHasher::new(), size)
     }
+
+    pub fn with_shards(size: usize, shards: usize) -> Self {
+        NetworkFilter::with_hasher_and_shards(DefaultNetworkFilterHasher::new(), size, shards)
+    }
 }
 
 impl Default for NetworkFilter {
@@ -270,6 +299,41 @@ mod tests {
         assert_eq!(existed, true);
     }
 
+    #[test]
+    fn entries_are_split_over_shards() {
+        let filter = NetworkFilter::with_hasher_and_shards(StubHasher::default(), 10, 4);
+        assert_eq!(filter.shard_count(), 4);
+        for i in 0..10 {
+            assert_eq!(filter.apply_digest(i), false);
+        }
+        for i in 0..10 {
+            assert!(filter.check(i), "digest {} missing", i);
+        }
+
+        // Same slot as digest 1
+        assert_eq!(filter.apply_digest(11), false);
+        assert_eq!(filter.check(1), false);
+        assert!(filter.check(11));
+    }
+
+    #[test]
+    fn shard_count_is_limited_by_size() {
+        let filter = NetworkFilter::with_shards(2, 64);
+        assert_eq!(filter.shard_count(), 2);
+        let filter = NetworkFilter::with_shards(0, 64);
+        assert_eq!(filter.shard_count(), 1);
+    }
+
+    #[test]
+    fn clear_all() {
+        let filter = NetworkFilter::with_hasher_and_shards(StubHasher::default(), 8, 4);
+        filter.apply_digest(1);
+        filter.apply_digest(6);
+        filter.clear_all();
+        assert_eq!(filter.check(1), false);
+        assert_eq!(filter.check(6), false);
+    }
+
     #[test]
     fn expire() {
         let mut filter = NetworkFilter::with_hasher(StubHasher::default(), 4);
@@ -4,8 +4,10 @@ use super::{
 use crate::{
     config::NodeFlags,
     stats::{DetailType, StatType, Stats},
+    utils::place_current_thread,
     NetworkParams,
 };
+use rsnano_core::utils::ThreadRole;
 use rsnano_messages::{Keepalive, Message};
 use rsnano_network::{DeadChannelCleanup, DropPolicy, NetworkInfo, PeerConnector, TrafficType};
 use rsnano_nullable_clock::SteadyClock;
@@ -82,7 +84,10 @@ impl NetworkThreads {
         self.cleanup_thread = Some(
             std::thread::Builder::new()
                 .name("Net cleanup".to_string())
-                .spawn(move || cleanup.run())
+                .spawn(move || {
+                    place_current_thread(ThreadRole::Network);
+                    cleanup.run()
+                })
                 .unwrap(),
         );
 
@@ -99,7 +104,10 @@ impl NetworkThreads {
         self.keepalive_thread = Some(
             std::thread::Builder::new()
                 .name("Net keepalive".to_string())
-                .spawn(move || keepalive.run())
+                .spawn(move || {
+                    place_current_thread(ThreadRole::Network);
+                    keepalive.run()
+                })
                 .unwrap(),
         );
 
@@ -115,7 +123,10 @@ impl NetworkThreads {
             self.reachout_thread = Some(
                 std::thread::Builder::new()
                     .name("Net reachout".to_string())
-                    .spawn(move || reachout.run())
+                    .spawn(move || {
+                        place_current_thread(ThreadRole::Network);
+                        reachout.run()
+                    })
                     .unwrap(),
             );
         }
@@ -4,7 +4,7 @@ use crate::{
     bootstrap::{BootstrapServer, BootstrapService},
     config::NodeConfig,
     consensus::{RequestAggregator, VoteProcessorQueue},
-    stats::{DetailType, Direction, StatType, Stats},
+    stats::{DetailType, Direction, LatencyStage, StatType, Stats},
     wallets::Wallets,
     Telemetry,
 };
@@ -93,6 +93,9 @@ impl RealtimeMessageHandler {
                 } else {
                     BlockSource::Live
                 };
+                self.stats
+                    .latency()
+                    .record(&publish.block.hash(), LatencyStage::Received);
                 let added = self
                     .block_processor
                     .add(publish.block, source, channel.channel_id());
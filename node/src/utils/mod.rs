@@ -3,6 +3,7 @@ mod blake2b;
 mod hardened_constants;
 mod long_running_transaction_logger;
 mod processing_queue;
+mod signature_checker;
 mod thread_pool;
 mod timer;
 mod timer_thread;
@@ -17,6 +18,8 @@ pub use blake2b::*;
 pub use hardened_constants::HardenedConstants;
 pub use long_running_transaction_logger::{LongRunningTransactionLogger, TxnTrackingConfig};
 pub use processing_queue::*;
+pub use rsnano_core::utils::place_current_thread;
+pub use signature_checker::SignatureChecker;
 use std::net::Ipv6Addr;
 pub use thread_pool::*;
 pub use timer_thread::*;
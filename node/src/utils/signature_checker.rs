@@ -0,0 +1,183 @@
+use scoped_threadpool::Pool;
+use std::{cmp::min, sync::Mutex};
+
+/// Verifies the signatures of a whole batch of items (votes, blocks) in parallel.
+/// The batch is split into one chunk per thread, each with at least `MIN_CHUNK_SIZE`
+/// items. One chunk is checked on the calling thread and the others on a persistent
+/// pool of worker threads.
+pub struct SignatureChecker {
+    num_threads: usize,
+    pool: Option<Mutex<Pool>>,
+}
+
+impl SignatureChecker {
+    /// Smaller chunks are not worth the overhead of handing them to a worker thread
+    pub const MIN_CHUNK_SIZE: usize = 32;
+
+    /// With 0 threads all signatures get verified on the calling thread
+    pub fn new(num_threads: usize) -> Self {
+        Self {
+            num_threads,
+            pool: (num_threads > 0).then(|| Mutex::new(Pool::new(num_threads as u32))),
+        }
+    }
+
+    pub fn num_threads(&self) -> usize {
+        self.num_threads
+    }
+
+    /// Calls `verify` for every item and returns the results in the same order as the items
+    pub fn verify<T, R, F>(&self, items: &[T], verify: F) -> Vec<R>
+    where
+        T: Sync,
+        R: Send,
+        F: Fn(&T) -> R + Sync,
+    {
+        self.verify_with(items, || (), |_, item| verify(item))
+    }
+
+    /// Like `verify`, but `init` creates a state once per chunk on the thread that
+    /// checks the chunk, for example a read transaction that all items of the chunk share
+    pub fn verify_with<S, T, R, I, F>(&self, items: &[T], init: I, verify: F) -> Vec<R>
+    where
+        T: Sync,
+        R: Send,
+        I: Fn() -> S + Sync,
+        F: Fn(&mut S, &T) -> R + Sync,
+    {
+        let verify_chunk = |chunk: &[T]| -> Vec<R> {
+            let mut state = init();
+            chunk.iter().map(|item| verify(&mut state, item)).collect()
+        };
+
+        let chunk_count = min(self.num_threads + 1, items.len() / Self::MIN_CHUNK_SIZE);
+        if chunk_count <= 1 {
+            return verify_chunk(items);
+        }
+
+        // The workers are shared by the block and vote processors. If another
+        // batch is being checked right now, the caller doesn't wait for it
+        let Some(Ok(mut pool)) = self.pool.as_ref().map(|p| p.try_lock()) else {
+            return verify_chunk(items);
+        };
+
+        let chunk_size = items.len().div_ceil(chunk_count);
+        let verify_chunk = &verify_chunk;
+        let mut results: Vec<Vec<R>> = (0..chunk_count).map(|_| Vec::new()).collect();
+
+        pool.scoped(|scope| {
+            let mut chunks = items.chunks(chunk_size);
+            let own_chunk = chunks.next().unwrap();
+            let (own_result, other_results) = results.split_first_mut().unwrap();
+
+            for (chunk, result) in chunks.zip(other_results.iter_mut()) {
+                scope.execute(move || *result = verify_chunk(chunk));
+            }
+
+            *own_result = verify_chunk(own_chunk);
+        });
+
+        results.into_iter().flatten().collect()
+    }
+}
+
+impl Default for SignatureChecker {
+    fn default() -> Self {
+        Self::new(0)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::block_processing::BlockProcessorConfig;
+    use rsnano_core::{PrivateKey, Vote};
+    use std::{
+        collections::HashSet,
+        sync::atomic::{AtomicUsize, Ordering},
+        thread,
+    };
+
+    #[test]
+    fn empty_batch() {
+        let checker = SignatureChecker::new(4);
+        let results = checker.verify(&Vec::<Vote>::new(), |vote| vote.validate().is_ok());
+        assert!(results.is_empty());
+    }
+
+    #[test]
+    fn small_batch_is_verified_on_calling_thread() {
+        let checker = SignatureChecker::new(4);
+        let caller = thread::current().id();
+        let results = checker.verify(&[1, 2, 3], |_| thread::current().id());
+        assert_eq!(results, vec![caller; 3]);
+    }
+
+    #[test]
+    fn reuses_worker_threads() {
+        let checker = SignatureChecker::new(2);
+        let caller = thread::current().id();
+        let items: Vec<usize> = (0..SignatureChecker::MIN_CHUNK_SIZE * 3).collect();
+        let mut workers = HashSet::new();
+        for _ in 0..5 {
+            workers.extend(
+                checker
+                    .verify(&items, |_| thread::current().id())
+                    .into_iter()
+                    .filter(|id| *id != caller),
+            );
+        }
+        assert_eq!(workers.len(), 2);
+    }
+
+    #[test]
+    fn splits_default_block_batch() {
+        let checker = SignatureChecker::new(3);
+        let caller = thread::current().id();
+        let items: Vec<usize> = (0..BlockProcessorConfig::default().batch_size).collect();
+        let results = checker.verify(&items, |_| thread::current().id());
+        let threads: HashSet<_> = results.iter().collect();
+        assert!(threads.contains(&caller));
+        assert!(threads.len() > 1);
+    }
+
+    #[test]
+    fn creates_state_once_per_chunk() {
+        let checker = SignatureChecker::new(2);
+        let items: Vec<usize> = (0..SignatureChecker::MIN_CHUNK_SIZE * 3).collect();
+        let inits = AtomicUsize::new(0);
+        let results =
+            checker.verify_with(&items, || inits.fetch_add(1, Ordering::Relaxed), |_, i| *i);
+        assert_eq!(results, items);
+        assert_eq!(inits.load(Ordering::Relaxed), 3);
+    }
+
+    #[test]
+    fn keeps_order_of_results() {
+        let checker = SignatureChecker::new(3);
+        let items: Vec<usize> = (0..SignatureChecker::MIN_CHUNK_SIZE * 5 + 7).collect();
+        let results = checker.verify(&items, |i| *i * 2);
+        let expected: Vec<usize> = items.iter().map(|i| *i * 2).collect();
+        assert_eq!(results, expected);
+    }
+
+    #[test]
+    fn splits_out_invalid_votes() {
+        let checker = SignatureChecker::new(2);
+        let mut votes: Vec<Vote> = (0..SignatureChecker::MIN_CHUNK_SIZE * 16)
+            .map(|_| Vote::new_final(&PrivateKey::new(), vec![1.into()]))
+            .collect();
+        votes[42].signature = Default::default();
+        votes[300].signature = Default::default();
+
+        let results = checker.verify(&votes, |vote| vote.validate().is_ok());
+
+        let invalid: Vec<usize> = results
+            .iter()
+            .enumerate()
+            .filter(|(_, valid)| !**valid)
+            .map(|(i, _)| i)
+            .collect();
+        assert_eq!(invalid, vec![42, 300]);
+    }
+}
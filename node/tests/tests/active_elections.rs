@@ -95,11 +95,7 @@ fn inactive_votes_cache_basic() {
     let vote = Arc::new(Vote::new_final(&DEV_GENESIS_KEY, vec![send.hash()]));
     node.vote_processor_queue
         .vote(vote, ChannelId::from(111), VoteSource::Live);
-    assert_timely_eq(
-        Duration::from_secs(5),
-        || node.vote_cache.lock().unwrap().size(),
-        1,
-    );
+    assert_timely_eq(Duration::from_secs(5), || node.vote_cache.size(), 1);
     node.process_active(send.clone());
     assert_timely_eq(
         Duration::from_secs(5),
@@ -126,11 +122,7 @@ fn non_final() {
     let vote = Arc::new(Vote::new(&DEV_GENESIS_KEY, 0, 0, vec![send.hash()]));
     node.vote_processor_queue
         .vote(vote, ChannelId::from(111), VoteSource::Live);
-    assert_timely_eq(
-        Duration::from_secs(5),
-        || node.vote_cache.lock().unwrap().size(),
-        1,
-    );
+    assert_timely_eq(Duration::from_secs(5), || node.vote_cache.size(), 1);
 
     node.process_active(send.clone());
 
@@ -181,11 +173,7 @@ fn inactive_votes_cache_fork() {
     node.vote_processor_queue
         .vote(vote, ChannelId::from(111), VoteSource::Live);
 
-    assert_timely_eq(
-        Duration::from_secs(5),
-        || node.vote_cache.lock().unwrap().size(),
-        1,
-    );
+    assert_timely_eq(Duration::from_secs(5), || node.vote_cache.size(), 1);
 
     node.process_active(send2.clone());
 
@@ -263,12 +251,9 @@ fn inactive_votes_cache_existing_vote() {
     assert_eq!(send.hash(), last_vote1.hash);
 
     // Attempt to change vote with inactive_votes_cache
-    node.vote_cache
-        .lock()
-        .unwrap()
-        .insert(&vote1, rep_weight, &HashMap::new());
+    node.vote_cache.insert(&vote1, rep_weight, &HashMap::new());
 
-    let cached = node.vote_cache.lock().unwrap().find(&send.hash());
+    let cached = node.vote_cache.find(&send.hash());
     assert_eq!(cached.len(), 1);
     node.vote_router.vote(&cached[0], VoteSource::Live);
 
@@ -318,10 +303,10 @@ fn inactive_votes_cache_multiple_votes() {
 
     assert_timely_eq(
         Duration::from_secs(5),
-        || node.vote_cache.lock().unwrap().find(&send1.hash()).len(),
+        || node.vote_cache.find(&send1.hash()).len(),
         2,
     );
-    assert_eq!(1, node.vote_cache.lock().unwrap().size());
+    assert_eq!(1, node.vote_cache.size());
     let election = start_election(&node, &send1.hash());
     assert_timely_eq(Duration::from_secs(5), || election.vote_count(), 3); // 2 votes and 1 default not_an_account
     assert_eq!(
@@ -377,11 +362,7 @@ fn inactive_votes_cache_election_start() {
     let channel = ChannelId::from(111);
     node.vote_processor_queue
         .vote(vote1, channel, VoteSource::Live);
-    assert_timely_eq(
-        Duration::from_secs(5),
-        || node.vote_cache.lock().unwrap().size(),
-        3,
-    );
+    assert_timely_eq(Duration::from_secs(5), || node.vote_cache.size(), 3);
     assert_eq!(node.active.len(), 0);
     assert_eq!(1, node.ledger.cemented_count());
 
@@ -411,7 +392,7 @@ fn inactive_votes_cache_election_start() {
 
     // A late block arrival also checks the inactive votes cache
     assert_eq!(node.active.len(), 0);
-    let send4_cache = node.vote_cache.lock().unwrap().find(&send4.hash());
+    let send4_cache = node.vote_cache.find(&send4.hash());
     assert_eq!(3, send4_cache.len());
     node.process_active(send3.clone());
     // An election is started for send6 but does not
@@ -97,6 +97,50 @@ fn pruning_depth_max_depth() {
         .block_exists_or_pruned(&tx, &send2.hash()));
 }
 
+#[test]
+fn pipelined_pruning_depth_max_depth() {
+    let mut system = System::new();
+
+    let mut node_config = System::default_config();
+    node_config.enable_voting = false; // Pruning and voting are incompatible in this test
+    node_config.max_pruning_depth = 1; // Pruning with max depth 1
+    node_config.pipelined_pruning = true;
+
+    let mut node_flags = NodeFlags::default();
+    node_flags.enable_pruning = true;
+
+    let node1 = system
+        .build_node()
+        .config(node_config)
+        .flags(node_flags)
+        .finish();
+    let mut lattice = UnsavedBlockLatticeBuilder::new();
+    let key1 = PrivateKey::new();
+    let send1 = lattice.genesis().legacy_send(&key1, Amount::nano(1000));
+    node1.process_active(send1.clone().into());
+    let send2 = lattice.genesis().send_max(&key1);
+    node1.process_active(send2.clone().into());
+
+    node1.confirm(send1.hash().clone());
+    assert_timely(Duration::from_secs(5), || {
+        node1.block_confirmed(&send1.hash())
+    });
+    node1.confirm(send2.hash().clone());
+    assert_timely(Duration::from_secs(5), || {
+        node1.block_confirmed(&send2.hash())
+    });
+
+    node1.ledger_pruning(1, true);
+
+    assert_eq!(node1.ledger.pruned_count(), 1);
+    assert_eq!(node1.ledger.block_count(), 3);
+    let tx = node1.ledger.read_txn();
+    assert!(node1
+        .ledger
+        .any()
+        .block_exists_or_pruned(&tx, &send1.hash()));
+}
+
 // Test that a node configured with `enable_pruning` and `max_pruning_age = 1s` will automatically
 // prune old confirmed blocks without explicitly saying `node.ledger_pruning` in the unit test
 #[test]
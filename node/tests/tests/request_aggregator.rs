@@ -76,8 +76,7 @@ fn one() {
         "no votes generated",
     );
 
-    // Already cached
-    // TODO: This is outdated, aggregator should not be using cache
+    // Already cached, the final vote is sent again
     let dummy_channel = make_fake_channel(&node);
     node.request_aggregator
         .request(request, dummy_channel.channel_id());
@@ -128,7 +127,18 @@ fn one() {
                 Direction::In,
             )
         },
-        2,
+        1,
+    );
+    assert_timely_eq(
+        Duration::from_secs(3),
+        || {
+            node.stats.count(
+                StatType::Requests,
+                DetailType::RequestsCachedVotes,
+                Direction::In,
+            )
+        },
+        1,
     );
     assert_timely_eq(
         Duration::from_secs(3),
@@ -356,7 +366,7 @@ fn two() {
                 Direction::In,
             )
         },
-        4,
+        2,
     );
     assert_timely_eq(
         Duration::from_secs(3),
@@ -367,7 +377,18 @@ fn two() {
                 Direction::In,
             )
         },
-        2,
+        1,
+    );
+    assert_timely_eq(
+        Duration::from_secs(3),
+        || {
+            node.stats.count(
+                StatType::Requests,
+                DetailType::RequestsCachedVotes,
+                Direction::In,
+            )
+        },
+        1,
     );
     assert_timely_eq(
         Duration::from_secs(3),
@@ -475,6 +496,73 @@ fn split() {
     );
 }
 
+#[test]
+fn coalesce_channels() {
+    let mut system = System::new();
+    let mut config = System::default_config_without_backlog_population();
+    // Wait until the requests of both channels are queued
+    config.request_aggregator.batch_size = 2;
+    config.request_aggregator.coalescing_window = Duration::from_secs(5);
+    let node = system.build_node().config(config).finish();
+    node.wallets
+        .insert_adhoc2(
+            &node.wallets.wallet_ids()[0],
+            &DEV_GENESIS_KEY.raw_key(),
+            true,
+        )
+        .unwrap();
+
+    let mut lattice = UnsavedBlockLatticeBuilder::new();
+    let send1 = lattice
+        .genesis()
+        .send(&*DEV_GENESIS_KEY, Amount::nano(1000));
+    node.process(send1.clone()).unwrap();
+    node.confirm(send1.hash());
+
+    let request = vec![(send1.hash(), send1.root())];
+    let channel1 = make_fake_channel(&node);
+    let channel2 = make_fake_channel(&node);
+    node.request_aggregator
+        .request(request.clone(), channel1.channel_id());
+    node.request_aggregator
+        .request(request, channel2.channel_id());
+
+    // One vote is generated and sent to both channels
+    assert_timely_eq(
+        Duration::from_secs(3),
+        || {
+            node.stats.count(
+                StatType::Requests,
+                DetailType::RequestsGeneratedVotes,
+                Direction::In,
+            )
+        },
+        2,
+    );
+    assert_eq!(
+        node.stats.count(
+            StatType::Requests,
+            DetailType::RequestsGeneratedHashes,
+            Direction::In,
+        ),
+        1
+    );
+    // The ledger was only queried for the first channel
+    assert_eq!(
+        node.stats.count(
+            StatType::Requests,
+            DetailType::RequestsCachedHashes,
+            Direction::In,
+        ),
+        1
+    );
+    assert_eq!(
+        node.stats
+            .count(StatType::Requests, DetailType::RequestsFinal, Direction::In,),
+        2
+    );
+}
+
 #[test]
 fn channel_max_queue() {
     let mut system = System::new();
@@ -92,6 +92,14 @@ impl LmdbEnvironment {
             EnvironmentStrategy::Nulled(s) => s.stat(),
         }
     }
+
+    /// ID of the last committed read-write transaction
+    pub fn last_txn_id(&self) -> u64 {
+        match &self.0 {
+            EnvironmentStrategy::Real(s) => s.last_txn_id(),
+            EnvironmentStrategy::Nulled(_) => 0,
+        }
+    }
 }
 
 enum EnvironmentStrategy {
@@ -154,6 +162,13 @@ impl EnvironmentWrapper {
     fn stat(&self) -> lmdb::Result<Stat> {
         self.0.stat()
     }
+
+    fn last_txn_id(&self) -> u64 {
+        let mut info = unsafe { std::mem::zeroed::<lmdb_sys::MDB_envinfo>() };
+        let status = unsafe { lmdb_sys::mdb_env_info(self.0.env(), &mut info) };
+        assert_eq!(status, lmdb_sys::MDB_SUCCESS, "could not read env info");
+        info.me_last_txnid as u64
+    }
 }
 
 struct EnvironmentStub {
@@ -56,6 +56,15 @@ impl RoTransaction {
             RoTransactionStrategy::Nulled(s) => s.count(database),
         }
     }
+
+    /// The ID of the snapshot this transaction reads. It contains the commits
+    /// of all write transactions up to this ID.
+    pub fn id(&self) -> u64 {
+        match &self.strategy {
+            RoTransactionStrategy::Real(s) => s.id(),
+            RoTransactionStrategy::Nulled(_) => 0,
+        }
+    }
 }
 
 enum RoTransactionStrategy {
@@ -93,6 +102,10 @@ impl RoTransactionWrapper {
         let stat = lmdb::Transaction::stat(&self.0, database.as_real());
         stat.unwrap().entries() as u64
     }
+
+    fn id(&self) -> u64 {
+        unsafe { lmdb_sys::mdb_txn_id(lmdb::Transaction::txn(&self.0)) as u64 }
+    }
 }
 
 struct RoTransactionStub {
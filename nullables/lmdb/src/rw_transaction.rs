@@ -106,6 +106,14 @@ impl RwTransaction {
         }
         Ok(())
     }
+
+    /// The ID this transaction will have once it is committed
+    pub fn id(&self) -> u64 {
+        match &self.strategy {
+            RwTransactionStrategy::Real(s) => s.id(),
+            RwTransactionStrategy::Nulled(_) => 0,
+        }
+    }
 }
 
 enum RwTransactionStrategy {
@@ -157,6 +165,10 @@ impl RwTransactionWrapper {
         stat.unwrap().entries() as u64
     }
 
+    fn id(&self) -> u64 {
+        unsafe { lmdb_sys::mdb_txn_id(lmdb::Transaction::txn(&self.0)) as u64 }
+    }
+
     /// ## Safety
     ///
     /// This method is unsafe in the same ways as `Environment::close_db`, and
@@ -371,6 +371,10 @@ impl NanoRpcClient {
         self.request(&RpcCommand::uptime()).await
     }
 
+    pub async fn latency(&self) -> Result<LatencyResponse> {
+        self.request(&RpcCommand::latency()).await
+    }
+
     pub async fn frontier_count(&self) -> Result<CountResponse> {
         self.request(&RpcCommand::FrontierCount).await
     }
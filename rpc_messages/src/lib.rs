@@ -50,6 +50,7 @@ pub enum RpcCommand {
     ConfirmationHistory(ConfirmationHistoryArgs),
     BlockCount,
     Uptime,
+    Latency,
     FrontierCount,
     ValidateAccountNumber(AccountCandidateArg),
     NanoToRaw(AmountRpcMessage),
@@ -0,0 +1,89 @@
+use crate::{RpcCommand, RpcU64};
+use indexmap::IndexMap;
+use serde::{Deserialize, Serialize};
+
+impl RpcCommand {
+    pub fn latency() -> Self {
+        Self::Latency
+    }
+}
+
+#[derive(PartialEq, Eq, Debug, Serialize, Deserialize)]
+pub struct LatencyResponse {
+    /// 1 out of `sampling` blocks and votes is tracked. 0 means disabled
+    pub sampling: RpcU64,
+    /// Time since the previous stage of the block, keyed by stage name, and the
+    /// time through the whole pipeline as "total"
+    pub blocks: IndexMap<String, LatencyDto>,
+    pub votes: IndexMap<String, LatencyDto>,
+}
+
+/// All durations are in microseconds
+#[derive(PartialEq, Eq, Debug, Serialize, Deserialize)]
+pub struct LatencyDto {
+    pub count: RpcU64,
+    pub sum: RpcU64,
+    pub max: RpcU64,
+    pub p50: RpcU64,
+    pub p99: RpcU64,
+    pub p999: RpcU64,
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use serde_json::{from_str, to_string_pretty};
+
+    #[test]
+    fn serialize_latency_command() {
+        assert_eq!(
+            to_string_pretty(&RpcCommand::latency()).unwrap(),
+            r#"{
+  "action": "latency"
+}"#
+        );
+    }
+
+    #[test]
+    fn deserialize_latency_command() {
+        let cmd = RpcCommand::latency();
+        let serialized = to_string_pretty(&cmd).unwrap();
+        let deserialized: RpcCommand = from_str(&serialized).unwrap();
+        assert_eq!(cmd, deserialized);
+    }
+
+    #[test]
+    fn serialize_latency_response() {
+        let latency = LatencyDto {
+            count: 1.into(),
+            sum: 2.into(),
+            max: 3.into(),
+            p50: 4.into(),
+            p99: 5.into(),
+            p999: 6.into(),
+        };
+        let response = LatencyResponse {
+            sampling: 32.into(),
+            blocks: [("total".to_string(), latency)].into(),
+            votes: IndexMap::new(),
+        };
+
+        assert_eq!(
+            to_string_pretty(&response).unwrap(),
+            r#"{
+  "sampling": "32",
+  "blocks": {
+    "total": {
+      "count": "1",
+      "sum": "2",
+      "max": "3",
+      "p50": "4",
+      "p99": "5",
+      "p999": "6"
+    }
+  },
+  "votes": {}
+}"#
+        );
+    }
+}
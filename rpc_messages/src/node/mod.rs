@@ -8,6 +8,7 @@ mod confirmation_history;
 mod confirmation_info;
 mod confirmation_quorum;
 mod keepalive;
+mod latency;
 mod node_id;
 mod peers;
 mod populate_backlog;
@@ -42,6 +43,7 @@ pub use confirmation_active::*;
 pub use confirmation_history::*;
 pub use confirmation_info::*;
 pub use confirmation_quorum::*;
+pub use latency::*;
 pub use node_id::*;
 pub use peers::*;
 pub use process::*;
@@ -0,0 +1,296 @@
+use rsnano_rpc_messages::RpcError;
+use serde::Serialize;
+use std::mem;
+use tokio::sync::mpsc;
+
+/// Writes a JSON response in chunks while it is being generated, so that
+/// huge responses never have to be held in memory as a whole.
+/// A chunk is sent as soon as the buffer reaches `CHUNK_SIZE`. The sender blocks
+/// while `MAX_PENDING_CHUNKS` chunks are not consumed by the client yet.
+pub(crate) struct JsonStreamWriter {
+    sender: Option<mpsc::Sender<Vec<u8>>>,
+    buffer: Vec<u8>,
+    needs_separator: bool,
+    /// A key was written and its value is still missing
+    after_key: bool,
+    /// Closing brackets of the arrays and objects that are open, outermost first
+    open_containers: Vec<u8>,
+    sent_chunks: usize,
+}
+
+impl JsonStreamWriter {
+    pub const CHUNK_SIZE: usize = 64 * 1024;
+    pub const MAX_PENDING_CHUNKS: usize = 4;
+
+    pub fn new(sender: mpsc::Sender<Vec<u8>>) -> Self {
+        Self {
+            sender: Some(sender),
+            buffer: Vec::with_capacity(Self::CHUNK_SIZE),
+            needs_separator: false,
+            after_key: false,
+            open_containers: Vec::new(),
+            sent_chunks: 0,
+        }
+    }
+
+    /// True if the client went away. Producers should stop iterating then
+    pub fn is_closed(&self) -> bool {
+        self.sender.is_none()
+    }
+
+    pub fn open_object(&mut self) {
+        self.open(b'{');
+    }
+
+    pub fn close_object(&mut self) {
+        self.close(b'}');
+    }
+
+    pub fn open_array(&mut self) {
+        self.open(b'[');
+    }
+
+    pub fn close_array(&mut self) {
+        self.close(b']');
+    }
+
+    /// Writes the name of an object field. It has to be followed by a value, an object or an array
+    pub fn key(&mut self, name: &str) {
+        self.write_separator();
+        serde_json::to_writer(&mut self.buffer, name).unwrap();
+        self.buffer.push(b':');
+        self.after_key = true;
+    }
+
+    /// Writes an array element
+    pub fn value(&mut self, value: &impl Serialize) {
+        self.write_separator();
+        serde_json::to_writer(&mut self.buffer, value).unwrap();
+        self.needs_separator = true;
+        self.after_key = false;
+        self.flush_if_full();
+    }
+
+    /// Writes an object field. The key must serialize to a JSON string
+    pub fn entry(&mut self, key: &impl Serialize, value: &impl Serialize) {
+        self.write_separator();
+        serde_json::to_writer(&mut self.buffer, key).unwrap();
+        self.buffer.push(b':');
+        serde_json::to_writer(&mut self.buffer, value).unwrap();
+        self.needs_separator = true;
+        self.flush_if_full();
+    }
+
+    /// Responds with an error object instead, if nothing was sent yet.
+    /// Otherwise the status is already out: the open arrays and objects get closed and
+    /// the error is added as an "error" field of the response object, so that the
+    /// client still gets valid JSON and can tell that the response is incomplete.
+    pub fn error(&mut self, error: &RpcError) {
+        if self.sent_chunks == 0 {
+            self.buffer.clear();
+            self.open_containers.clear();
+            self.needs_separator = false;
+            self.after_key = false;
+            serde_json::to_writer(&mut self.buffer, error).unwrap();
+            return;
+        }
+
+        if self.open_containers.first() != Some(&b'}') {
+            // There is no response object which could take the error
+            self.buffer.clear();
+            self.sender = None;
+            return;
+        }
+        if self.after_key {
+            self.value(&());
+        }
+        while self.open_containers.len() > 1 {
+            let bracket = self.open_containers.pop().unwrap();
+            self.push_close(bracket);
+        }
+        self.entry(&"error", &error.error);
+        self.close_object();
+    }
+
+    /// Sends the rest of the buffer and ends the response
+    pub fn finish(&mut self) {
+        self.flush();
+        self.sender = None;
+    }
+
+    fn open(&mut self, bracket: u8) {
+        self.write_separator();
+        self.buffer.push(bracket);
+        self.needs_separator = false;
+        self.after_key = false;
+        self.open_containers
+            .push(if bracket == b'{' { b'}' } else { b']' });
+    }
+
+    fn close(&mut self, bracket: u8) {
+        debug_assert_eq!(self.open_containers.last(), Some(&bracket));
+        self.open_containers.pop();
+        self.push_close(bracket);
+    }
+
+    fn push_close(&mut self, bracket: u8) {
+        self.buffer.push(bracket);
+        self.needs_separator = true;
+        self.flush_if_full();
+    }
+
+    fn write_separator(&mut self) {
+        if self.needs_separator {
+            self.buffer.push(b',');
+            // A key is always followed by its value, without a separator
+            self.needs_separator = false;
+        }
+    }
+
+    fn flush_if_full(&mut self) {
+        if self.buffer.len() >= Self::CHUNK_SIZE {
+            self.flush();
+        }
+    }
+
+    fn flush(&mut self) {
+        if self.buffer.is_empty() {
+            return;
+        }
+        let chunk = mem::replace(&mut self.buffer, Vec::with_capacity(Self::CHUNK_SIZE));
+        if let Some(sender) = &self.sender {
+            if sender.blocking_send(chunk).is_err() {
+                self.sender = None;
+            } else {
+                self.sent_chunks += 1;
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use serde_json::{json, Value};
+
+    #[test]
+    fn write_nested_objects() {
+        let (tx, mut rx) = mpsc::channel(JsonStreamWriter::MAX_PENDING_CHUNKS);
+        let mut writer = JsonStreamWriter::new(tx);
+
+        writer.open_object();
+        writer.entry(&"account", &"abc");
+        writer.key("history");
+        writer.open_array();
+        writer.value(&1);
+        writer.value(&2);
+        writer.close_array();
+        writer.key("frontiers");
+        writer.open_object();
+        writer.entry(&"a", &"b");
+        writer.entry(&"c", &"d");
+        writer.close_object();
+        writer.close_object();
+        writer.finish();
+
+        assert_eq!(
+            read_json(&mut rx),
+            json!({"account": "abc", "history": [1, 2], "frontiers": {"a": "b", "c": "d"}})
+        );
+    }
+
+    #[test]
+    fn empty_collections() {
+        let (tx, mut rx) = mpsc::channel(JsonStreamWriter::MAX_PENDING_CHUNKS);
+        let mut writer = JsonStreamWriter::new(tx);
+
+        writer.open_object();
+        writer.key("accounts");
+        writer.open_object();
+        writer.close_object();
+        writer.key("history");
+        writer.open_array();
+        writer.close_array();
+        writer.close_object();
+        writer.finish();
+
+        assert_eq!(read_json(&mut rx), json!({"accounts": {}, "history": []}));
+    }
+
+    #[test]
+    fn send_in_chunks() {
+        let (tx, mut rx) = mpsc::channel(1000);
+        let mut writer = JsonStreamWriter::new(tx);
+        let count = 10_000;
+
+        writer.open_array();
+        for i in 0..count {
+            writer.value(&i);
+        }
+        writer.close_array();
+        writer.finish();
+
+        let mut chunks = Vec::new();
+        while let Ok(chunk) = rx.try_recv() {
+            chunks.push(chunk);
+        }
+        assert!(chunks.len() > 1);
+        let json: Value = serde_json::from_slice(&chunks.concat()).unwrap();
+        assert_eq!(json.as_array().unwrap().len(), count);
+    }
+
+    #[test]
+    fn error_before_anything_was_sent() {
+        let (tx, mut rx) = mpsc::channel(JsonStreamWriter::MAX_PENDING_CHUNKS);
+        let mut writer = JsonStreamWriter::new(tx);
+
+        writer.open_object();
+        writer.error(&RpcError::new("Account not found"));
+        writer.finish();
+
+        assert_eq!(read_json(&mut rx), json!({"error": "Account not found"}));
+    }
+
+    #[test]
+    fn error_after_the_first_chunk() {
+        let (tx, mut rx) = mpsc::channel(1000);
+        let mut writer = JsonStreamWriter::new(tx);
+        let count = 10_000;
+
+        writer.open_object();
+        writer.key("frontiers");
+        writer.open_object();
+        for i in 0..count {
+            writer.entry(&i.to_string(), &i);
+        }
+        writer.key("history");
+        writer.error(&RpcError::new("Store error"));
+        writer.finish();
+
+        let json = read_json(&mut rx);
+        assert_eq!(json["error"], "Store error");
+        // The dangling key gets a null value
+        assert_eq!(json["frontiers"].as_object().unwrap().len(), count + 1);
+        assert_eq!(json["frontiers"]["history"], Value::Null);
+    }
+
+    #[test]
+    fn stop_when_client_is_gone() {
+        let (tx, rx) = mpsc::channel(JsonStreamWriter::MAX_PENDING_CHUNKS);
+        let mut writer = JsonStreamWriter::new(tx);
+        drop(rx);
+
+        writer.open_array();
+        while !writer.is_closed() {
+            writer.value(&"x");
+        }
+    }
+
+    fn read_json(rx: &mut mpsc::Receiver<Vec<u8>>) -> Value {
+        let mut bytes = Vec::new();
+        while let Ok(chunk) = rx.try_recv() {
+            bytes.extend(chunk);
+        }
+        serde_json::from_slice(&bytes).unwrap()
+    }
+}
@@ -1,4 +1,4 @@
-use crate::command_handler::RpcCommandHandler;
+use crate::command_handler::{JsonStreamWriter, RpcCommandHandler};
 use anyhow::anyhow;
 use rsnano_core::{Account, Block, BlockBase, BlockHash, SavedBlock};
 use rsnano_ledger::Ledger;
@@ -6,7 +6,7 @@ use rsnano_rpc_messages::{
     unwrap_bool_or_false, unwrap_u64_or_zero, AccountHistoryArgs, AccountHistoryResponse,
     BlockSubTypeDto, BlockTypeDto, HistoryEntry,
 };
-use rsnano_store_lmdb::LmdbReadTransaction;
+use rsnano_store_lmdb::{LmdbReadTransaction, Transaction};
 
 impl RpcCommandHandler {
     pub(crate) fn account_history(
@@ -16,6 +16,35 @@ impl RpcCommandHandler {
         let helper = AccountHistoryHelper::new(&self.node.ledger, args);
         helper.account_history()
     }
+
+    pub(crate) fn stream_account_history(
+        &self,
+        args: AccountHistoryArgs,
+        writer: &mut JsonStreamWriter,
+    ) -> anyhow::Result<()> {
+        let mut helper = AccountHistoryHelper::new(&self.node.ledger, args);
+        let mut tx = self.node.ledger.read_txn();
+        helper.initialize(&tx)?;
+
+        writer.open_object();
+        writer.entry(&"account", &helper.account);
+        writer.key("history");
+        writer.open_array();
+        helper.for_each_entry(&mut tx, |entry| {
+            writer.value(&entry);
+            !writer.is_closed()
+        });
+        writer.close_array();
+        let (previous, next) = helper.previous_and_next();
+        if let Some(previous) = previous {
+            writer.entry(&"previous", &previous);
+        }
+        if let Some(next) = next {
+            writer.entry(&"next", &next);
+        }
+        writer.close_object();
+        Ok(())
+    }
 }
 
 pub(crate) struct AccountHistoryHelper<'a> {
@@ -83,10 +112,24 @@ impl<'a> AccountHistoryHelper<'a> {
     }
 
     pub(crate) fn account_history(mut self) -> anyhow::Result<AccountHistoryResponse> {
-        let tx = self.ledger.read_txn();
+        let mut tx = self.ledger.read_txn();
         self.initialize(&tx)?;
         let mut history = Vec::new();
-        let mut next_block = self.ledger.any().get_block(&tx, &self.current_block_hash);
+        self.for_each_entry(&mut tx, |entry| {
+            history.push(entry);
+            true
+        });
+        Ok(self.create_response(history))
+    }
+
+    /// Walks the chain until `count` entries were found or `f` returns false.
+    /// The read transaction gets renewed between blocks if it is open for too long.
+    fn for_each_entry(
+        &mut self,
+        tx: &mut LmdbReadTransaction,
+        mut f: impl FnMut(HistoryEntry) -> bool,
+    ) {
+        let mut next_block = self.ledger.any().get_block(tx, &self.current_block_hash);
         while let Some(block) = next_block {
             if self.count == 0 {
                 break;
@@ -95,16 +138,17 @@ impl<'a> AccountHistoryHelper<'a> {
             if self.offset > 0 {
                 self.offset -= 1;
             } else {
-                if let Some(entry) = self.entry_for(&block, &tx) {
-                    history.push(entry);
+                if let Some(entry) = self.entry_for(&block, tx) {
                     self.count -= 1;
+                    if !f(entry) {
+                        break;
+                    }
                 }
             }
 
-            next_block = self.go_to_next_block(&tx, &block);
+            tx.refresh_if_needed();
+            next_block = self.go_to_next_block(tx, &block);
         }
-
-        Ok(self.create_response(history))
     }
 
     fn go_to_next_block(&mut self, tx: &LmdbReadTransaction, block: &Block) -> Option<SavedBlock> {
@@ -297,21 +341,23 @@ impl<'a> AccountHistoryHelper<'a> {
     }
 
     fn create_response(&self, history: Vec<HistoryEntry>) -> AccountHistoryResponse {
-        let mut response = AccountHistoryResponse {
+        let (previous, next) = self.previous_and_next();
+        AccountHistoryResponse {
             account: self.account,
             history,
-            previous: None,
-            next: None,
-        };
+            previous,
+            next,
+        }
+    }
 
-        if !self.current_block_hash.is_zero() {
-            if self.reverse {
-                response.next = Some(self.current_block_hash);
-            } else {
-                response.previous = Some(self.current_block_hash);
-            }
+    fn previous_and_next(&self) -> (Option<BlockHash>, Option<BlockHash>) {
+        if self.current_block_hash.is_zero() {
+            (None, None)
+        } else if self.reverse {
+            (None, Some(self.current_block_hash))
+        } else {
+            (Some(self.current_block_hash), None)
         }
-        response
     }
 }
 
@@ -1,11 +1,34 @@
-use crate::command_handler::RpcCommandHandler;
+use crate::command_handler::{JsonStreamWriter, RpcCommandHandler};
 use rsnano_core::{Account, Amount, PublicKey};
 use rsnano_rpc_messages::{unwrap_u64_or, DelegatorsArgs, DelegatorsResponse};
+use rsnano_store_lmdb::Transaction;
+use std::collections::HashMap;
 
 impl RpcCommandHandler {
     pub(crate) fn delegators(&self, args: DelegatorsArgs) -> DelegatorsResponse {
+        let mut delegators = HashMap::new();
+        self.for_each_delegator(args, |account, balance| {
+            delegators.insert(account, balance);
+            true
+        });
+        DelegatorsResponse::new(delegators)
+    }
+
+    pub(crate) fn stream_delegators(&self, args: DelegatorsArgs, writer: &mut JsonStreamWriter) {
+        writer.open_object();
+        writer.key("delegators");
+        writer.open_object();
+        self.for_each_delegator(args, |account, balance| {
+            writer.entry(&account, &balance);
+            !writer.is_closed()
+        });
+        writer.close_object();
+        writer.close_object();
+    }
+
+    fn for_each_delegator(&self, args: DelegatorsArgs, mut f: impl FnMut(Account, Amount) -> bool) {
         let representative: PublicKey = args.account.into();
-        let count = unwrap_u64_or(args.count, 1024) as usize;
+        let mut count = unwrap_u64_or(args.count, 1024);
         let threshold = args.threshold.unwrap_or(Amount::zero());
 
         let start_account = args
@@ -14,22 +37,49 @@ impl RpcCommandHandler {
             .inc()
             .unwrap_or_default();
 
-        let tx = self.node.ledger.read_txn();
+        let mut tx = self.node.ledger.read_txn();
+        let store = &self.node.store;
 
-        let delegators = self
-            .node
-            .store
-            .account
-            .iter_range(&tx, start_account..)
-            .filter_map(|(account, info)| {
+        if self.node.ledger.delegators_index_enabled() {
+            let mut start = start_account;
+            loop {
+                let mut resume_at = None;
+                for account in store.delegator.iter_delegators(&tx, &representative, start) {
+                    if count == 0 {
+                        return;
+                    }
+                    if tx.is_refresh_needed() {
+                        resume_at = Some(account);
+                        break;
+                    }
+                    let Some(info) = store.account.get(&tx, &account) else {
+                        continue;
+                    };
+                    if info.balance >= threshold {
+                        count -= 1;
+                        if !f(account, info.balance) {
+                            return;
+                        }
+                    }
+                }
+                let Some(account) = resume_at else {
+                    return;
+                };
+                start = account;
+                tx.refresh();
+            }
+        } else {
+            self.for_each_account(&mut tx, start_account, |_, account, info| {
+                if count == 0 {
+                    return false;
+                }
                 if info.representative == representative && info.balance >= threshold {
-                    Some((account, info.balance))
+                    count -= 1;
+                    f(account, info.balance)
                 } else {
-                    None
+                    true
                 }
-            })
-            .take(count);
-
-        DelegatorsResponse::new(delegators.collect())
+            });
+        }
     }
 }
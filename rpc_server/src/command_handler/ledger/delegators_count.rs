@@ -7,14 +7,20 @@ impl RpcCommandHandler {
         let representative: PublicKey = args.account.into();
         let tx = self.node.ledger.read_txn();
 
-        let count = self
-            .node
-            .store
-            .account
-            .iter(&tx)
-            .filter(|(_, info)| info.representative == representative)
-            .count();
+        let count = if self.node.ledger.delegators_index_enabled() {
+            self.node
+                .store
+                .delegator
+                .delegators_count(&tx, &representative)
+        } else {
+            self.node
+                .store
+                .account
+                .iter(&tx)
+                .filter(|(_, info)| info.representative == representative)
+                .count() as u64
+        };
 
-        CountResponse::new(count as u64)
+        CountResponse::new(count)
     }
 }
@@ -1,18 +1,43 @@
-use crate::command_handler::RpcCommandHandler;
+use crate::command_handler::{JsonStreamWriter, RpcCommandHandler};
+use rsnano_core::{Account, BlockHash};
 use rsnano_rpc_messages::{FrontiersArgs, FrontiersResponse};
+use std::collections::HashMap;
 
 impl RpcCommandHandler {
     pub(crate) fn frontiers(&self, args: FrontiersArgs) -> FrontiersResponse {
-        let tx = self.node.ledger.read_txn();
+        let mut frontiers = HashMap::new();
+        self.for_each_frontier(args, |account, head| {
+            frontiers.insert(account, head);
+            true
+        });
+        FrontiersResponse::new(frontiers)
+    }
 
-        let frontiers = self
-            .node
-            .store
-            .account
-            .iter_range(&tx, args.account..)
-            .map(|(account, info)| (account, info.head))
-            .take(args.count.into());
+    pub(crate) fn stream_frontiers(&self, args: FrontiersArgs, writer: &mut JsonStreamWriter) {
+        writer.open_object();
+        writer.key("frontiers");
+        writer.open_object();
+        self.for_each_frontier(args, |account, head| {
+            writer.entry(&account, &head);
+            !writer.is_closed()
+        });
+        writer.close_object();
+        writer.close_object();
+    }
 
-        FrontiersResponse::new(frontiers.collect())
+    fn for_each_frontier(
+        &self,
+        args: FrontiersArgs,
+        mut f: impl FnMut(Account, BlockHash) -> bool,
+    ) {
+        let mut tx = self.node.ledger.read_txn();
+        let mut count = u64::from(args.count);
+        self.for_each_account(&mut tx, args.account, |_, account, info| {
+            if count == 0 {
+                return false;
+            }
+            count -= 1;
+            f(account, info.head)
+        });
     }
 }
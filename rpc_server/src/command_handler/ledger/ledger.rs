@@ -1,111 +1,133 @@
-use crate::command_handler::RpcCommandHandler;
-use rsnano_core::{Account, Amount};
+use crate::command_handler::{JsonStreamWriter, RpcCommandHandler};
+use rsnano_core::{Account, AccountInfo, Amount};
 use rsnano_rpc_messages::{
     unwrap_bool_or_false, unwrap_u64_or_max, unwrap_u64_or_zero, LedgerAccountInfo, LedgerArgs,
     LedgerResponse,
 };
+use rsnano_store_lmdb::{LmdbReadTransaction, Transaction};
 use std::collections::HashMap;
 
 impl RpcCommandHandler {
     pub(crate) fn ledger(&self, args: LedgerArgs) -> LedgerResponse {
+        let mut accounts: HashMap<Account, LedgerAccountInfo> = HashMap::new();
+        self.for_each_ledger_account(args, |account, entry| {
+            accounts.insert(account, entry);
+            true
+        });
+        LedgerResponse { accounts }
+    }
+
+    pub(crate) fn stream_ledger(&self, args: LedgerArgs, writer: &mut JsonStreamWriter) {
+        writer.open_object();
+        writer.key("accounts");
+        writer.open_object();
+        self.for_each_ledger_account(args, |account, entry| {
+            writer.entry(&account, &entry);
+            !writer.is_closed()
+        });
+        writer.close_object();
+        writer.close_object();
+    }
+
+    fn for_each_ledger_account(
+        &self,
+        args: LedgerArgs,
+        mut f: impl FnMut(Account, LedgerAccountInfo) -> bool,
+    ) {
         let count = unwrap_u64_or_max(args.count);
-        let threshold = args.threshold.unwrap_or(Amount::zero());
         let start = args.account.unwrap_or_default();
         let modified_since = unwrap_u64_or_zero(args.modified_since);
         let sorting = unwrap_bool_or_false(args.sorting);
-        let representative = unwrap_bool_or_false(args.representative);
-        let weight = unwrap_bool_or_false(args.weight);
-        let receivable = unwrap_bool_or_false(args.receivable);
+        let options = LedgerEntryOptions {
+            threshold: args.threshold.unwrap_or(Amount::zero()),
+            representative: unwrap_bool_or_false(args.representative),
+            weight: unwrap_bool_or_false(args.weight),
+            receivable: unwrap_bool_or_false(args.receivable),
+        };
 
-        let mut accounts: HashMap<Account, LedgerAccountInfo> = HashMap::new();
-        let tx = self.node.store.tx_begin_read();
+        let mut tx = self.node.store.tx_begin_read();
+        let mut found = 0;
+        let mut emit = |tx: &LmdbReadTransaction, account: Account, info: &AccountInfo| {
+            let Some(entry) = self.ledger_entry(tx, &account, info, &options) else {
+                return true;
+            };
+            found += 1;
+            f(account, entry) && found < count
+        };
 
         if !sorting {
             // Simple
-            for (account, info) in self.node.store.account.iter_range(&tx, start..) {
-                if info.modified >= modified_since && (receivable || info.balance >= threshold) {
-                    let receivable = if receivable {
-                        let account_receivable =
-                            self.node.ledger.account_receivable(&tx, &account, false);
-                        if info.balance + account_receivable < threshold {
-                            continue;
-                        }
-                        Some(account_receivable)
-                    } else {
-                        None
-                    };
-
-                    let entry = LedgerAccountInfo {
-                        frontier: info.head,
-                        open_block: info.open_block,
-                        representative_block: self
-                            .node
-                            .ledger
-                            .representative_block_hash(&tx, &info.head),
-                        balance: info.balance,
-                        modified_timestamp: info.modified.into(),
-                        block_count: info.block_count.into(),
-                        representative: representative.then(|| info.representative.into()),
-                        weight: weight.then(|| self.node.ledger.weight_exact(&tx, account.into())),
-                        pending: receivable,
-                        receivable,
-                    };
-                    accounts.insert(account, entry);
-                    if accounts.len() >= count as usize {
-                        break;
-                    }
+            self.for_each_account(&mut tx, start, |tx, account, info| {
+                if info.modified >= modified_since {
+                    emit(tx, account, &info)
+                } else {
+                    true
                 }
-            }
+            });
         } else {
             // Sorting
             let mut ledger: Vec<(Amount, Account)> = Vec::new();
-            for (account, info) in self.node.store.account.iter_range(&tx, start..) {
+            self.for_each_account(&mut tx, start, |_, account, info| {
                 if info.modified >= modified_since {
                     ledger.push((info.balance, account));
                 }
-            }
+                true
+            });
 
             ledger.sort_by(|a, b| b.cmp(&a));
 
             for (_, account) in ledger {
+                tx.refresh_if_needed();
                 if let Some(info) = self.node.store.account.get(&tx, &account) {
-                    if receivable || info.balance >= threshold {
-                        let pending = if receivable {
-                            let account_receivable =
-                                self.node.ledger.account_receivable(&tx, &account, false);
-                            if info.balance + account_receivable < threshold {
-                                continue;
-                            }
-                            Some(account_receivable)
-                        } else {
-                            None
-                        };
-
-                        let entry = LedgerAccountInfo {
-                            frontier: info.head,
-                            open_block: info.open_block,
-                            representative_block: self
-                                .node
-                                .ledger
-                                .representative_block_hash(&tx, &info.head),
-                            balance: info.balance,
-                            modified_timestamp: info.modified.into(),
-                            block_count: info.block_count.into(),
-                            representative: representative.then(|| info.representative.into()),
-                            weight: weight
-                                .then(|| self.node.ledger.weight_exact(&tx, account.into())),
-                            pending,
-                            receivable: pending,
-                        };
-                        accounts.insert(account, entry);
-                        if accounts.len() >= count as usize {
-                            break;
-                        }
+                    if !emit(&tx, account, &info) {
+                        break;
                     }
                 }
             }
         }
+    }
 
-        LedgerResponse { accounts }
+    fn ledger_entry(
+        &self,
+        tx: &LmdbReadTransaction,
+        account: &Account,
+        info: &AccountInfo,
+        options: &LedgerEntryOptions,
+    ) -> Option<LedgerAccountInfo> {
+        if !options.receivable && info.balance < options.threshold {
+            return None;
+        }
+
+        let receivable = if options.receivable {
+            let account_receivable = self.node.ledger.account_receivable(tx, account, false);
+            if info.balance + account_receivable < options.threshold {
+                return None;
+            }
+            Some(account_receivable)
+        } else {
+            None
+        };
+
+        Some(LedgerAccountInfo {
+            frontier: info.head,
+            open_block: info.open_block,
+            representative_block: self.node.ledger.representative_block_hash(tx, &info.head),
+            balance: info.balance,
+            modified_timestamp: info.modified.into(),
+            block_count: info.block_count.into(),
+            representative: options.representative.then(|| info.representative.into()),
+            weight: options
+                .weight
+                .then(|| self.node.ledger.weight_exact(tx, (*account).into())),
+            pending: receivable,
+            receivable,
+        })
     }
 }
+
+struct LedgerEntryOptions {
+    threshold: Amount,
+    representative: bool,
+    weight: bool,
+    receivable: bool,
+}
@@ -1,16 +1,38 @@
-use crate::command_handler::RpcCommandHandler;
+use crate::command_handler::{JsonStreamWriter, RpcCommandHandler};
 use rsnano_core::{Account, Amount, BlockHash, PendingKey};
 use rsnano_rpc_messages::{unwrap_u64_or_max, UnopenedArgs, UnopenedResponse};
+use rsnano_store_lmdb::Transaction;
 use std::collections::HashMap;
 
 impl RpcCommandHandler {
     pub(crate) fn unopened(&self, args: UnopenedArgs) -> UnopenedResponse {
+        let mut accounts: HashMap<Account, Amount> = HashMap::new();
+        self.for_each_unopened(args, |account, amount| {
+            accounts.insert(account, amount);
+            true
+        });
+        UnopenedResponse::new(accounts)
+    }
+
+    pub(crate) fn stream_unopened(&self, args: UnopenedArgs, writer: &mut JsonStreamWriter) {
+        writer.open_object();
+        writer.key("accounts");
+        writer.open_object();
+        self.for_each_unopened(args, |account, amount| {
+            writer.entry(&account, &amount);
+            !writer.is_closed()
+        });
+        writer.close_object();
+        writer.close_object();
+    }
+
+    fn for_each_unopened(&self, args: UnopenedArgs, mut f: impl FnMut(Account, Amount) -> bool) {
         let count = unwrap_u64_or_max(args.count) as usize;
         let threshold = args.threshold.unwrap_or_default();
         let start = args.account.unwrap_or(Account::from(1)); // exclude burn account by default
-        let mut accounts: HashMap<Account, Amount> = HashMap::new();
+        let mut found = 0;
 
-        let tx = self.node.store.tx_begin_read();
+        let mut tx = self.node.store.tx_begin_read();
 
         let mut iterator = self
             .node
@@ -23,11 +45,20 @@ impl RpcCommandHandler {
 
         let mut current = iterator.next();
         while let Some(cur) = current {
-            if accounts.len() >= count {
+            if found >= count {
                 break;
             }
 
             let (key, info) = cur;
+
+            if tx.is_refresh_needed() {
+                // Don't keep old database pages alive during a long scan
+                drop(iterator);
+                tx.refresh();
+                iterator = self.node.store.pending.iter_range(&tx, key..);
+                current = iterator.next();
+                continue;
+            }
             let account = key.receiving_account;
 
             if self.node.store.account.get(&tx, &account).is_some() {
@@ -44,7 +75,10 @@ impl RpcCommandHandler {
                 if account != current_account {
                     if !current_account_sum.is_zero() {
                         if current_account_sum >= threshold {
-                            accounts.insert(current_account, current_account_sum);
+                            found += 1;
+                            if !f(current_account, current_account_sum) {
+                                return;
+                            }
                         }
                         current_account_sum = Amount::zero();
                     }
@@ -57,13 +91,8 @@ impl RpcCommandHandler {
         }
 
         // last one after iterator reaches end
-        if accounts.len() < count
-            && !current_account_sum.is_zero()
-            && current_account_sum >= threshold
-        {
-            accounts.insert(current_account, current_account_sum);
+        if found < count && !current_account_sum.is_zero() && current_account_sum >= threshold {
+            f(current_account, current_account_sum);
         }
-
-        UnopenedResponse::new(accounts)
     }
 }
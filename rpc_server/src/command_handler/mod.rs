@@ -1,3 +1,4 @@
+mod json_stream;
 mod ledger;
 mod node;
 mod utils;
@@ -7,13 +8,18 @@ use anyhow::anyhow;
 use rsnano_core::{Account, AccountInfo, BlockHash, SavedBlock};
 use rsnano_node::Node;
 use rsnano_rpc_messages::{RpcCommand, RpcError, StatsType};
-use rsnano_store_lmdb::Transaction;
+use rsnano_store_lmdb::{LmdbReadTransaction, Transaction};
 use serde_json::{to_value, Value};
-use std::sync::{Arc, Mutex};
+use std::{
+    panic::{self, AssertUnwindSafe},
+    sync::{Arc, Mutex},
+};
 use tokio::sync::oneshot;
 use tracing::debug;
 use utils::*;
 
+pub(crate) use json_stream::JsonStreamWriter;
+
 #[derive(Clone)]
 pub(crate) struct RpcCommandHandler {
     node: Arc<Node>,
@@ -35,6 +41,49 @@ impl RpcCommandHandler {
         self.call_handler(command).unwrap_or_else(Self::error_value)
     }
 
+    /// Commands whose responses can get huge. They are written to the client
+    /// while they are generated instead of being built in memory first
+    pub fn is_streamed(command: &RpcCommand) -> bool {
+        matches!(
+            command,
+            RpcCommand::AccountHistory(_)
+                | RpcCommand::Delegators(_)
+                | RpcCommand::Frontiers(_)
+                | RpcCommand::Ledger(_)
+                | RpcCommand::Unopened(_)
+        )
+    }
+
+    pub fn handle_streamed(&self, command: RpcCommand, writer: &mut JsonStreamWriter) {
+        debug!(?command, "Handling streamed RPC command");
+        // A store error panics while the response is being written
+        let result = panic::catch_unwind(AssertUnwindSafe(|| {
+            self.call_streamed_handler(command, writer)
+        }))
+        .unwrap_or_else(|_| Err(anyhow!("Internal error")));
+        if let Err(e) = result {
+            writer.error(&RpcError::new(e.to_string()));
+        }
+        writer.finish();
+    }
+
+    fn call_streamed_handler(
+        &self,
+        command: RpcCommand,
+        writer: &mut JsonStreamWriter,
+    ) -> anyhow::Result<()> {
+        self.check_control_enabled(&command)?;
+        match command {
+            RpcCommand::AccountHistory(args) => self.stream_account_history(args, writer)?,
+            RpcCommand::Delegators(args) => self.stream_delegators(args, writer),
+            RpcCommand::Frontiers(args) => self.stream_frontiers(args, writer),
+            RpcCommand::Ledger(args) => self.stream_ledger(args, writer),
+            RpcCommand::Unopened(args) => self.stream_unopened(args, writer),
+            _ => return Err(anyhow!("Command can't be streamed")),
+        }
+        Ok(())
+    }
+
     fn error_value(error: anyhow::Error) -> serde_json::Value {
         serde_json::to_value(RpcError::new(error.to_string())).unwrap()
     }
@@ -124,6 +173,7 @@ impl RpcCommandHandler {
             RpcCommand::WorkSet(args) => to_value(self.work_set(args)?),
             RpcCommand::WorkValidate(args) => to_value(self.work_validate(args)),
             RpcCommand::Uptime => to_value(self.uptime()),
+            RpcCommand::Latency => to_value(self.latency()),
             RpcCommand::NanoToRaw(args) => to_value(nano_to_raw(args)?),
             RpcCommand::RawToNano(args) => to_value(raw_to_nano(args)),
             RpcCommand::Ledger(args) => to_value(self.ledger(args)),
@@ -192,6 +242,35 @@ impl RpcCommandHandler {
             .ok_or_else(|| anyhow!(Self::ACCOUNT_NOT_FOUND))
     }
 
+    /// Iterates the accounts starting at `start` until `f` returns false.
+    /// The read transaction gets renewed periodically, so that a long scan
+    /// doesn't keep old database pages alive.
+    fn for_each_account(
+        &self,
+        tx: &mut LmdbReadTransaction,
+        start: Account,
+        mut f: impl FnMut(&LmdbReadTransaction, Account, AccountInfo) -> bool,
+    ) {
+        let mut start = start;
+        loop {
+            let mut resume_at = None;
+            for (account, info) in self.node.store.account.iter_range(&*tx, start..) {
+                if tx.is_refresh_needed() {
+                    resume_at = Some(account);
+                    break;
+                }
+                if !f(tx, account, info) {
+                    return;
+                }
+            }
+            let Some(account) = resume_at else {
+                return;
+            };
+            start = account;
+            tx.refresh();
+        }
+    }
+
     const BLOCK_NOT_FOUND: &str = "Block not found";
     const NOT_IMPLEMENTED: &str = "Not implemented yet";
     const ACCOUNT_NOT_FOUND: &str = "Account not found";
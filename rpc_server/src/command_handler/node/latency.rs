@@ -0,0 +1,38 @@
+use crate::command_handler::RpcCommandHandler;
+use indexmap::IndexMap;
+use rsnano_node::stats::LatencySummary;
+use rsnano_rpc_messages::{LatencyDto, LatencyResponse};
+
+impl RpcCommandHandler {
+    pub(crate) fn latency(&self) -> LatencyResponse {
+        let latency = self.node.stats.latency();
+
+        let mut blocks: IndexMap<_, _> = latency
+            .stages()
+            .map(|(stage, summary)| (stage.as_str().to_string(), to_dto(summary)))
+            .collect();
+        blocks.insert("total".to_string(), to_dto(latency.total()));
+
+        LatencyResponse {
+            sampling: latency.sampling().into(),
+            blocks,
+            votes: [("processing".to_string(), to_dto(latency.vote_processing()))].into(),
+        }
+    }
+
+    /// The latency histograms in the Prometheus text exposition format
+    pub(crate) fn latency_metrics(&self) -> String {
+        crate::metrics::latency_metrics(self.node.stats.latency())
+    }
+}
+
+fn to_dto(summary: LatencySummary) -> LatencyDto {
+    LatencyDto {
+        count: summary.count.into(),
+        sum: summary.sum_us.into(),
+        max: summary.max_us.into(),
+        p50: summary.p50_us.into(),
+        p99: summary.p99_us.into(),
+        p999: summary.p999_us.into(),
+    }
+}
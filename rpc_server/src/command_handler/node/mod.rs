@@ -5,6 +5,7 @@ mod confirmation_history;
 mod confirmation_info;
 mod confirmation_quorum;
 mod keepalive;
+mod latency;
 mod node_id;
 mod peers;
 mod populate_backlog;
@@ -1,5 +1,6 @@
 pub(crate) mod command_handler;
 mod config;
+mod metrics;
 mod server;
 mod toml;
 
@@ -0,0 +1,134 @@
+use rsnano_node::stats::{LatencySummary, LatencyTracker};
+use std::fmt::Write;
+
+/// Formats the latency histograms as Prometheus summaries in the text exposition format.
+/// The durations are converted to seconds, as Prometheus expects
+pub(crate) fn latency_metrics(latency: &LatencyTracker) -> String {
+    let mut out = String::new();
+
+    write_header(
+        &mut out,
+        "nano_block_stage_latency_seconds",
+        "Time a sampled block spent since its previous pipeline stage",
+    );
+    for (stage, summary) in latency.stages() {
+        write_summary(
+            &mut out,
+            "nano_block_stage_latency_seconds",
+            &format!("stage=\"{}\"", stage.as_str()),
+            &summary,
+        );
+    }
+
+    write_header(
+        &mut out,
+        "nano_block_total_latency_seconds",
+        "Time a sampled block spent from arrival until the observers were notified of its cementing",
+    );
+    write_summary(
+        &mut out,
+        "nano_block_total_latency_seconds",
+        "",
+        &latency.total(),
+    );
+
+    write_header(
+        &mut out,
+        "nano_vote_processing_latency_seconds",
+        "Time a sampled vote spent from queueing until it was applied",
+    );
+    write_summary(
+        &mut out,
+        "nano_vote_processing_latency_seconds",
+        "",
+        &latency.vote_processing(),
+    );
+
+    out
+}
+
+fn write_header(out: &mut String, name: &str, help: &str) {
+    writeln!(out, "# HELP {name} {help}").unwrap();
+    writeln!(out, "# TYPE {name} summary").unwrap();
+}
+
+fn write_summary(out: &mut String, name: &str, labels: &str, summary: &LatencySummary) {
+    let separator = if labels.is_empty() { "" } else { "," };
+    for (quantile, micros) in [
+        ("0.5", summary.p50_us),
+        ("0.99", summary.p99_us),
+        ("0.999", summary.p999_us),
+    ] {
+        writeln!(
+            out,
+            "{name}{{{labels}{separator}quantile=\"{quantile}\"}} {}",
+            seconds(micros)
+        )
+        .unwrap();
+    }
+
+    let labels = if labels.is_empty() {
+        String::new()
+    } else {
+        format!("{{{labels}}}")
+    };
+    writeln!(out, "{name}_sum{labels} {}", seconds(summary.sum_us)).unwrap();
+    writeln!(out, "{name}_count{labels} {}", summary.count).unwrap();
+}
+
+fn seconds(micros: u64) -> f64 {
+    micros as f64 / 1_000_000.0
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn summary_with_labels() {
+        let mut out = String::new();
+        let summary = LatencySummary {
+            count: 2,
+            sum_us: 3_000_000,
+            max_us: 2_000_000,
+            p50_us: 1_000_000,
+            p99_us: 2_000_000,
+            p999_us: 2_000_000,
+        };
+
+        write_summary(&mut out, "latency", "stage=\"queued\"", &summary);
+
+        assert_eq!(
+            out,
+            "latency{stage=\"queued\",quantile=\"0.5\"} 1\n\
+             latency{stage=\"queued\",quantile=\"0.99\"} 2\n\
+             latency{stage=\"queued\",quantile=\"0.999\"} 2\n\
+             latency_sum{stage=\"queued\"} 3\n\
+             latency_count{stage=\"queued\"} 2\n"
+        );
+    }
+
+    #[test]
+    fn summary_without_labels() {
+        let mut out = String::new();
+
+        write_summary(&mut out, "latency", "", &LatencySummary::default());
+
+        assert_eq!(
+            out,
+            "latency{quantile=\"0.5\"} 0\n\
+             latency{quantile=\"0.99\"} 0\n\
+             latency{quantile=\"0.999\"} 0\n\
+             latency_sum 0\n\
+             latency_count 0\n"
+        );
+    }
+
+    #[test]
+    fn all_latencies() {
+        let out = latency_metrics(&LatencyTracker::new(1));
+        assert!(out.contains("nano_block_stage_latency_seconds{stage=\"election_started\""));
+        assert!(out.contains("nano_block_total_latency_seconds_count 0"));
+        assert!(out.contains("nano_vote_processing_latency_seconds_count 0"));
+    }
+}
@@ -1,10 +1,18 @@
-use crate::command_handler::RpcCommandHandler;
+use crate::command_handler::{JsonStreamWriter, RpcCommandHandler};
 use anyhow::{Context, Result};
-use axum::{extract::State, http::Request, middleware::map_request, routing::post, Json, Router};
+use axum::{
+    body::Body,
+    extract::State,
+    http::{header, Request},
+    middleware::map_request,
+    response::{IntoResponse, Response},
+    routing::{get, post},
+    Json, Router,
+};
 use rsnano_node::Node;
 use rsnano_rpc_messages::RpcCommand;
-use std::{future::Future, sync::Arc};
-use tokio::{net::TcpListener, task::spawn_blocking};
+use std::{convert::Infallible, future::Future, sync::Arc};
+use tokio::{net::TcpListener, sync::mpsc, task::spawn_blocking};
 use tracing::info;
 
 pub async fn run_rpc_server<F>(
@@ -22,6 +30,7 @@ where
     let app = Router::new()
         .route("/", post(handle_rpc))
         .layer(map_request(set_json_content))
+        .route("/metrics", get(handle_metrics))
         .with_state(command_handler);
 
     info!("RPC listening address: {}", listener.local_addr()?);
@@ -35,11 +44,44 @@ where
 async fn handle_rpc(
     State(command_handler): State<RpcCommandHandler>,
     Json(command): Json<RpcCommand>,
-) -> Json<serde_json::Value> {
+) -> Response {
+    if RpcCommandHandler::is_streamed(&command) {
+        return stream_rpc(command_handler, command);
+    }
+
     let response = spawn_blocking(move || command_handler.handle(command))
         .await
         .unwrap();
-    Json(response)
+    Json(response).into_response()
+}
+
+/// Scrape endpoint for Prometheus
+async fn handle_metrics(State(command_handler): State<RpcCommandHandler>) -> Response {
+    (
+        [(header::CONTENT_TYPE, "text/plain; version=0.0.4")],
+        command_handler.latency_metrics(),
+    )
+        .into_response()
+}
+
+/// Sends the response chunk by chunk while the command handler is still generating it
+fn stream_rpc(command_handler: RpcCommandHandler, command: RpcCommand) -> Response {
+    let (tx, rx) = mpsc::channel(JsonStreamWriter::MAX_PENDING_CHUNKS);
+    spawn_blocking(move || {
+        let mut writer = JsonStreamWriter::new(tx);
+        command_handler.handle_streamed(command, &mut writer);
+    });
+
+    let chunks = futures_util::stream::unfold(rx, |mut rx| async move {
+        let chunk = rx.recv().await?;
+        Some((Ok::<_, Infallible>(chunk), rx))
+    });
+
+    (
+        [(header::CONTENT_TYPE, "application/json")],
+        Body::from_stream(chunks),
+    )
+        .into_response()
 }
 
 /// JSON is the default and the only accepted content type!
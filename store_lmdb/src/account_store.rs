@@ -1,7 +1,8 @@
 use crate::{
     iterator::{LmdbIterator, LmdbRangeIterator},
-    parallel_traversal, LmdbDatabase, LmdbEnv, LmdbWriteTransaction, Transaction,
-    ACCOUNT_TEST_DATABASE,
+    parallel_traversal,
+    read_cache::ReadCache,
+    LmdbDatabase, LmdbEnv, LmdbWriteTransaction, ReadCacheKind, Transaction, ACCOUNT_TEST_DATABASE,
 };
 use lmdb::{DatabaseFlags, WriteFlags};
 use rsnano_core::{
@@ -18,18 +19,27 @@ pub struct LmdbAccountStore {
 
     /// U256 (arbitrary key) -> blob
     database: LmdbDatabase,
+    cache: ReadCache<Account, AccountInfo>,
     #[cfg(feature = "output_tracking")]
     put_listener: OutputListenerMt<(Account, AccountInfo)>,
 }
 
 impl LmdbAccountStore {
     pub fn new(env: Arc<LmdbEnv>) -> anyhow::Result<Self> {
+        Self::with_cache(env, ReadCache::disabled(ReadCacheKind::Account))
+    }
+
+    pub(crate) fn with_cache(
+        env: Arc<LmdbEnv>,
+        cache: ReadCache<Account, AccountInfo>,
+    ) -> anyhow::Result<Self> {
         let database = env
             .environment
             .create_db(Some("accounts"), DatabaseFlags::empty())?;
         Ok(Self {
             env,
             database,
+            cache,
             #[cfg(feature = "output_tracking")]
             put_listener: OutputListenerMt::new(),
         })
@@ -52,6 +62,7 @@ impl LmdbAccountStore {
     ) {
         #[cfg(feature = "output_tracking")]
         self.put_listener.emit((*account, info.clone()));
+        self.cache.invalidate(transaction, account);
         transaction
             .put(
                 self.database,
@@ -63,18 +74,26 @@ impl LmdbAccountStore {
     }
 
     pub fn get(&self, transaction: &dyn Transaction, account: &Account) -> Option<AccountInfo> {
-        let result = transaction.get(self.database, account.as_bytes());
-        match result {
-            Err(lmdb::Error::NotFound) => None,
-            Ok(bytes) => {
-                let mut stream = BufferReader::new(bytes);
-                AccountInfo::deserialize(&mut stream).ok()
+        self.cache.get_or_load(transaction, account, || {
+            let result = transaction.get(self.database, account.as_bytes());
+            match result {
+                Err(lmdb::Error::NotFound) => None,
+                Ok(bytes) => {
+                    let mut stream = BufferReader::new(bytes);
+                    AccountInfo::deserialize(&mut stream).ok()
+                }
+                Err(e) => panic!("Could not load account info {:?}", e),
             }
-            Err(e) => panic!("Could not load account info {:?}", e),
-        }
+        })
+    }
+
+    /// Number of deserialized account infos in the read cache
+    pub fn cached_count(&self) -> usize {
+        self.cache.len()
     }
 
     pub fn del(&self, transaction: &mut LmdbWriteTransaction, account: &Account) {
+        self.cache.invalidate(transaction, account);
         transaction
             .delete(self.database, account.as_bytes(), None)
             .unwrap();
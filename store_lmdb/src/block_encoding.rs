@@ -0,0 +1,374 @@
+use num_traits::FromPrimitive;
+use rsnano_core::{
+    utils::{
+        BufferReader, BufferWriter, Deserialize, FixedSizeSerialize, MemoryStream, Serialize,
+        Stream,
+    },
+    Account, Amount, Block, BlockDetails, BlockHash, BlockSideband, BlockType, Epoch, SavedBlock,
+};
+
+const COMPACT: u8 = 0x80;
+const HAS_SUCCESSOR: u8 = 0x40;
+const BLOCK_TYPE_MASK: u8 = 0x3f;
+
+/// Value encoding of the block table since store version 25:
+///
+/// | field     | size   | present                                           |
+/// |-----------|--------|---------------------------------------------------|
+/// | tag       | 1      | always: block type, `COMPACT` and `HAS_SUCCESSOR` |
+/// | successor | 32     | if `HAS_SUCCESSOR` is set                         |
+/// | block     | fixed  | always, without the block type                    |
+/// | height    | varint | all blocks except legacy open                     |
+/// | timestamp | varint | always                                            |
+/// | account   | 32     | legacy send, receive and change blocks            |
+/// | balance   | varint | legacy receive, change and open blocks            |
+/// | details   | 1 + 1  | state blocks, with the source epoch               |
+///
+/// Compared to the legacy encoding (block followed by its sideband) the frontier blocks
+/// save 32 bytes, because they have no successor, and height and timestamp take 6 to
+/// 9 bytes instead of 16. The successor is stored up front, so that it can be read
+/// and replaced without decoding the rest.
+///
+/// Legacy entries start with the plain block type, which never has the `COMPACT` bit set,
+/// so that both encodings can be read while the table gets migrated.
+pub(crate) fn encode_block(block: &SavedBlock) -> Vec<u8> {
+    let block_type = block.block_type();
+    let sideband = block.sideband();
+    let mut stream = MemoryStream::new();
+
+    let mut tag = block_type as u8 | COMPACT;
+    if !sideband.successor.is_zero() {
+        tag |= HAS_SUCCESSOR;
+    }
+    stream.write_u8_safe(tag);
+    if !sideband.successor.is_zero() {
+        sideband.successor.serialize(&mut stream);
+    }
+
+    block.serialize_without_block_type(&mut stream);
+
+    if block_type != BlockType::LegacyOpen {
+        write_varint(&mut stream, sideband.height as u128);
+    }
+    write_varint(&mut stream, sideband.timestamp as u128);
+
+    if has_account(block_type) {
+        sideband.account.serialize(&mut stream);
+    }
+    if has_balance(block_type) {
+        write_varint(&mut stream, sideband.balance.number());
+    }
+    if block_type == BlockType::State {
+        stream.write_u8_safe(sideband.details.packed());
+        stream.write_u8_safe(sideband.source_epoch as u8);
+    }
+
+    stream.to_vec()
+}
+
+/// Decodes entries of both encodings
+pub(crate) fn decode_block(bytes: &[u8]) -> anyhow::Result<SavedBlock> {
+    StoredBlock::deserialize(&mut BufferReader::new(bytes)).map(|stored| stored.block)
+}
+
+/// A decoded value of the block table
+pub(crate) struct StoredBlock {
+    pub block: SavedBlock,
+    /// False if the entry still has the legacy encoding
+    pub compact: bool,
+}
+
+impl Deserialize for StoredBlock {
+    type Target = Self;
+
+    fn deserialize(stream: &mut dyn Stream) -> anyhow::Result<Self> {
+        let tag = stream.read_u8()?;
+        if tag & COMPACT == 0 {
+            let block_type =
+                BlockType::from_u8(tag).ok_or_else(|| anyhow!("invalid block type"))?;
+            let block = Block::deserialize_block_type(block_type, stream)?;
+            let sideband = BlockSideband::from_stream(stream, block_type)?;
+            return Ok(Self {
+                block: SavedBlock::from_stored_sideband(block, sideband),
+                compact: false,
+            });
+        }
+
+        let (block_type, successor) = read_header(tag, stream)?;
+        let block = Block::deserialize_block_type(block_type, stream)?;
+
+        let height = if block_type == BlockType::LegacyOpen {
+            1
+        } else {
+            read_varint(stream)? as u64
+        };
+        let timestamp = read_varint(stream)? as u64;
+        let account = if has_account(block_type) {
+            Account::deserialize(stream)?
+        } else {
+            Account::zero()
+        };
+        let balance = if has_balance(block_type) {
+            Amount::raw(read_varint(stream)?)
+        } else {
+            Amount::zero()
+        };
+        let (details, source_epoch) = if block_type == BlockType::State {
+            let details = BlockDetails::unpack(stream.read_u8()?)?;
+            let source_epoch =
+                Epoch::from_u8(stream.read_u8()?).ok_or_else(|| anyhow!("invalid epoch value"))?;
+            (details, source_epoch)
+        } else {
+            (
+                BlockDetails::new(Epoch::Epoch0, false, false, false),
+                Epoch::Epoch0,
+            )
+        };
+
+        let sideband = BlockSideband::new(
+            account,
+            successor,
+            balance,
+            height,
+            timestamp,
+            details,
+            source_epoch,
+        );
+        Ok(Self {
+            block: SavedBlock::from_stored_sideband(block, sideband),
+            compact: true,
+        })
+    }
+}
+
+pub(crate) fn decode_block_without_sideband(bytes: &[u8]) -> anyhow::Result<Block> {
+    let mut stream = BufferReader::new(bytes);
+    if !is_compact(bytes) {
+        return Block::deserialize(&mut stream);
+    }
+    let tag = stream.read_u8()?;
+    let (block_type, _) = read_header(tag, &mut stream)?;
+    Block::deserialize_block_type(block_type, &mut stream)
+}
+
+pub(crate) fn is_compact(bytes: &[u8]) -> bool {
+    bytes[0] & COMPACT != 0
+}
+
+pub(crate) fn successor(bytes: &[u8]) -> anyhow::Result<Option<BlockHash>> {
+    let successor = if is_compact(bytes) {
+        let mut stream = BufferReader::new(&bytes[1..]);
+        read_header(bytes[0], &mut stream)?.1
+    } else {
+        let block_type = legacy_block_type(bytes)?;
+        let offset = bytes.len() - BlockSideband::serialized_size(block_type);
+        BlockHash::from_slice(&bytes[offset..offset + BlockHash::serialized_size()])
+            .ok_or_else(|| anyhow!("block entry too short"))?
+    };
+    Ok(if successor.is_zero() {
+        None
+    } else {
+        Some(successor)
+    })
+}
+
+/// Returns the entry with the new successor in the compact encoding.
+/// A zero successor removes it
+pub(crate) fn with_successor(bytes: &[u8], successor: &BlockHash) -> anyhow::Result<Vec<u8>> {
+    if !is_compact(bytes) {
+        let mut block = decode_block(bytes)?;
+        block.set_sideband(BlockSideband {
+            successor: *successor,
+            ..block.sideband().clone()
+        });
+        return Ok(encode_block(&block));
+    }
+
+    let mut tag = bytes[0] & !HAS_SUCCESSOR;
+    let rest = if bytes[0] & HAS_SUCCESSOR != 0 {
+        &bytes[1 + BlockHash::serialized_size()..]
+    } else {
+        &bytes[1..]
+    };
+
+    let mut result = Vec::with_capacity(1 + BlockHash::serialized_size() + rest.len());
+    if !successor.is_zero() {
+        tag |= HAS_SUCCESSOR;
+    }
+    result.push(tag);
+    if !successor.is_zero() {
+        result.extend_from_slice(successor.as_bytes());
+    }
+    result.extend_from_slice(rest);
+    Ok(result)
+}
+
+/// Reads the successor that follows the tag of a compact entry
+fn read_header(tag: u8, stream: &mut dyn Stream) -> anyhow::Result<(BlockType, BlockHash)> {
+    let block_type =
+        BlockType::from_u8(tag & BLOCK_TYPE_MASK).ok_or_else(|| anyhow!("invalid block type"))?;
+    let successor = if tag & HAS_SUCCESSOR != 0 {
+        BlockHash::deserialize(stream)?
+    } else {
+        BlockHash::zero()
+    };
+    Ok((block_type, successor))
+}
+
+fn legacy_block_type(bytes: &[u8]) -> anyhow::Result<BlockType> {
+    BlockType::from_u8(bytes[0]).ok_or_else(|| anyhow!("invalid block type"))
+}
+
+fn has_account(block_type: BlockType) -> bool {
+    matches!(
+        block_type,
+        BlockType::LegacySend | BlockType::LegacyReceive | BlockType::LegacyChange
+    )
+}
+
+fn has_balance(block_type: BlockType) -> bool {
+    matches!(
+        block_type,
+        BlockType::LegacyReceive | BlockType::LegacyChange | BlockType::LegacyOpen
+    )
+}
+
+/// LEB128: 7 bits per byte, the high bit marks that more bytes follow
+fn write_varint(stream: &mut dyn BufferWriter, mut value: u128) {
+    while value >= 0x80 {
+        stream.write_u8_safe((value as u8) | 0x80);
+        value >>= 7;
+    }
+    stream.write_u8_safe(value as u8);
+}
+
+fn read_varint(stream: &mut dyn Stream) -> anyhow::Result<u128> {
+    let mut value = 0u128;
+    let mut shift = 0;
+    loop {
+        let byte = stream.read_u8()?;
+        if shift >= 128 {
+            bail!("varint too long");
+        }
+        value |= ((byte & 0x7f) as u128) << shift;
+        if byte & 0x80 == 0 {
+            return Ok(value);
+        }
+        shift += 7;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use rsnano_core::TestBlockBuilder;
+
+    #[test]
+    fn varint() {
+        for value in [0, 1, 127, 128, 300, u64::MAX as u128, u128::MAX] {
+            let mut stream = MemoryStream::new();
+            write_varint(&mut stream, value);
+            let bytes = stream.to_vec();
+            assert_eq!(read_varint(&mut BufferReader::new(&bytes)).unwrap(), value);
+        }
+    }
+
+    #[test]
+    fn state_block_roundtrip() {
+        let block = SavedBlock::new_test_instance();
+        let encoded = encode_block(&block);
+
+        assert!(is_compact(&encoded));
+        assert!(encoded.len() < block.serialize_with_sideband().len());
+        assert_eq!(decode_block(&encoded).unwrap(), block);
+    }
+
+    #[test]
+    fn legacy_blocks_roundtrip() {
+        let blocks = [
+            TestBlockBuilder::legacy_send().build(),
+            TestBlockBuilder::legacy_receive().build(),
+            TestBlockBuilder::legacy_open().build(),
+            TestBlockBuilder::legacy_change().build(),
+        ];
+        for block in blocks {
+            let sideband = BlockSideband {
+                details: BlockDetails::new(Epoch::Epoch0, false, false, false),
+                source_epoch: Epoch::Epoch0,
+                ..BlockSideband::new_test_instance()
+            };
+            let saved = SavedBlock::from_stored_sideband(block, sideband);
+            let height_stored = saved.block_type() != BlockType::LegacyOpen;
+            let expected = if height_stored {
+                saved.clone()
+            } else {
+                SavedBlock::from_stored_sideband(
+                    Block::clone(&saved),
+                    BlockSideband {
+                        height: 1,
+                        ..saved.sideband().clone()
+                    },
+                )
+            };
+
+            assert_eq!(decode_block(&encode_block(&saved)).unwrap(), expected);
+        }
+    }
+
+    #[test]
+    fn decode_legacy_encoding() {
+        let block = SavedBlock::new_test_instance();
+        let legacy = block.serialize_with_sideband();
+
+        assert!(!is_compact(&legacy));
+        assert_eq!(decode_block(&legacy).unwrap(), block);
+        assert_eq!(decode_block_without_sideband(&legacy).unwrap(), *block);
+    }
+
+    #[test]
+    fn read_successor() {
+        let block = SavedBlock::new_test_instance();
+        let successor = block.successor();
+        assert!(successor.is_some());
+
+        assert_eq!(super::successor(&encode_block(&block)).unwrap(), successor);
+        assert_eq!(
+            super::successor(&block.serialize_with_sideband()).unwrap(),
+            successor
+        );
+    }
+
+    #[test]
+    fn replace_successor() {
+        let block = SavedBlock::new_test_instance();
+        let encoded = encode_block(&block);
+
+        let cleared = with_successor(&encoded, &BlockHash::zero()).unwrap();
+        assert_eq!(super::successor(&cleared).unwrap(), None);
+        assert_eq!(cleared.len(), encoded.len() - 32);
+
+        let replaced = with_successor(&cleared, &BlockHash::from(7)).unwrap();
+        assert_eq!(
+            super::successor(&replaced).unwrap(),
+            Some(BlockHash::from(7))
+        );
+        assert_eq!(
+            decode_block_without_sideband(&replaced).unwrap(),
+            *decode_block(&encoded).unwrap()
+        );
+    }
+
+    #[test]
+    fn replace_successor_of_legacy_entry() {
+        let block = SavedBlock::new_test_instance();
+
+        let replaced =
+            with_successor(&block.serialize_with_sideband(), &BlockHash::from(7)).unwrap();
+
+        assert!(is_compact(&replaced));
+        assert_eq!(
+            super::successor(&replaced).unwrap(),
+            Some(BlockHash::from(7))
+        );
+    }
+}
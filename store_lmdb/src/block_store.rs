@@ -1,13 +1,13 @@
 use crate::{
-    LmdbDatabase, LmdbEnv, LmdbIterator, LmdbRangeIterator, LmdbWriteTransaction, Transaction,
-    BLOCK_TEST_DATABASE,
+    block_encoding::{
+        decode_block, decode_block_without_sideband, encode_block, with_successor, StoredBlock,
+    },
+    read_cache::ReadCache,
+    LmdbDatabase, LmdbEnv, LmdbIterator, LmdbRangeIterator, LmdbWriteTransaction, ReadCacheKind,
+    Transaction, BLOCK_TEST_DATABASE,
 };
 use lmdb::{DatabaseFlags, WriteFlags};
-use num_traits::FromPrimitive;
-use rsnano_core::{
-    utils::{BufferReader, Deserialize, FixedSizeSerialize},
-    Block, BlockHash, BlockSideband, BlockType, SavedBlock,
-};
+use rsnano_core::{Block, BlockHash, SavedBlock};
 use rsnano_nullable_lmdb::ConfiguredDatabase;
 #[cfg(feature = "output_tracking")]
 use rsnano_output_tracker::{OutputListenerMt, OutputTrackerMt};
@@ -16,6 +16,7 @@ use std::{ops::RangeBounds, sync::Arc};
 pub struct LmdbBlockStore {
     _env: Arc<LmdbEnv>,
     database: LmdbDatabase,
+    cache: ReadCache<BlockHash, SavedBlock>,
     #[cfg(feature = "output_tracking")]
     put_listener: OutputListenerMt<SavedBlock>,
 }
@@ -32,10 +33,9 @@ impl ConfiguredBlockDatabaseBuilder {
     }
 
     pub fn block(mut self, block: &SavedBlock) -> Self {
-        self.database.entries.insert(
-            block.hash().as_bytes().to_vec(),
-            block.serialize_with_sideband(),
-        );
+        self.database
+            .entries
+            .insert(block.hash().as_bytes().to_vec(), encode_block(block));
         self
     }
 
@@ -50,12 +50,20 @@ impl LmdbBlockStore {
     }
 
     pub fn new(env: Arc<LmdbEnv>) -> anyhow::Result<Self> {
+        Self::with_cache(env, ReadCache::disabled(ReadCacheKind::Block))
+    }
+
+    pub(crate) fn with_cache(
+        env: Arc<LmdbEnv>,
+        cache: ReadCache<BlockHash, SavedBlock>,
+    ) -> anyhow::Result<Self> {
         let database = env
             .environment
             .create_db(Some("blocks"), DatabaseFlags::empty())?;
         Ok(Self {
             _env: env,
             database,
+            cache,
             #[cfg(feature = "output_tracking")]
             put_listener: OutputListenerMt::new(),
         })
@@ -79,7 +87,7 @@ impl LmdbBlockStore {
             block.successor().is_none() || self.exists(txn, &block.successor().unwrap_or_default())
         );
 
-        self.raw_put(txn, &block.serialize_with_sideband(), &hash);
+        self.raw_put(txn, &encode_block(block), &hash);
         self.update_predecessor(txn, &block);
     }
 
@@ -89,47 +97,38 @@ impl LmdbBlockStore {
 
     pub fn successor(&self, txn: &dyn Transaction, hash: &BlockHash) -> Option<BlockHash> {
         self.block_raw_get(txn, hash).and_then(|data| {
-            debug_assert!(data.len() >= 32);
-            let block_type = BlockType::from_u8(data[0]).unwrap();
-            let offset = block_successor_offset(data.len(), block_type);
-            let successor = BlockHash::from_bytes(data[offset..offset + 32].try_into().unwrap());
-            if successor.is_zero() {
-                None
-            } else {
-                Some(successor)
-            }
+            crate::block_encoding::successor(data)
+                .unwrap_or_else(|_| panic!("Could not read successor of block {}!", hash))
         })
     }
 
     pub fn successor_clear(&self, txn: &mut LmdbWriteTransaction, hash: &BlockHash) {
         let value = self.block_raw_get(txn, hash).unwrap();
-        let block_type = BlockType::from_u8(value[0]).unwrap();
-
-        let mut data = value.to_vec();
-        let offset = block_successor_offset(value.len(), block_type);
-        data[offset..offset + BlockHash::serialized_size()].fill(0);
+        let data = with_successor(value, &BlockHash::zero()).unwrap();
         self.raw_put(txn, &data, hash)
     }
 
     pub fn get(&self, txn: &dyn Transaction, hash: &BlockHash) -> Option<SavedBlock> {
-        self.block_raw_get(txn, hash).map(|bytes| {
-            let mut stream = BufferReader::new(bytes);
-            SavedBlock::deserialize(&mut stream)
-                .unwrap_or_else(|_| panic!("Could not deserialize block {}!", hash))
+        self.cache.get_or_load(txn, hash, || {
+            self.block_raw_get(txn, hash).map(|bytes| {
+                decode_block(bytes)
+                    .unwrap_or_else(|_| panic!("Could not deserialize block {}!", hash))
+            })
         })
     }
 
+    /// Number of deserialized blocks in the read cache
+    pub fn cached_count(&self) -> usize {
+        self.cache.len()
+    }
+
     pub fn get_no_sideband(&self, txn: &dyn Transaction, hash: &BlockHash) -> Option<Block> {
-        match self.block_raw_get(txn, hash) {
-            None => None,
-            Some(bytes) => {
-                let mut stream = BufferReader::new(bytes);
-                Some(Block::deserialize(&mut stream).unwrap())
-            }
-        }
+        self.block_raw_get(txn, hash)
+            .map(|bytes| decode_block_without_sideband(bytes).unwrap())
     }
 
     pub fn del(&self, txn: &mut LmdbWriteTransaction, hash: &BlockHash) {
+        self.cache.invalidate(txn, hash);
         txn.delete(self.database, hash.as_bytes(), None).unwrap();
     }
 
@@ -144,9 +143,7 @@ impl LmdbBlockStore {
 
         LmdbIterator::new(cursor, |k, v| {
             let hash = BlockHash::from_slice(k).unwrap();
-            let mut stream = BufferReader::new(v);
-            let block = SavedBlock::deserialize(&mut stream).unwrap();
-            (hash, block)
+            (hash, decode_block(v).unwrap())
         })
         .map(|(_, v)| v)
     }
@@ -160,7 +157,8 @@ impl LmdbBlockStore {
             .open_ro_cursor(self.database)
             .expect("Could not open cursor for block table");
 
-        LmdbRangeIterator::new(cursor, range).map(|(_, v)| v)
+        LmdbRangeIterator::<BlockHash, StoredBlock, _>::new(cursor, range)
+            .map(|(_, stored)| stored.block)
     }
 
     pub fn random(&self, tx: &dyn Transaction) -> Option<SavedBlock> {
@@ -169,7 +167,41 @@ impl LmdbBlockStore {
         existing.or_else(|| self.iter(tx).next())
     }
 
+    /// Rewrites the entries that still have the legacy encoding, starting at `start`.
+    /// At most `max_count` entries are visited. Returns the number of rewritten entries
+    /// and the key at which the next batch has to continue, or None at the end of the table
+    pub fn reencode_legacy_entries(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        start: BlockHash,
+        max_count: usize,
+    ) -> (usize, Option<BlockHash>) {
+        let mut legacy = Vec::new();
+        let mut next = None;
+        {
+            let cursor = txn
+                .open_ro_cursor(self.database)
+                .expect("Could not open cursor for block table");
+            let entries = LmdbRangeIterator::<BlockHash, StoredBlock, _>::new(cursor, start..);
+            for (i, (hash, stored)) in entries.enumerate() {
+                if i == max_count {
+                    next = Some(hash);
+                    break;
+                }
+                if !stored.compact {
+                    legacy.push(stored.block);
+                }
+            }
+        }
+
+        for block in &legacy {
+            self.raw_put(txn, &encode_block(block), &block.hash());
+        }
+        (legacy.len(), next)
+    }
+
     pub fn raw_put(&self, txn: &mut LmdbWriteTransaction, data: &[u8], hash: &BlockHash) {
+        self.cache.invalidate(txn, hash);
         txn.put(self.database, hash.as_bytes(), data, WriteFlags::empty())
             .unwrap();
     }
@@ -195,20 +227,11 @@ impl LmdbBlockStore {
         let value = self
             .block_raw_get(txn, &block.previous())
             .expect("block not found by fill_value");
-        let mut data = value.to_vec();
-        let block_type = BlockType::from_u8(data[0]).unwrap();
-
-        let offset = block_successor_offset(data.len(), block_type);
-        data[offset..offset + hash.as_bytes().len()].copy_from_slice(hash.as_bytes());
-
+        let data = with_successor(value, &hash).unwrap();
         self.raw_put(txn, &data, &block.previous());
     }
 }
 
-fn block_successor_offset(entry_size: usize, block_type: BlockType) -> usize {
-    entry_size - BlockSideband::serialized_size(block_type)
-}
-
 #[cfg(test)]
 mod tests {
     use crate::PutEvent;
@@ -276,7 +299,7 @@ mod tests {
             vec![PutEvent {
                 database: LmdbDatabase::new_null(42),
                 key: block.hash().as_bytes().to_vec(),
-                value: block.serialize_with_sideband(),
+                value: encode_block(&block),
                 flags: lmdb::WriteFlags::empty(),
             }]
         );
@@ -313,7 +336,7 @@ mod tests {
             vec![PutEvent {
                 database: LmdbDatabase::new_null(100),
                 key: expected_block.hash().as_bytes().to_vec(),
-                value: expected_block.serialize_with_sideband(),
+                value: encode_block(&expected_block),
                 flags: WriteFlags::empty(),
             }]
         );
@@ -338,6 +361,36 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn reencode_legacy_entries() {
+        let block = SavedBlock::new_test_instance();
+        let env = LmdbEnv::new_null_with()
+            .database("blocks", LmdbDatabase::new_null(100))
+            .entry(block.hash().as_bytes(), &block.serialize_with_sideband())
+            .build()
+            .build();
+        let fixture = Fixture::with_env(env);
+        let mut txn = fixture.env.tx_begin_write();
+        let put_tracker = txn.track_puts();
+
+        let (reencoded, next) =
+            fixture
+                .store
+                .reencode_legacy_entries(&mut txn, BlockHash::zero(), 10);
+
+        assert_eq!(reencoded, 1);
+        assert_eq!(next, None);
+        assert_eq!(
+            put_tracker.output(),
+            vec![PutEvent {
+                database: LmdbDatabase::new_null(100),
+                key: block.hash().as_bytes().to_vec(),
+                value: encode_block(&block),
+                flags: WriteFlags::empty(),
+            }]
+        );
+    }
+
     #[test]
     fn track_inserted_blocks() {
         let fixture = Fixture::new();
@@ -0,0 +1,280 @@
+use crate::{
+    LmdbDatabase, LmdbEnv, LmdbRangeIterator, LmdbWriteTransaction, Transaction,
+    DELEGATOR_TEST_DATABASE,
+};
+use lmdb::{DatabaseFlags, WriteFlags};
+use rsnano_core::{
+    utils::{BufferWriter, Deserialize, Serialize, Stream},
+    Account, NoValue, PublicKey,
+};
+use rsnano_nullable_lmdb::ConfiguredDatabase;
+use std::sync::Arc;
+
+/// Secondary index of the account table: representative -> delegating accounts.
+/// The key is the representative followed by the account, the value is empty.
+pub struct LmdbDelegatorStore {
+    database: LmdbDatabase,
+}
+
+impl LmdbDelegatorStore {
+    pub fn new(env: Arc<LmdbEnv>) -> anyhow::Result<Self> {
+        let database = env
+            .environment
+            .create_db(Some("delegators"), DatabaseFlags::empty())?;
+        Ok(Self { database })
+    }
+
+    pub fn database(&self) -> LmdbDatabase {
+        self.database
+    }
+
+    pub fn put(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        representative: &PublicKey,
+        account: &Account,
+    ) {
+        txn.put(
+            self.database,
+            &DelegatorKey::new(*representative, *account).to_bytes(),
+            &[0; 0],
+            WriteFlags::empty(),
+        )
+        .unwrap();
+    }
+
+    pub fn del(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        representative: &PublicKey,
+        account: &Account,
+    ) {
+        match txn.delete(
+            self.database,
+            &DelegatorKey::new(*representative, *account).to_bytes(),
+            None,
+        ) {
+            Ok(()) | Err(lmdb::Error::NotFound) => {}
+            Err(e) => panic!("Could not delete delegator: {:?}", e),
+        }
+    }
+
+    pub fn exists(
+        &self,
+        txn: &dyn Transaction,
+        representative: &PublicKey,
+        account: &Account,
+    ) -> bool {
+        txn.exists(
+            self.database,
+            &DelegatorKey::new(*representative, *account).to_bytes(),
+        )
+    }
+
+    /// Accounts that delegate to `representative`, in ascending order and starting at `start`
+    pub fn iter_delegators<'tx>(
+        &self,
+        txn: &'tx dyn Transaction,
+        representative: &PublicKey,
+        start: Account,
+    ) -> impl Iterator<Item = Account> + 'tx {
+        let cursor = txn.open_ro_cursor(self.database).unwrap();
+        let range = DelegatorKey::new(*representative, start)
+            ..=DelegatorKey::new(*representative, Account::from_bytes([0xFF; 32]));
+        LmdbRangeIterator::<DelegatorKey, NoValue, _>::new(cursor, range).map(|(k, _)| k.account)
+    }
+
+    pub fn delegators_count(&self, txn: &dyn Transaction, representative: &PublicKey) -> u64 {
+        self.iter_delegators(txn, representative, Account::zero())
+            .count() as u64
+    }
+
+    pub fn count(&self, txn: &dyn Transaction) -> u64 {
+        txn.count(self.database)
+    }
+
+    pub fn clear(&self, txn: &mut LmdbWriteTransaction) {
+        txn.clear_db(self.database).unwrap();
+    }
+}
+
+#[derive(Clone, Copy, PartialEq, Eq, PartialOrd, Ord, Debug)]
+struct DelegatorKey {
+    representative: PublicKey,
+    account: Account,
+}
+
+impl DelegatorKey {
+    fn new(representative: PublicKey, account: Account) -> Self {
+        Self {
+            representative,
+            account,
+        }
+    }
+
+    fn to_bytes(&self) -> [u8; 64] {
+        let mut result = [0; 64];
+        result[..32].copy_from_slice(self.representative.as_bytes());
+        result[32..].copy_from_slice(self.account.as_bytes());
+        result
+    }
+}
+
+impl Serialize for DelegatorKey {
+    fn serialize(&self, writer: &mut dyn BufferWriter) {
+        self.representative.serialize(writer);
+        self.account.serialize(writer);
+    }
+}
+
+impl Deserialize for DelegatorKey {
+    type Target = Self;
+
+    fn deserialize(stream: &mut dyn Stream) -> anyhow::Result<Self::Target> {
+        let representative = PublicKey::deserialize(stream)?;
+        let account = Account::deserialize(stream)?;
+        Ok(Self::new(representative, account))
+    }
+}
+
+pub struct ConfiguredDelegatorDatabaseBuilder {
+    database: ConfiguredDatabase,
+}
+
+impl ConfiguredDelegatorDatabaseBuilder {
+    pub fn new() -> Self {
+        Self {
+            database: ConfiguredDatabase::new(DELEGATOR_TEST_DATABASE, "delegators"),
+        }
+    }
+
+    pub fn delegator(mut self, representative: &PublicKey, account: &Account) -> Self {
+        self.database.entries.insert(
+            DelegatorKey::new(*representative, *account)
+                .to_bytes()
+                .to_vec(),
+            Vec::new(),
+        );
+        self
+    }
+
+    pub fn build(self) -> ConfiguredDatabase {
+        self.database
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{DeleteEvent, PutEvent};
+
+    struct Fixture {
+        env: Arc<LmdbEnv>,
+        store: LmdbDelegatorStore,
+    }
+
+    impl Fixture {
+        fn new() -> Self {
+            Self::with_database(ConfiguredDelegatorDatabaseBuilder::new().build())
+        }
+
+        fn with_database(database: ConfiguredDatabase) -> Self {
+            let env = Arc::new(
+                LmdbEnv::new_null_with()
+                    .configured_database(database)
+                    .build(),
+            );
+            Self {
+                env: env.clone(),
+                store: LmdbDelegatorStore::new(env).unwrap(),
+            }
+        }
+    }
+
+    #[test]
+    fn empty_store() {
+        let fixture = Fixture::new();
+        let txn = fixture.env.tx_begin_read();
+        assert_eq!(fixture.store.count(&txn), 0);
+        assert_eq!(
+            fixture
+                .store
+                .exists(&txn, &PublicKey::from(1), &Account::from(2)),
+            false
+        );
+    }
+
+    #[test]
+    fn put() {
+        let fixture = Fixture::new();
+        let mut txn = fixture.env.tx_begin_write();
+        let put_tracker = txn.track_puts();
+        let representative = PublicKey::from(1);
+        let account = Account::from(2);
+
+        fixture.store.put(&mut txn, &representative, &account);
+
+        let mut expected_key = representative.as_bytes().to_vec();
+        expected_key.extend_from_slice(account.as_bytes());
+        assert_eq!(
+            put_tracker.output(),
+            vec![PutEvent {
+                database: DELEGATOR_TEST_DATABASE.into(),
+                key: expected_key,
+                value: Vec::new(),
+                flags: WriteFlags::empty()
+            }]
+        );
+    }
+
+    #[test]
+    fn delete() {
+        let fixture = Fixture::new();
+        let mut txn = fixture.env.tx_begin_write();
+        let delete_tracker = txn.track_deletions();
+        let representative = PublicKey::from(1);
+        let account = Account::from(2);
+
+        fixture.store.del(&mut txn, &representative, &account);
+
+        assert_eq!(
+            delete_tracker.output(),
+            vec![DeleteEvent {
+                database: DELEGATOR_TEST_DATABASE.into(),
+                key: DelegatorKey::new(representative, account)
+                    .to_bytes()
+                    .to_vec()
+            }]
+        );
+    }
+
+    #[test]
+    fn iter_delegators_of_one_representative() {
+        let rep1 = PublicKey::from(1);
+        let rep2 = PublicKey::from(2);
+        let fixture = Fixture::with_database(
+            ConfiguredDelegatorDatabaseBuilder::new()
+                .delegator(&rep1, &Account::from(10))
+                .delegator(&rep1, &Account::from(11))
+                .delegator(&rep2, &Account::from(5))
+                .delegator(&rep2, &Account::from(12))
+                .build(),
+        );
+        let txn = fixture.env.tx_begin_read();
+
+        let delegators: Vec<_> = fixture
+            .store
+            .iter_delegators(&txn, &rep1, Account::zero())
+            .collect();
+        assert_eq!(delegators, vec![Account::from(10), Account::from(11)]);
+
+        let delegators: Vec<_> = fixture
+            .store
+            .iter_delegators(&txn, &rep2, Account::from(6))
+            .collect();
+        assert_eq!(delegators, vec![Account::from(12)]);
+
+        assert_eq!(fixture.store.delegators_count(&txn, &rep1), 2);
+        assert_eq!(fixture.store.delegators_count(&txn, &PublicKey::from(3)), 0);
+    }
+}
@@ -0,0 +1,563 @@
+use crate::{
+    block_encoding::{decode_block, encode_block, is_compact},
+    ConsistentIndexes, LmdbDatabase, LmdbStore, LmdbWriteTransaction, Transaction,
+    STORE_VERSION_CURRENT,
+};
+use lmdb::WriteFlags;
+use rsnano_core::{
+    utils::{BufferReader, Deserialize},
+    BlockHashBuilder, ConfirmationHeightInfo,
+};
+use std::{
+    io::{Read, Write},
+    ops::Range,
+    sync::{
+        atomic::Ordering,
+        mpsc::{self, Receiver, SyncSender},
+    },
+    thread,
+};
+
+/// A ledger snapshot is a stream of the ledger tables in key order, read from a single
+/// read transaction:
+///
+/// | field            | size    |                                               |
+/// |------------------|---------|-----------------------------------------------|
+/// | magic            | 8       | "RSNLSNAP"                                    |
+/// | format version   | 4       |                                               |
+/// | store version    | 4       | the block encoding depends on it              |
+/// | tables           |         | one section per `SnapshotTable::ALL` entry    |
+///
+/// A table section is the table ID (1 byte) and the entry count (8 bytes), followed by
+/// chunks of at most `CHUNK_ENTRIES` entries. A chunk is its entry count (4 bytes), the
+/// payload length (4 bytes), the payload and the blake2b checksum of the payload (32 bytes).
+/// The payload is a sequence of key length (2 bytes), key, value length (4 bytes) and value.
+/// All integers are little endian.
+const MAGIC: &[u8; 8] = b"RSNLSNAP";
+const FORMAT_VERSION: u32 = 1;
+const CHUNK_ENTRIES: usize = 4096;
+const MAX_CHUNK_BYTES: usize = 64 * 1024 * 1024;
+const CHECKSUM_SIZE: usize = 32;
+
+/// Number of verified chunks the importer reads ahead of the writer
+const IMPORT_QUEUE_LEN: usize = 16;
+/// The import commits after this many entries, so that the write transaction doesn't grow unbounded
+const ENTRIES_PER_TXN: usize = 256 * 1024;
+
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum SnapshotTable {
+    Accounts,
+    Blocks,
+    ConfirmationHeight,
+    Pending,
+    RepWeights,
+    Pruned,
+    FinalVotes,
+    Delegators,
+    Unconfirmed,
+}
+
+impl SnapshotTable {
+    /// The tables in the order in which they appear in a snapshot
+    pub const ALL: [SnapshotTable; 9] = [
+        SnapshotTable::Accounts,
+        SnapshotTable::Blocks,
+        SnapshotTable::ConfirmationHeight,
+        SnapshotTable::Pending,
+        SnapshotTable::RepWeights,
+        SnapshotTable::Pruned,
+        SnapshotTable::FinalVotes,
+        SnapshotTable::Delegators,
+        SnapshotTable::Unconfirmed,
+    ];
+
+    pub fn as_str(&self) -> &'static str {
+        match self {
+            SnapshotTable::Accounts => "accounts",
+            SnapshotTable::Blocks => "blocks",
+            SnapshotTable::ConfirmationHeight => "confirmation_height",
+            SnapshotTable::Pending => "pending",
+            SnapshotTable::RepWeights => "rep_weights",
+            SnapshotTable::Pruned => "pruned",
+            SnapshotTable::FinalVotes => "final_votes",
+            SnapshotTable::Delegators => "delegators",
+            SnapshotTable::Unconfirmed => "unconfirmed",
+        }
+    }
+
+    fn database(&self, store: &LmdbStore) -> LmdbDatabase {
+        match self {
+            SnapshotTable::Accounts => store.account.database(),
+            SnapshotTable::Blocks => store.block.database(),
+            SnapshotTable::ConfirmationHeight => store.confirmation_height.database(),
+            SnapshotTable::Pending => store.pending.database(),
+            SnapshotTable::RepWeights => store.rep_weight.database(),
+            SnapshotTable::Pruned => store.pruned.database(),
+            SnapshotTable::FinalVotes => store.final_vote.database(),
+            SnapshotTable::Delegators => store.delegator.database(),
+            SnapshotTable::Unconfirmed => store.unconfirmed.database(),
+        }
+    }
+
+    fn from_id(id: u8) -> Option<Self> {
+        Self::ALL.get(id as usize).copied()
+    }
+}
+
+#[derive(Default, Clone, PartialEq, Eq, Debug)]
+pub struct SnapshotSummary {
+    /// The number of entries per table
+    pub tables: Vec<(SnapshotTable, u64)>,
+    /// The sum of all confirmation heights
+    pub cemented_count: u64,
+}
+
+impl SnapshotSummary {
+    pub fn entries(&self, table: SnapshotTable) -> u64 {
+        self.tables
+            .iter()
+            .find(|(t, _)| *t == table)
+            .map(|(_, count)| *count)
+            .unwrap_or_default()
+    }
+}
+
+/// Writes a consistent snapshot of the ledger tables. The ledger can be written to
+/// while the snapshot is taken, because all tables are read from one read transaction.
+/// Blocks which still have the legacy encoding are written in the compact encoding.
+pub fn export_snapshot(
+    store: &LmdbStore,
+    output: &mut dyn Write,
+) -> anyhow::Result<SnapshotSummary> {
+    let txn = store.tx_begin_read();
+    output.write_all(MAGIC)?;
+    output.write_all(&FORMAT_VERSION.to_le_bytes())?;
+    output.write_all(&STORE_VERSION_CURRENT.to_le_bytes())?;
+
+    let mut summary = SnapshotSummary::default();
+    for (id, table) in SnapshotTable::ALL.iter().enumerate() {
+        let database = table.database(store);
+        let count = txn.count(database);
+        output.write_all(&[id as u8])?;
+        output.write_all(&count.to_le_bytes())?;
+
+        let mut chunk = ChunkWriter::new();
+        let mut exported = 0;
+        let mut cursor = txn.open_ro_cursor(database)?;
+        for entry in cursor.iter_start() {
+            let (key, value) = entry?;
+            match table {
+                SnapshotTable::Blocks if !is_compact(value) => {
+                    chunk.push(key, &encode_block(&decode_block(value)?))
+                }
+                SnapshotTable::ConfirmationHeight => {
+                    summary.cemented_count += confirmation_height(value)?;
+                    chunk.push(key, value);
+                }
+                _ => chunk.push(key, value),
+            }
+            exported += 1;
+            if chunk.entries == CHUNK_ENTRIES {
+                chunk.flush(output)?;
+            }
+        }
+        chunk.flush(output)?;
+
+        if exported != count {
+            bail!(
+                "table {} has {} entries, but {} were exported",
+                table.as_str(),
+                count,
+                exported
+            );
+        }
+        summary.tables.push((*table, count));
+    }
+    output.flush()?;
+    Ok(summary)
+}
+
+/// Loads a snapshot into a store whose ledger tables are empty. Reading and verifying
+/// the chunks happens on a separate thread, while the entries are appended to the tables
+/// in key order. Afterwards the ledger cache counters are persisted as a cache checkpoint,
+/// so that the ledger doesn't have to scan the imported tables on the next start.
+///
+/// The import commits in batches, so the store must be discarded if the import fails.
+pub fn import_snapshot(
+    store: &LmdbStore,
+    input: impl Read + Send,
+) -> anyhow::Result<SnapshotSummary> {
+    {
+        let txn = store.tx_begin_read();
+        for table in SnapshotTable::ALL {
+            if txn.count(table.database(store)) > 0 {
+                bail!("the {} table already contains entries", table.as_str());
+            }
+        }
+    }
+
+    let summary = thread::scope(|s| {
+        let (sender, receiver) = mpsc::sync_channel(IMPORT_QUEUE_LEN);
+        let reader = thread::Builder::new()
+            .name("Snapshot read".to_string())
+            .spawn_scoped(s, move || read_snapshot(input, sender))?;
+        let loaded = load_snapshot(store, receiver);
+        reader.join().expect("snapshot reader panicked")?;
+        loaded
+    })?;
+
+    let txn = store.tx_begin_read();
+    for (table, count) in &summary.tables {
+        let imported = txn.count(table.database(store));
+        if imported != *count {
+            bail!(
+                "table {} has {} entries, but {} were imported",
+                table.as_str(),
+                count,
+                imported
+            );
+        }
+    }
+    drop(txn);
+
+    let cache = &store.cache;
+    cache
+        .block_count
+        .store(summary.entries(SnapshotTable::Blocks), Ordering::SeqCst);
+    cache
+        .account_count
+        .store(summary.entries(SnapshotTable::Accounts), Ordering::SeqCst);
+    cache
+        .cemented_count
+        .store(summary.cemented_count, Ordering::SeqCst);
+    // A snapshot doesn't tell whether its index tables were maintained by every
+    // write, so the node rebuilds them
+    store.write_cache_checkpoint(ConsistentIndexes::default());
+
+    Ok(summary)
+}
+
+struct ChunkWriter {
+    entries: usize,
+    payload: Vec<u8>,
+}
+
+impl ChunkWriter {
+    fn new() -> Self {
+        Self {
+            entries: 0,
+            payload: Vec::new(),
+        }
+    }
+
+    fn push(&mut self, key: &[u8], value: &[u8]) {
+        self.payload
+            .extend_from_slice(&(key.len() as u16).to_le_bytes());
+        self.payload.extend_from_slice(key);
+        self.payload
+            .extend_from_slice(&(value.len() as u32).to_le_bytes());
+        self.payload.extend_from_slice(value);
+        self.entries += 1;
+    }
+
+    fn flush(&mut self, output: &mut dyn Write) -> anyhow::Result<()> {
+        if self.entries == 0 {
+            return Ok(());
+        }
+        output.write_all(&(self.entries as u32).to_le_bytes())?;
+        output.write_all(&(self.payload.len() as u32).to_le_bytes())?;
+        output.write_all(&self.payload)?;
+        output.write_all(&checksum(&self.payload))?;
+        self.entries = 0;
+        self.payload.clear();
+        Ok(())
+    }
+}
+
+enum SnapshotItem {
+    Table(SnapshotTable, u64),
+    Chunk(Chunk),
+}
+
+/// A verified chunk and the positions of its keys and values in the payload
+struct Chunk {
+    payload: Vec<u8>,
+    entries: Vec<(Range<usize>, Range<usize>)>,
+}
+
+impl Chunk {
+    fn parse(payload: Vec<u8>, count: usize) -> anyhow::Result<Self> {
+        let mut entries = Vec::with_capacity(count);
+        let mut pos = 0;
+        while pos < payload.len() {
+            let key = read_field(&payload, &mut pos, 2)?;
+            let value = read_field(&payload, &mut pos, 4)?;
+            entries.push((key, value));
+        }
+        if entries.len() != count {
+            bail!(
+                "chunk contains {} entries instead of {}",
+                entries.len(),
+                count
+            );
+        }
+        Ok(Self { payload, entries })
+    }
+
+    fn entries(&self) -> impl Iterator<Item = (&[u8], &[u8])> {
+        self.entries
+            .iter()
+            .map(|(key, value)| (&self.payload[key.clone()], &self.payload[value.clone()]))
+    }
+}
+
+/// Reads a length prefixed field with a little endian length of `len_size` bytes
+fn read_field(payload: &[u8], pos: &mut usize, len_size: usize) -> anyhow::Result<Range<usize>> {
+    let len_end = *pos + len_size;
+    let Some(len_bytes) = payload.get(*pos..len_end) else {
+        bail!("truncated chunk entry");
+    };
+    let mut len = [0; 8];
+    len[..len_size].copy_from_slice(len_bytes);
+    let end = len_end + u64::from_le_bytes(len) as usize;
+    if end > payload.len() {
+        bail!("truncated chunk entry");
+    }
+    *pos = end;
+    Ok(len_end..end)
+}
+
+fn read_snapshot(mut input: impl Read, sender: SyncSender<SnapshotItem>) -> anyhow::Result<()> {
+    let mut magic = [0; 8];
+    input.read_exact(&mut magic)?;
+    if &magic != MAGIC {
+        bail!("not a ledger snapshot");
+    }
+    let format_version = u32::from_le_bytes(read_array(&mut input)?);
+    if format_version != FORMAT_VERSION {
+        bail!("unsupported snapshot format version {}", format_version);
+    }
+    let store_version = i32::from_le_bytes(read_array(&mut input)?);
+    if store_version != STORE_VERSION_CURRENT {
+        bail!(
+            "the snapshot was taken with store version {}, but this node uses version {}",
+            store_version,
+            STORE_VERSION_CURRENT
+        );
+    }
+
+    for expected in SnapshotTable::ALL {
+        let [id] = read_array(&mut input)?;
+        if SnapshotTable::from_id(id) != Some(expected) {
+            bail!("expected table {}, but found ID {}", expected.as_str(), id);
+        }
+        let count = u64::from_le_bytes(read_array(&mut input)?);
+        if sender.send(SnapshotItem::Table(expected, count)).is_err() {
+            return Ok(()); // The import failed
+        }
+
+        let mut remaining = count;
+        while remaining > 0 {
+            let entries = u32::from_le_bytes(read_array(&mut input)?) as usize;
+            let len = u32::from_le_bytes(read_array(&mut input)?) as usize;
+            if entries == 0 || entries as u64 > remaining || len > MAX_CHUNK_BYTES {
+                bail!("invalid chunk header in table {}", expected.as_str());
+            }
+            let mut payload = vec![0; len];
+            input.read_exact(&mut payload)?;
+            let expected_checksum: [u8; CHECKSUM_SIZE] = read_array(&mut input)?;
+            if checksum(&payload) != expected_checksum {
+                bail!("checksum mismatch in table {}", expected.as_str());
+            }
+            let chunk = Chunk::parse(payload, entries)?;
+            if sender.send(SnapshotItem::Chunk(chunk)).is_err() {
+                return Ok(());
+            }
+            remaining -= entries as u64;
+        }
+    }
+
+    match input.read(&mut [0; 1]) {
+        Ok(0) => Ok(()),
+        Ok(_) => Err(anyhow!("unexpected data after the last table")),
+        Err(e) => Err(e.into()),
+    }
+}
+
+fn load_snapshot(
+    store: &LmdbStore,
+    items: Receiver<SnapshotItem>,
+) -> anyhow::Result<SnapshotSummary> {
+    let mut summary = SnapshotSummary::default();
+    let mut txn = store.tx_begin_write();
+    let mut current = None;
+    let mut uncommitted = 0;
+
+    for item in items {
+        match item {
+            SnapshotItem::Table(table, count) => {
+                current = Some((table, table.database(store)));
+                summary.tables.push((table, count));
+            }
+            SnapshotItem::Chunk(chunk) => {
+                let Some((table, database)) = current else {
+                    bail!("chunk without table");
+                };
+                append_chunk(&mut txn, table, database, &chunk, &mut summary)?;
+                uncommitted += chunk.entries.len();
+                if uncommitted >= ENTRIES_PER_TXN {
+                    txn.refresh();
+                    uncommitted = 0;
+                }
+            }
+        }
+    }
+    txn.commit();
+    Ok(summary)
+}
+
+fn append_chunk(
+    txn: &mut LmdbWriteTransaction,
+    table: SnapshotTable,
+    database: LmdbDatabase,
+    chunk: &Chunk,
+    summary: &mut SnapshotSummary,
+) -> anyhow::Result<()> {
+    for (key, value) in chunk.entries() {
+        if table == SnapshotTable::ConfirmationHeight {
+            summary.cemented_count += confirmation_height(value)?;
+        }
+        // The entries are sorted, so they can be appended to the end of the B-tree.
+        // This fails if the keys of the snapshot aren't in order
+        txn.put(database, key, value, WriteFlags::APPEND)
+            .map_err(|e| anyhow!("could not import into table {}: {}", table.as_str(), e))?;
+    }
+    Ok(())
+}
+
+fn confirmation_height(value: &[u8]) -> anyhow::Result<u64> {
+    let mut stream = BufferReader::new(value);
+    Ok(ConfirmationHeightInfo::deserialize(&mut stream)?.height)
+}
+
+fn checksum(payload: &[u8]) -> [u8; CHECKSUM_SIZE] {
+    *BlockHashBuilder::new().update(payload).build().as_bytes()
+}
+
+fn read_array<const N: usize>(input: &mut impl Read) -> anyhow::Result<[u8; N]> {
+    let mut buffer = [0; N];
+    input.read_exact(&mut buffer)?;
+    Ok(buffer)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::TestDbFile;
+    use rsnano_core::{Account, Amount, BlockHash, PublicKey, SavedBlock};
+
+    #[test]
+    fn export_and_import() -> anyhow::Result<()> {
+        let source_file = TestDbFile::random();
+        let source = LmdbStore::open(&source_file.path).build()?;
+        let block = SavedBlock::new_test_instance();
+        {
+            let mut txn = source.tx_begin_write();
+            source.block.put(&mut txn, &block);
+            source.confirmation_height.put(
+                &mut txn,
+                &Account::from(1),
+                &ConfirmationHeightInfo::new(3, BlockHash::from(2)),
+            );
+            source.confirmation_height.put(
+                &mut txn,
+                &Account::from(2),
+                &ConfirmationHeightInfo::new(4, BlockHash::from(3)),
+            );
+            source
+                .rep_weight
+                .put(&mut txn, PublicKey::from(5), Amount::raw(100));
+        }
+
+        let mut snapshot = Vec::new();
+        let exported = export_snapshot(&source, &mut snapshot)?;
+
+        let target_file = TestDbFile::random();
+        let target = LmdbStore::open(&target_file.path).build()?;
+        let imported = import_snapshot(&target, snapshot.as_slice())?;
+
+        assert_eq!(imported, exported);
+        assert_eq!(imported.entries(SnapshotTable::Blocks), 1);
+        assert_eq!(imported.entries(SnapshotTable::ConfirmationHeight), 2);
+        assert_eq!(imported.cemented_count, 7);
+
+        let txn = target.tx_begin_read();
+        assert_eq!(target.block.get(&txn, &block.hash()), Some(block));
+        assert_eq!(
+            target.rep_weight.get(&txn, &PublicKey::from(5)),
+            Some(Amount::raw(100))
+        );
+        drop(txn);
+
+        let checkpoint = target.valid_cache_checkpoint().unwrap();
+        assert_eq!(checkpoint.block_count, 1);
+        assert_eq!(checkpoint.cemented_count, 7);
+        Ok(())
+    }
+
+    #[test]
+    fn detect_corruption() -> anyhow::Result<()> {
+        let source_file = TestDbFile::random();
+        let source = LmdbStore::open(&source_file.path).build()?;
+        {
+            let mut txn = source.tx_begin_write();
+            source.block.put(&mut txn, &SavedBlock::new_test_instance());
+        }
+        let mut snapshot = Vec::new();
+        export_snapshot(&source, &mut snapshot)?;
+        // header, empty accounts table, blocks table header, chunk header, key length
+        let first_key_byte = 16 + 9 + 9 + 8 + 2;
+        snapshot[first_key_byte] ^= 0xff;
+
+        let target_file = TestDbFile::random();
+        let target = LmdbStore::open(&target_file.path).build()?;
+        let result = import_snapshot(&target, snapshot.as_slice());
+
+        assert!(result
+            .unwrap_err()
+            .to_string()
+            .contains("checksum mismatch"));
+        Ok(())
+    }
+
+    #[test]
+    fn detect_truncation() -> anyhow::Result<()> {
+        let source_file = TestDbFile::random();
+        let source = LmdbStore::open(&source_file.path).build()?;
+        let mut snapshot = Vec::new();
+        export_snapshot(&source, &mut snapshot)?;
+        snapshot.pop();
+
+        let target_file = TestDbFile::random();
+        let target = LmdbStore::open(&target_file.path).build()?;
+        assert!(import_snapshot(&target, snapshot.as_slice()).is_err());
+        Ok(())
+    }
+
+    #[test]
+    fn target_must_be_empty() -> anyhow::Result<()> {
+        let file = TestDbFile::random();
+        let store = LmdbStore::open(&file.path).build()?;
+        {
+            let mut txn = store.tx_begin_write();
+            store.block.put(&mut txn, &SavedBlock::new_test_instance());
+        }
+        let mut snapshot = Vec::new();
+        export_snapshot(&store, &mut snapshot)?;
+
+        let result = import_snapshot(&store, snapshot.as_slice());
+
+        assert!(result.unwrap_err().to_string().contains("blocks"));
+        Ok(())
+    }
+}
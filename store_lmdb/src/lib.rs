@@ -5,44 +5,55 @@ extern crate num_derive;
 extern crate anyhow;
 
 mod account_store;
+mod block_encoding;
 mod block_store;
 mod confirmation_height_store;
+mod delegator_store;
 mod fan;
 mod final_vote_store;
 mod iterator;
+mod ledger_snapshot;
 mod lmdb_config;
 mod lmdb_env;
 mod online_weight_store;
 mod peer_store;
 mod pending_store;
 mod pruned_store;
+mod read_cache;
 mod rep_weight_store;
 mod store;
+mod unconfirmed_store;
 mod version_store;
 mod wallet_store;
 
 pub use account_store::{ConfiguredAccountDatabaseBuilder, LmdbAccountStore};
 pub use block_store::{ConfiguredBlockDatabaseBuilder, LmdbBlockStore};
 pub use confirmation_height_store::*;
+pub use delegator_store::{ConfiguredDelegatorDatabaseBuilder, LmdbDelegatorStore};
 pub use fan::Fan;
 pub use final_vote_store::LmdbFinalVoteStore;
 pub use iterator::{LmdbIterator, LmdbRangeIterator};
+pub use ledger_snapshot::{export_snapshot, import_snapshot, SnapshotSummary, SnapshotTable};
 pub use lmdb_config::{LmdbConfig, SyncStrategy};
 pub use lmdb_env::*;
 pub use online_weight_store::LmdbOnlineWeightStore;
 pub use peer_store::*;
 pub use pending_store::{ConfiguredPendingDatabaseBuilder, LmdbPendingStore};
 pub use pruned_store::{ConfiguredPrunedDatabaseBuilder, LmdbPrunedStore};
+pub use read_cache::{NullReadCacheObserver, ReadCacheKind, ReadCacheObserver};
 pub use rep_weight_store::*;
 use rsnano_nullable_lmdb::{
     InactiveTransaction, LmdbDatabase, LmdbEnvironment, RoCursor, RoTransaction, RwTransaction,
 };
-pub use store::{create_backup_file, LedgerCache, LmdbStore};
+pub use store::{
+    create_backup_file, ConsistentIndexes, LedgerCache, LedgerCacheCheckpoint, LmdbStore,
+};
+pub use unconfirmed_store::{ConfiguredUnconfirmedDatabaseBuilder, LmdbUnconfirmedStore};
 pub use version_store::LmdbVersionStore;
 pub use wallet_store::{Fans, KeyType, LmdbWalletStore, WalletValue};
 
 use primitive_types::U256;
-use rsnano_core::utils::get_cpu_count;
+use rsnano_core::utils::{get_cpu_count, place_current_thread, ThreadRole};
 use std::{
     any::Any,
     cmp::{max, min},
@@ -72,6 +83,8 @@ pub trait Transaction {
     }
     fn open_ro_cursor(&self, database: LmdbDatabase) -> lmdb::Result<RoCursor>;
     fn count(&self, database: LmdbDatabase) -> u64;
+    /// The LMDB ID of the snapshot this transaction sees
+    fn snapshot_id(&self) -> u64;
 }
 
 pub trait TransactionTracker: Send + Sync {
@@ -193,6 +206,10 @@ impl Transaction for LmdbReadTransaction {
         self.txn().get(database, key)
     }
 
+    fn snapshot_id(&self) -> u64 {
+        self.txn().id()
+    }
+
     fn open_ro_cursor(&self, database: LmdbDatabase) -> lmdb::Result<RoCursor> {
         self.txn().open_ro_cursor(database)
     }
@@ -394,6 +411,10 @@ impl Transaction for LmdbWriteTransaction {
         self.rw_txn().count(database)
     }
 
+    fn snapshot_id(&self) -> u64 {
+        self.rw_txn().id()
+    }
+
     fn is_refresh_needed(&self) -> bool {
         self.is_refresh_needed_with(Duration::from_millis(500))
     }
@@ -425,6 +446,7 @@ pub fn parallel_traversal(action: &(impl Fn(U256, U256, bool) + Send + Sync)) {
             std::thread::Builder::new()
                 .name("DB par traversl".to_owned())
                 .spawn_scoped(s, move || {
+                    place_current_thread(ThreadRole::Traversal);
                     action(start, end, is_last);
                 })
                 .unwrap();
@@ -433,7 +455,7 @@ pub fn parallel_traversal(action: &(impl Fn(U256, U256, bool) + Send + Sync)) {
 }
 
 pub const STORE_VERSION_MINIMUM: i32 = 24;
-pub const STORE_VERSION_CURRENT: i32 = 24;
+pub const STORE_VERSION_CURRENT: i32 = 25;
 
 pub const BLOCK_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(1);
 pub const FRONTIER_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(2);
@@ -443,6 +465,8 @@ pub const PRUNED_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(5);
 pub const REP_WEIGHT_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(6);
 pub const CONFIRMATION_HEIGHT_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(7);
 pub const PEERS_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(8);
+pub const DELEGATOR_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(9);
+pub const UNCONFIRMED_TEST_DATABASE: LmdbDatabase = LmdbDatabase::new_null(10);
 
 #[cfg(test)]
 mod test {
@@ -17,6 +17,12 @@ pub enum SyncStrategy {
      * @warning Do not use this option if external processes uses the database concurrently.
      */
     NosyncUnsafeLargeMemory,
+    /**
+     * Don't flush to disk on commit. Instead the ledger's write queue flushes once for all writers
+     * that committed since the last flush. Commits are durable once the next flush completes.
+     * Between flushes this has the same guarantees as nosync_unsafe.
+     */
+    GroupCommit,
 }
 
 #[derive(Clone, Debug, PartialEq)]
@@ -24,6 +30,10 @@ pub struct LmdbConfig {
     pub sync: SyncStrategy,
     pub max_databases: u32,
     pub map_size: usize,
+    /// Maximum number of deserialized blocks kept in memory. 0 disables the cache
+    pub block_cache_size: usize,
+    /// Maximum number of deserialized account infos kept in memory. 0 disables the cache
+    pub account_cache_size: usize,
 }
 
 impl Default for LmdbConfig {
@@ -32,6 +42,8 @@ impl Default for LmdbConfig {
             sync: SyncStrategy::Always,
             max_databases: 128,
             map_size: 256 * 1024 * 1024 * 1024,
+            block_cache_size: 64 * 1024,
+            account_cache_size: 64 * 1024,
         }
     }
 }
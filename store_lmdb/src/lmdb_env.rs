@@ -2,7 +2,7 @@ use crate::{
     LmdbConfig, LmdbReadTransaction, LmdbWriteTransaction, NullTransactionTracker, SyncStrategy,
     TransactionTracker,
 };
-use anyhow::bail;
+use anyhow::{anyhow, bail};
 use lmdb::EnvironmentFlags;
 use lmdb_sys::MDB_SUCCESS;
 use rsnano_core::utils::memory_intensive_instrumentation;
@@ -18,11 +18,35 @@ use std::{
     path::{Path, PathBuf},
     sync::{
         atomic::{AtomicU64, AtomicUsize, Ordering},
-        Arc,
+        Arc, OnceLock,
     },
 };
 use tracing::debug;
 
+/// Gets called after each commit of a write transaction
+pub type CommitObserver = Box<dyn Fn() + Send + Sync>;
+
+/// Forwards the transaction events and notifies the commit observer
+struct CommitTracker {
+    inner: Arc<dyn TransactionTracker>,
+    observer: Arc<OnceLock<CommitObserver>>,
+}
+
+impl TransactionTracker for CommitTracker {
+    fn txn_start(&self, txn_id: u64, is_write: bool) {
+        self.inner.txn_start(txn_id, is_write);
+    }
+
+    fn txn_end(&self, txn_id: u64, is_write: bool) {
+        self.inner.txn_end(txn_id, is_write);
+        if is_write {
+            if let Some(observer) = self.observer.get() {
+                observer();
+            }
+        }
+    }
+}
+
 #[derive(Default, Debug)]
 pub struct EnvOptions {
     pub config: LmdbConfig,
@@ -72,7 +96,9 @@ pub struct LmdbEnv {
     pub environment: LmdbEnvironment,
     next_txn_id: AtomicU64,
     txn_tracker: Arc<dyn TransactionTracker>,
+    commit_observer: Arc<OnceLock<CommitObserver>>,
     env_id: usize,
+    group_commit: bool,
 }
 
 static ENV_COUNT: AtomicUsize = AtomicUsize::new(0);
@@ -95,18 +121,26 @@ impl LmdbEnv {
 
     pub fn new_with_options(path: impl AsRef<Path>, options: &EnvOptions) -> anyhow::Result<Self> {
         let environment = Self::init(path.as_ref(), options)?;
-        Ok(Self::new_with_env(environment))
+        let mut env = Self::new_with_env(environment);
+        env.group_commit = options.config.sync == SyncStrategy::GroupCommit;
+        Ok(env)
     }
 
     pub fn new_with_env(env: LmdbEnvironment) -> Self {
         let env_id = NEXT_ENV_ID.fetch_add(1, Ordering::SeqCst);
         let alive = ENV_COUNT.fetch_add(1, Ordering::SeqCst) + 1;
         debug!(env_id, alive, "LMDB env created",);
+        let commit_observer = Arc::new(OnceLock::new());
         Self {
             environment: env,
             next_txn_id: AtomicU64::new(0),
-            txn_tracker: Arc::new(NullTransactionTracker::new()),
+            txn_tracker: Arc::new(CommitTracker {
+                inner: Arc::new(NullTransactionTracker::new()),
+                observer: commit_observer.clone(),
+            }),
+            commit_observer,
             env_id,
+            group_commit: false,
         }
     }
 
@@ -115,11 +149,17 @@ impl LmdbEnv {
         options: &EnvOptions,
         txn_tracker: Arc<dyn TransactionTracker>,
     ) -> anyhow::Result<Self> {
+        let commit_observer = Arc::new(OnceLock::new());
         let env = Self {
             environment: Self::init(path, options)?,
             next_txn_id: AtomicU64::new(0),
-            txn_tracker,
+            txn_tracker: Arc::new(CommitTracker {
+                inner: txn_tracker,
+                observer: commit_observer.clone(),
+            }),
+            commit_observer,
             env_id: NEXT_ENV_ID.fetch_add(1, Ordering::SeqCst),
+            group_commit: options.config.sync == SyncStrategy::GroupCommit,
         };
         let alive = ENV_COUNT.fetch_add(1, Ordering::SeqCst) + 1;
         debug!(env_id = env.env_id, alive, ?path, "LMDB env created",);
@@ -149,7 +189,9 @@ impl LmdbEnv {
             | EnvironmentFlags::NO_READAHEAD;
         if options.config.sync == SyncStrategy::NosyncSafe {
             environment_flags |= EnvironmentFlags::NO_META_SYNC;
-        } else if options.config.sync == SyncStrategy::NosyncUnsafe {
+        } else if options.config.sync == SyncStrategy::NosyncUnsafe
+            || options.config.sync == SyncStrategy::GroupCommit
+        {
             environment_flags |= EnvironmentFlags::NO_SYNC;
         } else if options.config.sync == SyncStrategy::NosyncUnsafeLargeMemory {
             environment_flags |= EnvironmentFlags::NO_SYNC
@@ -185,6 +227,24 @@ impl LmdbEnv {
             .expect("Could not create LMDB read-write transaction")
     }
 
+    /// Commits don't flush to disk. The writers have to call `sync` instead
+    pub fn group_commit(&self) -> bool {
+        self.group_commit
+    }
+
+    /// Calls `observer` after every commit of a write transaction, no matter who opened it.
+    /// Only one observer can be set, later calls are ignored
+    pub fn observe_commits(&self, observer: CommitObserver) {
+        let _ = self.commit_observer.set(observer);
+    }
+
+    /// Flushes all committed transactions to disk
+    pub fn sync(&self) -> anyhow::Result<()> {
+        self.environment
+            .sync(true)
+            .map_err(|e| anyhow!("Could not sync LMDB environment: {:?}", e))
+    }
+
     pub fn file_path(&self) -> anyhow::Result<PathBuf> {
         let mut path: *const c_char = std::ptr::null();
         let status = unsafe { lmdb_sys::mdb_env_get_path(self.environment.env(), &mut path) };
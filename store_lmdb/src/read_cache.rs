@@ -0,0 +1,361 @@
+use crate::Transaction;
+use rsnano_core::utils::ClockCache;
+use std::{
+    collections::hash_map::RandomState,
+    hash::{BuildHasher, Hash},
+    sync::{Arc, Mutex},
+};
+
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub enum ReadCacheKind {
+    Block,
+    Account,
+}
+
+/// Gets notified about the lookups of the read caches, e.g. to count them in the node stats
+pub trait ReadCacheObserver: Send + Sync {
+    fn cache_hit(&self, kind: ReadCacheKind);
+    fn cache_miss(&self, kind: ReadCacheKind);
+}
+
+pub struct NullReadCacheObserver {}
+
+impl NullReadCacheObserver {
+    pub fn new() -> Self {
+        Self {}
+    }
+}
+
+impl ReadCacheObserver for NullReadCacheObserver {
+    fn cache_hit(&self, _kind: ReadCacheKind) {}
+    fn cache_miss(&self, _kind: ReadCacheKind) {}
+}
+
+/// Bounded cache of deserialized table values, split into independently locked shards.
+///
+/// The cache respects the snapshot isolation of LMDB: every entry remembers the ID of
+/// the last write transaction that changed its key. Invalidating a key leaves a tombstone
+/// with that ID behind. A transaction with an older snapshot bypasses the cache for that
+/// key only, because the cached value might be newer than what it is allowed to see, and
+/// it must not insert the value it read either. Evicted entries raise a per-shard
+/// watermark, so that their change IDs aren't forgotten.
+pub(crate) struct ReadCache<K, V> {
+    kind: ReadCacheKind,
+    shards: Vec<Mutex<CacheShard<K, V>>>,
+    hasher: RandomState,
+    observer: Arc<dyn ReadCacheObserver>,
+}
+
+impl<K, V> ReadCache<K, V>
+where
+    K: Hash + Eq + Clone,
+    V: Clone,
+{
+    pub const SHARDS: usize = 32;
+
+    /// A cache with a capacity of 0 is disabled
+    pub fn new(kind: ReadCacheKind, capacity: usize, observer: Arc<dyn ReadCacheObserver>) -> Self {
+        let shard_count = if capacity == 0 { 0 } else { Self::SHARDS };
+        let shard_capacity = capacity.div_ceil(Self::SHARDS);
+        Self {
+            kind,
+            shards: (0..shard_count)
+                .map(|_| Mutex::new(CacheShard::new(shard_capacity)))
+                .collect(),
+            hasher: RandomState::new(),
+            observer,
+        }
+    }
+
+    pub fn disabled(kind: ReadCacheKind) -> Self {
+        Self::new(kind, 0, Arc::new(NullReadCacheObserver::new()))
+    }
+
+    /// Returns the cached value or loads it from the database and caches it
+    pub fn get_or_load(
+        &self,
+        txn: &dyn Transaction,
+        key: &K,
+        load: impl FnOnce() -> Option<V>,
+    ) -> Option<V> {
+        let Some(shard) = self.shard(key) else {
+            return load();
+        };
+
+        let snapshot = txn.snapshot_id();
+        {
+            let mut guard = shard.lock().unwrap();
+            if let Some(value) = guard.get(key, snapshot) {
+                drop(guard);
+                self.observer.cache_hit(self.kind);
+                return Some(value);
+            }
+        }
+
+        self.observer.cache_miss(self.kind);
+        let value = load()?;
+        let mut guard = shard.lock().unwrap();
+        // A writer might have changed the key while the lock wasn't held
+        let changed_at = guard.changed_at(key);
+        if snapshot >= changed_at {
+            guard.insert(key.clone(), value.clone(), changed_at);
+        }
+        Some(value)
+    }
+
+    /// Has to be called by a write transaction before it changes or deletes the value of `key`
+    pub fn invalidate(&self, txn: &dyn Transaction, key: &K) {
+        if let Some(shard) = self.shard(key) {
+            shard
+                .lock()
+                .unwrap()
+                .invalidate(key.clone(), txn.snapshot_id());
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.shards.iter().map(|s| s.lock().unwrap().len()).sum()
+    }
+
+    fn shard(&self, key: &K) -> Option<&Mutex<CacheShard<K, V>>> {
+        if self.shards.is_empty() {
+            return None;
+        }
+        let index = self.hasher.hash_one(key) as usize % self.shards.len();
+        Some(&self.shards[index])
+    }
+}
+
+struct CacheShard<K, V> {
+    entries: ClockCache<K, CacheEntry<V>>,
+    /// The latest change of all keys that were evicted
+    evicted_changed_at: u64,
+}
+
+struct CacheEntry<V> {
+    /// None for a tombstone of an invalidated key
+    value: Option<V>,
+    /// ID of the last write transaction that changed the key
+    changed_at: u64,
+}
+
+impl<K, V> CacheShard<K, V>
+where
+    K: Hash + Eq + Clone,
+    V: Clone,
+{
+    fn new(capacity: usize) -> Self {
+        Self {
+            entries: ClockCache::new(capacity),
+            evicted_changed_at: 0,
+        }
+    }
+
+    /// Returns the cached value, if a transaction with the given snapshot may see it
+    fn get(&mut self, key: &K, snapshot: u64) -> Option<V> {
+        if snapshot < self.entries.peek(key)?.changed_at {
+            return None;
+        }
+        self.entries.get(key)?.value.clone()
+    }
+
+    /// A value that was read with an older snapshot than this must not be cached
+    fn changed_at(&self, key: &K) -> u64 {
+        match self.entries.peek(key) {
+            Some(entry) => entry.changed_at,
+            None => self.evicted_changed_at,
+        }
+    }
+
+    fn insert(&mut self, key: K, value: V, changed_at: u64) {
+        self.put(key, Some(value), changed_at);
+    }
+
+    fn invalidate(&mut self, key: K, changed_at: u64) {
+        let changed_at = changed_at.max(self.changed_at(&key));
+        self.put(key, None, changed_at);
+    }
+
+    fn put(&mut self, key: K, value: Option<V>, changed_at: u64) {
+        let evicted = self.entries.insert(key, CacheEntry { value, changed_at });
+        if let Some((_, evicted)) = evicted {
+            self.evicted_changed_at = self.evicted_changed_at.max(evicted.changed_at);
+        }
+    }
+
+    /// The number of cached values, without tombstones
+    fn len(&self) -> usize {
+        self.entries.values().filter(|e| e.value.is_some()).count()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::LmdbEnv;
+    use std::sync::atomic::{AtomicUsize, Ordering};
+
+    #[test]
+    fn load_once() {
+        let env = LmdbEnv::new_null();
+        let cache = ReadCache::new(
+            ReadCacheKind::Block,
+            100,
+            Arc::new(NullReadCacheObserver::new()),
+        );
+        let txn = env.tx_begin_read();
+        let loads = AtomicUsize::new(0);
+        let load = || {
+            loads.fetch_add(1, Ordering::SeqCst);
+            Some(42)
+        };
+
+        assert_eq!(cache.get_or_load(&txn, &1, load), Some(42));
+        assert_eq!(cache.get_or_load(&txn, &1, load), Some(42));
+
+        assert_eq!(loads.load(Ordering::SeqCst), 1);
+        assert_eq!(cache.len(), 1);
+    }
+
+    #[test]
+    fn dont_cache_missing_values() {
+        let env = LmdbEnv::new_null();
+        let cache: ReadCache<i32, i32> = ReadCache::new(
+            ReadCacheKind::Block,
+            100,
+            Arc::new(NullReadCacheObserver::new()),
+        );
+        let txn = env.tx_begin_read();
+
+        assert_eq!(cache.get_or_load(&txn, &1, || None), None);
+
+        assert_eq!(cache.len(), 0);
+    }
+
+    #[test]
+    fn disabled() {
+        let env = LmdbEnv::new_null();
+        let cache = ReadCache::disabled(ReadCacheKind::Block);
+        let txn = env.tx_begin_read();
+
+        cache.get_or_load(&txn, &1, || Some(42));
+
+        assert_eq!(cache.len(), 0);
+    }
+
+    #[test]
+    fn invalidate() {
+        let env = LmdbEnv::new_null();
+        let cache = ReadCache::new(
+            ReadCacheKind::Block,
+            100,
+            Arc::new(NullReadCacheObserver::new()),
+        );
+        cache.get_or_load(&env.tx_begin_read(), &1, || Some(42));
+
+        cache.invalidate(&env.tx_begin_write(), &1);
+
+        assert_eq!(
+            cache.get_or_load(&env.tx_begin_read(), &1, || Some(43)),
+            Some(43)
+        );
+    }
+
+    #[test]
+    fn evict_entries_that_were_not_hit() {
+        let mut shard = CacheShard::new(2);
+        shard.insert(1, 1, 0);
+        shard.insert(2, 2, 0);
+        shard.get(&1, 0);
+
+        shard.insert(3, 3, 0);
+
+        assert_eq!(shard.len(), 2);
+        assert_eq!(shard.get(&1, 0), Some(1));
+        assert_eq!(shard.get(&2, 0), None);
+        assert_eq!(shard.get(&3, 0), Some(3));
+    }
+
+    #[test]
+    fn bypass_changed_keys_for_older_snapshots() {
+        let mut shard: CacheShard<i32, i32> = CacheShard::new(10);
+        shard.insert(1, 1, 5);
+        shard.insert(2, 2, 0);
+
+        assert_eq!(shard.get(&1, 4), None);
+        assert_eq!(shard.get(&1, 5), Some(1));
+        // Other keys of the shard are not affected
+        assert_eq!(shard.get(&2, 4), Some(2));
+    }
+
+    #[test]
+    fn tombstone_blocks_inserts_of_older_snapshots() {
+        let mut shard: CacheShard<i32, i32> = CacheShard::new(10);
+        // A writer with txn id 5 is changing the key
+        shard.invalidate(1, 5);
+
+        assert_eq!(shard.changed_at(&1), 5);
+        assert_eq!(shard.changed_at(&2), 0);
+        assert_eq!(shard.len(), 0);
+    }
+
+    #[test]
+    fn eviction_remembers_changes() {
+        let mut shard: CacheShard<i32, i32> = CacheShard::new(1);
+        shard.invalidate(1, 5);
+
+        shard.insert(2, 2, 0);
+
+        assert_eq!(shard.changed_at(&1), 5);
+    }
+
+    #[test]
+    fn older_snapshot_doesnt_insert_invalidated_key() {
+        let cache = ReadCache::new(
+            ReadCacheKind::Account,
+            100,
+            Arc::new(NullReadCacheObserver::new()),
+        );
+        let shard = cache.shard(&1).unwrap();
+        shard.lock().unwrap().invalidate(1, 5);
+        // The nulled environment always reads snapshot 0
+        let env = LmdbEnv::new_null();
+
+        assert_eq!(
+            cache.get_or_load(&env.tx_begin_read(), &1, || Some(2)),
+            Some(2)
+        );
+        assert_eq!(cache.len(), 0);
+    }
+
+    #[test]
+    fn notify_observer() {
+        let observer = Arc::new(CountingObserver::default());
+        let env = LmdbEnv::new_null();
+        let cache = ReadCache::new(ReadCacheKind::Account, 100, observer.clone());
+        let txn = env.tx_begin_read();
+
+        cache.get_or_load(&txn, &1, || Some(1));
+        cache.get_or_load(&txn, &1, || Some(1));
+        cache.get_or_load(&txn, &1, || Some(1));
+
+        assert_eq!(observer.hits.load(Ordering::SeqCst), 2);
+        assert_eq!(observer.misses.load(Ordering::SeqCst), 1);
+    }
+
+    #[derive(Default)]
+    struct CountingObserver {
+        hits: AtomicUsize,
+        misses: AtomicUsize,
+    }
+
+    impl ReadCacheObserver for CountingObserver {
+        fn cache_hit(&self, _kind: ReadCacheKind) {
+            self.hits.fetch_add(1, Ordering::SeqCst);
+        }
+
+        fn cache_miss(&self, _kind: ReadCacheKind) {
+            self.misses.fetch_add(1, Ordering::SeqCst);
+        }
+    }
+}
@@ -36,6 +36,10 @@ impl LmdbRepWeightStore {
         })
     }
 
+    pub fn database(&self) -> LmdbDatabase {
+        self.database
+    }
+
     #[cfg(feature = "output_tracking")]
     pub fn track_deletions(&self) -> Arc<OutputTrackerMt<PublicKey>> {
         self.delete_listener.track()
@@ -1,13 +1,15 @@
+use crate::read_cache::ReadCache;
 use crate::{
-    EnvOptions, LmdbAccountStore, LmdbBlockStore, LmdbConfirmationHeightStore, LmdbDatabase,
-    LmdbEnv, LmdbFinalVoteStore, LmdbOnlineWeightStore, LmdbPeerStore, LmdbPendingStore,
-    LmdbPrunedStore, LmdbReadTransaction, LmdbRepWeightStore, LmdbVersionStore,
-    LmdbWriteTransaction, NullTransactionTracker, TransactionTracker, STORE_VERSION_CURRENT,
-    STORE_VERSION_MINIMUM,
+    EnvOptions, LmdbAccountStore, LmdbBlockStore, LmdbConfig, LmdbConfirmationHeightStore,
+    LmdbDatabase, LmdbDelegatorStore, LmdbEnv, LmdbFinalVoteStore, LmdbOnlineWeightStore,
+    LmdbPeerStore, LmdbPendingStore, LmdbPrunedStore, LmdbReadTransaction, LmdbRepWeightStore,
+    LmdbUnconfirmedStore, LmdbVersionStore, LmdbWriteTransaction, NullReadCacheObserver,
+    NullTransactionTracker, ReadCacheKind, ReadCacheObserver, TransactionTracker,
+    STORE_VERSION_CURRENT, STORE_VERSION_MINIMUM,
 };
 use lmdb::{DatabaseFlags, WriteFlags};
 use lmdb_sys::{MDB_CP_COMPACT, MDB_SUCCESS};
-use rsnano_core::utils::seconds_since_epoch;
+use rsnano_core::{utils::seconds_since_epoch, BlockHash};
 use serde::{Deserialize, Serialize};
 use std::{
     ffi::CString,
@@ -50,6 +52,74 @@ impl LedgerCache {
     }
 }
 
+/// The ledger cache counters as they were persisted by `LmdbStore::write_cache_checkpoint`.
+/// `txn_id` is the ID of the write transaction that wrote the checkpoint. The checkpoint is
+/// only valid as long as no other write transaction was committed after it.
+#[derive(Clone, Copy, PartialEq, Eq, Debug, Default)]
+pub struct LedgerCacheCheckpoint {
+    pub txn_id: u64,
+    pub block_count: u64,
+    pub account_count: u64,
+    pub cemented_count: u64,
+}
+
+impl LedgerCacheCheckpoint {
+    pub fn to_bytes(&self) -> [u8; 32] {
+        let mut result = [0; 32];
+        result[..8].copy_from_slice(&self.txn_id.to_be_bytes());
+        result[8..16].copy_from_slice(&self.block_count.to_be_bytes());
+        result[16..24].copy_from_slice(&self.account_count.to_be_bytes());
+        result[24..].copy_from_slice(&self.cemented_count.to_be_bytes());
+        result
+    }
+
+    pub fn from_bytes(bytes: &[u8]) -> Option<Self> {
+        if bytes.len() != 32 {
+            return None;
+        }
+        let read = |i: usize| u64::from_be_bytes(bytes[i * 8..(i + 1) * 8].try_into().unwrap());
+        Some(Self {
+            txn_id: read(0),
+            block_count: read(1),
+            account_count: read(2),
+            cemented_count: read(3),
+        })
+    }
+}
+
+/// The secondary indexes which were maintained by every write up to a checkpoint.
+/// Writers that run without an index (a node with the index disabled, the CLI) don't
+/// update it, so a flag is only trusted if no write transaction was committed after
+/// the checkpoint.
+#[derive(Clone, Copy, PartialEq, Eq, Debug, Default)]
+pub struct ConsistentIndexes {
+    pub delegators: bool,
+    pub unconfirmed: bool,
+}
+
+impl ConsistentIndexes {
+    const DELEGATORS: u8 = 1;
+    const UNCONFIRMED: u8 = 2;
+
+    pub fn to_flags(&self) -> u8 {
+        let mut flags = 0;
+        if self.delegators {
+            flags |= Self::DELEGATORS;
+        }
+        if self.unconfirmed {
+            flags |= Self::UNCONFIRMED;
+        }
+        flags
+    }
+
+    pub fn from_flags(flags: u8) -> Self {
+        Self {
+            delegators: flags & Self::DELEGATORS != 0,
+            unconfirmed: flags & Self::UNCONFIRMED != 0,
+        }
+    }
+}
+
 pub struct LmdbStore {
     pub env: Arc<LmdbEnv>,
     pub cache: Arc<LedgerCache>,
@@ -61,6 +131,8 @@ pub struct LmdbStore {
     pub rep_weight: Arc<LmdbRepWeightStore>,
     pub peer: Arc<LmdbPeerStore>,
     pub confirmation_height: Arc<LmdbConfirmationHeightStore>,
+    pub delegator: Arc<LmdbDelegatorStore>,
+    pub unconfirmed: Arc<LmdbUnconfirmedStore>,
     pub final_vote: Arc<LmdbFinalVoteStore>,
     pub version: Arc<LmdbVersionStore>,
 }
@@ -69,6 +141,7 @@ pub struct LmdbStoreBuilder<'a> {
     path: &'a Path,
     options: Option<&'a EnvOptions>,
     tracker: Option<Arc<dyn TransactionTracker>>,
+    cache_observer: Option<Arc<dyn ReadCacheObserver>>,
     backup_before_upgrade: bool,
 }
 
@@ -78,6 +151,7 @@ impl<'a> LmdbStoreBuilder<'a> {
             path,
             options: None,
             tracker: None,
+            cache_observer: None,
             backup_before_upgrade: false,
         }
     }
@@ -92,6 +166,11 @@ impl<'a> LmdbStoreBuilder<'a> {
         self
     }
 
+    pub fn cache_observer(mut self, observer: Arc<dyn ReadCacheObserver>) -> Self {
+        self.cache_observer = Some(observer);
+        self
+    }
+
     pub fn backup_before_upgrade(mut self, backup: bool) -> Self {
         self.backup_before_upgrade = backup;
         self
@@ -104,14 +183,28 @@ impl<'a> LmdbStoreBuilder<'a> {
         let txn_tracker = self
             .tracker
             .unwrap_or_else(|| Arc::new(NullTransactionTracker::new()));
-
-        LmdbStore::new(self.path, options, txn_tracker, self.backup_before_upgrade)
+        let cache_observer = self
+            .cache_observer
+            .unwrap_or_else(|| Arc::new(NullReadCacheObserver::new()));
+
+        LmdbStore::new(
+            self.path,
+            options,
+            txn_tracker,
+            cache_observer,
+            self.backup_before_upgrade,
+        )
     }
 }
 
 impl LmdbStore {
     pub fn new_null() -> Self {
-        Self::new_with_env(LmdbEnv::new_null()).unwrap()
+        Self::new_with_env(
+            LmdbEnv::new_null(),
+            &LmdbConfig::default(),
+            Arc::new(NullReadCacheObserver::new()),
+        )
+        .unwrap()
     }
 
     pub fn open(path: &Path) -> LmdbStoreBuilder<'_> {
@@ -122,27 +215,44 @@ impl LmdbStore {
         path: impl AsRef<Path>,
         options: &EnvOptions,
         txn_tracker: Arc<dyn TransactionTracker>,
+        cache_observer: Arc<dyn ReadCacheObserver>,
         backup_before_upgrade: bool,
     ) -> anyhow::Result<Self> {
         let path = path.as_ref();
         upgrade_if_needed(path, backup_before_upgrade)?;
 
         let env = LmdbEnv::new_with_txn_tracker(path, options, txn_tracker)?;
-        Self::new_with_env(env)
+        Self::new_with_env(env, &options.config, cache_observer)
     }
 
-    fn new_with_env(env: LmdbEnv) -> anyhow::Result<Self> {
+    fn new_with_env(
+        env: LmdbEnv,
+        config: &LmdbConfig,
+        cache_observer: Arc<dyn ReadCacheObserver>,
+    ) -> anyhow::Result<Self> {
         let env = Arc::new(env);
+        let block_cache = ReadCache::new(
+            ReadCacheKind::Block,
+            config.block_cache_size,
+            cache_observer.clone(),
+        );
+        let account_cache = ReadCache::new(
+            ReadCacheKind::Account,
+            config.account_cache_size,
+            cache_observer,
+        );
         Ok(Self {
             cache: Arc::new(LedgerCache::new()),
-            block: Arc::new(LmdbBlockStore::new(env.clone())?),
-            account: Arc::new(LmdbAccountStore::new(env.clone())?),
+            block: Arc::new(LmdbBlockStore::with_cache(env.clone(), block_cache)?),
+            account: Arc::new(LmdbAccountStore::with_cache(env.clone(), account_cache)?),
             pending: Arc::new(LmdbPendingStore::new(env.clone())?),
             online_weight: Arc::new(LmdbOnlineWeightStore::new(env.clone())?),
             pruned: Arc::new(LmdbPrunedStore::new(env.clone())?),
             rep_weight: Arc::new(LmdbRepWeightStore::new(env.clone())?),
             peer: Arc::new(LmdbPeerStore::new(env.clone())?),
             confirmation_height: Arc::new(LmdbConfirmationHeightStore::new(env.clone())?),
+            delegator: Arc::new(LmdbDelegatorStore::new(env.clone())?),
+            unconfirmed: Arc::new(LmdbUnconfirmedStore::new(env.clone())?),
             final_vote: Arc::new(LmdbFinalVoteStore::new(env.clone())?),
             version: Arc::new(LmdbVersionStore::new(env.clone())?),
             env,
@@ -180,6 +290,46 @@ impl LmdbStore {
         })
     }
 
+    /// Persists the counters of the ledger cache, so that the next start doesn't
+    /// have to scan the account and confirmation height tables. This should be
+    /// called when the ledger isn't written to anymore, e.g. on shutdown.
+    /// `indexes` are the secondary indexes that were maintained up to now. They
+    /// don't have to be rebuilt on the next start.
+    pub fn write_cache_checkpoint(&self, indexes: ConsistentIndexes) {
+        let mut txn = self.tx_begin_write();
+        // The write lock is held, so this transaction will get the next ID
+        let txn_id = self.env.environment.last_txn_id() + 1;
+        let checkpoint = LedgerCacheCheckpoint {
+            txn_id,
+            block_count: self.cache.block_count.load(Ordering::SeqCst),
+            account_count: self.cache.account_count.load(Ordering::SeqCst),
+            cemented_count: self.cache.cemented_count.load(Ordering::SeqCst),
+        };
+        self.version.put_cache_checkpoint(&mut txn, &checkpoint);
+        self.version
+            .put_index_checkpoint(&mut txn, txn_id, &indexes);
+        txn.commit();
+    }
+
+    /// Returns the persisted cache counters if nothing was written to the ledger
+    /// since `write_cache_checkpoint` was called
+    pub fn valid_cache_checkpoint(&self) -> Option<LedgerCacheCheckpoint> {
+        let txn = self.tx_begin_read();
+        self.version
+            .get_cache_checkpoint(&txn)
+            .filter(|c| c.txn_id == self.env.environment.last_txn_id())
+    }
+
+    /// Returns the indexes that were consistent with the ledger when
+    /// `write_cache_checkpoint` was called, if nothing was written since then
+    pub fn valid_consistent_indexes(&self) -> ConsistentIndexes {
+        let txn = self.tx_begin_read();
+        match self.version.get_index_checkpoint(&txn) {
+            Some((txn_id, indexes)) if txn_id == self.env.environment.last_txn_id() => indexes,
+            _ => ConsistentIndexes::default(),
+        }
+    }
+
     pub fn vendor(&self) -> String {
         // fake version! TODO: read version
         format!("lmdb-rkv {}.{}.{}", 0, 14, 0)
@@ -286,10 +436,23 @@ fn do_upgrades(env: Arc<LmdbEnv>) -> anyhow::Result<Vacuuming> {
         bail!("version too high");
     }
 
+    if version == 24 {
+        upgrade_v24_to_v25(&version_store, &mut txn);
+    }
+
     // most recent version
     Ok(Vacuuming::NotNeeded)
 }
 
+/// Version 25 introduced the compact encoding of the block table. Both encodings can be
+/// read, so the existing entries are re-encoded online by the node after the upgrade
+fn upgrade_v24_to_v25(version_store: &LmdbVersionStore, txn: &mut LmdbWriteTransaction) {
+    info!("Upgrading database from v24 to v25...");
+    version_store.put_block_migration_cursor(txn, &BlockHash::zero());
+    version_store.put(txn, 25);
+    info!("Upgrading database from v24 to v25 completed. The block table gets compacted in the background");
+}
+
 fn vacuum_after_upgrade(env: Arc<LmdbEnv>, path: &Path) -> anyhow::Result<()> {
     // Vacuum the database. This is not a required step and may actually fail if there isn't enough storage space.
     let mut vacuum_path = path.to_owned();
@@ -396,6 +559,7 @@ fn backup_file_path(source_path: &Path) -> anyhow::Result<PathBuf> {
 mod tests {
     use super::*;
     use crate::TestDbFile;
+    use rsnano_core::BlockHash;
 
     #[test]
     fn create_store() -> anyhow::Result<()> {
@@ -420,12 +584,112 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn cache_checkpoint_is_valid_after_reopen() {
+        let file = TestDbFile::random();
+        {
+            let store = LmdbStore::open(&file.path).build().unwrap();
+            store.cache.block_count.store(3, Ordering::SeqCst);
+            store.cache.account_count.store(2, Ordering::SeqCst);
+            store.cache.cemented_count.store(1, Ordering::SeqCst);
+            store.write_cache_checkpoint(ConsistentIndexes::default());
+        }
+
+        let store = LmdbStore::open(&file.path).build().unwrap();
+        let checkpoint = store.valid_cache_checkpoint().unwrap();
+        assert_eq!(checkpoint.block_count, 3);
+        assert_eq!(checkpoint.account_count, 2);
+        assert_eq!(checkpoint.cemented_count, 1);
+    }
+
+    #[test]
+    fn cache_checkpoint_gets_stale_after_write() {
+        let file = TestDbFile::random();
+        let store = LmdbStore::open(&file.path).build().unwrap();
+        store.write_cache_checkpoint(ConsistentIndexes::default());
+        assert!(store.valid_cache_checkpoint().is_some());
+
+        let mut txn = store.tx_begin_write();
+        store.pruned.put(&mut txn, &BlockHash::from(1));
+        txn.commit();
+
+        assert!(store.valid_cache_checkpoint().is_none());
+    }
+
+    #[test]
+    fn consistent_indexes_are_valid_after_reopen() {
+        let file = TestDbFile::random();
+        let indexes = ConsistentIndexes {
+            delegators: false,
+            unconfirmed: true,
+        };
+        {
+            let store = LmdbStore::open(&file.path).build().unwrap();
+            store.write_cache_checkpoint(indexes);
+        }
+
+        let store = LmdbStore::open(&file.path).build().unwrap();
+        assert_eq!(store.valid_consistent_indexes(), indexes);
+        assert!(store.valid_cache_checkpoint().is_some());
+    }
+
+    #[test]
+    fn consistent_indexes_get_stale_after_write() {
+        let file = TestDbFile::random();
+        let store = LmdbStore::open(&file.path).build().unwrap();
+        store.write_cache_checkpoint(ConsistentIndexes {
+            delegators: true,
+            unconfirmed: true,
+        });
+
+        // e.g. a node that runs without the index
+        let mut txn = store.tx_begin_write();
+        store.pruned.put(&mut txn, &BlockHash::from(1));
+        txn.commit();
+
+        assert_eq!(
+            store.valid_consistent_indexes(),
+            ConsistentIndexes::default()
+        );
+    }
+
+    #[test]
+    fn cache_checkpoint_serialization() {
+        let checkpoint = LedgerCacheCheckpoint {
+            txn_id: 1,
+            block_count: 2,
+            account_count: 3,
+            cemented_count: 4,
+        };
+        assert_eq!(
+            LedgerCacheCheckpoint::from_bytes(&checkpoint.to_bytes()),
+            Some(checkpoint)
+        );
+        assert_eq!(LedgerCacheCheckpoint::from_bytes(&[0; 31]), None);
+    }
+
     #[test]
     fn writes_db_version_for_new_store() {
         let file = TestDbFile::random();
         let store = LmdbStore::open(&file.path).build().unwrap();
         let txn = store.tx_begin_read();
-        assert_eq!(store.version.get(&txn), Some(STORE_VERSION_MINIMUM));
+        assert_eq!(store.version.get(&txn), Some(STORE_VERSION_CURRENT));
+    }
+
+    #[test]
+    fn upgrade_v24_to_v25() -> anyhow::Result<()> {
+        let file = TestDbFile::random();
+        set_store_version(&file, 24)?;
+
+        let store = LmdbStore::open(&file.path).build()?;
+
+        let txn = store.tx_begin_read();
+        assert_eq!(store.version.get(&txn), Some(25));
+        assert_eq!(
+            store.version.get_block_migration_cursor(&txn),
+            Some(BlockHash::zero())
+        );
+        Ok(())
     }
 
     fn assert_upgrade_fails(path: &Path, error_msg: &str) {
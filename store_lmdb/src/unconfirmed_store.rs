@@ -0,0 +1,182 @@
+use crate::{
+    LmdbDatabase, LmdbEnv, LmdbRangeIterator, LmdbWriteTransaction, Transaction,
+    UNCONFIRMED_TEST_DATABASE,
+};
+use lmdb::{DatabaseFlags, WriteFlags};
+use rsnano_core::{Account, NoValue};
+use rsnano_nullable_lmdb::ConfiguredDatabase;
+use std::{ops::RangeBounds, sync::Arc};
+
+/// Secondary index of the account table: all accounts which have blocks
+/// that are not confirmed yet (confirmation height < block count).
+/// The key is the account, the value is empty.
+pub struct LmdbUnconfirmedStore {
+    database: LmdbDatabase,
+}
+
+impl LmdbUnconfirmedStore {
+    pub fn new(env: Arc<LmdbEnv>) -> anyhow::Result<Self> {
+        let database = env
+            .environment
+            .create_db(Some("unconfirmed"), DatabaseFlags::empty())?;
+        Ok(Self { database })
+    }
+
+    pub fn database(&self) -> LmdbDatabase {
+        self.database
+    }
+
+    pub fn put(&self, txn: &mut LmdbWriteTransaction, account: &Account) {
+        txn.put(
+            self.database,
+            account.as_bytes(),
+            &[0; 0],
+            WriteFlags::empty(),
+        )
+        .unwrap();
+    }
+
+    pub fn del(&self, txn: &mut LmdbWriteTransaction, account: &Account) {
+        match txn.delete(self.database, account.as_bytes(), None) {
+            Ok(()) | Err(lmdb::Error::NotFound) => {}
+            Err(e) => panic!("Could not delete unconfirmed account: {:?}", e),
+        }
+    }
+
+    pub fn exists(&self, txn: &dyn Transaction, account: &Account) -> bool {
+        txn.exists(self.database, account.as_bytes())
+    }
+
+    pub fn iter_range<'tx>(
+        &self,
+        txn: &'tx dyn Transaction,
+        range: impl RangeBounds<Account> + 'static,
+    ) -> impl Iterator<Item = Account> + 'tx {
+        let cursor = txn.open_ro_cursor(self.database).unwrap();
+        LmdbRangeIterator::<Account, NoValue, _>::new(cursor, range).map(|(k, _)| k)
+    }
+
+    pub fn count(&self, txn: &dyn Transaction) -> u64 {
+        txn.count(self.database)
+    }
+
+    pub fn clear(&self, txn: &mut LmdbWriteTransaction) {
+        txn.clear_db(self.database).unwrap();
+    }
+}
+
+pub struct ConfiguredUnconfirmedDatabaseBuilder {
+    database: ConfiguredDatabase,
+}
+
+impl ConfiguredUnconfirmedDatabaseBuilder {
+    pub fn new() -> Self {
+        Self {
+            database: ConfiguredDatabase::new(UNCONFIRMED_TEST_DATABASE, "unconfirmed"),
+        }
+    }
+
+    pub fn account(mut self, account: &Account) -> Self {
+        self.database
+            .entries
+            .insert(account.as_bytes().to_vec(), Vec::new());
+        self
+    }
+
+    pub fn build(self) -> ConfiguredDatabase {
+        self.database
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{DeleteEvent, PutEvent};
+
+    struct Fixture {
+        env: Arc<LmdbEnv>,
+        store: LmdbUnconfirmedStore,
+    }
+
+    impl Fixture {
+        fn new() -> Self {
+            Self::with_database(ConfiguredUnconfirmedDatabaseBuilder::new().build())
+        }
+
+        fn with_database(database: ConfiguredDatabase) -> Self {
+            let env = Arc::new(
+                LmdbEnv::new_null_with()
+                    .configured_database(database)
+                    .build(),
+            );
+            Self {
+                env: env.clone(),
+                store: LmdbUnconfirmedStore::new(env).unwrap(),
+            }
+        }
+    }
+
+    #[test]
+    fn empty_store() {
+        let fixture = Fixture::new();
+        let txn = fixture.env.tx_begin_read();
+        assert_eq!(fixture.store.count(&txn), 0);
+        assert_eq!(fixture.store.exists(&txn, &Account::from(1)), false);
+        assert!(fixture.store.iter_range(&txn, ..).next().is_none());
+    }
+
+    #[test]
+    fn put() {
+        let fixture = Fixture::new();
+        let mut txn = fixture.env.tx_begin_write();
+        let put_tracker = txn.track_puts();
+        let account = Account::from(1);
+
+        fixture.store.put(&mut txn, &account);
+
+        assert_eq!(
+            put_tracker.output(),
+            vec![PutEvent {
+                database: UNCONFIRMED_TEST_DATABASE.into(),
+                key: account.as_bytes().to_vec(),
+                value: Vec::new(),
+                flags: WriteFlags::empty()
+            }]
+        );
+    }
+
+    #[test]
+    fn delete() {
+        let fixture = Fixture::new();
+        let mut txn = fixture.env.tx_begin_write();
+        let delete_tracker = txn.track_deletions();
+        let account = Account::from(1);
+
+        fixture.store.del(&mut txn, &account);
+
+        assert_eq!(
+            delete_tracker.output(),
+            vec![DeleteEvent {
+                database: UNCONFIRMED_TEST_DATABASE.into(),
+                key: account.as_bytes().to_vec()
+            }]
+        );
+    }
+
+    #[test]
+    fn iter_range() {
+        let fixture = Fixture::with_database(
+            ConfiguredUnconfirmedDatabaseBuilder::new()
+                .account(&Account::from(1))
+                .account(&Account::from(5))
+                .account(&Account::from(7))
+                .build(),
+        );
+        let txn = fixture.env.tx_begin_read();
+
+        let accounts: Vec<_> = fixture.store.iter_range(&txn, Account::from(2)..).collect();
+
+        assert_eq!(accounts, vec![Account::from(5), Account::from(7)]);
+        assert_eq!(fixture.store.count(&txn), 3);
+    }
+}
@@ -1,6 +1,10 @@
-use crate::{LmdbDatabase, LmdbEnv, LmdbWriteTransaction, Transaction, STORE_VERSION_CURRENT};
+use crate::{
+    ConsistentIndexes, LedgerCacheCheckpoint, LmdbDatabase, LmdbEnv, LmdbWriteTransaction,
+    Transaction, STORE_VERSION_CURRENT,
+};
 use core::panic;
 use lmdb::{DatabaseFlags, WriteFlags};
+use rsnano_core::BlockHash;
 use std::{path::Path, sync::Arc};
 
 pub struct LmdbVersionStore {
@@ -69,6 +73,88 @@ impl LmdbVersionStore {
         let db = self.db_handle();
         load_version(txn, db)
     }
+
+    pub fn put_cache_checkpoint(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        checkpoint: &LedgerCacheCheckpoint,
+    ) {
+        txn.put(
+            self.db_handle,
+            &cache_checkpoint_key(),
+            &checkpoint.to_bytes(),
+            WriteFlags::empty(),
+        )
+        .unwrap();
+    }
+
+    pub fn get_cache_checkpoint(&self, txn: &dyn Transaction) -> Option<LedgerCacheCheckpoint> {
+        match txn.get(self.db_handle, &cache_checkpoint_key()) {
+            Ok(value) => LedgerCacheCheckpoint::from_bytes(value),
+            Err(lmdb::Error::NotFound) => None,
+            Err(_) => panic!("Error while loading ledger cache checkpoint"),
+        }
+    }
+
+    /// `txn_id` is the ID of the write transaction up to which the indexes were maintained
+    pub fn put_index_checkpoint(
+        &self,
+        txn: &mut LmdbWriteTransaction,
+        txn_id: u64,
+        indexes: &ConsistentIndexes,
+    ) {
+        let mut value = [0; 9];
+        value[..8].copy_from_slice(&txn_id.to_be_bytes());
+        value[8] = indexes.to_flags();
+        txn.put(
+            self.db_handle,
+            &index_checkpoint_key(),
+            &value,
+            WriteFlags::empty(),
+        )
+        .unwrap();
+    }
+
+    pub fn get_index_checkpoint(&self, txn: &dyn Transaction) -> Option<(u64, ConsistentIndexes)> {
+        match txn.get(self.db_handle, &index_checkpoint_key()) {
+            Ok(value) if value.len() == 9 => Some((
+                u64::from_be_bytes(value[..8].try_into().unwrap()),
+                ConsistentIndexes::from_flags(value[8]),
+            )),
+            Ok(_) | Err(lmdb::Error::NotFound) => None,
+            Err(_) => panic!("Error while loading index checkpoint"),
+        }
+    }
+
+    pub fn del_index_checkpoint(&self, txn: &mut LmdbWriteTransaction) {
+        let _ = txn.delete(self.db_handle, &index_checkpoint_key(), None);
+    }
+}
+
+impl LmdbVersionStore {
+    /// The key at which the re-encoding of the block table has to continue.
+    /// None if there are no entries with the legacy encoding left
+    pub fn get_block_migration_cursor(&self, txn: &dyn Transaction) -> Option<BlockHash> {
+        match txn.get(self.db_handle, &block_migration_key()) {
+            Ok(value) => BlockHash::from_slice(value),
+            Err(lmdb::Error::NotFound) => None,
+            Err(_) => panic!("Error while loading block migration cursor"),
+        }
+    }
+
+    pub fn put_block_migration_cursor(&self, txn: &mut LmdbWriteTransaction, next: &BlockHash) {
+        txn.put(
+            self.db_handle,
+            &block_migration_key(),
+            next.as_bytes(),
+            WriteFlags::empty(),
+        )
+        .unwrap();
+    }
+
+    pub fn del_block_migration_cursor(&self, txn: &mut LmdbWriteTransaction) {
+        let _ = txn.delete(self.db_handle, &block_migration_key(), None);
+    }
 }
 
 fn load_version(txn: &dyn Transaction, db: LmdbDatabase) -> Option<i32> {
@@ -89,3 +175,15 @@ fn value_bytes(version: i32) -> [u8; 32] {
 fn version_key() -> [u8; 32] {
     value_bytes(1)
 }
+
+fn cache_checkpoint_key() -> [u8; 32] {
+    value_bytes(2)
+}
+
+fn block_migration_key() -> [u8; 32] {
+    value_bytes(3)
+}
+
+fn index_checkpoint_key() -> [u8; 32] {
+    value_bytes(4)
+}
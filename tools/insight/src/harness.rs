@@ -0,0 +1,496 @@
+use crate::{
+    message_collection::MessageCollection,
+    message_recorder::{make_node_callbacks, MessageRecorder},
+    message_replayer::{ConfirmationLatencies, MessageReplayer, ReplaySpeed},
+    node_runner::{NodeRunner, NodeState},
+    nullable_runtime::NullableRuntime,
+    recording_file::{load_recording, save_recording},
+    replay_report::{ReplayReport, ReplaySample},
+};
+use anyhow::{anyhow, bail};
+use rsnano_core::Networks;
+use rsnano_node::{
+    config::{get_node_toml_config_path, NodeFlags},
+    remove_temporary_directories, unique_path_for, working_path_for, Node, NodeCallbacks,
+};
+use rsnano_nullable_clock::SteadyClock;
+use rsnano_store_lmdb::{export_snapshot, import_snapshot, LmdbStore};
+use std::{
+    fs::File,
+    io::{BufReader, BufWriter},
+    path::{Path, PathBuf},
+    sync::{
+        atomic::{AtomicBool, Ordering},
+        Arc, Mutex, RwLock,
+    },
+    thread::{self, sleep},
+    time::{Duration, Instant},
+};
+
+const USAGE: &str = "\
+usage:
+  rsnano-insight
+      Starts the user interface
+  rsnano-insight record --file <path> [--seconds <n>] [node options]
+      Records the traffic of a node. Before the recording starts, a snapshot of
+      the ledger is exported to <path>.ledger
+  rsnano-insight replay --file <path> [--max-speed] [--drain-timeout <seconds>]
+                        [--min-cps <n>] [--reuse-ledger] [node options]
+      Replays the inbound publish, confirm_req and confirm_ack messages of a recording
+      against a node and reports its throughput. Fails if fewer than <n> blocks
+      per second were cemented. The node starts without peering in a temporary
+      data path, into which the ledger snapshot of the recording is imported.
+      --reuse-ledger runs it on the ledger of the data path instead, with its own config
+
+node options:
+  --network <live|beta|test|dev>
+  --data-path <path>
+  --config <key=value>    Overrides a node config value. Can be repeated";
+
+/// The node of a replay must not talk to the network: the replay is the only load
+/// it gets, and the replayed votes and blocks are not sent to other peers
+const NO_PEERING_CONFIG: &str = "\
+node.preconfigured_peers = []
+node.tcp_incoming_connections_max = 0
+";
+
+/// The headless commands, which run a node without the user interface
+pub(crate) enum Command {
+    Record(RecordArgs),
+    Replay(ReplayArgs),
+}
+
+pub(crate) struct NodeArgs {
+    network: Networks,
+    data_path: Option<PathBuf>,
+    config_overrides: Vec<String>,
+    /// Replays run on a fresh ledger, unless the existing one should be reused
+    reuse_ledger: bool,
+}
+
+pub(crate) struct RecordArgs {
+    node: NodeArgs,
+    file: PathBuf,
+    duration: Duration,
+}
+
+pub(crate) struct ReplayArgs {
+    node: NodeArgs,
+    file: PathBuf,
+    speed: ReplaySpeed,
+    drain_timeout: Duration,
+    min_cps: Option<u64>,
+}
+
+/// Returns `None` if the user interface should be started
+pub(crate) fn parse_command(args: &[String]) -> anyhow::Result<Option<Command>> {
+    let Some((command, options)) = args.split_first() else {
+        return Ok(None);
+    };
+
+    let mut node = NodeArgs {
+        network: Networks::NanoLiveNetwork,
+        data_path: None,
+        config_overrides: Vec::new(),
+        reuse_ledger: false,
+    };
+    let mut file = None;
+    let mut duration = Duration::from_secs(60);
+    let mut speed = ReplaySpeed::Original;
+    let mut drain_timeout = Duration::from_secs(30);
+    let mut min_cps = None;
+
+    let mut options = options.iter();
+    while let Some(option) = options.next() {
+        let mut value = || {
+            options
+                .next()
+                .ok_or_else(|| anyhow!("missing value for {}\n{}", option, USAGE))
+        };
+        match option.as_str() {
+            "--file" => file = Some(PathBuf::from(value()?)),
+            "--seconds" => duration = Duration::from_secs(value()?.parse()?),
+            "--max-speed" => speed = ReplaySpeed::Max,
+            "--drain-timeout" => drain_timeout = Duration::from_secs(value()?.parse()?),
+            "--min-cps" => min_cps = Some(value()?.parse()?),
+            "--network" => {
+                node.network = value()?.parse().map_err(|e: &str| anyhow!(e))?;
+            }
+            "--data-path" => node.data_path = Some(PathBuf::from(value()?)),
+            "--config" => node.config_overrides.push(value()?.clone()),
+            "--reuse-ledger" => node.reuse_ledger = true,
+            _ => bail!("unknown option {}\n{}", option, USAGE),
+        }
+    }
+
+    let file = file.ok_or_else(|| anyhow!("--file is missing\n{}", USAGE))?;
+    match command.as_str() {
+        "record" => Ok(Some(Command::Record(RecordArgs {
+            node,
+            file,
+            duration,
+        }))),
+        "replay" if node.data_path.is_some() && !node.reuse_ledger => {
+            bail!("--data-path needs --reuse-ledger\n{}", USAGE)
+        }
+        "replay" => Ok(Some(Command::Replay(ReplayArgs {
+            node,
+            file,
+            speed,
+            drain_timeout,
+            min_cps,
+        }))),
+        _ => bail!("unknown command {}\n{}", command, USAGE),
+    }
+}
+
+pub(crate) fn run_command(command: Command, runtime: tokio::runtime::Handle) -> anyhow::Result<()> {
+    let runtime = Arc::new(NullableRuntime::new(runtime));
+    match command {
+        Command::Record(args) => record(args, runtime),
+        Command::Replay(args) => replay(args, runtime),
+    }
+}
+
+fn record(args: RecordArgs, runtime: Arc<NullableRuntime>) -> anyhow::Result<()> {
+    let messages = Arc::new(RwLock::new(MessageCollection::default()));
+    let recorder = Arc::new(MessageRecorder::new(messages.clone()));
+    let callbacks = make_node_callbacks(recorder.clone(), Arc::new(SteadyClock::default()));
+    let data_path = existing_data_path(&args.node)?;
+    let (mut runner, node) = start_node(runtime, &args.node, data_path, callbacks)?;
+
+    // The replay needs the ledger state from which the recorded traffic continues
+    let snapshot = snapshot_path(&args.file);
+    println!("Exporting the ledger to {}...", snapshot.display());
+    if let Err(e) = export_ledger_snapshot(&node, &snapshot) {
+        stop_node(&mut runner);
+        return Err(e);
+    }
+
+    println!("Recording for {}s...", args.duration.as_secs());
+    recorder.start_recording();
+    sleep(args.duration);
+    recorder.stop_recording();
+    stop_node(&mut runner);
+
+    let messages = messages.read().unwrap();
+    save_recording(&args.file, messages.all_messages())?;
+    println!(
+        "Saved {} messages to {}",
+        messages.all_messages().len(),
+        args.file.display()
+    );
+    Ok(())
+}
+
+fn replay(args: ReplayArgs, runtime: Arc<NullableRuntime>) -> anyhow::Result<()> {
+    let messages = load_recording(&args.file)?;
+    println!(
+        "Loaded {} messages from {}",
+        messages.len(),
+        args.file.display()
+    );
+    let data_path = if args.node.reuse_ledger {
+        existing_data_path(&args.node)?
+    } else {
+        match fresh_data_path(&args.node, &snapshot_path(&args.file)) {
+            Ok(data_path) => data_path,
+            Err(e) => {
+                remove_temporary_directories();
+                return Err(e);
+            }
+        }
+    };
+    println!("Using the ledger in {}", data_path.display());
+    let started = start_node(runtime, &args.node, data_path, NodeCallbacks::default());
+    let (mut runner, node) = match started {
+        Ok(started) => started,
+        Err(e) => {
+            remove_temporary_directories();
+            return Err(e);
+        }
+    };
+
+    let latencies = Arc::new(Mutex::new(ConfirmationLatencies::default()));
+    let latencies2 = latencies.clone();
+    node.confirming_set.on_cemented(Box::new(move |block| {
+        latencies2
+            .lock()
+            .unwrap()
+            .cemented(&block.hash(), Instant::now());
+    }));
+
+    let mut replayer = MessageReplayer::new(node.clone(), args.speed, latencies.clone());
+    let replay_done = AtomicBool::new(false);
+    let mut report = thread::scope(|s| {
+        let sampler = s.spawn(|| monitor(&node, &replay_done, args.drain_timeout));
+        replayer.replay(&messages);
+        replay_done.store(true, Ordering::SeqCst);
+        sampler.join().unwrap()
+    });
+    stop_node(&mut runner);
+    remove_temporary_directories();
+
+    report.replayed = replayer.replayed;
+    report.dropped = replayer.dropped;
+    report.backpressure_waits = replayer.backpressure_waits;
+    {
+        let latencies = latencies.lock().unwrap();
+        report.unconfirmed = latencies.unconfirmed();
+        report.set_latencies(latencies.latencies());
+    }
+    println!("{}", report);
+
+    if let Some(min_cps) = args.min_cps {
+        if report.cemented_per_second() < min_cps {
+            bail!(
+                "only {} blocks/s were cemented, expected at least {}",
+                report.cemented_per_second(),
+                min_cps
+            );
+        }
+    }
+    Ok(())
+}
+
+/// Samples the node until the replay is done and the node has processed the replayed messages
+fn monitor(node: &Node, replay_done: &AtomicBool, drain_timeout: Duration) -> ReplayReport {
+    let mut report = ReplayReport::new(ReplaySample::from_node(node), Instant::now());
+    let mut drain_deadline = None;
+    loop {
+        sleep(Duration::from_millis(500));
+        let now = Instant::now();
+        let sample = ReplaySample::from_node(node);
+        report.add_sample(sample, now);
+
+        if replay_done.load(Ordering::SeqCst) {
+            let deadline = *drain_deadline.get_or_insert(now + drain_timeout);
+            if sample.queues_empty() || now >= deadline {
+                return report;
+            }
+        }
+    }
+}
+
+fn existing_data_path(args: &NodeArgs) -> anyhow::Result<PathBuf> {
+    match &args.data_path {
+        Some(path) => Ok(path.clone()),
+        None => working_path_for(args.network).ok_or_else(|| anyhow!("no data path")),
+    }
+}
+
+/// The ledger snapshot is stored next to the recording
+fn snapshot_path(recording: &Path) -> PathBuf {
+    let mut path = recording.as_os_str().to_owned();
+    path.push(".ledger");
+    path.into()
+}
+
+pub(crate) fn export_ledger_snapshot(node: &Node, path: &Path) -> anyhow::Result<()> {
+    let mut writer = BufWriter::with_capacity(1024 * 1024, File::create(path)?);
+    export_snapshot(&node.store, &mut writer)?;
+    Ok(())
+}
+
+/// Creates a temporary data path with a config that disables peering and imports
+/// the ledger snapshot into it. `remove_temporary_directories` deletes it again
+pub(crate) fn fresh_data_path(args: &NodeArgs, snapshot: &Path) -> anyhow::Result<PathBuf> {
+    let data_path = unique_path_for(args.network).ok_or_else(|| anyhow!("no data path"))?;
+    std::fs::write(get_node_toml_config_path(&data_path), NO_PEERING_CONFIG)?;
+
+    if snapshot.exists() {
+        println!("Importing the ledger from {}...", snapshot.display());
+        import_ledger_snapshot(snapshot, &data_path)?;
+    } else {
+        // Most of the recorded blocks and votes have no effect on an empty ledger
+        eprintln!(
+            "{} not found, replaying against an empty ledger",
+            snapshot.display()
+        );
+    }
+    Ok(data_path)
+}
+
+fn import_ledger_snapshot(snapshot: &Path, data_path: &Path) -> anyhow::Result<()> {
+    let store = LmdbStore::open(&data_path.join("data.ldb")).build()?;
+    let reader = BufReader::with_capacity(1024 * 1024, File::open(snapshot)?);
+    import_snapshot(&store, reader)?;
+    Ok(())
+}
+
+fn start_node(
+    runtime: Arc<NullableRuntime>,
+    args: &NodeArgs,
+    data_path: PathBuf,
+    callbacks: NodeCallbacks,
+) -> anyhow::Result<(NodeRunner, Arc<Node>)> {
+    let mut flags = NodeFlags::default();
+    flags.config_overrides = args.config_overrides.clone();
+
+    let mut runner = NodeRunner::new(runtime);
+    runner.start_node(args.network, data_path, callbacks, flags);
+    loop {
+        if let Some(node) = runner.node() {
+            return Ok((runner, node));
+        }
+        if runner.state() == NodeState::Stopped {
+            bail!("the node could not be started");
+        }
+        sleep(Duration::from_millis(100));
+    }
+}
+
+fn stop_node(runner: &mut NodeRunner) {
+    runner.stop();
+    while runner.state() != NodeState::Stopped {
+        sleep(Duration::from_millis(100));
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use rsnano_core::{UnsavedBlockLatticeBuilder, DEV_GENESIS_KEY};
+    use rsnano_node::unique_path;
+    use test_helpers::{assert_timely, System};
+
+    fn args(args: &[&str]) -> Vec<String> {
+        args.iter().map(|i| i.to_string()).collect()
+    }
+
+    #[test]
+    fn no_command_starts_ui() {
+        assert!(parse_command(&[]).unwrap().is_none());
+    }
+
+    #[test]
+    fn parse_replay() {
+        let Some(Command::Replay(replay)) = parse_command(&args(&[
+            "replay",
+            "--file",
+            "traffic.rec",
+            "--max-speed",
+            "--network",
+            "beta",
+            "--config",
+            "node.enable_voting=false",
+            "--min-cps",
+            "100",
+        ]))
+        .unwrap() else {
+            panic!("not a replay command");
+        };
+        assert_eq!(replay.file, PathBuf::from("traffic.rec"));
+        assert_eq!(replay.speed, ReplaySpeed::Max);
+        assert_eq!(replay.node.network, Networks::NanoBetaNetwork);
+        assert_eq!(replay.node.config_overrides, ["node.enable_voting=false"]);
+        assert_eq!(replay.min_cps, Some(100));
+        assert!(!replay.node.reuse_ledger);
+    }
+
+    #[test]
+    fn reusing_a_ledger_is_explicit() {
+        assert!(parse_command(&args(&["replay", "--file", "a", "--data-path", "b"])).is_err());
+
+        let Some(Command::Replay(replay)) = parse_command(&args(&[
+            "replay",
+            "--file",
+            "a",
+            "--reuse-ledger",
+            "--data-path",
+            "b",
+        ]))
+        .unwrap() else {
+            panic!("not a replay command");
+        };
+        assert!(replay.node.reuse_ledger);
+        assert_eq!(replay.node.data_path, Some(PathBuf::from("b")));
+    }
+
+    #[test]
+    fn parse_record() {
+        let Some(Command::Record(record)) = parse_command(&args(&[
+            "record",
+            "--file",
+            "traffic.rec",
+            "--seconds",
+            "5",
+        ]))
+        .unwrap() else {
+            panic!("not a record command");
+        };
+        assert_eq!(record.duration, Duration::from_secs(5));
+        assert_eq!(record.node.network, Networks::NanoLiveNetwork);
+    }
+
+    #[test]
+    fn file_is_required() {
+        assert!(parse_command(&args(&["replay"])).is_err());
+    }
+
+    #[test]
+    fn reject_unknown_option() {
+        assert!(parse_command(&args(&["replay", "--file", "a", "--speed"])).is_err());
+    }
+
+    #[test]
+    fn record_and_replay_dev_session() {
+        let mut system = System::new();
+        let voting_node = system.make_node();
+        voting_node.insert_into_wallet(&DEV_GENESIS_KEY);
+
+        let messages = Arc::new(RwLock::new(MessageCollection::default()));
+        let recorder = Arc::new(MessageRecorder::new(messages.clone()));
+        let recorded_node = system
+            .build_node()
+            .callbacks(make_node_callbacks(
+                recorder.clone(),
+                Arc::new(SteadyClock::default()),
+            ))
+            .finish();
+
+        // The recorded traffic continues from a ledger which already contains send1
+        let mut lattice = UnsavedBlockLatticeBuilder::new();
+        let send1 = lattice.genesis().send(&*DEV_GENESIS_KEY, 1);
+        voting_node.process_local(send1.clone()).unwrap();
+        assert_timely(Duration::from_secs(10), || {
+            recorded_node.block_confirmed(&send1.hash())
+        });
+
+        let recording = unique_path().unwrap().join("session.rec");
+        export_ledger_snapshot(&recorded_node, &snapshot_path(&recording)).unwrap();
+        recorder.start_recording();
+        let send2 = lattice.genesis().send(&*DEV_GENESIS_KEY, 1);
+        voting_node.process_local(send2.clone()).unwrap();
+        assert_timely(Duration::from_secs(10), || {
+            recorded_node.block_confirmed(&send2.hash())
+        });
+        recorder.stop_recording();
+        save_recording(&recording, messages.read().unwrap().all_messages()).unwrap();
+
+        let args = NodeArgs {
+            network: Networks::NanoDevNetwork,
+            data_path: None,
+            config_overrides: Vec::new(),
+            reuse_ledger: false,
+        };
+        let data_path = fresh_data_path(&args, &snapshot_path(&recording)).unwrap();
+        let replay_node = system
+            .build_node()
+            .data_path(data_path)
+            .disconnected()
+            .finish();
+        assert!(replay_node.block_confirmed(&send1.hash()));
+        assert!(!replay_node.block_confirmed(&send2.hash()));
+
+        let latencies = Arc::new(Mutex::new(ConfirmationLatencies::default()));
+        let mut replayer =
+            MessageReplayer::new(replay_node.clone(), ReplaySpeed::Max, latencies.clone());
+        replayer.replay(&load_recording(&recording).unwrap());
+
+        assert!(replayer.replayed > 0);
+        assert_timely(Duration::from_secs(10), || {
+            replay_node.block_confirmed(&send2.hash())
+        });
+    }
+}
@@ -1,11 +1,15 @@
 mod channels;
+mod harness;
 mod ledger_stats;
 mod message_collection;
 mod message_rate_calculator;
 mod message_recorder;
+mod message_replayer;
 mod node_runner;
 mod nullable_runtime;
 mod rate_calculator;
+mod recording_file;
+mod replay_report;
 mod view_models;
 mod views;
 
@@ -17,6 +21,22 @@ fn main() -> eframe::Result {
     let runtime = Runtime::new().unwrap();
     let runtime_handle = runtime.handle().clone();
 
+    let args: Vec<String> = std::env::args().skip(1).collect();
+    match harness::parse_command(&args) {
+        Ok(Some(command)) => {
+            if let Err(e) = harness::run_command(command, runtime_handle) {
+                eprintln!("{:?}", e);
+                std::process::exit(1);
+            }
+            return Ok(());
+        }
+        Ok(None) => {}
+        Err(e) => {
+            eprintln!("{:?}", e);
+            std::process::exit(1);
+        }
+    }
+
     let options = eframe::NativeOptions {
         viewport: egui::ViewportBuilder::default().with_inner_size([1024.0, 768.0]),
         ..Default::default()
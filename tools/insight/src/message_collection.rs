@@ -182,6 +182,11 @@ impl MessageCollection {
         self.filtered.len()
     }
 
+    /// All recorded messages, regardless of the current filter
+    pub fn all_messages(&self) -> &[RecordedMessage] {
+        &self.all_messages
+    }
+
     pub fn add(&mut self, message: RecordedMessage) {
         if self.filter.include(&message) {
             self.filtered.push(message.clone());
@@ -0,0 +1,219 @@
+use crate::message_collection::RecordedMessage;
+use rsnano_core::BlockHash;
+use rsnano_messages::Message;
+use rsnano_network::{ChannelDirection, ChannelId, ChannelInfo};
+use rsnano_node::Node;
+use std::{
+    collections::HashMap,
+    net::{Ipv6Addr, SocketAddrV6},
+    sync::{Arc, Mutex},
+    thread::sleep,
+    time::{Duration, Instant},
+};
+
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub(crate) enum ReplaySpeed {
+    /// Keep the time between the messages as it was recorded
+    Original,
+    /// Replay as fast as the node accepts the messages
+    Max,
+}
+
+/// Only the messages which put load on the node are replayed. Handshakes,
+/// keepalives and bootstrap responses only make sense on the connection they were recorded on
+pub(crate) fn is_replayable(message: &RecordedMessage) -> bool {
+    message.direction == ChannelDirection::Inbound
+        && matches!(
+            message.message,
+            Message::Publish(_) | Message::ConfirmAck(_) | Message::ConfirmReq(_)
+        )
+}
+
+/// Remembers when the replayed blocks were published, to measure how long
+/// the node needs to confirm them
+#[derive(Default)]
+pub(crate) struct ConfirmationLatencies {
+    published: HashMap<BlockHash, Instant>,
+    latencies: Vec<Duration>,
+}
+
+impl ConfirmationLatencies {
+    pub fn published(&mut self, hash: BlockHash, now: Instant) {
+        self.published.entry(hash).or_insert(now);
+    }
+
+    pub fn cemented(&mut self, hash: &BlockHash, now: Instant) {
+        if let Some(published) = self.published.remove(hash) {
+            self.latencies.push(now - published);
+        }
+    }
+
+    pub fn unconfirmed(&self) -> usize {
+        self.published.len()
+    }
+
+    pub fn latencies(&self) -> &[Duration] {
+        &self.latencies
+    }
+}
+
+/// Feeds recorded messages into the inbound message queue of a node,
+/// as if they were received from the network
+pub(crate) struct MessageReplayer {
+    node: Arc<Node>,
+    speed: ReplaySpeed,
+    latencies: Arc<Mutex<ConfirmationLatencies>>,
+    channels: HashMap<ChannelId, Arc<ChannelInfo>>,
+    pub replayed: usize,
+    /// Messages which were dropped, because the inbound queue was full
+    pub dropped: usize,
+    /// How often the inbound queue was full and the replay had to wait
+    pub backpressure_waits: usize,
+}
+
+impl MessageReplayer {
+    // The replayed channels aren't registered in the network, so they
+    // get ids far away from the ones of the real channels
+    const FIRST_CHANNEL_ID: usize = usize::MAX / 2;
+
+    pub(crate) fn new(
+        node: Arc<Node>,
+        speed: ReplaySpeed,
+        latencies: Arc<Mutex<ConfirmationLatencies>>,
+    ) -> Self {
+        Self {
+            node,
+            speed,
+            latencies,
+            channels: HashMap::new(),
+            replayed: 0,
+            dropped: 0,
+            backpressure_waits: 0,
+        }
+    }
+
+    pub(crate) fn replay(&mut self, messages: &[RecordedMessage]) {
+        let Some(first) = messages.first() else {
+            return;
+        };
+        let recording_start = first.date;
+        let replay_start = Instant::now();
+
+        for message in messages.iter().filter(|m| is_replayable(m)) {
+            if self.speed == ReplaySpeed::Original {
+                let offset = (message.date - recording_start)
+                    .to_std()
+                    .unwrap_or_default();
+                let due = replay_start + offset;
+                let now = Instant::now();
+                if due > now {
+                    sleep(due - now);
+                }
+            }
+
+            self.put(message);
+        }
+    }
+
+    fn put(&mut self, message: &RecordedMessage) {
+        let channel = self.channel(message.channel_id);
+        if let Message::Publish(publish) = &message.message {
+            self.latencies
+                .lock()
+                .unwrap()
+                .published(publish.block.hash(), Instant::now());
+        }
+
+        while !self
+            .node
+            .inbound_message_queue
+            .put(message.message.clone(), channel.clone())
+        {
+            if self.speed == ReplaySpeed::Original {
+                // Like the network, the original timing drops what the node can't keep up with
+                self.dropped += 1;
+                return;
+            }
+            self.backpressure_waits += 1;
+            sleep(Duration::from_millis(1));
+        }
+        self.replayed += 1;
+    }
+
+    fn channel(&mut self, recorded_id: ChannelId) -> Arc<ChannelInfo> {
+        let next_id = Self::FIRST_CHANNEL_ID + self.channels.len();
+        let node = &self.node;
+        self.channels
+            .entry(recorded_id)
+            .or_insert_with(|| {
+                let index = next_id - Self::FIRST_CHANNEL_ID;
+                // Each replayed channel gets its own peer address
+                let peer_addr = SocketAddrV6::new(
+                    Ipv6Addr::new(
+                        0x2001,
+                        0xdb8,
+                        (index >> 16) as u16,
+                        index as u16,
+                        0,
+                        0,
+                        0,
+                        1,
+                    ),
+                    7075,
+                    0,
+                    0,
+                );
+                Arc::new(ChannelInfo::new(
+                    next_id.into(),
+                    SocketAddrV6::new(Ipv6Addr::LOCALHOST, 7075, 0, 0),
+                    peer_addr,
+                    ChannelDirection::Inbound,
+                    node.network_params.network.protocol_version,
+                    node.steady_clock.now(),
+                ))
+            })
+            .clone()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use rsnano_messages::ConfirmReq;
+
+    #[test]
+    fn replay_inbound_load_only() {
+        let mut message = RecordedMessage {
+            message: Message::ConfirmReq(ConfirmReq::new_test_instance()),
+            direction: ChannelDirection::Inbound,
+            ..RecordedMessage::new_test_instance()
+        };
+        assert!(is_replayable(&message));
+
+        message.direction = ChannelDirection::Outbound;
+        assert!(!is_replayable(&message));
+
+        let bootstrap = RecordedMessage {
+            message: Message::BulkPush,
+            direction: ChannelDirection::Inbound,
+            ..RecordedMessage::new_test_instance()
+        };
+        assert!(!is_replayable(&bootstrap));
+    }
+
+    #[test]
+    fn measure_confirmation_latency() {
+        let mut latencies = ConfirmationLatencies::default();
+        let start = Instant::now();
+        latencies.published(BlockHash::from(1), start);
+        latencies.published(BlockHash::from(2), start);
+        // republished blocks keep their first publish time
+        latencies.published(BlockHash::from(1), start + Duration::from_millis(50));
+
+        latencies.cemented(&BlockHash::from(1), start + Duration::from_millis(100));
+        latencies.cemented(&BlockHash::from(3), start + Duration::from_millis(100));
+
+        assert_eq!(latencies.latencies(), [Duration::from_millis(100)]);
+        assert_eq!(latencies.unconfirmed(), 1);
+    }
+}
@@ -3,7 +3,7 @@ use num::FromPrimitive;
 use num_derive::FromPrimitive;
 use rsnano_core::Networks;
 use rsnano_daemon::DaemonBuilder;
-use rsnano_node::{Node, NodeCallbacks};
+use rsnano_node::{config::NodeFlags, Node, NodeCallbacks};
 use std::{
     path::PathBuf,
     sync::{
@@ -42,6 +42,7 @@ impl NodeRunner {
         network: Networks,
         data_path: impl Into<PathBuf>,
         callbacks: NodeCallbacks,
+        flags: NodeFlags,
     ) {
         self.state
             .store(NodeState::Starting as u8, Ordering::SeqCst);
@@ -64,13 +65,16 @@ impl NodeRunner {
                 let _ = rx_stop.await;
             };
 
-            DaemonBuilder::new(network)
+            let result = DaemonBuilder::new(network)
                 .data_path(data_path)
+                .flags(flags)
                 .callbacks(callbacks)
                 .on_node_started(on_started)
                 .run(shutdown_signal)
-                .await
-                .unwrap();
+                .await;
+            if let Err(e) = result {
+                eprintln!("Node stopped with an error: {:?}", e);
+            }
 
             state2.store(NodeState::Stopped as u8, Ordering::SeqCst);
         });
@@ -0,0 +1,219 @@
+use crate::message_collection::RecordedMessage;
+use anyhow::{anyhow, bail};
+use chrono::DateTime;
+use num::FromPrimitive;
+use rsnano_messages::{Message, MessageHeader, MessageSerializer};
+use rsnano_network::{ChannelDirection, ChannelId};
+use std::{
+    fs::File,
+    io::{BufReader, BufWriter, ErrorKind, Read, Write},
+    path::Path,
+};
+
+const MAGIC: &[u8; 8] = b"RSNRECRD";
+const FORMAT_VERSION: u8 = 1;
+
+/// Writes the messages in a compact binary format.
+/// The file starts with a header of magic bytes, the format version and the
+/// date of the first message. Each message consists of its direction, its channel id,
+/// the microseconds since the previous message and the message as it is sent over the wire.
+/// All numbers are varints, so that a message only needs a few bytes on top of its own size
+pub(crate) fn write_recording(
+    writer: &mut impl Write,
+    messages: &[RecordedMessage],
+) -> anyhow::Result<()> {
+    let start = messages
+        .first()
+        .map(|m| m.date.timestamp_micros())
+        .unwrap_or_default();
+
+    writer.write_all(MAGIC)?;
+    writer.write_all(&[FORMAT_VERSION])?;
+    writer.write_all(&start.to_le_bytes())?;
+
+    let mut serializer = MessageSerializer::default();
+    let mut previous = start;
+    for message in messages {
+        let date = message.date.timestamp_micros();
+        writer.write_all(&[message.direction as u8])?;
+        write_varint(writer, message.channel_id.as_usize() as u64)?;
+        // Messages are recorded by several threads, so the dates aren't strictly ordered
+        write_varint(writer, zigzag(date - previous))?;
+        let bytes = serializer.serialize(&message.message);
+        write_varint(writer, bytes.len() as u64)?;
+        writer.write_all(bytes)?;
+        previous = date;
+    }
+    Ok(())
+}
+
+pub(crate) fn read_recording(reader: &mut impl Read) -> anyhow::Result<Vec<RecordedMessage>> {
+    let mut magic = [0; 8];
+    reader.read_exact(&mut magic)?;
+    if &magic != MAGIC {
+        bail!("not a message recording");
+    }
+    let mut version = [0];
+    reader.read_exact(&mut version)?;
+    if version[0] != FORMAT_VERSION {
+        bail!("unsupported recording format version {}", version[0]);
+    }
+    let mut start = [0; 8];
+    reader.read_exact(&mut start)?;
+    let mut date = i64::from_le_bytes(start);
+
+    let mut messages = Vec::new();
+    let mut buffer = Vec::new();
+    loop {
+        let mut direction = [0];
+        match reader.read_exact(&mut direction) {
+            Ok(()) => {}
+            Err(e) if e.kind() == ErrorKind::UnexpectedEof => break,
+            Err(e) => return Err(e.into()),
+        }
+        let direction: ChannelDirection = FromPrimitive::from_u8(direction[0])
+            .ok_or_else(|| anyhow!("invalid channel direction {}", direction[0]))?;
+        let channel_id = ChannelId::from(read_varint(reader)? as usize);
+        date += unzigzag(read_varint(reader)?);
+
+        let len = read_varint(reader)? as usize;
+        if len < MessageHeader::SERIALIZED_SIZE
+            || len > MessageHeader::SERIALIZED_SIZE + Message::MAX_MESSAGE_SIZE
+        {
+            bail!("invalid message length {}", len);
+        }
+        buffer.resize(len, 0);
+        reader.read_exact(&mut buffer)?;
+        let header = MessageHeader::deserialize_slice(&buffer[..MessageHeader::SERIALIZED_SIZE])?;
+        let message = Message::deserialize(&buffer[MessageHeader::SERIALIZED_SIZE..], &header, 0)
+            .ok_or_else(|| anyhow!("invalid {:?} message", header.message_type))?;
+
+        messages.push(RecordedMessage {
+            channel_id,
+            message,
+            direction,
+            date: DateTime::from_timestamp_micros(date)
+                .ok_or_else(|| anyhow!("invalid message date"))?,
+        });
+    }
+    Ok(messages)
+}
+
+pub(crate) fn save_recording(path: &Path, messages: &[RecordedMessage]) -> anyhow::Result<()> {
+    let mut writer = BufWriter::new(File::create(path)?);
+    write_recording(&mut writer, messages)?;
+    writer.flush()?;
+    Ok(())
+}
+
+pub(crate) fn load_recording(path: &Path) -> anyhow::Result<Vec<RecordedMessage>> {
+    read_recording(&mut BufReader::new(File::open(path)?))
+}
+
+fn write_varint(writer: &mut impl Write, mut value: u64) -> std::io::Result<()> {
+    let mut buffer = [0; 10];
+    let mut len = 0;
+    loop {
+        let byte = (value & 0x7f) as u8;
+        value >>= 7;
+        if value == 0 {
+            buffer[len] = byte;
+            len += 1;
+            break;
+        }
+        buffer[len] = byte | 0x80;
+        len += 1;
+    }
+    writer.write_all(&buffer[..len])
+}
+
+fn read_varint(reader: &mut impl Read) -> anyhow::Result<u64> {
+    let mut value = 0u64;
+    for shift in (0..64).step_by(7) {
+        let mut byte = [0];
+        reader.read_exact(&mut byte)?;
+        value |= ((byte[0] & 0x7f) as u64) << shift;
+        if byte[0] & 0x80 == 0 {
+            return Ok(value);
+        }
+    }
+    bail!("varint too long")
+}
+
+fn zigzag(value: i64) -> u64 {
+    ((value << 1) ^ (value >> 63)) as u64
+}
+
+fn unzigzag(value: u64) -> i64 {
+    ((value >> 1) as i64) ^ -((value & 1) as i64)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use chrono::Duration;
+    use rsnano_messages::ConfirmReq;
+
+    #[test]
+    fn empty_recording() {
+        let mut buffer = Vec::new();
+        write_recording(&mut buffer, &[]).unwrap();
+        assert!(read_recording(&mut buffer.as_slice()).unwrap().is_empty());
+    }
+
+    #[test]
+    fn write_and_read() {
+        let first = RecordedMessage::new_test_instance();
+        let second = RecordedMessage {
+            channel_id: 1000.into(),
+            message: Message::ConfirmReq(ConfirmReq::new_test_instance()),
+            direction: ChannelDirection::Inbound,
+            date: first.date + Duration::milliseconds(1500),
+        };
+        // out of order
+        let third = RecordedMessage {
+            date: first.date + Duration::microseconds(1_499_999),
+            ..second.clone()
+        };
+
+        let mut buffer = Vec::new();
+        write_recording(&mut buffer, &[first.clone(), second.clone(), third.clone()]).unwrap();
+        let messages = read_recording(&mut buffer.as_slice()).unwrap();
+
+        assert_eq!(messages.len(), 3);
+        for (read, written) in messages.iter().zip([first, second, third]) {
+            assert_eq!(read.channel_id, written.channel_id);
+            assert_eq!(read.message, written.message);
+            assert_eq!(read.direction, written.direction);
+            assert_eq!(read.date, written.date);
+        }
+    }
+
+    #[test]
+    fn reject_invalid_file() {
+        let mut buffer = Vec::new();
+        write_recording(&mut buffer, &[RecordedMessage::new_test_instance()]).unwrap();
+        buffer[0] = b'X';
+        assert!(read_recording(&mut buffer.as_slice()).is_err());
+    }
+
+    #[test]
+    fn reject_truncated_file() {
+        let mut buffer = Vec::new();
+        write_recording(&mut buffer, &[RecordedMessage::new_test_instance()]).unwrap();
+        buffer.pop();
+        assert!(read_recording(&mut buffer.as_slice()).is_err());
+    }
+
+    #[test]
+    fn varints() {
+        for value in [0, 1, 127, 128, 300, u32::MAX as u64, u64::MAX] {
+            let mut buffer = Vec::new();
+            write_varint(&mut buffer, value).unwrap();
+            assert_eq!(read_varint(&mut buffer.as_slice()).unwrap(), value);
+        }
+        for value in [0, -1, 1, i64::MIN, i64::MAX] {
+            assert_eq!(unzigzag(zigzag(value)), value);
+        }
+    }
+}
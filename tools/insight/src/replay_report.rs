@@ -0,0 +1,260 @@
+use rsnano_node::{
+    stats::{DetailType, Direction, StatType},
+    Node,
+};
+use std::{
+    fmt::Display,
+    time::{Duration, Instant},
+};
+
+/// The node counters and queue depths at one point in time
+#[derive(Clone, Copy, Default)]
+pub(crate) struct ReplaySample {
+    pub blocks: u64,
+    pub cemented: u64,
+    pub votes: u64,
+    pub block_processor_queue: usize,
+    pub vote_processor_queue: usize,
+    pub confirming_set: usize,
+    pub active_elections: usize,
+}
+
+impl ReplaySample {
+    pub fn from_node(node: &Node) -> Self {
+        Self {
+            blocks: node.ledger.block_count(),
+            cemented: node.ledger.cemented_count(),
+            votes: node
+                .stats
+                .count(StatType::Vote, DetailType::VoteProcessed, Direction::In),
+            block_processor_queue: node.block_processor.info().total_size,
+            vote_processor_queue: node.vote_processor_queue.info().total_size,
+            confirming_set: node.confirming_set.info().size,
+            active_elections: node.active.info().total,
+        }
+    }
+
+    pub fn queues_empty(&self) -> bool {
+        self.block_processor_queue == 0
+            && self.vote_processor_queue == 0
+            && self.confirming_set == 0
+    }
+}
+
+/// Collects the samples taken while a recording is replayed and
+/// summarizes the throughput of the node
+pub(crate) struct ReplayReport {
+    start: ReplaySample,
+    start_time: Instant,
+    last: ReplaySample,
+    last_time: Instant,
+    max: ReplaySample,
+    peak_bps: u64,
+    peak_cps: u64,
+    peak_vps: u64,
+    pub replayed: usize,
+    pub dropped: usize,
+    pub backpressure_waits: usize,
+    pub unconfirmed: usize,
+    latencies: Vec<Duration>,
+}
+
+impl ReplayReport {
+    pub fn new(start: ReplaySample, now: Instant) -> Self {
+        Self {
+            start,
+            start_time: now,
+            last: start,
+            last_time: now,
+            max: ReplaySample::default(),
+            peak_bps: 0,
+            peak_cps: 0,
+            peak_vps: 0,
+            replayed: 0,
+            dropped: 0,
+            backpressure_waits: 0,
+            unconfirmed: 0,
+            latencies: Vec::new(),
+        }
+    }
+
+    pub fn add_sample(&mut self, sample: ReplaySample, now: Instant) {
+        let elapsed = now - self.last_time;
+        if !elapsed.is_zero() {
+            let rate = |current: u64, previous: u64| {
+                (current.saturating_sub(previous) as f64 / elapsed.as_secs_f64()) as u64
+            };
+            self.peak_bps = self.peak_bps.max(rate(sample.blocks, self.last.blocks));
+            self.peak_cps = self.peak_cps.max(rate(sample.cemented, self.last.cemented));
+            self.peak_vps = self.peak_vps.max(rate(sample.votes, self.last.votes));
+        }
+
+        self.max.block_processor_queue = self
+            .max
+            .block_processor_queue
+            .max(sample.block_processor_queue);
+        self.max.vote_processor_queue = self
+            .max
+            .vote_processor_queue
+            .max(sample.vote_processor_queue);
+        self.max.confirming_set = self.max.confirming_set.max(sample.confirming_set);
+        self.max.active_elections = self.max.active_elections.max(sample.active_elections);
+
+        self.last = sample;
+        self.last_time = now;
+    }
+
+    pub fn set_latencies(&mut self, latencies: &[Duration]) {
+        self.latencies = latencies.to_vec();
+        self.latencies.sort();
+    }
+
+    pub fn cemented_per_second(&self) -> u64 {
+        self.average_rate(self.last.cemented, self.start.cemented)
+    }
+
+    pub fn elapsed(&self) -> Duration {
+        self.last_time - self.start_time
+    }
+
+    fn average_rate(&self, current: u64, start: u64) -> u64 {
+        let elapsed = self.elapsed().as_secs_f64();
+        if elapsed == 0.0 {
+            0
+        } else {
+            (current.saturating_sub(start) as f64 / elapsed) as u64
+        }
+    }
+
+    fn percentile(&self, percent: usize) -> Duration {
+        if self.latencies.is_empty() {
+            return Duration::ZERO;
+        }
+        let index = (self.latencies.len() - 1) * percent / 100;
+        self.latencies[index]
+    }
+}
+
+impl Display for ReplayReport {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        let blocks = self.last.blocks.saturating_sub(self.start.blocks);
+        let cemented = self.last.cemented.saturating_sub(self.start.cemented);
+        let votes = self.last.votes.saturating_sub(self.start.votes);
+
+        writeln!(
+            f,
+            "replayed {} messages in {:.1}s, {} dropped, {} waits for a full inbound queue",
+            self.replayed,
+            self.elapsed().as_secs_f64(),
+            self.dropped,
+            self.backpressure_waits
+        )?;
+        writeln!(
+            f,
+            "blocks:      {} ({} blocks/s, peak {} blocks/s)",
+            blocks,
+            self.average_rate(self.last.blocks, self.start.blocks),
+            self.peak_bps
+        )?;
+        writeln!(
+            f,
+            "cemented:    {} ({} blocks/s, peak {} blocks/s)",
+            cemented,
+            self.average_rate(self.last.cemented, self.start.cemented),
+            self.peak_cps
+        )?;
+        writeln!(
+            f,
+            "votes:       {} ({} votes/s, peak {} votes/s)",
+            votes,
+            self.average_rate(self.last.votes, self.start.votes),
+            self.peak_vps
+        )?;
+        writeln!(
+            f,
+            "confirmation latency: p50 {}ms, p90 {}ms, p99 {}ms, max {}ms ({} confirmed, {} unconfirmed)",
+            self.percentile(50).as_millis(),
+            self.percentile(90).as_millis(),
+            self.percentile(99).as_millis(),
+            self.percentile(100).as_millis(),
+            self.latencies.len(),
+            self.unconfirmed
+        )?;
+        write!(
+            f,
+            "max queue depths: block processor {}, vote processor {}, confirming set {}, active elections {}",
+            self.max.block_processor_queue,
+            self.max.vote_processor_queue,
+            self.max.confirming_set,
+            self.max.active_elections
+        )
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn rates() {
+        let start = Instant::now();
+        let mut report = ReplayReport::new(ReplaySample::default(), start);
+        report.add_sample(
+            ReplaySample {
+                blocks: 100,
+                cemented: 10,
+                votes: 1000,
+                ..Default::default()
+            },
+            start + Duration::from_secs(1),
+        );
+        report.add_sample(
+            ReplaySample {
+                blocks: 400,
+                cemented: 20,
+                votes: 2000,
+                ..Default::default()
+            },
+            start + Duration::from_secs(2),
+        );
+
+        assert_eq!(report.average_rate(report.last.blocks, 0), 200);
+        assert_eq!(report.peak_bps, 300);
+        assert_eq!(report.peak_cps, 10);
+        assert_eq!(report.peak_vps, 1000);
+    }
+
+    #[test]
+    fn max_queue_depths() {
+        let start = Instant::now();
+        let mut report = ReplayReport::new(ReplaySample::default(), start);
+        report.add_sample(
+            ReplaySample {
+                block_processor_queue: 10,
+                vote_processor_queue: 5,
+                ..Default::default()
+            },
+            start + Duration::from_secs(1),
+        );
+        report.add_sample(
+            ReplaySample {
+                block_processor_queue: 3,
+                vote_processor_queue: 7,
+                ..Default::default()
+            },
+            start + Duration::from_secs(2),
+        );
+        assert_eq!(report.max.block_processor_queue, 10);
+        assert_eq!(report.max.vote_processor_queue, 7);
+    }
+
+    #[test]
+    fn latency_percentiles() {
+        let mut report = ReplayReport::new(ReplaySample::default(), Instant::now());
+        let latencies: Vec<_> = (1..=100).rev().map(Duration::from_millis).collect();
+        report.set_latencies(&latencies);
+        assert_eq!(report.percentile(50), Duration::from_millis(50));
+        assert_eq!(report.percentile(99), Duration::from_millis(99));
+        assert_eq!(report.percentile(100), Duration::from_millis(100));
+    }
+}
@@ -3,7 +3,7 @@ use crate::{
     node_runner::{NodeRunner, NodeState},
 };
 use rsnano_core::Networks;
-use rsnano_node::{working_path_for, Node};
+use rsnano_node::{config::NodeFlags, working_path_for, Node};
 use rsnano_nullable_clock::SteadyClock;
 use std::sync::Arc;
 
@@ -42,8 +42,12 @@ impl NodeRunnerViewModel {
 
     pub(crate) fn start_node(&mut self) {
         let callbacks = make_node_callbacks(self.msg_recorder.clone(), self.clock.clone());
-        self.node_runner
-            .start_node(self.network, &self.data_path, callbacks);
+        self.node_runner.start_node(
+            self.network,
+            &self.data_path,
+            callbacks,
+            NodeFlags::default(),
+        );
     }
 
     pub(crate) fn stop_node(&mut self) {
@@ -11,13 +11,14 @@ use rsnano_node::{
     unique_path,
     utils::AsyncRuntime,
     wallets::WalletsExt,
-    NetworkParams, Node, NodeBuilder, NodeExt,
+    NetworkParams, Node, NodeBuilder, NodeCallbacks, NodeExt,
 };
 use rsnano_nullable_tcp::TcpStream;
 use rsnano_rpc_client::{NanoRpcClient, Url};
 use rsnano_rpc_server::run_rpc_server;
 use std::{
     net::{IpAddr, Ipv6Addr, SocketAddr, TcpListener},
+    path::PathBuf,
     sync::{
         atomic::{AtomicU16, Ordering},
         Arc, OnceLock,
@@ -79,6 +80,8 @@ impl System {
             config: None,
             flags: None,
             disconnected: false,
+            data_path: None,
+            callbacks: None,
         }
     }
 
@@ -107,8 +110,10 @@ impl System {
         config: NodeConfig,
         flags: NodeFlags,
         disconnected: bool,
+        data_path: Option<PathBuf>,
+        callbacks: Option<NodeCallbacks>,
     ) -> Arc<Node> {
-        let node = self.new_node(config, flags);
+        let node = self.new_node(config, flags, data_path, callbacks);
 
         self.setup_node(&node);
 
@@ -156,18 +161,25 @@ impl System {
         node
     }
 
-    fn new_node(&self, config: NodeConfig, flags: NodeFlags) -> Arc<Node> {
-        let path = unique_path().expect("Could not get a unique path");
-        let node = NodeBuilder::new(self.network_params.network.current_network)
+    fn new_node(
+        &self,
+        config: NodeConfig,
+        flags: NodeFlags,
+        data_path: Option<PathBuf>,
+        callbacks: Option<NodeCallbacks>,
+    ) -> Arc<Node> {
+        let path = data_path.unwrap_or_else(|| unique_path().expect("Could not get a unique path"));
+        let mut builder = NodeBuilder::new(self.network_params.network.current_network)
             .runtime(self.runtime.tokio.handle().clone())
             .data_path(path)
             .config(config)
             .network_params(self.network_params.clone())
             .flags(flags)
-            .work(self.work.clone())
-            .finish()
-            .unwrap();
-        Arc::new(node)
+            .work(self.work.clone());
+        if let Some(callbacks) = callbacks {
+            builder = builder.callbacks(callbacks);
+        }
+        Arc::new(builder.finish().unwrap())
     }
 
     fn stop(&mut self) {
@@ -190,6 +202,8 @@ pub struct TestNodeBuilder<'a> {
     config: Option<NodeConfig>,
     flags: Option<NodeFlags>,
     disconnected: bool,
+    data_path: Option<PathBuf>,
+    callbacks: Option<NodeCallbacks>,
 }
 
 impl<'a> TestNodeBuilder<'a> {
@@ -208,10 +222,27 @@ impl<'a> TestNodeBuilder<'a> {
         self
     }
 
+    /// Uses an existing data path instead of a new unique one. It gets deleted with the system
+    pub fn data_path(mut self, path: impl Into<PathBuf>) -> Self {
+        self.data_path = Some(path.into());
+        self
+    }
+
+    pub fn callbacks(mut self, callbacks: NodeCallbacks) -> Self {
+        self.callbacks = Some(callbacks);
+        self
+    }
+
     pub fn finish(self) -> Arc<Node> {
         let config = self.config.unwrap_or_else(|| System::default_config());
         let flags = self.flags.unwrap_or_default();
-        self.system.make_node_with(config, flags, self.disconnected)
+        self.system.make_node_with(
+            config,
+            flags,
+            self.disconnected,
+            self.data_path,
+            self.callbacks,
+        )
     }
 }
 
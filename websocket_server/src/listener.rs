@@ -1,12 +1,17 @@
 use super::{ConfirmationJsonOptions, ConfirmationOptions, Options, WebsocketSessionEntry};
-use crate::WebsocketSession;
+use crate::{serialize_message, SerializedMessage, WebsocketSession};
 use rsnano_core::{Account, Amount, BlockSideband, SavedBlock, VoteWithWeightInfo};
-use rsnano_node::{consensus::ElectionStatus, wallets::Wallets};
+use rsnano_node::{
+    consensus::ElectionStatus,
+    stats::{DetailType, StatType, Stats},
+    wallets::Wallets,
+};
 use rsnano_websocket_messages::{OutgoingMessageEnvelope, Topic};
 use serde::{Deserialize, Serialize};
 use serde_json::Value;
 use std::{
     borrow::Cow,
+    collections::HashMap,
     net::SocketAddr,
     sync::{
         atomic::{AtomicUsize, Ordering},
@@ -19,8 +24,11 @@ use tokio::{
     sync::{mpsc, oneshot},
 };
 use tokio_tungstenite::tungstenite::protocol::{frame::coding::CloseCode, CloseFrame};
-use tracing::{info, warn};
+use tracing::{debug, info, warn};
 
+/// Broadcasts are handed over to a fan-out task, so that the node threads that notify
+/// about events never wait for websocket clients. The fan-out task serializes every
+/// distinct message once and queues it for each subscribed session without blocking.
 pub struct WebsocketListener {
     endpoint: Mutex<SocketAddr>,
     tx_stop: Mutex<Option<oneshot::Sender<()>>>,
@@ -30,10 +38,26 @@ pub struct WebsocketListener {
     tokio: tokio::runtime::Handle,
     bound: Mutex<bool>,
     bound_condition: Condvar,
+    tx_broadcast: mpsc::Sender<Broadcast>,
+    rx_broadcast: Mutex<Option<mpsc::Receiver<Broadcast>>>,
+    send_queue_size: usize,
+    disconnect_slow_clients: bool,
+    stats: Arc<Stats>,
 }
 
 impl WebsocketListener {
-    pub fn new(endpoint: SocketAddr, wallets: Arc<Wallets>, tokio: tokio::runtime::Handle) -> Self {
+    /// Maximum number of broadcasts waiting for the fan-out task
+    pub const BROADCAST_QUEUE_SIZE: usize = 16 * 1024;
+
+    pub fn new(
+        endpoint: SocketAddr,
+        wallets: Arc<Wallets>,
+        tokio: tokio::runtime::Handle,
+        send_queue_size: usize,
+        disconnect_slow_clients: bool,
+        stats: Arc<Stats>,
+    ) -> Self {
+        let (tx_broadcast, rx_broadcast) = mpsc::channel(Self::BROADCAST_QUEUE_SIZE);
         Self {
             endpoint: Mutex::new(endpoint),
             tx_stop: Mutex::new(None),
@@ -43,6 +67,11 @@ impl WebsocketListener {
             tokio,
             bound: Mutex::new(false),
             bound_condition: Condvar::new(),
+            tx_broadcast,
+            rx_broadcast: Mutex::new(Some(rx_broadcast)),
+            send_queue_size: send_queue_size.max(1),
+            disconnect_slow_clients,
+            stats,
         }
     }
 
@@ -77,9 +106,17 @@ impl WebsocketListener {
         let (tx_stop, rx_stop) = oneshot::channel::<()>();
         *self.tx_stop.lock().unwrap() = Some(tx_stop);
 
+        let rx_broadcast = self
+            .rx_broadcast
+            .lock()
+            .unwrap()
+            .take()
+            .expect("websocket listener already started");
+
         tokio::select! {
             _ = rx_stop =>{},
            _ = self.accept(listener) =>{}
+           _ = self.fan_out(rx_broadcast) =>{}
         }
     }
 
@@ -104,12 +141,7 @@ impl WebsocketListener {
 
     /// Broadcast \p message to all session subscribing to the message topic.
     pub fn broadcast(&self, message: &OutgoingMessageEnvelope) {
-        let sessions = self.sessions.lock().unwrap();
-        for session in sessions.iter() {
-            if let Some(session) = session.upgrade() {
-                let _ = session.blocking_write(message);
-            }
-        }
+        self.enqueue_broadcast(Broadcast::Message(message.clone()));
     }
 
     /// Broadcast block confirmation. The content of the message depends on subscription options (such as "include_block")
@@ -122,55 +154,77 @@ impl WebsocketListener {
         election_status_a: &ElectionStatus,
         election_votes_a: &Vec<VoteWithWeightInfo>,
     ) {
-        let mut msg_with_block = None;
-        let mut msg_without_block = None;
-        let sessions = self.sessions.lock().unwrap();
-        for session in sessions.iter() {
-            if let Some(session) = session.upgrade() {
+        self.enqueue_broadcast(Broadcast::Confirmation(Box::new(ConfirmationBroadcast {
+            block: block_a.clone(),
+            account: *account_a,
+            amount: *amount_a,
+            subtype: subtype.to_string(),
+            election_status: election_status_a.clone(),
+            election_votes: election_votes_a.clone(),
+        })));
+    }
+
+    fn enqueue_broadcast(&self, broadcast: Broadcast) {
+        if self.tx_broadcast.try_send(broadcast).is_err() {
+            self.stats
+                .inc(StatType::Websocket, DetailType::BroadcastOverflow);
+            debug!("Websocket broadcast queue full, dropping message");
+        }
+    }
+
+    async fn fan_out(&self, mut rx_broadcast: mpsc::Receiver<Broadcast>) {
+        while let Some(broadcast) = rx_broadcast.recv().await {
+            let sessions: Vec<_> = self
+                .sessions
+                .lock()
+                .unwrap()
+                .iter()
+                .filter_map(|s| s.upgrade())
+                .collect();
+
+            match broadcast {
+                Broadcast::Message(message) => fan_out_message(&sessions, &message),
+                Broadcast::Confirmation(confirmation) => {
+                    self.fan_out_confirmation(&sessions, &confirmation)
+                }
+            }
+        }
+    }
+
+    fn fan_out_confirmation(
+        &self,
+        sessions: &[Arc<WebsocketSessionEntry>],
+        confirmation: &ConfirmationBroadcast,
+    ) {
+        // Every combination of options that changes the content is built and serialized once
+        let mut variants: HashMap<
+            ConfirmationVariant,
+            (OutgoingMessageEnvelope, Option<SerializedMessage>),
+        > = HashMap::new();
+        let default_variant = ConfirmationVariant::from(&ConfirmationOptions::new(
+            Arc::clone(&self.wallets),
+            ConfirmationJsonOptions::default(),
+        ));
+
+        for session in sessions {
+            let variant = {
                 let subs = session.subscriptions.lock().unwrap();
-                if let Some(options) = subs.get(&Topic::Confirmation) {
-                    let default_opts = ConfirmationOptions::new(
-                        Arc::clone(&self.wallets),
-                        ConfirmationJsonOptions::default(),
-                    );
-                    let conf_opts = if let Options::Confirmation(i) = options {
-                        i
-                    } else {
-                        &default_opts
-                    };
-
-                    let include_block = conf_opts.include_block;
-
-                    if include_block && msg_with_block.is_none() {
-                        msg_with_block = Some(block_confirmed_message(
-                            block_a,
-                            account_a,
-                            amount_a,
-                            subtype.to_string(),
-                            include_block,
-                            election_status_a,
-                            election_votes_a,
-                            conf_opts,
-                        ));
-                    } else if !include_block && msg_without_block.is_none() {
-                        msg_without_block = Some(block_confirmed_message(
-                            block_a,
-                            account_a,
-                            amount_a,
-                            subtype.to_string(),
-                            include_block,
-                            election_status_a,
-                            election_votes_a,
-                            conf_opts,
-                        ));
-                    }
-                    drop(subs);
-                    let _ = session.blocking_write(if include_block {
-                        msg_with_block.as_ref().unwrap()
-                    } else {
-                        msg_without_block.as_ref().unwrap()
-                    });
+                let Some(options) = subs.get(&Topic::Confirmation) else {
+                    continue;
+                };
+                match options {
+                    Options::Confirmation(i) => ConfirmationVariant::from(i),
+                    _ => default_variant,
                 }
+            };
+
+            let (message, serialized) = variants
+                .entry(variant)
+                .or_insert_with(|| (block_confirmed_message(confirmation, variant), None));
+
+            if !session.should_filter(message) {
+                let serialized = serialized.get_or_insert_with(|| serialize_message(message));
+                session.enqueue(serialized.clone());
             }
         }
     }
@@ -179,13 +233,22 @@ impl WebsocketListener {
         loop {
             match listener.accept().await {
                 Ok((stream, peer_addr)) => {
+                    let (tx_close, rx_close) = oneshot::channel::<()>();
                     let wallets = Arc::clone(&self.wallets);
                     let sub_count = Arc::clone(&self.topic_subscriber_count);
-                    let (tx_send, rx_send) = mpsc::channel::<OutgoingMessageEnvelope>(1024);
+                    let (tx_send, rx_send) =
+                        mpsc::channel::<SerializedMessage>(self.send_queue_size);
+                    let entry = WebsocketSessionEntry::new(
+                        tx_send,
+                        tx_close,
+                        self.disconnect_slow_clients,
+                        Arc::clone(&self.stats),
+                    );
                     let sessions = Arc::clone(&self.sessions);
                     tokio::spawn(async move {
                         if let Err(e) = accept_connection(
-                            stream, wallets, sub_count, peer_addr, tx_send, rx_send, sessions,
+                            stream, wallets, sub_count, peer_addr, entry, rx_close, rx_send,
+                            sessions,
                         )
                         .await
                         {
@@ -228,15 +291,15 @@ async fn accept_connection(
     wallets: Arc<Wallets>,
     topic_subscriber_count: Arc<[AtomicUsize; 11]>,
     peer_addr: SocketAddr,
-    tx_send: mpsc::Sender<OutgoingMessageEnvelope>,
-    mut rx_send: mpsc::Receiver<OutgoingMessageEnvelope>,
+    entry: WebsocketSessionEntry,
+    rx_close: oneshot::Receiver<()>,
+    mut rx_send: mpsc::Receiver<SerializedMessage>,
     sessions: Arc<Mutex<Vec<Weak<WebsocketSessionEntry>>>>,
 ) -> anyhow::Result<()> {
     // Create the session and initiate websocket handshake
     let mut ws_stream = tokio_tungstenite::accept_async(stream).await?;
 
-    let (tx_close, rx_close) = oneshot::channel::<()>();
-    let entry = Arc::new(WebsocketSessionEntry::new(tx_send, tx_close));
+    let entry = Arc::new(entry);
 
     {
         let mut sessions = sessions.lock().unwrap();
@@ -263,32 +326,81 @@ async fn accept_connection(
     Ok(())
 }
 
-fn block_confirmed_message(
-    block: &SavedBlock,
-    account: &Account,
-    amount: &Amount,
+fn fan_out_message(sessions: &[Arc<WebsocketSessionEntry>], message: &OutgoingMessageEnvelope) {
+    let mut serialized = None;
+    for session in sessions {
+        if !session.should_filter(message) {
+            let serialized = serialized.get_or_insert_with(|| serialize_message(message));
+            session.enqueue(serialized.clone());
+        }
+    }
+}
+
+enum Broadcast {
+    Message(OutgoingMessageEnvelope),
+    Confirmation(Box<ConfirmationBroadcast>),
+}
+
+struct ConfirmationBroadcast {
+    block: SavedBlock,
+    account: Account,
+    amount: Amount,
     subtype: String,
+    election_status: ElectionStatus,
+    election_votes: Vec<VoteWithWeightInfo>,
+}
+
+/// The subscription options that change the content of a confirmation message
+#[derive(Clone, Copy, PartialEq, Eq, Hash)]
+struct ConfirmationVariant {
     include_block: bool,
-    election_status: &ElectionStatus,
-    election_votes: &[VoteWithWeightInfo],
-    options: &ConfirmationOptions,
+    include_election_info: bool,
+    include_election_info_with_votes: bool,
+    include_sideband_info: bool,
+}
+
+impl From<&ConfirmationOptions> for ConfirmationVariant {
+    fn from(options: &ConfirmationOptions) -> Self {
+        Self {
+            include_block: options.include_block,
+            include_election_info: options.include_election_info,
+            include_election_info_with_votes: options.include_election_info_with_votes,
+            include_sideband_info: options.include_sideband_info,
+        }
+    }
+}
+
+fn block_confirmed_message(
+    confirmation: &ConfirmationBroadcast,
+    variant: ConfirmationVariant,
 ) -> OutgoingMessageEnvelope {
-    let election_info = if options.include_election_info || options.include_election_info_with_votes
+    let block = &confirmation.block;
+    let election_status = &confirmation.election_status;
+    let election_info = if variant.include_election_info || variant.include_election_info_with_votes
     {
         let mut info = ElectionInfo::from(election_status);
-        if options.include_election_info_with_votes {
-            info.votes = Some(election_votes.iter().map(|v| v.into()).collect());
+        if variant.include_election_info_with_votes {
+            info.votes = Some(
+                confirmation
+                    .election_votes
+                    .iter()
+                    .map(|v| v.into())
+                    .collect(),
+            );
         }
         Some(info)
     } else {
         None
     };
 
-    let block_json = if include_block {
+    let block_json = if variant.include_block {
         let mut block_node_l: serde_json::Value = (**block).clone().into();
-        if !subtype.is_empty() {
+        if !confirmation.subtype.is_empty() {
             if let serde_json::Value::Object(o) = &mut block_node_l {
-                o.insert("subtype".to_string(), Value::String(subtype));
+                o.insert(
+                    "subtype".to_string(),
+                    Value::String(confirmation.subtype.clone()),
+                );
             }
         }
         Some(block_node_l)
@@ -296,7 +408,7 @@ fn block_confirmed_message(
         None
     };
 
-    let sideband = if options.include_sideband_info {
+    let sideband = if variant.include_sideband_info {
         Some(block.sideband().into())
     } else {
         None
@@ -305,8 +417,8 @@ fn block_confirmed_message(
     OutgoingMessageEnvelope::new(
         Topic::Confirmation,
         BlockConfirmed {
-            account: account.encode_account(),
-            amount: amount.to_string_dec(),
+            account: confirmation.account.encode_account(),
+            amount: confirmation.amount.to_string_dec(),
             hash: block.hash().to_string(),
             confirmation_type: election_status.election_status_type.as_str().to_string(),
             election_info,
@@ -35,6 +35,9 @@ pub fn create_websocket_server(
         endpoint,
         node.wallets.clone(),
         node.runtime.clone(),
+        config.send_queue_size,
+        config.disconnect_slow_clients,
+        node.stats.clone(),
     ));
 
     let server_w = Arc::downgrade(&server);
@@ -1,6 +1,9 @@
 use super::{ConfirmationJsonOptions, ConfirmationOptions, Options, VoteJsonOptions, VoteOptions};
 use futures_util::{SinkExt, StreamExt};
-use rsnano_node::wallets::Wallets;
+use rsnano_node::{
+    stats::{DetailType, StatType, Stats},
+    wallets::Wallets,
+};
 use rsnano_websocket_messages::{to_topic, IncomingMessage, OutgoingMessageEnvelope, Topic};
 use std::{
     collections::HashMap,
@@ -10,38 +13,76 @@ use std::{
         Arc, Mutex,
     },
 };
-use tokio::sync::{mpsc, oneshot};
-use tracing::{info, trace, warn};
+use tokio::sync::{
+    mpsc::{self, error::TrySendError},
+    oneshot,
+};
+use tracing::{debug, info, trace, warn};
+
+/// A serialized message. The same payload is shared by every session it is sent to
+pub type SerializedMessage = Arc<String>;
+
+pub fn serialize_message(envelope: &OutgoingMessageEnvelope) -> SerializedMessage {
+    Arc::new(serde_json::to_string_pretty(envelope).unwrap())
+}
 
 pub struct WebsocketSessionEntry {
     /// Map of subscriptions -> options registered by this session.
     pub subscriptions: Mutex<HashMap<Topic, Options>>,
-    send_queue_tx: mpsc::Sender<OutgoingMessageEnvelope>,
+    send_queue_tx: mpsc::Sender<SerializedMessage>,
     tx_close: Mutex<Option<oneshot::Sender<()>>>,
+    disconnect_when_full: bool,
+    dropped: AtomicUsize,
+    stats: Arc<Stats>,
 }
 
 impl WebsocketSessionEntry {
     pub fn new(
-        send_queue_tx: mpsc::Sender<OutgoingMessageEnvelope>,
+        send_queue_tx: mpsc::Sender<SerializedMessage>,
         tx_close: oneshot::Sender<()>,
+        disconnect_when_full: bool,
+        stats: Arc<Stats>,
     ) -> Self {
         Self {
             subscriptions: Mutex::new(HashMap::new()),
             send_queue_tx,
             tx_close: Mutex::new(Some(tx_close)),
+            disconnect_when_full,
+            dropped: AtomicUsize::new(0),
+            stats,
         }
     }
 
-    pub fn blocking_write(&self, envelope: &OutgoingMessageEnvelope) -> anyhow::Result<()> {
-        if !self.should_filter(&envelope) {
-            self.send_queue_tx.blocking_send(envelope.clone())?;
+    /// Queues a broadcast message without waiting. If the client doesn't keep up
+    /// the message is dropped, or the session gets closed if so configured
+    pub fn enqueue(&self, message: SerializedMessage) {
+        match self.send_queue_tx.try_send(message) {
+            Ok(()) => {}
+            Err(TrySendError::Full(_)) => {
+                if self.disconnect_when_full {
+                    self.stats
+                        .inc(StatType::Websocket, DetailType::SlowClientDisconnected);
+                    info!("Closing websocket session, because the client is too slow");
+                    self.close();
+                } else {
+                    self.stats
+                        .inc(StatType::Websocket, DetailType::SendQueueOverflow);
+                    let dropped = self.dropped.fetch_add(1, Ordering::Relaxed) + 1;
+                    debug!(dropped, "Websocket send queue full, dropping message");
+                }
+            }
+            Err(TrySendError::Closed(_)) => {}
         }
-        Ok(())
+    }
+
+    /// Number of messages that were dropped, because the send queue was full
+    pub fn dropped(&self) -> usize {
+        self.dropped.load(Ordering::Relaxed)
     }
 
     pub async fn write(&self, envelope: &OutgoingMessageEnvelope) -> anyhow::Result<()> {
         if !self.should_filter(&envelope) {
-            self.send_queue_tx.send(envelope.clone()).await?
+            self.send_queue_tx.send(serialize_message(envelope)).await?
         }
         Ok(())
     }
@@ -53,7 +94,7 @@ impl WebsocketSessionEntry {
         }
     }
 
-    fn should_filter(&self, envelope: &OutgoingMessageEnvelope) -> bool {
+    pub fn should_filter(&self, envelope: &OutgoingMessageEnvelope) -> bool {
         if envelope.ack.is_some() {
             return false;
         }
@@ -101,7 +142,7 @@ impl WebsocketSession {
     pub async fn run(
         self,
         stream: &mut tokio_tungstenite::WebSocketStream<tokio::net::TcpStream>,
-        send_queue: &mut mpsc::Receiver<OutgoingMessageEnvelope>,
+        send_queue: &mut mpsc::Receiver<SerializedMessage>,
     ) -> anyhow::Result<()> {
         loop {
             tokio::select! {
@@ -111,12 +152,11 @@ impl WebsocketSession {
                     }
                 }
                 Some(msg) = send_queue.recv() =>{
-                    let message_text = serde_json::to_string_pretty(&msg).unwrap();
-                    trace!(message = message_text, "sending websocket message");
+                    trace!(message = %msg, "sending websocket message");
                     // write queued messages
                     stream
                         .send(tokio_tungstenite::tungstenite::Message::text(
-                            message_text,
+                            msg.as_str(),
                         )).await?;
                 }
                 else =>{
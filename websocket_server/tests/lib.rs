@@ -8,16 +8,22 @@ use rsnano_ledger::{DEV_GENESIS_ACCOUNT, DEV_GENESIS_HASH};
 use rsnano_messages::{Message, Publish};
 use rsnano_node::{
     config::{NetworkConstants, NodeConfig, WebsocketConfig},
+    stats::{DetailType, Direction, StatType, Stats},
     Node,
 };
 use rsnano_websocket_messages::{OutgoingMessageEnvelope, Topic};
 use rsnano_websocket_server::{
     create_websocket_server, vote_received, BlockConfirmed, TelemetryReceived, VoteReceived,
-    WebsocketListener, WebsocketListenerExt,
+    WebsocketListener, WebsocketListenerExt, WebsocketSessionEntry,
 };
 use std::{sync::Arc, time::Duration};
 use test_helpers::{assert_timely, get_available_port, make_fake_channel, System};
-use tokio::{net::TcpStream, task::spawn_blocking, time::timeout};
+use tokio::{
+    net::TcpStream,
+    sync::{mpsc, oneshot},
+    task::spawn_blocking,
+    time::timeout,
+};
 use tokio_tungstenite::{connect_async, tungstenite, MaybeTlsStream, WebSocketStream};
 
 /// Tests getting notification of a started election
@@ -653,6 +659,91 @@ fn new_unconfirmed_block() {
     });
 }
 
+#[test]
+// Tests that the fan-out task delivers one broadcast to every subscribed session
+fn broadcast_to_all_subscribers() {
+    let mut system = System::new();
+    let (node1, websocket) = create_node_with_websocket(&mut system);
+    node1.runtime.block_on(async {
+        let mut clients = Vec::new();
+        for _ in 0..2 {
+            let mut ws_stream = connect_websocket(&node1).await;
+            ws_stream
+                .send(tungstenite::Message::Text(
+                    r#"{"action": "subscribe", "topic": "vote", "ack": true}"#.to_string(),
+                ))
+                .await
+                .unwrap();
+            //await ack
+            ws_stream.next().await.unwrap().unwrap();
+            clients.push(ws_stream);
+        }
+        assert_eq!(websocket.subscriber_count(Topic::Vote), 2);
+
+        let vote = Vote::new(&DEV_GENESIS_KEY, 0, 0, vec![*DEV_GENESIS_HASH]);
+        websocket.broadcast(&vote_received(&vote, VoteCode::Vote));
+
+        for ws_stream in &mut clients {
+            let Ok(response) = timeout(Duration::from_secs(5), ws_stream.next()).await else {
+                panic!("timeout");
+            };
+            let response = response.unwrap().unwrap();
+            let response_msg: OutgoingMessageEnvelope =
+                serde_json::from_str(response.to_text().unwrap()).unwrap();
+            assert_eq!(response_msg.topic, Some(Topic::Vote));
+        }
+    });
+}
+
+#[test]
+// Tests that a full send queue drops the message instead of waiting for the client
+fn drop_message_when_send_queue_is_full() {
+    let stats = Arc::new(Stats::default());
+    let (tx_send, mut rx_send) = mpsc::channel(1);
+    let (tx_close, mut rx_close) = oneshot::channel();
+    let session = WebsocketSessionEntry::new(tx_send, tx_close, false, stats.clone());
+
+    for _ in 0..3 {
+        session.enqueue(Arc::new("message".to_string()));
+    }
+
+    assert_eq!(session.dropped(), 2);
+    assert_eq!(
+        stats.count(
+            StatType::Websocket,
+            DetailType::SendQueueOverflow,
+            Direction::In
+        ),
+        2
+    );
+    assert!(rx_send.try_recv().is_ok());
+    assert!(rx_close.try_recv().is_err());
+}
+
+#[test]
+// Tests that a slow client gets disconnected when disconnect_slow_clients is enabled
+fn disconnect_slow_client() {
+    let stats = Arc::new(Stats::default());
+    let (tx_send, _rx_send) = mpsc::channel(1);
+    let (tx_close, mut rx_close) = oneshot::channel();
+    let session = WebsocketSessionEntry::new(tx_send, tx_close, true, stats.clone());
+
+    session.enqueue(Arc::new("message".to_string()));
+    assert!(rx_close.try_recv().is_err());
+    session.enqueue(Arc::new("message".to_string()));
+
+    assert!(rx_close.try_recv().is_ok());
+    assert_eq!(session.dropped(), 0);
+    assert_eq!(
+        stats.count(
+            StatType::Websocket,
+            DetailType::SlowClientDisconnected,
+            Direction::In
+        ),
+        1
+    );
+}
+
 fn create_node_with_websocket(system: &mut System) -> (Arc<Node>, Arc<WebsocketListener>) {
     let websocket_port = get_available_port();
     let config = NodeConfig {
@@ -664,15 +755,8 @@ fn create_node_with_websocket(system: &mut System) -> (Arc<Node>, Arc<WebsocketL
         ..System::default_config()
     };
     let node = system.build_node().config(config).finish();
-    let websocket_server = create_websocket_server(
-        WebsocketConfig {
-            enabled: node.config.websocket_config.enabled,
-            port: node.config.websocket_config.port,
-            address: node.config.websocket_config.address.clone(),
-        },
-        &node,
-    )
-    .unwrap();
+    let websocket_server =
+        create_websocket_server(node.config.websocket_config.clone(), &node).unwrap();
 
     websocket_server.start();
     (node, websocket_server)